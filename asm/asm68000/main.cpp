@@ -13,7 +13,7 @@ int usage()
     std::cout << "  -h, --help    Show this help message" << std::endl;
     std::cout << "  -t, --tree    Show parse tree" << std::endl;
     std::cout << "  -o, --output  <binary file>  Save binary output" << std::endl;
-    std::cout << "  -s, --symbols <symbols file> Save the symbol table" << std::endl;
+    std::cout << "  -s, --symbols <symbols file> Save the symbol table, and its binary form in the .symb file" << std::endl;
     std::cout << "  -l, --listing <listing file> Save the assembly listing" << std::endl;
     return 0;
 }
@@ -148,6 +148,12 @@ int main(int argc, const char * argv[])
     {
         std::cerr << "error saving symbols file: " << symbolsFilename << std::endl;
         return 1;
+    }
+    std::string binarySymbolsFilename = std::filesystem::path(symbolsFilename).replace_extension(".symb").string();
+    if (saveSymbols && !parser.saveBinarySymbols(binarySymbolsFilename.c_str()))
+    {
+        std::cerr << "error saving symbols file: " << binarySymbolsFilename << std::endl;
+        return 1;
     }
 	return 0;
 }
@@ -1,5 +1,6 @@
 #include <boost/test/unit_test.hpp>
 #include "asmparser.h"
+#include "symboltable.h"
 #include "util.h"
 namespace parserTest
 {
@@ -223,5 +224,28 @@ namespace parserTest
         }
     }
 
+    BOOST_AUTO_TEST_CASE(binary_symbol_save)
+    {
+        asmparser parser;
+        parser.parseText(" org $1000\nstart: nop\n bsr finish\nfinish: nop\n end start\n");
+        validate_noErrors(parser);
+        const asmResult& result = parser.getCode68000();
+
+        bool saved = result.saveBinarySymbols("symbols.symb");
+        BOOST_CHECK(saved);
+
+        // the disassembler reads the file in place
+        mc68000::SymbolTable table;
+        bool loaded = table.load("symbols.symb");
+        BOOST_CHECK(loaded);
+        BOOST_CHECK_EQUAL(result.labels.size(), table.size());
+        for (const auto& [label, address] : result.labels)
+        {
+            size_t index = table.find(address);
+            BOOST_REQUIRE(index != mc68000::SymbolTable::npos);
+            BOOST_CHECK_EQUAL(label, std::string(table.getName(index)));
+        }
+    }
+
 	BOOST_AUTO_TEST_SUITE_END()
 }
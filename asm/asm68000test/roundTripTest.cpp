@@ -0,0 +1,62 @@
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "asmparser.h"
+#include "imagefile.h"
+#include "sourcewriter.h"
+#include "util.h"
+
+namespace roundTripTest
+{
+	const std::filesystem::path examples(ASM_EXAMPLES_DIR);
+
+	std::vector<char> fileContent(const std::string& fileName)
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	/// <summary>
+	/// Disassembles an example as source with dasm68000's SourceWriter, assembles the source and compares
+	/// the binary with the example.
+	/// </summary>
+	void checkRoundTrip(const char* name)
+	{
+		std::string binary = (examples / name).string();
+		mc68000::ImageFile image(binary);
+		std::ostringstream source;
+		mc68000::SourceWriter writer(source);
+		writer.setHeader(image.getStart(), image.getMemoryStart(), image.getMemoryEnd());
+		writer.write(image.getBlocks());
+
+		asmparser parser;
+		parser.parseText(source.str().c_str());
+		validate_noErrors(parser);
+		std::string output = std::string("roundtrip_") + name;
+		BOOST_REQUIRE(parser.saveBinary(output.c_str()));
+		BOOST_CHECK(fileContent(binary) == fileContent(output));
+	}
+
+	BOOST_AUTO_TEST_SUITE(roundTripTest)
+
+	BOOST_AUTO_TEST_CASE(tinybasic)
+	{
+		checkRoundTrip("tinybasic.bin");
+	}
+
+	BOOST_AUTO_TEST_CASE(game)
+	{
+		checkRoundTrip("game.bin");
+	}
+
+	BOOST_AUTO_TEST_CASE(io)
+	{
+		checkRoundTrip("io.bin");
+	}
+
+	BOOST_AUTO_TEST_SUITE_END()
+}
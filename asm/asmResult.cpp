@@ -1,6 +1,11 @@
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include "asmResult.h"
+#include "symboltable.h"
+
+// the binary symbols files are read in place by the SymbolTable of the disassembler
+using mc68000::SymbolTable;
 
 bool asmResult::saveBinary(const char* filename) const
 {
@@ -73,6 +78,127 @@ bool asmResult::saveSymbols(const char* filename) const
     return true;
 }
 
+bool asmResult::saveBinarySymbols(const char* filename) const
+{
+    std::ofstream outputFile(filename, std::ios::binary);
+    if (!outputFile)
+    {
+        return false;
+    }
+    // the names are gathered in a pool of null terminated strings, referred to by their offset
+    std::string pool;
+    auto addName = [&pool](const std::string& name)
+    {
+        uint32_t offset = static_cast<uint32_t>(pool.size());
+        pool.append(name.c_str(), name.size() + 1);
+        return offset;
+    };
+
+    // the labels are sorted by address for the binary search, the names of equal addresses stay in order
+    std::vector<std::pair<uint32_t, uint32_t>> sortedLabels;
+    sortedLabels.reserve(labels.size());
+    for (const auto& [label, address] : labels)
+    {
+        sortedLabels.emplace_back(address, addName(label));
+    }
+    std::stable_sort(sortedLabels.begin(), sortedLabels.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<uint32_t> symbolsTable;
+    for (const auto& [symbol, value] : symbols)
+    {
+        uint32_t name = addName(symbol);
+        if (value.type() == typeid(int32_t))
+        {
+            symbolsTable.insert(symbolsTable.end(), { name, static_cast<uint32_t>(SymbolTable::SymbolKind::Integer), static_cast<uint32_t>(any_cast<int32_t>(value)) });
+        }
+        else if (value.type() == typeid(uint32_t))
+        {
+            symbolsTable.insert(symbolsTable.end(), { name, static_cast<uint32_t>(SymbolTable::SymbolKind::Unsigned), any_cast<uint32_t>(value) });
+        }
+        else if (value.type() == typeid(std::string))
+        {
+            symbolsTable.insert(symbolsTable.end(), { name, static_cast<uint32_t>(SymbolTable::SymbolKind::String), addName(any_cast<std::string>(value)) });
+        }
+    }
+    // at least one null, so the pool always ends with one
+    do
+    {
+        pool += '\0';
+    } while (pool.size() % sizeof(uint32_t));
+
+    const uint32_t header[] = {
+        SymbolTable::binaryMagicNumber,
+        static_cast<uint32_t>(sortedLabels.size()),
+        static_cast<uint32_t>(symbolsTable.size() / 3),
+        static_cast<uint32_t>(pool.size())
+    };
+    outputFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (const auto& label : sortedLabels)
+    {
+        outputFile.write(reinterpret_cast<const char*>(&label.first), sizeof(uint32_t));
+    }
+    for (const auto& label : sortedLabels)
+    {
+        outputFile.write(reinterpret_cast<const char*>(&label.second), sizeof(uint32_t));
+    }
+    outputFile.write(reinterpret_cast<const char*>(symbolsTable.data()), symbolsTable.size() * sizeof(uint32_t));
+    outputFile.write(pool.data(), pool.size());
+    return static_cast<bool>(outputFile);
+}
+
+bool asmResult::loadBinarySymbols(const char* filename)
+{
+    std::ifstream inputFile(filename, std::ios::binary);
+    if (!inputFile)
+    {
+        return false;
+    }
+    uint32_t header[4];
+    if (!inputFile.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != SymbolTable::binaryMagicNumber)
+    {
+        return false;
+    }
+    std::vector<uint32_t> addresses(header[1]);
+    std::vector<uint32_t> names(header[1]);
+    std::vector<uint32_t> symbolsTable(header[2] * 3ull);
+    std::vector<char> pool(header[3]);
+    inputFile.read(reinterpret_cast<char*>(addresses.data()), addresses.size() * sizeof(uint32_t));
+    inputFile.read(reinterpret_cast<char*>(names.data()), names.size() * sizeof(uint32_t));
+    inputFile.read(reinterpret_cast<char*>(symbolsTable.data()), symbolsTable.size() * sizeof(uint32_t));
+    inputFile.read(pool.data(), pool.size());
+    if (!inputFile || pool.empty() || pool.back() != 0)
+    {
+        return false;
+    }
+    auto nameAt = [&pool](uint32_t offset) { return offset < pool.size() ? std::string(&pool[offset]) : std::string(); };
+
+    labels.clear();
+    symbols.clear();
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        labels[nameAt(names[i])] = addresses[i];
+    }
+    for (size_t i = 0; i < symbolsTable.size(); i += 3)
+    {
+        std::string name = nameAt(symbolsTable[i]);
+        uint32_t value = symbolsTable[i + 2];
+        switch (static_cast<SymbolTable::SymbolKind>(symbolsTable[i + 1]))
+        {
+        case SymbolTable::SymbolKind::Integer:
+            symbols[name] = static_cast<int32_t>(value);
+            break;
+        case SymbolTable::SymbolKind::Unsigned:
+            symbols[name] = value;
+            break;
+        case SymbolTable::SymbolKind::String:
+            symbols[name] = nameAt(value);
+            break;
+        }
+    }
+    return true;
+}
+
 bool asmResult::loadBinary(const char* filename)
 {
 	std::ifstream inputFile(filename, std::ios::binary);
@@ -127,6 +253,15 @@ bool asmResult::loadSymbols(const char* filename)
     {
         return false;
     }
+    // the binary files are recognized from their magic number
+    uint32_t magicNumber = 0;
+    inputFile.read(reinterpret_cast<char*>(&magicNumber), sizeof(uint32_t));
+    if (magicNumber == SymbolTable::binaryMagicNumber)
+    {
+        return loadBinarySymbols(filename);
+    }
+    inputFile.clear();
+    inputFile.seekg(0);
     labels.clear();
     symbols.clear();
     std::string line;
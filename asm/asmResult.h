@@ -25,6 +25,7 @@ public:
 	}
 	bool saveBinary(const char* filename) const;
     bool saveSymbols(const char* filename) const;
+    bool saveBinarySymbols(const char* filename) const;
     bool loadBinary(const char* filename);
     bool loadSymbols(const char* filename);
 
@@ -37,6 +38,8 @@ public:
 	std::map<std::string, std::any> symbols;
 	mc68000::errors                 errors;
 private:
+    bool loadBinarySymbols(const char* filename);
+
 	asmResult(const asmResult&)            = delete;
 	asmResult& operator=(const asmResult&) = delete;
 };
@@ -97,6 +97,11 @@ bool asmparser::saveSymbols(const char* filename)
     return result.saveSymbols(filename);
 }
 
+bool asmparser::saveBinarySymbols(const char* filename)
+{
+    return result.saveBinarySymbols(filename);
+}
+
 void asmparser::listingFileName(const char* filename)
 {
     listingFile = filename;
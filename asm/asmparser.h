@@ -14,6 +14,7 @@ public:
 	size_t checkSyntax(const char* text);
     bool saveBinary(const char* filename);
     bool saveSymbols(const char* filename);
+    bool saveBinarySymbols(const char* filename);
     void listingFileName(const char* filename);
 
 	const std::vector<codeBlock>& getCodeBlocks() const { return result.code; }
@@ -0,0 +1,54 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace mc68000
+{
+    /// <summary>
+    /// Measures the elapsed wall clock time since its creation.
+    /// </summary>
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// <summary>
+    /// Prints one benchmark result as a JSON line so runs can be compared by scripts.
+    /// </summary>
+    /// <param name="name">Name of the measure, prefixed by the benchmark group</param>
+    /// <param name="operations">Number of operations timed</param>
+    /// <param name="seconds">Elapsed time</param>
+    /// <param name="bytes">Number of bytes processed, 0 if not relevant</param>
+    inline void report(const std::string& name, uint64_t operations, double seconds, uint64_t bytes = 0)
+    {
+        std::cout << "{\"benchmark\":\"" << name << "\""
+            << ",\"operations\":" << operations
+            << ",\"seconds\":" << seconds
+            << ",\"ns_per_op\":" << (operations ? seconds * 1e9 / operations : 0.0)
+            << ",\"ops_per_s\":" << (seconds > 0 ? operations / seconds : 0.0);
+        if (bytes)
+        {
+            std::cout << ",\"mb_per_s\":" << (seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0.0);
+        }
+        std::cout << "}" << std::endl;
+    }
+
+    // benchmark groups
+    void diskBenchmarks();
+    void heapBenchmarks();
+    void trapBenchmarks();
+    void cpuBenchmarks();
+    void programBenchmarks();
+    void disasmBenchmarks();
+}
@@ -0,0 +1,148 @@
+#include <vector>
+#include "benchmark.h"
+#include "cpu.h"
+
+using namespace mc68000;
+
+namespace
+{
+    /// <summary>
+    /// One instruction, or a short sequence, repeated in the body of a loop.
+    /// </summary>
+    struct MicroBenchmark
+    {
+        const char* name;
+        std::vector<uint16_t> body;     // instruction words of one copy
+        unsigned executed;              // instructions executed by one copy
+        std::vector<uint16_t> setup;    // run once before the loop
+    };
+
+    // data at $4000 (abs.w), $8000 (a0) and $9000 (a1), subroutine at $3000, stack at $f000
+    // d0 = 0, d1 = 3 and d2 = 0 before the setup
+    const MicroBenchmark benchmarks[] = {
+        { "moveq",              { 0x7001 }, 1, {} },                            // moveq   #1,d0
+        { "move.b_dn_dn",       { 0x1001 }, 1, {} },                            // move.b  d1,d0
+        { "move.w_dn_dn",       { 0x3001 }, 1, {} },                            // move.w  d1,d0
+        { "move.l_dn_dn",       { 0x2001 }, 1, {} },                            // move.l  d1,d0
+        { "move.l_ind_dn",      { 0x2010 }, 1, {} },                            // move.l  (a0),d0
+        { "move.l_postinc_dn",  { 0x2018 }, 1, {} },                            // move.l  (a0)+,d0
+        { "move.l_predec_dn",   { 0x2020 }, 1, {} },                            // move.l  -(a0),d0
+        { "move.l_disp_dn",     { 0x2028, 0x0008 }, 1, {} },                    // move.l  8(a0),d0
+        { "move.l_index_dn",    { 0x2030, 0x2008 }, 1, {} },                    // move.l  8(a0,d2.w),d0
+        { "move.l_absw_dn",     { 0x2038, 0x4000 }, 1, {} },                    // move.l  $4000.w,d0
+        { "move.l_absl_dn",     { 0x2039, 0x0000, 0x8000 }, 1, {} },            // move.l  $8000.l,d0
+        { "move.l_pcdisp_dn",   { 0x203a, 0x0000 }, 1, {} },                    // move.l  *(pc),d0
+        { "move.l_imm_dn",      { 0x203c, 0x1234, 0x5678 }, 1, {} },            // move.l  #$12345678,d0
+        { "move.l_dn_ind",      { 0x2280 }, 1, {} },                            // move.l  d0,(a1)
+        { "move.l_dn_postinc",  { 0x22c0 }, 1, {} },                            // move.l  d0,(a1)+
+        { "move.l_dn_predec",   { 0x2300 }, 1, {} },                            // move.l  d0,-(a1)
+        { "move.l_ind_ind",     { 0x2290 }, 1, {} },                            // move.l  (a0),(a1)
+        { "movea.l",            { 0x2441 }, 1, {} },                            // movea.l d1,a2
+        { "movem.l_to_memory",  { 0x48d1, 0x000f }, 1, {} },                    // movem.l d0-d3,(a1)
+        { "movem.l_to_regs",    { 0x4cd0, 0x000f }, 1, {} },                    // movem.l (a0),d0-d3
+        { "lea_disp",           { 0x45e8, 0x0008 }, 1, {} },                    // lea     8(a0),a2
+        { "pea",                { 0x4850 }, 1, {} },                            // pea     (a0)
+        { "add.w_dn_dn",        { 0xd041 }, 1, {} },                            // add.w   d1,d0
+        { "add.l_dn_dn",        { 0xd081 }, 1, {} },                            // add.l   d1,d0
+        { "add.l_ind_dn",       { 0xd090 }, 1, {} },                            // add.l   (a0),d0
+        { "add.l_dn_ind",       { 0xd191 }, 1, {} },                            // add.l   d0,(a1)
+        { "adda.l",             { 0xd5c1 }, 1, {} },                            // adda.l  d1,a2
+        { "addi.l",             { 0x0680, 0x0000, 0x0001 }, 1, {} },            // addi.l  #1,d0
+        { "addq.l",             { 0x5280 }, 1, {} },                            // addq.l  #1,d0
+        { "addx.l",             { 0xd181 }, 1, {} },                            // addx.l  d1,d0
+        { "sub.l_dn_dn",        { 0x9081 }, 1, {} },                            // sub.l   d1,d0
+        { "subq.l",             { 0x5380 }, 1, {} },                            // subq.l  #1,d0
+        { "cmp.l_dn_dn",        { 0xb081 }, 1, {} },                            // cmp.l   d1,d0
+        { "cmpi.l",             { 0x0c80, 0x0000, 0x0001 }, 1, {} },            // cmpi.l  #1,d0
+        { "and.l_dn_dn",        { 0xc081 }, 1, {} },                            // and.l   d1,d0
+        { "or.l_dn_dn",         { 0x8081 }, 1, {} },                            // or.l    d1,d0
+        { "eor.l_dn_dn",        { 0xb380 }, 1, {} },                            // eor.l   d1,d0
+        { "not.l",              { 0x4680 }, 1, {} },                            // not.l   d0
+        { "neg.l",              { 0x4480 }, 1, {} },                            // neg.l   d0
+        { "clr.l",              { 0x4280 }, 1, {} },                            // clr.l   d0
+        { "tst.l",              { 0x4a80 }, 1, {} },                            // tst.l   d0
+        { "ext.l",              { 0x48c0 }, 1, {} },                            // ext.l   d0
+        { "swap",               { 0x4840 }, 1, {} },                            // swap    d0
+        { "exg",                { 0xc141 }, 1, {} },                            // exg     d0,d1
+        { "lsl.l_imm",          { 0xe388 }, 1, {} },                            // lsl.l   #1,d0
+        { "lsl.l_dn",           { 0xe3a8 }, 1, {} },                            // lsl.l   d1,d0
+        { "asr.l_imm",          { 0xe280 }, 1, {} },                            // asr.l   #1,d0
+        { "rol.l_imm",          { 0xe398 }, 1, {} },                            // rol.l   #1,d0
+        { "mulu.w",             { 0xc0c1 }, 1, {} },                            // mulu.w  d1,d0
+        { "muls.w",             { 0xc1c1 }, 1, {} },                            // muls.w  d1,d0
+        { "divu.w",             { 0x80c1 }, 1, {} },                            // divu.w  d1,d0
+        { "divs.w",             { 0x81c1 }, 1, {} },                            // divs.w  d1,d0
+        { "abcd",               { 0xc101 }, 1, {} },                            // abcd    d1,d0
+        { "btst_imm",           { 0x0800, 0x0001 }, 1, {} },                    // btst    #1,d0
+        { "bset_dn",            { 0x03c0 }, 1, {} },                            // bset    d1,d0
+        { "bchg_imm",           { 0x0840, 0x0001 }, 1, {} },                    // bchg    #1,d0
+        { "scc",                { 0x57c0 }, 1, {} },                            // seq     d0
+        { "tas",                { 0x4ac0 }, 1, {} },                            // tas     d0
+        { "chk",                { 0x4181 }, 1, {} },                            // chk     d1,d0
+        { "nop",                { 0x4e71 }, 1, {} },                            // nop
+        { "bra.s_taken",        { 0x6002, 0x4e71 }, 1, {} },                    // bra.s   *+4 / nop skipped
+        { "bne.s_not_taken",    { 0x6602, 0x4e71 }, 2, { 0xb080 } },            // bne.s   *+4 / nop, after cmp.l d0,d0
+        { "jsr_rts",            { 0x4eb8, 0x3000 }, 2, {} },                    // jsr     $3000.w / rts
+        { "link_unlk",          { 0x4e56, 0xfff8, 0x4e5e }, 2, {} },            // link    a6,#-8 / unlk a6
+    };
+
+    const unsigned copies = 16;
+    const unsigned iterations = 16384;
+
+    /// <summary>
+    /// Builds the loop program: setup, then iterations of (reset a0, a1 and sp; copies of the body).
+    /// </summary>
+    std::vector<uint16_t> buildLoop(const std::vector<uint16_t>& body, unsigned bodyCopies, const std::vector<uint16_t>& setup)
+    {
+        std::vector<uint16_t> program = { 0x7203, 0x7000 };                // moveq #3,d1 / moveq #0,d0
+        program.insert(program.end(), setup.begin(), setup.end());
+        program.insert(program.end(), { 0x3e3c, static_cast<uint16_t>(iterations - 1) });  // move.w #n,d7
+        size_t loop = program.size();
+        program.insert(program.end(), {
+            0x41f9, 0x0000, 0x8000,                                         // lea $8000,a0
+            0x43f9, 0x0000, 0x9000,                                         // lea $9000,a1
+            0x4ff9, 0x0000, 0xf000 });                                      // lea $f000,sp
+        for (unsigned i = 0; i < bodyCopies; i++)
+        {
+            program.insert(program.end(), body.begin(), body.end());
+        }
+        program.push_back(0x51cf);                                          // dbra d7,loop
+        program.push_back(static_cast<uint16_t>((loop - program.size()) * 2));
+        program.push_back(0xffff);
+        return program;
+    }
+
+    double runLoop(const std::vector<uint16_t>& program)
+    {
+        std::vector<uint8_t> bytes(0x10000);
+        for (size_t i = 0; i < program.size(); i++)
+        {
+            bytes[i * 2] = static_cast<uint8_t>(program[i] >> 8);
+            bytes[i * 2 + 1] = static_cast<uint8_t>(program[i]);
+        }
+        bytes[0x3000] = 0x4e;                                               // rts
+        bytes[0x3001] = 0x75;
+        Memory memory(static_cast<uint32_t>(bytes.size()), 0, bytes.data(), static_cast<uint32_t>(bytes.size()));
+        Cpu cpu(memory);
+
+        cpu.reset();
+        Stopwatch stopwatch;
+        cpu.start(0, 0xf000, 0xf800);
+        return stopwatch.seconds();
+    }
+}
+
+/// <summary>
+/// ns per instruction for each instruction family, the loop overhead being measured first and subtracted.
+/// </summary>
+void mc68000::cpuBenchmarks()
+{
+    double overhead = runLoop(buildLoop({}, 0, {}));
+    report("cpu.loop_overhead", iterations, overhead);
+
+    for (const auto& benchmark : benchmarks)
+    {
+        double seconds = runLoop(buildLoop(benchmark.body, copies, benchmark.setup)) - overhead;
+        report(std::string("cpu.") + benchmark.name, static_cast<uint64_t>(iterations) * copies * benchmark.executed, seconds > 0 ? seconds : 0);
+    }
+}
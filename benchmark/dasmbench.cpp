@@ -0,0 +1,184 @@
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "controlflow.h"
+#include "disasm.h"
+#include "memory.h"
+#include "paralleldisasm.h"
+
+using namespace mc68000;
+
+namespace
+{
+    const std::filesystem::path examples(RUN68000_EXAMPLES_DIR);
+
+    // longest 68000 instruction, the walk stops before an instruction could read past the image
+    const uint32_t maxInstructionSize = 10;
+
+    /// <summary>
+    /// Disassembles the whole image passes times, instruction after instruction, giving each line to output.
+    /// </summary>
+    /// <returns>The number of instructions disassembled</returns>
+    template<typename Output>
+    uint64_t disassembleImage(const Memory& memory, int passes, Output output)
+    {
+        auto [base, size] = memory.getMemoryRange();
+        DisAsm disAsm(static_cast<const uint16_t*>(memory.get<void*>(base)), base);
+        uint64_t instructions = 0;
+        for (int pass = 0; pass < passes; pass++)
+        {
+            uint32_t address = base;
+            while (address + maxInstructionSize <= base + size)
+            {
+                output(disAsm, address);
+                address = base + disAsm.getPc() * 2;
+                instructions++;
+            }
+        }
+        return instructions;
+    }
+
+    uint64_t countInstructions(const ControlFlowGraph& graph)
+    {
+        uint64_t instructions = 0;
+        for (const auto& block : graph.getBlocks())
+        {
+            instructions += block.instructions;
+        }
+        return instructions;
+    }
+}
+
+/// <summary>
+/// Disassembly throughput over tinybasic.bin, code and data alike, reported in instructions per second:
+/// string returns a std::string per instruction, buffer formats into a char array and
+/// listing appends the lines to an arena reused by every pass and decode stops at the DecodedInstruction.
+/// cfg follows the code from the start of the image, once on the image and once on copies of it filling 4 MB,
+/// the two show if the cost per instruction stays the same as the image grows.
+/// parallel lists 16 MB of copies cut at the start of each copy, on one thread then on every hardware thread.
+/// </summary>
+void mc68000::disasmBenchmarks()
+{
+    std::filesystem::path path = examples / "tinybasic.bin";
+    if (!std::filesystem::exists(path))
+    {
+        std::cerr << "dasm: " << path.string() << " not found" << std::endl;
+        return;
+    }
+    Memory memory(path.string().c_str());
+    const int passes = 200;
+
+    {
+        size_t bytes = 0;
+        Stopwatch stopwatch;
+        uint64_t instructions = disassembleImage(memory, passes, [&bytes](DisAsm& disAsm, uint32_t address)
+        {
+            bytes += disAsm.disassembleInstruction(address).size();
+        });
+        report("dasm.string", instructions, stopwatch.seconds(), bytes);
+    }
+    {
+        char line[128];
+        size_t bytes = 0;
+        Stopwatch stopwatch;
+        uint64_t instructions = disassembleImage(memory, passes, [&line, &bytes](DisAsm& disAsm, uint32_t address)
+        {
+            bytes += disAsm.disassembleInstruction(address, line, sizeof(line));
+        });
+        report("dasm.buffer", instructions, stopwatch.seconds(), bytes);
+    }
+    {
+        DisAsm symbols;
+        symbols.loadSymbols((examples / "tinybasic.sym").string().c_str());
+        char line[128];
+        size_t bytes = 0;
+        Stopwatch stopwatch;
+        uint64_t instructions = disassembleImage(memory, passes, [&symbols, &line, &bytes](DisAsm& disAsm, uint32_t address)
+        {
+            bytes += disAsm.disassembleInstruction(address, line, sizeof(line));
+            bytes += symbols.findSymbol(address).size();
+        });
+        report("dasm.symbols", instructions, stopwatch.seconds(), bytes);
+    }
+    {
+        uint64_t operands = 0;
+        Stopwatch stopwatch;
+        uint64_t instructions = disassembleImage(memory, passes, [&operands](DisAsm& disAsm, uint32_t address)
+        {
+            operands += disAsm.decodeInstruction(address).operandCount;
+        });
+        report("dasm.decode", instructions, stopwatch.seconds());
+    }
+    {
+        char line[128];
+        std::string arena;
+        size_t bytes = 0;
+        Stopwatch stopwatch;
+        uint64_t instructions = 0;
+        for (int pass = 0; pass < passes; pass++)
+        {
+            arena.clear();
+            instructions += disassembleImage(memory, 1, [&line, &arena](DisAsm& disAsm, uint32_t address)
+            {
+                arena.append(line, disAsm.disassembleInstruction(address, line, sizeof(line)));
+                arena += '\n';
+            });
+            bytes += arena.size();
+        }
+        report("dasm.listing", instructions, stopwatch.seconds(), bytes);
+    }
+    {
+        auto [base, size] = memory.getMemoryRange();
+        const uint8_t* image = static_cast<const uint8_t*>(memory.get<void*>(base));
+        size &= ~1u;
+        ControlFlowGraph graph(image, base, size);
+        graph.addEntryPoint(base);
+        Stopwatch stopwatch;
+        graph.build();
+        report("dasm.cfg", countInstructions(graph), stopwatch.seconds(), size);
+
+        std::vector<uint8_t> copies;
+        while (copies.size() < 4 * 1024 * 1024)
+        {
+            copies.insert(copies.end(), image, image + size);
+        }
+        ControlFlowGraph large(copies.data(), base, static_cast<uint32_t>(copies.size()));
+        for (uint32_t offset = 0; offset < copies.size(); offset += size)
+        {
+            large.addEntryPoint(base + offset);
+        }
+        stopwatch = Stopwatch();
+        large.build();
+        report("dasm.cfg.4mb", countInstructions(large), stopwatch.seconds(), copies.size());
+    }
+    {
+        auto [base, size] = memory.getMemoryRange();
+        const uint8_t* image = static_cast<const uint8_t*>(memory.get<void*>(base));
+        size &= ~1u;
+        std::vector<uint8_t> copies;
+        while (copies.size() < 16 * 1024 * 1024)
+        {
+            copies.insert(copies.end(), image, image + size);
+        }
+        std::vector<unsigned> threadCounts = { 1 };
+        if (std::thread::hardware_concurrency() > 1)
+        {
+            threadCounts.push_back(std::thread::hardware_concurrency());
+        }
+        for (unsigned threads : threadCounts)
+        {
+            ParallelDisAsm disAsm(reinterpret_cast<const uint16_t*>(copies.data()), base, static_cast<uint32_t>(copies.size()));
+            for (uint32_t offset = 0; offset < copies.size(); offset += size)
+            {
+                disAsm.addBoundary(base + offset);
+            }
+            disAsm.setThreads(threads);
+            std::string listing;
+            Stopwatch stopwatch;
+            size_t instructions = disAsm.disassemble(listing);
+            report("dasm.parallel." + std::to_string(threads), instructions, stopwatch.seconds(), copies.size());
+        }
+    }
+}
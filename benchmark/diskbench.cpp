@@ -0,0 +1,161 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "benchmark.h"
+#include "cpu.h"
+#include "diskimage.h"
+#include "osbios.h"
+
+using namespace mc68000;
+
+namespace
+{
+    const uint32_t sectorCount = 1440;     // 720 KB floppy
+    const uint32_t bytesPerSector = 512;
+    const uint32_t tableEntries = 4096;
+
+    // reads the sectors listed in a table at $2000 into a buffer at $1000 with trap #2
+    const uint8_t readLoop[] = {
+        0x3e,0x3c, 0x0f,0xff,               //      move.w  #4095,d7
+        0x41,0xf9, 0x00,0x00, 0x20,0x00,    //      lea     $2000,a0
+        0x3f,0x3c, 0x00,0x01,               // loop move.w  #1,-(sp)        sectorCount (patched)
+        0x3f,0x18,                          //      move.w  (a0)+,-(sp)     sectorNumber
+        0x3f,0x3c, 0x00,0x01,               //      move.w  #1,-(sp)        device
+        0x2f,0x3c, 0x00,0x00, 0x10,0x00,    //      move.l  #$1000,-(sp)    buffer
+        0x3f,0x3c, 0x00,0x01,               //      move.w  #1,-(sp)        diskread
+        0x4e,0x42,                          //      trap    #2
+        0x4f,0xef, 0x00,0x0c,               //      lea     12(sp),sp
+        0x51,0xcf, 0xff,0xe4,               //      dbra    d7,loop
+        0xff,0xff };
+    const uint32_t sectorCountOffset = 10;     // move.w #n,-(sp) of the sector count
+
+    std::filesystem::path createImage(const std::filesystem::path& directory)
+    {
+        std::filesystem::path path = directory / "run68000bench.dsk";
+        std::ofstream disk(path, std::ios::binary);
+        std::vector<char> content(sectorCount * bytesPerSector);
+        for (size_t i = 0; i < content.size(); i++)
+        {
+            content[i] = static_cast<char>(i * 7);
+        }
+        BiosParameterBlock bpb(false);
+        std::copy_n(reinterpret_cast<char*>(&bpb), sizeof(BiosParameterBlock), content.begin());
+        disk.write(content.data(), content.size());
+        return path;
+    }
+
+    std::vector<uint16_t> sequentialSectors(uint32_t sectorsPerRead)
+    {
+        std::vector<uint16_t> sectors(tableEntries);
+        for (uint32_t i = 0; i < tableEntries; i++)
+        {
+            sectors[i] = static_cast<uint16_t>((i * sectorsPerRead) % (sectorCount - sectorsPerRead));
+        }
+        return sectors;
+    }
+
+    std::vector<uint16_t> randomSectors()
+    {
+        std::mt19937 generator(68000);
+        std::uniform_int_distribution<uint32_t> distribution(0, sectorCount - 1);
+        std::vector<uint16_t> sectors(tableEntries);
+        for (auto& sector : sectors)
+        {
+            sector = static_cast<uint16_t>(distribution(generator));
+        }
+        return sectors;
+    }
+
+    void imageRead(const std::string& name, DiskImage& image, const std::vector<uint16_t>& sectors, uint32_t sectorsPerRead, int rounds)
+    {
+        std::vector<uint8_t> buffer(sectorsPerRead * bytesPerSector);
+        uint64_t bytes = 0;
+        Stopwatch stopwatch;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (uint16_t sector : sectors)
+            {
+                bytes += image.read(buffer.data(), sector, sectorsPerRead);
+            }
+        }
+        report(name, static_cast<uint64_t>(rounds) * sectors.size(), stopwatch.seconds(), bytes);
+    }
+
+    void imageWrite(const std::string& name, DiskImage& image, const std::vector<uint16_t>& sectors, uint32_t sectorsPerWrite, int rounds)
+    {
+        std::vector<uint8_t> buffer(sectorsPerWrite * bytesPerSector, 0x5a);
+        uint64_t bytes = 0;
+        Stopwatch stopwatch;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (uint16_t sector : sectors)
+            {
+                // keep the boot sector intact
+                bytes += image.write(buffer.data(), sector == 0 ? 1 : sector, sectorsPerWrite);
+            }
+        }
+        image.flush();
+        report(name, static_cast<uint64_t>(rounds) * sectors.size(), stopwatch.seconds(), bytes);
+    }
+
+    void trapRead(const std::string& name, const std::vector<uint16_t>& sectors, uint16_t sectorsPerRead, int rounds)
+    {
+        std::vector<uint8_t> code(0x6000);
+        std::copy(std::begin(readLoop), std::end(readLoop), code.begin());
+        code[sectorCountOffset + 2] = static_cast<uint8_t>(sectorsPerRead >> 8);
+        code[sectorCountOffset + 3] = static_cast<uint8_t>(sectorsPerRead);
+        for (uint32_t i = 0; i < tableEntries; i++)
+        {
+            code[0x2000 + i * 2] = static_cast<uint8_t>(sectors[i] >> 8);
+            code[0x2000 + i * 2 + 1] = static_cast<uint8_t>(sectors[i]);
+        }
+
+        Memory memory(static_cast<uint32_t>(code.size()), 0, code.data(), static_cast<uint32_t>(code.size()));
+        Cpu cpu(memory);
+        OSBios bios;
+        bios.setup();
+        bios.registerTrapHandlers(&cpu);
+
+        uint64_t bytes = 0;
+        Stopwatch stopwatch;
+        for (int round = 0; round < rounds; round++)
+        {
+            cpu.reset();
+            cpu.start(0, 0x5000, 0x4800);
+            bytes += static_cast<uint64_t>(tableEntries) * sectorsPerRead * bytesPerSector;
+        }
+        report(name, static_cast<uint64_t>(rounds) * tableEntries, stopwatch.seconds(), bytes);
+    }
+}
+
+/// <summary>
+/// Sequential and random sector throughput, directly on a DiskImage and through the OSBios trap.
+/// </summary>
+void mc68000::diskBenchmarks()
+{
+    auto previous = std::filesystem::current_path();
+    auto directory = std::filesystem::temp_directory_path();
+    auto path = createImage(directory);
+
+    // OSBios reads its configuration from the current directory
+    std::filesystem::current_path(directory);
+    {
+        std::ofstream configFile("osbios.conf");
+        configFile << "disk1 = " << path.string() << std::endl;
+    }
+
+    {
+        DiskImage image(path.string());
+        imageRead("disk.image_sequential_read_8", image, sequentialSectors(8), 8, 64);
+        imageRead("disk.image_random_read_1", image, randomSectors(), 1, 256);
+        imageWrite("disk.image_sequential_write_8", image, sequentialSectors(8), 8, 16);
+        imageWrite("disk.image_random_write_1", image, randomSectors(), 1, 64);
+    }
+    trapRead("disk.trap_sequential_read_8", sequentialSectors(8), 8, 16);
+    trapRead("disk.trap_random_read_1", randomSectors(), 1, 64);
+
+    std::filesystem::remove("osbios.conf");
+    std::filesystem::current_path(previous);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,92 @@
+#include <random>
+#include <vector>
+#include "benchmark.h"
+#include "cpu.h"
+#include "ataribios.h"
+#include "guestheap.h"
+
+using namespace mc68000;
+
+namespace
+{
+    // keeps 16 live blocks in a table at $1000: each iteration frees the oldest one and allocates a new one of 8 to 519 bytes
+    const uint8_t allocationLoop[] = {
+        0x3e,0x3c, 0x0f,0xff,               //      move.w  #4095,d7
+        0x7c,0x00,                          //      moveq   #0,d6
+        0x41,0xf9, 0x00,0x00, 0x10,0x00,    // loop lea     $1000,a0
+        0x20,0x30, 0x60,0x00,               //      move.l  0(a0,d6.w),d0
+        0x67,0x0a,                          //      beq.s   skip
+        0x2f,0x00,                          //      move.l  d0,-(sp)
+        0x3f,0x3c, 0x00,0x49,               //      move.w  #73,-(sp)       Mfree
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0x20,0x07,                          // skip move.l  d7,d0
+        0x02,0x80, 0x00,0x00, 0x01,0xff,    //      andi.l  #$1ff,d0
+        0x50,0x80,                          //      addq.l  #8,d0
+        0x2f,0x00,                          //      move.l  d0,-(sp)
+        0x3f,0x3c, 0x00,0x48,               //      move.w  #72,-(sp)       Malloc
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0x21,0x80, 0x60,0x00,               //      move.l  d0,0(a0,d6.w)
+        0x58,0x46,                          //      addq.w  #4,d6
+        0x02,0x46, 0x00,0x3c,               //      andi.w  #$3c,d6
+        0x51,0xcf, 0xff,0xca,               //      dbra    d7,loop
+        0xff,0xff };
+    const uint32_t iterations = 4096;
+
+    void guestAllocations(int rounds)
+    {
+        std::vector<uint8_t> code(0x10000);
+        std::copy(std::begin(allocationLoop), std::end(allocationLoop), code.begin());
+        Memory memory(static_cast<uint32_t>(code.size()), 0, code.data(), static_cast<uint32_t>(code.size()));
+        Cpu cpu(memory);
+        AtariBios bios;
+        bios.setup();
+        bios.registerTrapHandlers(&cpu);
+
+        Stopwatch stopwatch;
+        for (int round = 0; round < rounds; round++)
+        {
+            cpu.reset();
+            cpu.start(0, 0x10000, 0xf800);
+        }
+        report("heap.guest_malloc_mfree", static_cast<uint64_t>(rounds) * iterations * 2, stopwatch.seconds());
+    }
+
+    void hostAllocations(uint32_t liveBlocks, int rounds)
+    {
+        GuestHeap heap(0x100000, 0x400000);
+        std::mt19937 generator(68000);
+        std::uniform_int_distribution<uint32_t> sizes(8, 4096);
+        std::vector<uint32_t> live(liveBlocks, 0);
+
+        uint64_t operations = 0;
+        Stopwatch stopwatch;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (uint32_t i = 0; i < liveBlocks; i++)
+            {
+                // release a random block to fragment the heap, then allocate again
+                uint32_t& slot = live[generator() % liveBlocks];
+                if (slot != 0)
+                {
+                    heap.release(slot);
+                    operations++;
+                }
+                slot = heap.allocate(sizes(generator));
+                operations++;
+            }
+        }
+        report("heap.host_fragmented_" + std::to_string(liveBlocks), operations, stopwatch.seconds());
+    }
+}
+
+/// <summary>
+/// GEMDOS Malloc/Mfree from a guest loop and GuestHeap alone on a fragmented heap.
+/// </summary>
+void mc68000::heapBenchmarks()
+{
+    guestAllocations(64);
+    hostAllocations(64, 4096);
+    hostAllocations(512, 512);
+}
@@ -0,0 +1,59 @@
+#include <cstring>
+#include <iostream>
+#include "benchmark.h"
+
+using namespace mc68000;
+
+namespace
+{
+    struct BenchmarkGroup
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const BenchmarkGroup groups[] = {
+        { "disk", diskBenchmarks },
+        { "heap", heapBenchmarks },
+        { "trap", trapBenchmarks },
+        { "cpu", cpuBenchmarks },
+        { "programs", programBenchmarks },
+        { "dasm", disasmBenchmarks },
+    };
+}
+
+int usage()
+{
+    std::cout << "Usage: run68000bench [group...]" << std::endl;
+    std::cout << "Runs all the benchmark groups when none is given. Groups:" << std::endl;
+    for (const auto& group : groups)
+    {
+        std::cout << "  " << group.name << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, const char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            return usage();
+        }
+    }
+
+    for (const auto& group : groups)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++)
+        {
+            selected |= strcmp(argv[i], group.name) == 0;
+        }
+        if (selected)
+        {
+            group.run();
+        }
+    }
+    return 0;
+}
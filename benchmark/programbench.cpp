@@ -0,0 +1,191 @@
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include "benchmark.h"
+#include "cpu.h"
+#include "simplebios.h"
+#include "consoleinput.h"
+#include "nativeroutines.h"
+
+using namespace mc68000;
+
+namespace
+{
+    const std::filesystem::path examples(RUN68000_EXAMPLES_DIR);
+
+    /// <summary>
+    /// Trap #15 of SimpleBios that stops the CPU when the guest waits for a character after the end of the script,
+    /// so that an interactive program ends with its input.
+    /// </summary>
+    class ScriptEnd : public TrapHandler
+    {
+    public:
+        ScriptEnd(TrapHandler& bios, const ConsoleInput& input) : bios(bios), input(input) {}
+
+        void handle(Cpu& cpu, uint16_t vector) override
+        {
+            if (cpu.trapArguments().getWord(0) == 1 && !input.available())
+            {
+                throw "end of script";
+            }
+            bios.handle(cpu, vector);
+        }
+
+    private:
+        TrapHandler& bios;
+        const ConsoleInput& input;
+    };
+
+    /// <summary>
+    /// The trap #15 tasks of the EASy68K simulator used by game.bin: the task number is in d0 and not on the stack.
+    /// The time is fixed so that every run plays the same game.
+    /// </summary>
+    class Easy68kTasks : public TrapHandler
+    {
+    public:
+        explicit Easy68kTasks(ConsoleInput& input) : input(input) {}
+
+        void handle(Cpu& cpu, uint16_t) override
+        {
+            switch (cpu.d0 & 0xff)
+            {
+                case 4:     // read a number into d1
+                {
+                    int32_t value = 0;
+                    for (int32_t ch = input.read(); ch >= '0' && ch <= '9'; ch = input.read())
+                    {
+                        value = value * 10 + (ch - '0');
+                    }
+                    cpu.setDRegister(1, static_cast<uint32_t>(value));
+                    break;
+                }
+                case 8:     // time in d1
+                    cpu.setDRegister(1, 0);
+                    break;
+                case 14:    // display the string at a1
+                    for (uint32_t address = cpu.a1; cpu.mem.get<uint8_t>(address) != 0; address++)
+                    {
+                        std::cout << static_cast<char>(cpu.mem.get<uint8_t>(address));
+                    }
+                    break;
+            }
+        }
+
+    private:
+        ConsoleInput& input;
+    };
+
+    /// <summary>
+    /// Runs a program of asm/examples with its console output discarded.
+    /// </summary>
+    /// <returns>The elapsed time</returns>
+    double runProgram(const std::filesystem::path& path, const std::string& script, bool easy68k, bool native, bool threaded, Statistics* statistics)
+    {
+        Memory memory(path.string().c_str());
+        Cpu cpu(memory);
+        cpu.setThreadedDispatch(threaded);
+        NativeRoutines natives;
+        if (native)
+        {
+            natives.installFromSignatures(cpu);
+        }
+        ScriptedInput input(script);
+        SimpleBios bios;
+        ScriptEnd scriptEnd(bios, input);
+        Easy68kTasks tasks(input);
+        if (easy68k)
+        {
+            cpu.registerTrapHandler(15, &tasks);
+        }
+        else
+        {
+            bios.setConsoleInput(std::shared_ptr<ConsoleInput>(&input, [](ConsoleInput*) {}));
+            bios.registerTrapHandlers(&cpu);
+            cpu.registerTrapHandler(15, &scriptEnd);
+        }
+        cpu.setStatistics(statistics);
+
+        // same stacks as the Emulator
+        auto [base, size] = memory.getMemoryRange();
+        uint32_t uspOffset = (size > 4096) ? 1024 : size / 4;
+        std::ostringstream output;
+        auto* savedOutput = std::cout.rdbuf(output.rdbuf());
+        cpu.reset();
+        Stopwatch stopwatch;
+        try
+        {
+            cpu.start(base, (base + size - uspOffset) & ~1u, (base + size) & ~1u);
+        }
+        catch (const char*)
+        {
+            // ScriptEnd stops the program when the script is consumed
+        }
+        double seconds = stopwatch.seconds();
+        std::cout.rdbuf(savedOutput);
+        return seconds;
+    }
+
+    void benchmarkProgram(const char* name, const char* binary, const std::string& script, bool easy68k, bool native = false, bool threaded = true)
+    {
+        std::filesystem::path path = examples / binary;
+        if (!std::filesystem::exists(path))
+        {
+            std::cerr << name << ": " << path.string() << " not found" << std::endl;
+            return;
+        }
+
+        // the instructions are counted in a first run, the statistics loop being slower
+        Statistics statistics;
+        runProgram(path, script, easy68k, native, threaded, &statistics);
+        double seconds = runProgram(path, script, easy68k, native, threaded, nullptr);
+        report(std::string("program.") + name, statistics.getInstructionCount(), seconds);
+    }
+
+    std::string tinyBasicScript()
+    {
+        // sieve of the odd numbers up to 2000 then a loop of arithmetic, RUN comes last
+        // because the interpreter polls the keyboard while a program runs
+        // the loops are made of IF ... GOTO: FOR never finds the end of its stack frames in tinybasic.68k
+        return
+            "10 N=0\n"
+            "20 I=3\n"
+            "30 J=3\n"
+            "40 IF J*J>I GOTO 80\n"
+            "50 IF I=I/J*J GOTO 90\n"
+            "60 J=J+2\n"
+            "70 GOTO 40\n"
+            "80 N=N+1\n"
+            "90 I=I+2\n"
+            "100 IF I<2000 GOTO 30\n"
+            "110 K=1\n"
+            "120 A=A+K*7/3-K\n"
+            "130 K=K+1\n"
+            "140 IF K<3000 GOTO 120\n"
+            "150 PRINT N,A\n"
+            "RUN\n";
+    }
+
+    std::string gameScript()
+    {
+        // the number is 1 with the fixed time: one guess too big then the right one, many rounds
+        std::string script;
+        for (int round = 0; round < 2000; round++)
+        {
+            script += "50\n1\n";
+        }
+        return script + "0\n";
+    }
+}
+
+/// <summary>
+/// Whole programs of asm/examples driven by scripted input: ns per executed instruction.
+/// tinybasic_native runs the routines of NativeRoutines on the host, its guest instructions exclude theirs.
+/// tinybasic_table_dispatch calls the handlers through the table instead of the threaded dispatch.
+/// </summary>
+void mc68000::programBenchmarks()
+{
+    benchmarkProgram("tinybasic", "tinybasic.bin", tinyBasicScript(), false);
+    benchmarkProgram("tinybasic_table_dispatch", "tinybasic.bin", tinyBasicScript(), false, false, false);
+    benchmarkProgram("tinybasic_native", "tinybasic.bin", tinyBasicScript(), false, true);
+    benchmarkProgram("game", "game.bin", gameScript(), true);
+}
@@ -0,0 +1,49 @@
+#include <vector>
+#include "benchmark.h"
+#include "cpu.h"
+#include "simplebios.h"
+
+using namespace mc68000;
+
+namespace
+{
+    // one host trap per iteration with a word argument, as a syscall-heavy guest does
+    const uint8_t trapLoop[] = {
+        0x3e,0x3c, 0xff,0xff,               //      move.w  #65535,d7
+        0x3f,0x07,                          // loop move.w  d7,-(sp)
+        0x3f,0x3c, 0x00,0x65,               //      move.w  #101,-(sp)
+        0x4e,0x4f,                          //      trap    #15
+        0x58,0x8f,                          //      addq.l  #4,sp
+        0x51,0xcf, 0xff,0xf4,               //      dbra    d7,loop
+        0xff,0xff };
+    const uint32_t iterations = 65536;
+
+    void guestTraps(bool fastTraps, int rounds)
+    {
+        std::vector<uint8_t> code(0x1000);
+        std::copy(std::begin(trapLoop), std::end(trapLoop), code.begin());
+        Memory memory(static_cast<uint32_t>(code.size()), 0, code.data(), static_cast<uint32_t>(code.size()));
+        Cpu cpu(memory);
+        cpu.setFastTraps(fastTraps);
+        SimpleBios bios;
+        bios.setup();
+        bios.registerTrapHandlers(&cpu);
+
+        Stopwatch stopwatch;
+        for (int round = 0; round < rounds; round++)
+        {
+            cpu.reset();
+            cpu.start(0, 0x1000, 0x800);
+        }
+        report(fastTraps ? "trap.host_fast" : "trap.host_exception_frame", static_cast<uint64_t>(rounds) * iterations, stopwatch.seconds());
+    }
+}
+
+/// <summary>
+/// TRAPs handled by the host, with and without the exception frame.
+/// </summary>
+void mc68000::trapBenchmarks()
+{
+    guestTraps(false, 32);
+    guestTraps(true, 32);
+}
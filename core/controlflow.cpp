@@ -0,0 +1,342 @@
+#include "controlflow.h"
+#include "disasm.h"
+#include "instructions.h"
+
+using namespace mc68000;
+
+namespace
+{
+    const char* const edgeKindNames[] = { "fallthrough", "branch", "jump", "call" };
+
+    /// <summary>
+    /// Writes text between double quotes, escaping the characters that would end it in DOT and JSON.
+    /// </summary>
+    void writeQuoted(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (; *text; text++)
+        {
+            if (*text == '"' || *text == '\\')
+            {
+                out << '\\';
+            }
+            out << *text;
+        }
+        out << '"';
+    }
+
+    std::string hexAddress(uint32_t address)
+    {
+        static const char hex[] = "0123456789abcdef";
+        std::string text;
+        for (int shift = 28; shift >= 0; shift -= 4)
+        {
+            text += hex[(address >> shift) & 0xf];
+        }
+        return text;
+    }
+}
+
+ControlFlowGraph::ControlFlowGraph(const uint8_t* image, uint32_t base, uint32_t size) :
+    image(image),
+    base(base),
+    size(size & ~1u),
+    flags(size / 2)
+{
+}
+
+void ControlFlowGraph::addEntryPoint(uint32_t address)
+{
+    queue(address);
+}
+
+void ControlFlowGraph::addEntryPoints(const SymbolTable& symbols)
+{
+    for (size_t index = 0; index < symbols.size(); index++)
+    {
+        queue(symbols.getAddress(index));
+    }
+}
+
+bool ControlFlowGraph::isInstruction(uint32_t address) const
+{
+    return inImage(address) && (flags[(address - base) / 2] & Start);
+}
+
+bool ControlFlowGraph::inImage(uint32_t address) const
+{
+    return (address & 1) == 0 && address - base < size;
+}
+
+void ControlFlowGraph::queue(uint32_t address)
+{
+    if (!inImage(address))
+    {
+        return;
+    }
+    uint8_t& state = flags[(address - base) / 2];
+    state |= Leader;
+    if (!(state & (Start | Pending)))
+    {
+        state |= Pending;
+        worklist.push_back(address);
+    }
+}
+
+/// <summary>
+/// Decodes the instruction at address, false when it does not fit in the image.
+/// </summary>
+bool ControlFlowGraph::decodeAt(uint32_t address, DecodedInstruction& instruction)
+{
+    uint32_t offset = address - base;
+    return decoder.decode(reinterpret_cast<const uint16_t*>(image + offset), size - offset, true, address, instruction);
+}
+
+ControlFlowGraph::Flow ControlFlowGraph::flowOf(const DecodedInstruction& instruction)
+{
+    Flow flow = { false, 0, FlowEdgeKind::FallThrough, true };
+    const Operand& operand = instruction.operands[0];
+    switch (instruction.instruction)
+    {
+    case instructions::BRA:
+        flow = { true, operand.value, FlowEdgeKind::Jump, false };
+        break;
+    case instructions::BSR:
+        flow = { true, operand.value, FlowEdgeKind::Call, true };
+        break;
+    case instructions::DBCC:
+        flow = { true, instruction.address + 2 + instruction.operands[1].value, FlowEdgeKind::Branch, true };
+        break;
+    case instructions::JMP:
+    case instructions::JSR:
+        if (instruction.instruction == instructions::JMP)
+        {
+            flow = { false, 0, FlowEdgeKind::Jump, false };
+        }
+        else
+        {
+            flow = { false, 0, FlowEdgeKind::Call, true };
+        }
+        // the targets computed from registers are not followed
+        if (operand.kind == OperandKind::AbsoluteWord || operand.kind == OperandKind::AbsoluteLong)
+        {
+            flow.known = true;
+            flow.target = operand.value;
+        }
+        else if (operand.kind == OperandKind::PcDisplacement)
+        {
+            flow.known = true;
+            flow.target = instruction.address + 2 + operand.value;
+        }
+        break;
+    case instructions::RTS:
+    case instructions::RTE:
+    case instructions::RTR:
+    case instructions::ILLEGAL:
+    case instructions::UNKNOWN:
+        flow.continues = false;
+        break;
+    default:
+        if (operand.kind == OperandKind::BranchTarget)
+        {
+            // Bcc
+            flow = { true, operand.value, FlowEdgeKind::Branch, true };
+        }
+        break;
+    }
+    return flow;
+}
+
+/// <summary>
+/// Decodes the instructions from address until the flow stops or joins code already decoded.
+/// </summary>
+void ControlFlowGraph::explore(uint32_t address)
+{
+    DecodedInstruction instruction;
+    while (inImage(address))
+    {
+        uint32_t index = (address - base) / 2;
+        if (flags[index] & Start)
+        {
+            return;
+        }
+        if ((flags[index] & Continuation) || !decodeAt(address, instruction))
+        {
+            overlaps += (flags[index] & Continuation) ? 1 : 0;
+            return;
+        }
+        for (uint32_t i = 1; i < instruction.length; i++)
+        {
+            if (flags[index + i] & (Start | Continuation))
+            {
+                overlaps++;
+                return;
+            }
+        }
+        flags[index] |= Start;
+        for (uint32_t i = 1; i < instruction.length; i++)
+        {
+            flags[index + i] |= Continuation;
+        }
+
+        Flow flow = flowOf(instruction);
+        if (flow.known)
+        {
+            queue(flow.target);
+        }
+        if (!flow.continues)
+        {
+            return;
+        }
+        address += instruction.length * 2;
+        if (flow.kind == FlowEdgeKind::Branch && inImage(address))
+        {
+            flags[(address - base) / 2] |= Leader;
+        }
+    }
+}
+
+void ControlFlowGraph::build()
+{
+    while (!worklist.empty())
+    {
+        uint32_t address = worklist.back();
+        worklist.pop_back();
+        flags[(address - base) / 2] &= ~Pending;
+        explore(address);
+    }
+    buildBlocks();
+}
+
+void ControlFlowGraph::buildBlocks()
+{
+    blocks.clear();
+    edges.clear();
+    BasicBlock block = {};
+    bool open = false;
+    DecodedInstruction instruction;
+
+    for (uint32_t index = 0; index < flags.size();)
+    {
+        if (!(flags[index] & Start))
+        {
+            if (open)
+            {
+                blocks.push_back(block);
+                open = false;
+            }
+            index++;
+            continue;
+        }
+        uint32_t address = base + index * 2;
+        if (open && (flags[index] & Leader))
+        {
+            edges.push_back({ block.start, address, FlowEdgeKind::FallThrough });
+            blocks.push_back(block);
+            open = false;
+        }
+        if (!open)
+        {
+            block = { address, address, 0 };
+            open = true;
+        }
+
+        decodeAt(address, instruction);
+        block.end = address + instruction.length * 2;
+        block.instructions++;
+        index += instruction.length;
+
+        Flow flow = flowOf(instruction);
+        if (flow.known)
+        {
+            edges.push_back({ block.start, flow.target, flow.kind });
+        }
+        if (!flow.continues || flow.kind == FlowEdgeKind::Branch)
+        {
+            if (flow.continues)
+            {
+                edges.push_back({ block.start, block.end, FlowEdgeKind::FallThrough });
+            }
+            blocks.push_back(block);
+            open = false;
+        }
+    }
+    if (open)
+    {
+        blocks.push_back(block);
+    }
+}
+
+void ControlFlowGraph::writeDot(std::ostream& out, DisAsm& disAsm) const
+{
+    char line[256];
+    out << "digraph cfg {" << std::endl;
+    out << "    node [shape=box, fontname=\"monospace\"];" << std::endl;
+    for (const auto& block : blocks)
+    {
+        std::string label = disAsm.findSymbol(block.start);
+        label = (label.empty() ? hexAddress(block.start) : label) + ":\\l";
+        for (uint32_t address = block.start; address < block.end;)
+        {
+            DecodedInstruction instruction = disAsm.decodeInstruction(address, base + size - address);
+            disAsm.format(instruction, line, sizeof(line));
+            label += hexAddress(address) + "  " + line + "\\l";
+            address += instruction.length * 2;
+        }
+        out << "    \"" << hexAddress(block.start) << "\" [label=\"";
+        // the \l line ends are kept, the quotes of the text are escaped
+        for (char c : label)
+        {
+            if (c == '"')
+            {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << "\"];" << std::endl;
+    }
+    for (const auto& edge : edges)
+    {
+        out << "    \"" << hexAddress(edge.from) << "\" -> \"" << hexAddress(edge.to) << "\" [label=\""
+            << edgeKindNames[static_cast<int>(edge.kind)] << "\"];" << std::endl;
+    }
+    out << "}" << std::endl;
+}
+
+void ControlFlowGraph::writeJson(std::ostream& out, DisAsm& disAsm) const
+{
+    char line[256];
+    out << "{\"blocks\":[";
+    const char* separator = "";
+    for (const auto& block : blocks)
+    {
+        out << separator << "{\"start\":" << block.start << ",\"end\":" << block.end;
+        std::string label = disAsm.findSymbol(block.start);
+        if (!label.empty())
+        {
+            out << ",\"label\":";
+            writeQuoted(out, label.c_str());
+        }
+        out << ",\"instructions\":[";
+        for (uint32_t address = block.start; address < block.end;)
+        {
+            DecodedInstruction instruction = disAsm.decodeInstruction(address, base + size - address);
+            disAsm.format(instruction, line, sizeof(line));
+            out << (address != block.start ? "," : "") << "{\"address\":" << address << ",\"text\":";
+            writeQuoted(out, line);
+            out << "}";
+            address += instruction.length * 2;
+        }
+        out << "]}";
+        separator = ",";
+    }
+    out << "],\"edges\":[";
+    separator = "";
+    for (const auto& edge : edges)
+    {
+        out << separator << "{\"from\":" << edge.from << ",\"to\":" << edge.to
+            << ",\"kind\":\"" << edgeKindNames[static_cast<int>(edge.kind)] << "\"}";
+        separator = ",";
+    }
+    out << "]}" << std::endl;
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "decoder.h"
+#include "symboltable.h"
+
+namespace mc68000
+{
+    class DisAsm;
+
+    /// <summary>
+    /// Sequence of instructions entered only at its first one and left only after its last one.
+    /// </summary>
+    struct BasicBlock
+    {
+        uint32_t start;
+        uint32_t end;               // address after the last instruction
+        uint32_t instructions;
+    };
+
+    enum class FlowEdgeKind : uint8_t
+    {
+        FallThrough,                // next instruction, after a conditional branch or into a leader
+        Branch,                     // taken Bcc or DBcc
+        Jump,                       // BRA or JMP
+        Call,                       // BSR or JSR, the block goes on after the call
+    };
+
+    struct FlowEdge
+    {
+        uint32_t from;              // start of the block
+        uint32_t to;                // target address, possibly outside of the image
+        FlowEdgeKind kind;
+    };
+
+    /// <summary>
+    /// Control flow disassembly of an image: starting from the entry points, the instructions are decoded
+    /// along the branches, jumps and calls whose targets are known, so the data between the routines is
+    /// never taken for code. The instructions found are then cut into basic blocks linked by edges.
+    /// The work is linear in the size of the image: one state byte per word and each word decoded once per pass.
+    /// </summary>
+    class ControlFlowGraph
+    {
+    public:
+        /// <summary>
+        /// The image is in the memory order of the 68000 and is not copied.
+        /// </summary>
+        ControlFlowGraph(const uint8_t* image, uint32_t base, uint32_t size);
+
+        /// <summary>
+        /// Adds an address where the code starts, ignored if odd or outside of the image.
+        /// </summary>
+        void addEntryPoint(uint32_t address);
+
+        /// <summary>
+        /// Adds the symbols as entry points, for the images whose labels are all code.
+        /// </summary>
+        void addEntryPoints(const SymbolTable& symbols);
+
+        /// <summary>
+        /// Follows the code from the entry points and builds the blocks and edges.
+        /// </summary>
+        void build();
+
+        const std::vector<BasicBlock>& getBlocks() const { return blocks; }
+        const std::vector<FlowEdge>& getEdges() const { return edges; }
+
+        /// <summary>
+        /// Indicates if address is the first word of a decoded instruction.
+        /// </summary>
+        bool isInstruction(uint32_t address) const;
+
+        /// <summary>
+        /// Number of targets that fall in the middle of an instruction already decoded.
+        /// </summary>
+        uint32_t getOverlaps() const { return overlaps; }
+
+        /// <summary>
+        /// Writes the graph in the DOT language of Graphviz, one node per block with its instructions.
+        /// disAsm must disassemble the same image, it gives the text and the symbols.
+        /// </summary>
+        void writeDot(std::ostream& out, DisAsm& disAsm) const;
+
+        /// <summary>
+        /// Writes the graph as one JSON object with the blocks, their instructions and the edges.
+        /// </summary>
+        void writeJson(std::ostream& out, DisAsm& disAsm) const;
+
+    private:
+        enum Flags : uint8_t
+        {
+            Start = 1,              // first word of an instruction
+            Continuation = 2,       // extension word of an instruction
+            Leader = 4,             // first instruction of a block
+            Pending = 8,            // in the worklist
+        };
+
+        /// <summary>
+        /// Where the execution goes after an instruction.
+        /// </summary>
+        struct Flow
+        {
+            bool known;             // target is valid
+            uint32_t target;
+            FlowEdgeKind kind;
+            bool continues;         // the next instruction can be executed
+        };
+
+        bool inImage(uint32_t address) const;
+        bool decodeAt(uint32_t address, DecodedInstruction& instruction);
+        static Flow flowOf(const DecodedInstruction& instruction);
+        void explore(uint32_t address);
+        void queue(uint32_t address);
+        void buildBlocks();
+
+        const uint8_t* image;
+        uint32_t base;
+        uint32_t size;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> worklist;
+        std::vector<BasicBlock> blocks;
+        std::vector<FlowEdge> edges;
+        uint32_t overlaps = 0;
+        Decoder decoder;
+    };
+}
@@ -34,9 +34,13 @@ namespace mc68000
 			{
 				for (int ea = 0; ea <= 0x3f; ea++)
 				{
-					handlers[0xd000 + (reg << 9) + (opmode << 6) + ea] = &T::add;
-					handlers[0xb000 + (reg << 9) + (opmode << 6) + ea] = &T::cmp;
-					handlers[0x9000 + (reg << 9) + (opmode << 6) + ea] = &T::sub;
+					// an address register is not a byte operand
+					if (isValidAddressingMode(ea, opmode == 0 ? 0b101111111111u : 0b111111111111u))
+					{
+						handlers[0xd000 + (reg << 9) + (opmode << 6) + ea] = &T::add;
+						handlers[0xb000 + (reg << 9) + (opmode << 6) + ea] = &T::cmp;
+						handlers[0x9000 + (reg << 9) + (opmode << 6) + ea] = &T::sub;
+					}
 					if (isValidAddressingMode(ea, 0b101111111111u))
 					{
 						handlers[0xc000 + (reg << 9) + (opmode << 6) + ea] = &T::and_;
@@ -65,6 +69,10 @@ namespace mc68000
 			}
 			for (int ea = 0; ea <= 0x3f; ea++)
 			{
+				if (!isValidAddressingMode(ea, 0b111111111111u))
+				{
+					continue;
+				}
 				handlers[0xd000 + (reg << 9) + (0b011u << 6) + ea] = &T::adda;
 				handlers[0xd000 + (reg << 9) + (0b111u << 6) + ea] = &T::adda;
 				handlers[0xb000 + (reg << 9) + (0b011u << 6) + ea] = &T::cmpa;
@@ -98,7 +106,7 @@ namespace mc68000
 			{
 				for (int ea = 0; ea <= 0x3f; ea++)
 				{
-					if (isValidAddressingMode(ea, 0b111111111000u))
+					if (isValidAddressingMode(ea, size == 0 ? 0b101111111000u : 0b111111111000u))
 					{
 						handlers[0x5000 + (data << 9) + (0 << 8) + (size << 6) + ea] = &T::addq;
 						handlers[0x5000 + (data << 9) + (1 << 8) + (size << 6) + ea] = &T::subq;
@@ -353,7 +361,8 @@ namespace mc68000
 					unsigned short invertedDestination = (destinationRegister << 3) | destinationMode;
 					for (unsigned source = 0; source <= 0b111'111u; source++)
 					{
-						if (isValidAddressingMode(destination, 0b111111111111u))
+						// size 1 is byte: an address register is not a byte operand
+						if (isValidAddressingMode(source, size == 1 ? 0b101111111111u : 0b111111111111u))
 						{
 							handlers[(size << 12) + (invertedDestination << 6) + source] = &T::move;
 						}
@@ -369,7 +378,10 @@ namespace mc68000
 			{
 				for (unsigned source = 0; source <= 0b111'111u; source++)
 				{
-					handlers[(size << 12) + (reg << 9) + (1 << 6) + source] = &T::movea;
+					if (isValidAddressingMode(source, 0b111111111111u))
+					{
+						handlers[(size << 12) + (reg << 9) + (1 << 6) + source] = &T::movea;
+					}
 				}
 			}
 		}
@@ -563,7 +575,10 @@ namespace mc68000
 		{
 			for (unsigned ea = 0; ea <= 0b111'111u; ea++)
 			{
-				handlers[0x4A00 + (size << 6) + ea] = &T::tst;
+				if (isValidAddressingMode(ea, 0b101111111000u))
+				{
+					handlers[0x4A00 + (size << 6) + ea] = &T::tst;
+				}
 			}
 		}
 
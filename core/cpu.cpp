@@ -9,25 +9,24 @@
 namespace mc68000
 {
 	Cpu::Cpu(const Memory& memory) :
-		dRegisters{ 0 },
-		aRegisters{ 0 },
-		d0(dRegisters[0]),
-		d1(dRegisters[1]),
-		d2(dRegisters[2]),
-		d3(dRegisters[3]),
-		d4(dRegisters[4]),
-		d5(dRegisters[5]),
-		d6(dRegisters[6]),
-		d7(dRegisters[7]),
-
-		a0(aRegisters[0]),
-		a1(aRegisters[1]),
-		a2(aRegisters[2]),
-		a3(aRegisters[3]),
-		a4(aRegisters[4]),
-		a5(aRegisters[5]),
-		a6(aRegisters[6]),
-		a7(aRegisters[7]),
+		registers{ 0 },
+		d0(registers[0]),
+		d1(registers[1]),
+		d2(registers[2]),
+		d3(registers[3]),
+		d4(registers[4]),
+		d5(registers[5]),
+		d6(registers[6]),
+		d7(registers[7]),
+
+		a0(registers[8]),
+		a1(registers[9]),
+		a2(registers[10]),
+		a3(registers[11]),
+		a4(registers[12]),
+		a5(registers[13]),
+		a6(registers[14]),
+		a7(registers[15]),
 
 		mem(localMemory),
 		sr(statusRegister)
@@ -36,6 +35,14 @@ namespace mc68000
 		handlers = setup<Cpu>();
 		for (int i = 0; i < 16; trapHandlers[i++] = nullptr);
 		chkHandlers = nullptr;
+		fastTraps = true;
+		statistics = nullptr;
+		trapArgumentsAddress = 0;
+		trapCallerIsSupervisor = false;
+		threadedDispatch = true;
+		readModifyWriteAddress = 0;
+		verifyNativeRoutines = false;
+		nativeMismatches = 0;
 	}
 
 	Cpu::~Cpu()
@@ -45,12 +52,10 @@ namespace mc68000
 
 	void Cpu::reset()
 	{
-		for (auto& dRegister : dRegisters)
-			dRegister = 0;
-
-		for (auto& aRegister : aRegisters)
-			aRegister = 0;
+		for (auto& reg : registers)
+			reg = 0;
 		pc = 0;
+		readModifyWriteAddress = 0;
 	}
 
 	void Cpu::reset(const Memory& memory)
@@ -63,13 +68,49 @@ namespace mc68000
 	{
 		done = false;
 		pc = startPc;
-		aRegisters[7] = startSP;
+		registers[8 + 7] = startSP;
 		usp = startSP;
 		ssp = startSSP;
 
+		uint16_t opcode = 0;
+		if (statistics != nullptr)
+		{
+			// separate loop so that the statistics cost nothing when disabled
+			while (!done)
+			{
+				uint16_t x = localMemory.getWord(pc);
+				if (localMemory.hasFault())
+				{
+					handleFault(opcode);
+					continue;
+				}
+				opcode = x;
+				uint32_t instructionPc = pc;
+				pc += 2;
+				uint16_t id = (this->*handlers[x])(x);
+				statistics->instruction(x, id);
+				recordBranch(x, id, instructionPc);
+			}
+			return;
+		}
+#if defined(__GNUC__)
+		if (threadedDispatch)
+		{
+			runThreaded();
+			return;
+		}
+#endif
+
 		while (!done)
 		{
 			uint16_t x = localMemory.getWord(pc);
+			if (localMemory.hasFault())
+			{
+				// the previous instruction or this fetch faulted
+				handleFault(opcode);
+				continue;
+			}
+			opcode = x;
 			pc += 2;
 			(this->*handlers[x])(x);
 		}
@@ -77,18 +118,27 @@ namespace mc68000
 
 	void Cpu::setARegister(int reg, uint32_t value)
 	{
-		aRegisters[reg] = value;
+		registers[8 + reg] = value;
 	}
 
 	void Cpu::setDRegister(int reg, uint32_t value)
 	{
-		dRegisters[reg] = value;
+		registers[reg] = value;
 	}
 
     void Cpu::setCCR(uint8_t ccr)
     {
         statusRegister = ccr;
     }
+
+	/// <summary>
+	/// The address of the next instruction; after a halt, the address following the halting word.
+	/// </summary>
+	uint32_t Cpu::getPc() const
+	{
+		return pc;
+	}
+
 	void Cpu::registerTrapHandler(int trapNumber, TrapHandler* trapHandler)
 	{
 		if (trapNumber < 0 || trapNumber > 15)
@@ -103,6 +153,31 @@ namespace mc68000
         statusRegister.s = super ? 1 : 0;
     }
 
+    /// <summary>
+    /// Selects how TRAPs handled by the host are dispatched. When fast, the handler is called without
+    /// building the exception frame; otherwise the frame is pushed and popped as for a guest vector.
+    /// </summary>
+    void Cpu::setFastTraps(bool fast)
+    {
+        fastTraps = fast;
+    }
+
+    /// <summary>
+    /// Attaches a statistics collector to the following runs, nullptr to stop collecting.
+    /// </summary>
+    void Cpu::setStatistics(Statistics* stats)
+    {
+        statistics = stats;
+    }
+
+    /// <summary>
+    /// Arguments of the TRAP being handled by the host.
+    /// </summary>
+    TrapArguments Cpu::trapArguments() const
+    {
+        return TrapArguments(localMemory, trapArgumentsAddress, trapCallerIsSupervisor);
+    }
+
     template<> uint16_t Cpu::getFromStack<uint16_t>(bool isSuper, int16_t offset)
     {
         uint32_t sp = isSuper ? ssp : usp;
@@ -138,28 +213,22 @@ namespace mc68000
 		}
 		else
 		{
-			op1 = dRegisters[register1];
-			op2 = dRegisters[register2];
+			op1 = registers[register1];
+			op2 = registers[register2];
 		}
-		uint16_t m1 = (op1 & 0x0f) + (op2 & 0x0f) + statusRegister.x;
-		uint16_t m2 = (op1 & 0xf0) + (op2 & 0xf0);
-		uint16_t result = m2 + m1;
-		if (m1 >= 10)
+		// digit by digit, as the 68000 does it: the result of operands that aren't BCD follows from the same steps
+		uint16_t result = (op1 & 0x0f) + (op2 & 0x0f) + statusRegister.x;
+		if (result > 9)
 		{
 			result += 0x6; // in hexadecimal : 8 + 2 = A ; A + 6 = 10 ; in BCD 08 + 02 = 10
 		}
-		if ((result & 0xfff0) > 0x90)
+		result += (op1 & 0xf0) + (op2 & 0xf0);
+		statusRegister.c = statusRegister.x = result > 0x99 ? 1 : 0;
+		if (statusRegister.c)
 		{
-			statusRegister.c = 1;
-			statusRegister.x = 1;
 			result += 0x60;
 		}
-		else
-		{
-			statusRegister.c = 0;
-			statusRegister.x = 0;
-		}
-		if (result != 0)
+		if ((result & 0xff) != 0)
 		{
 			statusRegister.z = 0;
 		}
@@ -169,7 +238,7 @@ namespace mc68000
 		}
 		else
 		{
-			dRegisters[register2] = (dRegisters[register2] & 0xffffff00) | (result & 0xff);
+			registers[register2] = (registers[register2] & 0xffffff00) | (result & 0xff);
 		}
 
 		return instructions::ABCD;
@@ -223,13 +292,13 @@ namespace mc68000
 		if (isLongOperation)
 		{
 			uint32_t operand = readAt<uint32_t>(sourceEffectiveAddress, false);
-			aRegisters[destinationRegister] += operand;
+			registers[8 + destinationRegister] += operand;
 		}
 		else
 		{
 			uint16_t operand = readAt<uint16_t>(sourceEffectiveAddress, false);
 			uint32_t extended = (int16_t)operand;
-			aRegisters[destinationRegister] += extended;
+			registers[8 + destinationRegister] += extended;
 		}
 		return instructions::ADDA;
 	}
@@ -417,6 +486,9 @@ namespace mc68000
 		}
 		writeAt<uint16_t>(effectiveAddress, memory, true);
 		statusRegister.c = statusRegister.x = bit0;
+		statusRegister.n = (memory & 0x8000) ? 1 : 0;
+		statusRegister.z = memory == 0;
+		statusRegister.v = 0;
 		return instructions::ASR;
 	}
 
@@ -584,7 +656,7 @@ namespace mc68000
 		{
 			// a data register is being used. The size is long.
 			uint32_t bitToTest = 1 << (bit & 0x1f);
-			uint32_t& data = dRegisters[opcode & 0b111];
+			uint32_t& data = registers[opcode & 0b111];
 			statusRegister.z = (data & bitToTest) == 0;
 			switch (operation)
 			{
@@ -598,14 +670,15 @@ namespace mc68000
 		{
 			// a memory access is being used. The size is byte.
 			uint8_t bitToTest = 1 << (bit & 0x7);
-			uint8_t data = readAt<uint8_t>(opcode & 0b111'111, true);
+			// BTST only reads: a post increment is done by the read
+			uint8_t data = readAt<uint8_t>(opcode & 0b111'111, operation != BTST);
 			statusRegister.z = (data & bitToTest) == 0;
 			switch (operation)
 			{
 				case BCLR: data &= ~bitToTest; break;
 				case BSET: data |= bitToTest; break;
 				case BCHG: data ^= bitToTest; break;
-				case BTST: break;
+				case BTST: return;
 			}
 			writeAt<uint8_t>(opcode & 0b111'111, data, true);
 		}
@@ -614,7 +687,7 @@ namespace mc68000
 	uint16_t Cpu::bchg_r(uint16_t opcode)
 	{
 		uint8_t reg = (opcode >> 9) & 0b111;
-		uint32_t bit = dRegisters[reg];
+		uint32_t bit = registers[reg];
 		bchg(opcode, bit,BCHG);
 		return instructions::BCHG_R;
 	}
@@ -632,7 +705,7 @@ namespace mc68000
 	uint16_t Cpu::bclr_r(uint16_t opcode)
 	{
 		uint8_t reg = (opcode >> 9) & 0b111;
-		uint32_t bit = dRegisters[reg];
+		uint32_t bit = registers[reg];
 		bchg(opcode, bit, BCLR);
 		return instructions::BCLR_R;
 	}
@@ -650,7 +723,7 @@ namespace mc68000
 	uint16_t Cpu::bset_r(uint16_t opcode)
 	{
 		uint8_t reg = (opcode >> 9) & 0b111;
-		uint32_t bit = dRegisters[reg];
+		uint32_t bit = registers[reg];
 		bchg(opcode, bit, BSET);
 		return instructions::BSET_R;
 	}
@@ -684,6 +757,10 @@ namespace mc68000
 		writeAt<uint32_t>(0b100'111, pc, false);
 
 		pc = currentPc + displacement;
+		if (!nativeRoutines.empty())
+		{
+			callNativeRoutine();
+		}
 		return instructions::BSR;
 	}
 
@@ -693,7 +770,7 @@ namespace mc68000
 	uint16_t Cpu::btst_r(uint16_t opcode)
 	{
 		uint8_t reg = (opcode >> 9) & 0b111;
-		uint32_t bit = dRegisters[reg];
+		uint32_t bit = registers[reg];
 		bchg(opcode, bit, BTST);
 		return instructions::BTST_R;
 	}
@@ -711,19 +788,19 @@ namespace mc68000
 	uint16_t Cpu::chk(uint16_t opcode)
 	{
 		uint8_t reg = (opcode >> 9) & 0b111;
-		int16_t value = (int16_t)(dRegisters[reg] & 0xffff);
-		uint16_t upperBound = readAt<uint16_t>(opcode & 0b111'111, false);
+		int16_t value = (int16_t)(registers[reg] & 0xffff);
+		int16_t upperBound = (int16_t)readAt<uint16_t>(opcode & 0b111'111, false);
 		if (value < 0 || value > upperBound)
 		{
 			// The condition codes are set according to the result of the comparison.
 			statusRegister.n = (value < 0) ? 1 : 0;
 			if (chkHandlers != nullptr)
 			{
-                chkHandlers->handle(*this, 0); // TODO : the vector should be passed as an argument to the instruction
+                chkHandlers->handle(*this, Exceptions::CHK);
 			}
 			else
 			{
-				done = true;
+				handleException(Exceptions::CHK);
 			}
 		}
 
@@ -799,8 +876,17 @@ namespace mc68000
 		switch (size)
 		{
 		case 3:
-			cmp<uint16_t>(sourceEffectiveAddress, destinationEffectiveAdress);
+		{
+			// the word source is sign-extended and compared to the whole address register
+			uint32_t source = (int16_t)readAt<uint16_t>(sourceEffectiveAddress, false);
+			uint32_t destination = registers[8 + ((opcode >> 9) & 0b111)];
+			uint32_t result = destination - source;
+			statusRegister.n = (result & 0x80000000) != 0;
+			statusRegister.z = result == 0;
+			statusRegister.c = source > destination;
+			statusRegister.v = (((source ^ destination) & (destination ^ result)) & 0x80000000) != 0;
 			break;
+		}
 		case 7:
 			cmp<uint32_t>(sourceEffectiveAddress, destinationEffectiveAdress);
 			break;
@@ -885,7 +971,7 @@ namespace mc68000
 		bool condition = sr.condition(conditionCode);
 		if (!condition)
 		{
-			uint32_t& reg = dRegisters[opcode & 0b111];
+			uint32_t& reg = registers[opcode & 0b111];
 			uint16_t regW = reg & 0xFFFF;
 			regW--;
 			reg = (reg & 0xffff0000) | regW;
@@ -904,7 +990,7 @@ namespace mc68000
 	{
 		uint16_t source = readAt<uint16_t>(opcode & 0b111'111, false);
 		uint8_t reg = (opcode >> 9) & 0b111;
-		int32_t destination = dRegisters[reg];
+		int32_t destination = registers[reg];
 
 		if (source == 0)
 		{
@@ -913,10 +999,11 @@ namespace mc68000
 		else
 		{
 			int16_t divisor = static_cast<int16_t>(source);
-			int32_t dividend = static_cast<int32_t>(destination);
+			int64_t dividend = static_cast<int32_t>(destination);
 
-			int32_t quotient = dividend / divisor;
-			int16_t remainder = dividend % divisor;
+			// computed on 64 bits: $80000000 / -1 overflows 32 bits
+			int64_t quotient = dividend / divisor;
+			int16_t remainder = static_cast<int16_t>(dividend % divisor);
 
 			if (quotient > 0x7fff || quotient < -0x8000)
 			{
@@ -924,7 +1011,7 @@ namespace mc68000
 			}
 			else
 			{
-				dRegisters[reg] = (remainder << 16) | (quotient & 0xffff);
+				registers[reg] = (remainder << 16) | (quotient & 0xffff);
 				statusRegister.n = quotient < 0;
 				statusRegister.z = quotient == 0;
 				statusRegister.v = 0;
@@ -941,7 +1028,7 @@ namespace mc68000
 	{
 		uint16_t source = readAt<uint16_t>(opcode & 0b111'111, false);
 		uint8_t reg = (opcode >> 9) & 0b111;
-		int32_t destination = dRegisters[reg];
+		int32_t destination = registers[reg];
 
 		if (source == 0)
 		{
@@ -961,8 +1048,8 @@ namespace mc68000
 			}
 			else
 			{
-				dRegisters[reg] = (remainder << 16) | (quotient & 0xffff);
-				statusRegister.n = quotient < 0;
+				registers[reg] = (remainder << 16) | (quotient & 0xffff);
+				statusRegister.n = (quotient & 0x8000) != 0;
 				statusRegister.z = quotient == 0;
 				statusRegister.v = 0;
 			}
@@ -1036,23 +1123,23 @@ namespace mc68000
 		{
 			case 0b01000:
 			{
-				uint32_t temp = dRegisters[regx];
-				dRegisters[regx] = dRegisters[regy];
-				dRegisters[regy] = temp;
+				uint32_t temp = registers[regx];
+				registers[regx] = registers[regy];
+				registers[regy] = temp;
 				break;
 			}
 			case 0b01001:
 			{
-				uint32_t temp = aRegisters[regx];
-				aRegisters[regx] = aRegisters[regy];
-				aRegisters[regy] = temp;
+				uint32_t temp = registers[8 + regx];
+				registers[8 + regx] = registers[8 + regy];
+				registers[8 + regy] = temp;
 				break;
 			}
 			case 0b10001:
 			{
-				uint32_t temp = dRegisters[regx];
-				dRegisters[regx] = aRegisters[regy];
-				aRegisters[regy] = temp;
+				uint32_t temp = registers[regx];
+				registers[regx] = registers[8 + regy];
+				registers[8 + regy] = temp;
 				break;
 			}
 			default:
@@ -1071,22 +1158,28 @@ namespace mc68000
 
 		if (isLong)
 		{
-			uint32_t v = dRegisters[reg] & 0xffff;
+			uint32_t v = registers[reg] & 0xffff;
 			if (v & 0x8000)
 			{
 				v |= 0xffff0000;
 			}
-			dRegisters[reg] = v;
+			registers[reg] = v;
+			statusRegister.n = (v & 0x80000000) != 0;
+			statusRegister.z = v == 0;
 		}
 		else
 		{
-			uint16_t v = dRegisters[reg] & 0xff;
-			if (v & 0b1000'000)
+			uint16_t v = registers[reg] & 0xff;
+			if (v & 0b1000'0000)
 			{
 				v |= 0xff00;
 			}
-			dRegisters[reg] = (dRegisters[reg] & 0xffff0000) | v;
+			registers[reg] = (registers[reg] & 0xffff0000) | v;
+			statusRegister.n = (v & 0x8000) != 0;
+			statusRegister.z = v == 0;
 		}
+		statusRegister.v = 0;
+		statusRegister.c = 0;
 		return instructions::EXT;
 	}
 
@@ -1118,6 +1211,10 @@ namespace mc68000
 		uint32_t address = getEffectiveAddress(opcode);
 		writeAt<uint32_t>(0b100'111, pc, false);
 		pc = address;
+		if (!nativeRoutines.empty())
+		{
+			callNativeRoutine();
+		}
 
 		return instructions::JSR;
 	}
@@ -1130,7 +1227,7 @@ namespace mc68000
 		uint32_t address = getEffectiveAddress(opcode);
 
 		uint16_t destinationRegister = (opcode >> 9) & 0b111;
-		aRegisters[destinationRegister] = address;
+		registers[8 + destinationRegister] = address;
 
 		return instructions::LEA;
 	}
@@ -1144,10 +1241,10 @@ namespace mc68000
 		int16_t displacement = static_cast<int16_t>(localMemory.get<uint16_t>(pc));
 		pc += 2;
 
-		uint32_t& sp = aRegisters[7];
+		uint32_t& sp = registers[8 + 7];
 		sp -= 4;
-		localMemory.set(sp, aRegisters[reg]);
-		aRegisters[reg] = sp;
+		localMemory.set(sp, registers[8 + reg]);
+		registers[8 + reg] = sp;
 		sp += displacement;
 
 		return instructions::LINK;
@@ -1178,6 +1275,9 @@ namespace mc68000
 		memory &= 0x7fff;
 		writeAt<uint16_t>(effectiveAddress, memory, true);
 		statusRegister.c = statusRegister.x = bit0;
+		statusRegister.n = 0;
+		statusRegister.z = memory == 0;
+		statusRegister.v = 0;
 		return instructions::LSR;
 	}
 
@@ -1305,9 +1405,10 @@ namespace mc68000
 	{
 		uint16_t direction = (opcode >> 10) & 1;
 		uint16_t size = (opcode >> 6) & 1;
-		uint32_t effectiveAddress = getEffectiveAddress(opcode);
+		// the register list mask comes before the extension words of the effective address
 		uint16_t registerList = localMemory.get<uint16_t>(pc);
 		pc += 2;
+		uint32_t effectiveAddress = getEffectiveAddress(opcode);
 
 		if (direction == 0)
 		{
@@ -1318,77 +1419,45 @@ namespace mc68000
 				// If the effective address is specified by the predecrement mode, The registers are stored 
 				// starting at the specified address minus the operand length(2 or 4), and the address is 
 				// decremented by the operand length following each transfer.The order of storing is 
-				// from A7 to A0, then from D7 to D0.
-				for (int i = 0; i < 8; i++)
+				// from A7 to A0, then from D7 to D0: bit i of the mask is register 15 - i.
+				for (int i = 0; i < 16; i++)
 				{
 					if (registerList & (1 << i))
 					{
 						if (size == 0)
 						{
 							effectiveAddress -= 2;
-							localMemory.set<uint16_t>(effectiveAddress, aRegisters[7-i]);
+							localMemory.set<uint16_t>(effectiveAddress, registers[15 - i]);
 						}
 						else
 						{
 							effectiveAddress -= 4;
-							localMemory.set<uint32_t>(effectiveAddress, aRegisters[7-i]);
-						}
-					}
-				}
-				for (int i = 0; i < 8; i++)
-				{
-					if (registerList & (1 << (8+i)))
-					{
-						if (size == 0)
-						{
-							effectiveAddress -= 2;
-							localMemory.set<uint16_t>(effectiveAddress, dRegisters[7-i]);
-						}
-						else
-						{
-							effectiveAddress -= 4;
-							localMemory.set<uint32_t>(effectiveAddress, dRegisters[7-i]);
+							localMemory.set<uint32_t>(effectiveAddress, registers[15 - i]);
 						}
 					}
 				}
 				// When the instruction has completed, the decremented address register contains the address of 
 				// the last operand stored.
-				aRegisters[opcode & 0b111] = effectiveAddress; // TODO : check if this is correct
+				registers[8 + (opcode & 0b111)] = effectiveAddress;
 			}
 			else
 			{
 				// If the effective address is specified by one of the control modes, the registers are 
 				// transferred starting at the specified address, and the address is incremented by the 
 				// operand length(2 or 4) following each transfer.The order of the registers is from D0 
-				// to D7, then from A0 to A7.
-				for (int i = 0; i < 8; i++)
+				// to D7, then from A0 to A7: bit i of the mask is register i.
+				for (int i = 0; i < 16; i++)
 				{
 					if (registerList & (1 << i))
 					{
 						if (size == 0)
 						{
-							localMemory.set<uint16_t>(effectiveAddress, dRegisters[i]);
-							effectiveAddress += 2;
-						}
-						else
-						{
-							localMemory.set<uint32_t>(effectiveAddress, dRegisters[i]);
-							effectiveAddress += 4;
-						}
-					}
-				}
-				for (int i = 0; i < 8; i++)
-				{
-					if (registerList & (1 << (8 + i)))
-					{
-						if (size == 0)
-						{
-							localMemory.set<uint16_t>(effectiveAddress, aRegisters[i]);
+							localMemory.set<uint16_t>(effectiveAddress, registers[i]);
 							effectiveAddress += 2;
 						}
 						else
 						{
-							localMemory.set<uint32_t>(effectiveAddress, aRegisters[i]);
+							localMemory.set<uint32_t>(effectiveAddress, registers[i]);
 							effectiveAddress += 4;
 						}
 					}
@@ -1398,34 +1467,18 @@ namespace mc68000
 		else
 		{
 			// Memory to register
-			for (int i = 0; i < 8; i++)
-			{
-				if (registerList & (1 << i))
-				{
-					if (size == 0)
-					{
-						dRegisters[i] = static_cast<int16_t>(localMemory.get<uint16_t>(effectiveAddress));
-						effectiveAddress += 2;
-					}
-					else
-					{
-						dRegisters[i] = localMemory.get<uint32_t>(effectiveAddress);
-						effectiveAddress += 4;
-					}
-				}
-			}
-			for (int i = 0; i < 8; i++)
+			for (int i = 0; i < 16; i++)
 			{
 				if (registerList & (1 << i))
 				{
 					if (size == 0)
 					{
-						aRegisters[i] = static_cast<int16_t>(localMemory.get<uint16_t>(effectiveAddress));
+						registers[i] = static_cast<int16_t>(localMemory.get<uint16_t>(effectiveAddress));
 						effectiveAddress += 2;
 					}
 					else
 					{
-						aRegisters[i] = localMemory.get<uint32_t>(effectiveAddress);
+						registers[i] = localMemory.get<uint32_t>(effectiveAddress);
 						effectiveAddress += 4;
 					}
 				}
@@ -1437,7 +1490,7 @@ namespace mc68000
 				// the last operand loaded plus the operand length.If the addressing register is also loaded from
 				// memory, the memory value is ignored and the register is written with the postincremented
 				// effective address.
-				aRegisters[opcode & 0b111] = effectiveAddress; // TODO : check if this is correct
+				registers[8 + (opcode & 0b111)] = effectiveAddress;
 			}
 		}
 
@@ -1451,18 +1504,18 @@ namespace mc68000
 		uint16_t dRegister = (opcode >> 9) & 0b111;
 		uint16_t aRegister = opcode & 0b111;
 		uint16_t opmode = (opcode >> 6) & 0b111;
-		uint16_t displacement = localMemory.get<uint16_t>(pc);
+		int16_t displacement = static_cast<int16_t>(localMemory.get<uint16_t>(pc));
 		pc += 2;
 
-		uint32_t effectiveAddress = aRegisters[aRegister] + displacement;
+		uint32_t effectiveAddress = registers[8 + aRegister] + displacement;
 		switch (opmode)
 		{
 			case 0b100: // Transfer word from memory to register.
 			{
 				uint8_t m1 = localMemory.get<uint8_t>(effectiveAddress);
 				uint8_t m2 = localMemory.get<uint8_t>(effectiveAddress + 2 );
-				dRegisters[dRegister] &= 0xffff0000;
-				dRegisters[dRegister] |= (m1 << 8) | m2;
+				registers[dRegister] &= 0xffff0000;
+				registers[dRegister] |= (m1 << 8) | m2;
 				break;
 			}
 			case 0b101: // Transfer long from memory to register.
@@ -1471,21 +1524,21 @@ namespace mc68000
 				uint8_t m2 = localMemory.get<uint8_t>(effectiveAddress + 2);
 				uint8_t m3 = localMemory.get<uint8_t>(effectiveAddress + 4);
 				uint8_t m4 = localMemory.get<uint8_t>(effectiveAddress + 6);
-				dRegisters[dRegister] = (m1 << 24) | (m2 << 16) | (m3 << 8) | m4;
+				registers[dRegister] = (m1 << 24) | (m2 << 16) | (m3 << 8) | m4;
 				break;
 			}
 			case 0b110: // Transfer word from register to memory.
 			{
-				localMemory.set<uint8_t>(effectiveAddress + 0, (dRegisters[dRegister] & 0xff00) >> 8);
-				localMemory.set<uint8_t>(effectiveAddress + 2, (dRegisters[dRegister] & 0x00ff) >> 0);
+				localMemory.set<uint8_t>(effectiveAddress + 0, (registers[dRegister] & 0xff00) >> 8);
+				localMemory.set<uint8_t>(effectiveAddress + 2, (registers[dRegister] & 0x00ff) >> 0);
 				break;
 			}
 			case 0b111: // Transfer long from register to memory.
 			{
-				localMemory.set<uint8_t>(effectiveAddress + 0, (dRegisters[dRegister] & 0xff000000) >> 24);
-				localMemory.set<uint8_t>(effectiveAddress + 2, (dRegisters[dRegister] & 0x00ff0000) >> 16);
-				localMemory.set<uint8_t>(effectiveAddress + 4, (dRegisters[dRegister] & 0x0000ff00) >> 8);
-				localMemory.set<uint8_t>(effectiveAddress + 6, (dRegisters[dRegister] & 0x000000ff) >> 0);
+				localMemory.set<uint8_t>(effectiveAddress + 0, (registers[dRegister] & 0xff000000) >> 24);
+				localMemory.set<uint8_t>(effectiveAddress + 2, (registers[dRegister] & 0x00ff0000) >> 16);
+				localMemory.set<uint8_t>(effectiveAddress + 4, (registers[dRegister] & 0x0000ff00) >> 8);
+				localMemory.set<uint8_t>(effectiveAddress + 6, (registers[dRegister] & 0x000000ff) >> 0);
 				break;
 			}
 			default:
@@ -1502,7 +1555,7 @@ namespace mc68000
 		uint16_t reg = (opcode >> 9) & 0x07;
 		int32_t data = (int8_t) (opcode & 0xff);
 
-		dRegisters[reg] = data;
+		registers[reg] = data;
 		statusRegister.n = (data < 0);
 		statusRegister.z = (data == 0);
 		statusRegister.v = 0;
@@ -1518,10 +1571,10 @@ namespace mc68000
 	{
 		int32_t source = static_cast<int16_t>(readAt<uint16_t>(opcode & 0b111'111, false));
 		uint8_t reg = (opcode >> 9) & 0b111;
-		int32_t destination = static_cast<int16_t>(dRegisters[reg] & 0xffff);
+		int32_t destination = static_cast<int16_t>(registers[reg] & 0xffff);
 
 		destination *= source;
-		dRegisters[reg] = destination;
+		registers[reg] = destination;
 		statusRegister.n = (destination < 0);
 		statusRegister.z = (destination == 0);
 		statusRegister.v = 0;
@@ -1537,11 +1590,11 @@ namespace mc68000
 	{
 		uint32_t source = readAt<uint16_t>(opcode & 0b111'111, false);
 		uint8_t reg = (opcode >> 9) & 0b111;
-		uint32_t destination = dRegisters[reg] & 0xffff;
+		uint32_t destination = registers[reg] & 0xffff;
 
 		destination *= source;
-		dRegisters[reg] = destination;
-		statusRegister.n = (destination < 0);
+		registers[reg] = destination;
+		statusRegister.n = (destination & 0x80000000) != 0;
 		statusRegister.z = (destination == 0);
 		statusRegister.v = 0;
 		statusRegister.c = 0;
@@ -1554,19 +1607,22 @@ namespace mc68000
 	/// </summary>
 	uint16_t Cpu::nbcd(uint16_t opcode)
 	{
-		uint8_t value = readAt<uint8_t>(opcode & 0b111'111, false);
-		uint16_t m1 = value & 0x0f;
-		uint16_t m2 = value & 0xf0;
-
-		int16_t decimalValue = 10 * (m2 >> 4) + m1 + statusRegister.x;
-		decimalValue = 100 - decimalValue;
-		if (decimalValue == 100) decimalValue = 0;
-		m1 = decimalValue % 10;
-		m2 = decimalValue / 10;
-		value = (m2 << 4) | m1;
-		writeAt<uint8_t>(opcode & 0b111'111, value, false);
+		uint8_t value = readAt<uint8_t>(opcode & 0b111'111, true);
+		// 0 - value - X digit by digit, as SBCD
+		uint16_t result = 0 - (value & 0x0f) - statusRegister.x;
+		if (result > 9)
+		{
+			result -= 6;
+		}
+		result -= value & 0xf0;
+		statusRegister.x = statusRegister.c = result > 0x99 ? 1 : 0;
+		if (statusRegister.c)
+		{
+			result += 0xa0;
+		}
+		value = static_cast<uint8_t>(result);
+		writeAt<uint8_t>(opcode & 0b111'111, value, true);
 
-		statusRegister.x = statusRegister.c = (decimalValue == 0 ? 0 : 1);
 		if (value != 0) statusRegister.z = 0; // Z is cleared if the result is nonzero; unchanged otherwise.
 
 		return instructions::NBCD;
@@ -1763,7 +1819,7 @@ namespace mc68000
 		{
 			// Rotate count is in the register
 			uint16_t reg = (opcode >> 9) & 0b111;
-			count = dRegisters[reg] & 0x3f;
+			count = registers[reg] & 0x3f;
 		}
 		else
 		{
@@ -1966,50 +2022,22 @@ namespace mc68000
 		}
 		else
 		{
-			op1 = dRegisters[register1];
-			op2 = dRegisters[register2];
+			op1 = registers[register1];
+			op2 = registers[register2];
 		}
-		uint16_t op1_low = (op1 & 0x0f) + statusRegister.x;
-		uint16_t op1_high = op1 & 0xf0;
-		uint16_t op2_low = op2 & 0x0f;
-		uint16_t op2_high = op2 & 0xf0;
-
-		uint16_t m1;
-		uint16_t m2;
-		if (op1_low <= op2_low)
+		// digit by digit, as the 68000 does it: the result of operands that aren't BCD follows from the same steps
+		uint16_t result = (op2 & 0x0f) - (op1 & 0x0f) - statusRegister.x;
+		if (result > 9)
 		{
-			m1 = op2_low - op1_low;
-			if (op1_high <= op2_high)
-			{
-				m2 = op2_high - op1_high;
-				statusRegister.x = 0;
-				statusRegister.c = 0;
-			}
-			else
-			{
-				m2 = (op2_high + 10 * 0x10) - op1_high;
-				statusRegister.x = 1;
-				statusRegister.c = 1;
-			}
+			result -= 6;
 		}
-		else
+		result += (op2 & 0xf0) - (op1 & 0xf0);
+		statusRegister.c = statusRegister.x = result > 0x99 ? 1 : 0;
+		if (statusRegister.c)
 		{
-			m1 = (op2_low + 10) - op1_low;
-			if (op1_high-0x10 <= op2_high)
-			{
-				m2 = op2_high-0x10 - op1_high;
-				statusRegister.x = 0;
-				statusRegister.c = 0;
-			}
-			else
-			{
-				m2 = (op2_high + 10*0x10 - 0x10) - op1_high;
-				statusRegister.x = 1;
-				statusRegister.c = 1;
-			}
+			result += 0xa0;
 		}
-
-		uint16_t result = m2 + m1;
+		result &= 0xff;
 		if (result != 0)
 		{
 			statusRegister.z = 0;
@@ -2020,7 +2048,7 @@ namespace mc68000
 		}
 		else
 		{
-			dRegisters[register2] = (dRegisters[register2] & 0xffffff00) | (result & 0xff);
+			registers[register2] = (registers[register2] & 0xffffff00) | (result & 0xff);
 		}
 		return instructions::SBCD;
 	}
@@ -2117,13 +2145,13 @@ namespace mc68000
 		if (isLongOperation)
 		{
 			uint32_t operand = readAt<uint32_t>(sourceEffectiveAddress, false);
-			aRegisters[destinationRegister] -= operand;
+			registers[8 + destinationRegister] -= operand;
 		}
 		else
 		{
 			uint16_t operand = readAt<uint16_t>(sourceEffectiveAddress, false);
 			uint32_t extended = (int16_t)operand;
-			aRegisters[destinationRegister] -= extended;
+			registers[8 + destinationRegister] -= extended;
 		}
 
 		return instructions::SUBA;
@@ -2230,9 +2258,9 @@ namespace mc68000
 	uint16_t Cpu::swap(uint16_t opcode)
 	{
 		uint16_t destinationRegister = opcode & 0b111;
-		uint32_t value = dRegisters[destinationRegister];
+		uint32_t value = registers[destinationRegister];
 		value = (value >> 16) | (value << 16);
-		dRegisters[destinationRegister] = value;
+		registers[destinationRegister] = value;
 
 		statusRegister.n = static_cast<int32_t>(value) < 0;
 		statusRegister.z = value == 0;
@@ -2324,8 +2352,8 @@ namespace mc68000
 	uint16_t Cpu::unlk(uint16_t opcode)
 	{
 		uint8_t reg = opcode & 0b111;
-		aRegisters[7] = aRegisters[reg];
-		aRegisters[reg] = readAt<uint32_t>(0b011'111, false);
+		registers[8 + 7] = registers[8 + reg];
+		registers[8 + reg] = readAt<uint32_t>(0b011'111, false);
 
 		return instructions::UNLK;
 	}
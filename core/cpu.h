@@ -3,11 +3,34 @@
 #include "memory.h"
 #include "statusregister.h"
 #include "traphandler.h"
+#include "traparguments.h"
+#include "statistics.h"
+#include "nativeroutine.h"
+#include <unordered_map>
 
 namespace mc68000
 {
 	class Cpu
 	{
+		using t_handler = uint16_t (Cpu::*)(uint16_t);
+
+		//
+		// architectural state, first in the object and aligned on a cache line: d0-d7 then a0-a7 so that
+		// the mode and register fields of a Dn or An effective address, the D/A bit and register number of
+		// an index extension word and the bit number of a movem mask all index registers without a branch.
+		// What every instruction reads next - pc, status register, handlers and memory - fills the next line.
+		//
+	private:
+		alignas(64) uint32_t registers[16];
+		uint32_t pc;
+		StatusRegister statusRegister;
+		uint32_t readModifyWriteAddress;	// memory operand of the read modify write operation in progress
+		t_handler* handlers;
+		Memory localMemory;
+		uint32_t usp;
+		uint32_t ssp;
+		bool done;
+
 		//
 		// Instruction handlers
 		//
@@ -155,17 +178,27 @@ namespace mc68000
 		uint16_t tst(uint16_t);
 		uint16_t unlk(uint16_t);
 
-		using t_handler = uint16_t (Cpu::*)(uint16_t);
 		friend t_handler* setup<Cpu>();
 
-		t_handler* handlers;
-		
 		//
 		// trap handlers
 		// 
 	private:
 		TrapHandler* trapHandlers[16];
 		TrapHandler* chkHandlers;
+		bool fastTraps;
+		Statistics* statistics;
+		uint32_t trapArgumentsAddress;
+		bool trapCallerIsSupervisor;
+		bool threadedDispatch;
+		//
+		// native routines
+		//
+	private:
+		std::unordered_map<uint32_t, NativeRoutine*> nativeRoutines;
+		bool verifyNativeRoutines;
+		uint64_t nativeMismatches;
+		std::vector<uint8_t> verifyEntryBytes;		// guest memory at the entry of the verified routine
 		//
 		// internal datastructures
 		// 
@@ -191,7 +224,7 @@ namespace mc68000
 		void logical(uint16_t opcode, uint32_t(*logicalOperator)(uint32_t, uint32_t));
 		void logicalImmediate(uint16_t opcode, uint32_t(*logicalOperator)(uint32_t, uint32_t));
 
-		template <typename T> void shiftLeft(uint16_t destinationRegister, uint32_t shift);
+		template <typename T> void shiftLeft(uint16_t destinationRegister, uint32_t shift, bool arithmetic);
 		template <typename T> void shiftRight(uint16_t destinationRegister, uint32_t shift, bool logical);
 		uint16_t shiftLeftMemory(uint16_t opcode, uint16_t instruction);
 		uint16_t shiftLeftRegister(uint16_t opcode, uint16_t instruction);
@@ -219,19 +252,14 @@ namespace mc68000
 		template <typename T> void subq(uint32_t data, uint16_t destinationEffectiveAdress);
 		template <typename T> void subx(uint16_t source, uint16_t destination, bool useAddressRegister);
 		void handleException(uint16_t vector);
-		//
-		// private members
-		//
-	private:
-		uint32_t dRegisters[8];
-		uint32_t aRegisters[8];
-		uint32_t usp;
-		uint32_t ssp;
-		StatusRegister statusRegister;
-		uint32_t pc;
-		Memory localMemory;
-		bool done;
-
+		void callTrapHandler(int trapNumber);
+		void handleFault(uint16_t opcode);
+		void recordBranch(uint16_t opcode, uint16_t instructionId, uint32_t instructionPc);
+		void runThreaded();
+		static const uint8_t* handlerIndices();
+		void callNativeRoutine();
+		void verifyNativeRoutine(NativeRoutine& routine);
+		void runUntilReturn(uint32_t returnAddress, uint32_t returnStack);
 		//
 		// public methods
 		//
@@ -249,6 +277,14 @@ namespace mc68000
 		void registerTrapHandler(int trapNumber, TrapHandler* traphandler);
 		void setSupervisorMode(bool super);
         template <typename T> T getFromStack(bool isSuper, int16_t offset);
+		void setFastTraps(bool fast);
+		void setStatistics(Statistics* stats);
+		void setThreadedDispatch(bool threaded);
+		TrapArguments trapArguments() const;
+		uint32_t getPc() const;
+		void registerNativeRoutine(uint32_t address, NativeRoutine* routine);
+		void setNativeVerification(bool verify);
+		uint64_t getNativeMismatches() const;
 
 		//
 		// public fields
@@ -8,6 +8,7 @@
 
 #include "cpu.h"
 #include "disasm.h"
+#include "disasmcache.h"
 
 namespace mc68000
 {
@@ -76,24 +77,39 @@ namespace mc68000
 
         done = false;
         pc = startPc;
-        aRegisters[7] = startSP;
+        registers[8 + 7] = startSP;
         usp = startSP;
         ssp = startSSP;
 
-        uint16_t* memory = static_cast<uint16_t*>(localMemory.get<void*>(startPc));
+        // the disassembler indexes the memory from its base address
         auto memoryInfo = localMemory.getMemoryRange();
+        uint16_t* memory = static_cast<uint16_t*>(localMemory.get<void*>(memoryInfo.first));
+        if (memory == nullptr)
+        {
+            std::cerr << "debug: no memory to disassemble\n";
+            return;
+        }
         DisAsm disAsm(memory, memoryInfo.first);
         if (symbolsFile)
         {
             disAsm.loadSymbols(symbolsFile);
         }
+        // the loops are disassembled once, and again only when the guest rewrites them
+        DisAsmCache cache(localMemory, disAsm);
 
+        uint16_t opcode = 0;
         while (!done)
         {
             uint16_t x = localMemory.getWord(pc);
-            auto s = disAsm.disassembleInstruction(pc);
+            if (localMemory.hasFault())
+            {
+                handleFault(opcode);
+                continue;
+            }
+            opcode = x;
+            const std::string& s = cache.disassemble(pc);
 #ifdef _WIN32
-            std::string address = disAsm.findSymbol(pc);
+            std::string address = disAsm.findLocation(pc);
             if (!address.empty())
             {
                 fprintf(pipeStream, "%8s - %04x - %s\n", address.c_str(), x, s.c_str());
@@ -104,10 +120,16 @@ namespace mc68000
             }
             fflush(pipeStream);
 #else
-            std::cout << std::hex << pc << " - " << std::hex << x << " - " << s << std::endl;
+            std::cout << std::hex << pc << " - " << x << std::dec << " - " << s << std::endl;
 #endif
+            uint32_t instructionPc = pc;
             pc += 2;
-            (this->*handlers[x])(x);
+            uint16_t id = (this->*handlers[x])(x);
+            if (statistics != nullptr)
+            {
+                statistics->instruction(x, id);
+                recordBranch(x, id, instructionPc);
+            }
         }
     }
 }
@@ -0,0 +1,112 @@
+#include <memory>
+#include "cpu.h"
+
+// every instruction handler of the Cpu, setup<Cpu>() only uses these
+#define CPU_HANDLERS(X) \
+	X(unknown) X(abcd) X(sbcd) X(add) X(adda) X(cmp) X(cmpa) X(sub) X(suba) X(and_) X(or_) X(eor) \
+	X(addi) X(andi) X(cmpi) X(eori) X(ori) X(subi) X(addq) X(subq) X(addx) X(subx) \
+	X(andi2ccr) X(andi2sr) X(asl_register) X(asl_memory) X(asr_register) X(asr_memory) \
+	X(bra) X(bhi) X(bls) X(bcc) X(bcs) X(bne) X(beq) X(bvc) X(bvs) X(bpl) X(bmi) X(bge) X(blt) X(bgt) X(ble) X(bsr) \
+	X(bchg_r) X(bset_r) X(bclr_r) X(bchg_i) X(bset_i) X(bclr_i) X(btst_r) X(btst_i) \
+	X(chk) X(clr) X(cmpm) X(dbcc) X(divs) X(divu) X(muls) X(mulu) X(eori2ccr) X(eori2sr) X(exg) X(ext) \
+	X(illegal) X(jmp) X(jsr) X(lea) X(link) X(lsl_register) X(lsl_memory) X(lsr_register) X(lsr_memory) \
+	X(move) X(movea) X(move2ccr) X(movesr) X(move2sr) X(movem) X(movep) X(moveq) X(nbcd) X(neg) X(negx) \
+	X(nop) X(not_) X(ori2ccr) X(ori2sr) X(pea) X(rol_register) X(ror_register) X(roxl_register) X(roxr_register) \
+	X(rol_memory) X(ror_memory) X(roxl_memory) X(roxr_memory) X(rte) X(rtr) X(rts) X(scc) X(stop) X(swap) \
+	X(tas) X(trap) X(trapv) X(tst) X(unlk)
+
+namespace mc68000
+{
+	/// <summary>
+	/// Chooses between the threaded dispatch of runThreaded, the default where the compiler supports it,
+	/// and the call through the handler table.
+	/// </summary>
+	void Cpu::setThreadedDispatch(bool threaded)
+	{
+		threadedDispatch = threaded;
+	}
+
+	/// <summary>
+	/// Position in CPU_HANDLERS of the handler of each opcode.
+	/// </summary>
+	const uint8_t* Cpu::handlerIndices()
+	{
+		static const std::unique_ptr<uint8_t[]> indices = []
+		{
+			const t_handler list[] = {
+#define CPU_HANDLER_POINTER(name) &Cpu::name,
+				CPU_HANDLERS(CPU_HANDLER_POINTER)
+#undef CPU_HANDLER_POINTER
+			};
+			const size_t count = sizeof(list) / sizeof(list[0]);
+			static_assert(count <= 256, "the handler indices are bytes");
+
+			std::unique_ptr<t_handler[]> table(setup<Cpu>());
+			auto result = std::make_unique<uint8_t[]>(0x10000);
+			size_t index = 0;
+			for (uint32_t opcode = 0; opcode < 0x10000; opcode++)
+			{
+				// consecutive opcodes mostly share their handler
+				if (table[opcode] != list[index])
+				{
+					for (index = 0; index < count && table[opcode] != list[index]; index++);
+					if (index == count)
+					{
+						throw "handlerIndices: a handler is missing from CPU_HANDLERS";
+					}
+				}
+				result[opcode] = static_cast<uint8_t>(index);
+			}
+			return result;
+		}();
+		return indices.get();
+	}
+
+#if defined(__GNUC__)
+	/// <summary>
+	/// Same loop as start with one label per handler: the handler is called directly and the next opcode is
+	/// fetched and dispatched at the end of each label (computed goto, a GCC and Clang extension), so each
+	/// handler has its own indirect branch, predicted from the instruction before it.
+	/// </summary>
+	void Cpu::runThreaded()
+	{
+		static const uint8_t* const indices = handlerIndices();
+		static void* const labels[] = {
+#define CPU_HANDLER_LABEL(name) &&threaded_##name,
+			CPU_HANDLERS(CPU_HANDLER_LABEL)
+#undef CPU_HANDLER_LABEL
+		};
+		uint16_t opcode = 0;
+		uint16_t x;
+
+#define CPU_DISPATCH() \
+		if (done) \
+		{ \
+			return; \
+		} \
+		x = localMemory.getWord(pc); \
+		if (localMemory.hasFault()) \
+		{ \
+			goto fault; \
+		} \
+		opcode = x; \
+		pc += 2; \
+		goto *labels[indices[x]];
+
+		CPU_DISPATCH();
+	fault:
+		// the previous instruction or this fetch faulted
+		handleFault(opcode);
+		CPU_DISPATCH();
+
+#define CPU_HANDLER_CASE(name) \
+	threaded_##name: \
+		name(x); \
+		CPU_DISPATCH();
+
+		CPU_HANDLERS(CPU_HANDLER_CASE)
+#undef CPU_HANDLER_CASE
+#undef CPU_DISPATCH
+	}
+#endif
+}
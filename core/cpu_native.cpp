@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "cpu.h"
+
+namespace mc68000
+{
+	/// <summary>
+	/// Runs routine instead of the guest code starting at address when a JSR or BSR calls it; nullptr removes it.
+	/// </summary>
+	void Cpu::registerNativeRoutine(uint32_t address, NativeRoutine* routine)
+	{
+		if (routine == nullptr)
+		{
+			nativeRoutines.erase(address);
+		}
+		else
+		{
+			nativeRoutines[address] = routine;
+		}
+	}
+
+	/// <summary>
+	/// In verification mode each call runs the native routine, then the guest code from the same state, and
+	/// reports to std::cerr the registers and memory where they differ. The guest results are kept.
+	/// </summary>
+	void Cpu::setNativeVerification(bool verify)
+	{
+		verifyNativeRoutines = verify;
+	}
+
+	/// <summary>
+	/// Number of verified calls whose native results differed from the guest code.
+	/// </summary>
+	uint64_t Cpu::getNativeMismatches() const
+	{
+		return nativeMismatches;
+	}
+
+	/// <summary>
+	/// Called by JSR and BSR once the return address is pushed and the pc is on the subroutine.
+	/// </summary>
+	void Cpu::callNativeRoutine()
+	{
+		auto it = nativeRoutines.find(pc);
+		if (it == nativeRoutines.end() || localMemory.hasFault())
+		{
+			return;
+		}
+		if (verifyNativeRoutines)
+		{
+			verifyNativeRoutine(*it->second);
+		}
+		else if (it->second->execute(*this, localMemory))
+		{
+			// rts
+			pc = readAt<uint32_t>(0b011'111, false);
+		}
+	}
+
+	void Cpu::verifyNativeRoutine(NativeRoutine& routine)
+	{
+		uint32_t entryPc = pc;
+		uint32_t entryRegisters[16];
+		std::copy(registers, registers + 16, entryRegisters);
+		uint16_t entrySr = statusRegister;
+		auto [base, size] = localMemory.getMemoryRange();
+		auto bytes = static_cast<uint8_t*>(localMemory.get<void*>(base));
+		verifyEntryBytes.assign(bytes, bytes + size);
+		uint32_t returnAddress = localMemory.get<uint32_t>(registers[15]);
+		uint32_t returnStack = registers[15] + 4;
+
+		if (!routine.execute(*this, localMemory))
+		{
+			return;
+		}
+		uint32_t nativeRegisters[16];
+		std::copy(registers, registers + 16, nativeRegisters);
+		nativeRegisters[15] = returnStack;
+		uint16_t nativeSr = statusRegister;
+
+		// only the bytes the native routine changed are kept, and restored in place: the memory buffer must stay
+		// where it is for the debugger, and the code pages the routine invalidated stay invalidated
+		std::vector<std::pair<uint32_t, uint8_t>> nativeChanges;
+		for (uint32_t i = 0; i < size; i++)
+		{
+			if (bytes[i] != verifyEntryBytes[i])
+			{
+				nativeChanges.emplace_back(i, bytes[i]);
+				bytes[i] = verifyEntryBytes[i];
+				localMemory.noteWrite(base + i, 1);
+			}
+		}
+
+		std::copy(entryRegisters, entryRegisters + 16, registers);
+		statusRegister = entrySr;
+		runUntilReturn(returnAddress, returnStack);
+		if (done)
+		{
+			return;
+		}
+
+		std::ostringstream differences;
+		differences << std::hex;
+		for (int i = 0; i < 16; i++)
+		{
+			if (registers[i] != nativeRegisters[i])
+			{
+				differences << (i < 8 ? " d" : " a") << (i & 7) << " $" << registers[i] << "/$" << nativeRegisters[i];
+			}
+		}
+		uint16_t guestSr = statusRegister;
+		if (guestSr != nativeSr)
+		{
+			differences << " sr $" << guestSr << "/$" << nativeSr;
+		}
+		// the native memory is the entry memory with the native changes
+		uint32_t from = 0;
+		uint32_t mismatch = size;
+		for (auto [offset, value] : nativeChanges)
+		{
+			mismatch = static_cast<uint32_t>(std::mismatch(bytes + from, bytes + offset, verifyEntryBytes.data() + from).first - bytes);
+			if (mismatch != offset || bytes[offset] != value)
+			{
+				break;
+			}
+			from = offset + 1;
+			mismatch = size;
+		}
+		if (mismatch == size)
+		{
+			mismatch = static_cast<uint32_t>(std::mismatch(bytes + from, bytes + size, verifyEntryBytes.data() + from).first - bytes);
+		}
+		if (mismatch != size)
+		{
+			differences << " memory at $" << base + mismatch;
+		}
+
+		if (!differences.str().empty())
+		{
+			nativeMismatches++;
+			std::cerr << "native routine " << routine.name() << " at $" << std::hex << entryPc << std::dec
+				<< " differs from the guest code (guest/native):" << differences.str() << std::endl;
+		}
+	}
+
+	/// <summary>
+	/// Executes guest instructions until the pc is returnAddress with the stack pointer at returnStack.
+	/// </summary>
+	void Cpu::runUntilReturn(uint32_t returnAddress, uint32_t returnStack)
+	{
+		uint16_t opcode = 0;
+		while (!done && (pc != returnAddress || registers[15] != returnStack))
+		{
+			uint16_t x = localMemory.getWord(pc);
+			if (localMemory.hasFault())
+			{
+				handleFault(opcode);
+				continue;
+			}
+			opcode = x;
+			pc += 2;
+			(this->*handlers[x])(x);
+		}
+	}
+}
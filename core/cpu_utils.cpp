@@ -1,4 +1,5 @@
 #include <cassert>
+#include <iostream>
 
 #include "core.h"
 #include "instructions.h"
@@ -99,10 +100,10 @@ namespace mc68000
 		}
 		else
 		{
-			opSource = subPart<T>(dRegisters[source]);
-			opDestination = subPart<T>(dRegisters[destination]);
+			opSource = subPart<T>(registers[source]);
+			opDestination = subPart<T>(registers[destination]);
 			result = (uint64_t)opDestination + (uint64_t)opSource + statusRegister.x;
-			dRegisters[destination] = setSubPart<T>(dRegisters[destination], static_cast<T>(result));
+			registers[destination] = setSubPart<T>(registers[destination], static_cast<T>(result));
 		}
 		statusRegister.n = signed_cast<T>(result) < 0;
 		if (static_cast<T>(result) != 0) statusRegister.z = 0;
@@ -117,9 +118,9 @@ namespace mc68000
 	// ==========
 	// shiftLeft ASL LSL
 	// ==========
-	template <typename T> void Cpu::shiftLeft(uint16_t destinationRegister, uint32_t shift)
+	template <typename T> void Cpu::shiftLeft(uint16_t destinationRegister, uint32_t shift, bool arithmetic)
 	{
-		T data = subPart<T>(dRegisters[destinationRegister]);
+		T data = subPart<T>(registers[destinationRegister]);
 		bool c = false;
 		bool v = false;
 		for (uint32_t i = 0; i < shift; i++)
@@ -132,19 +133,19 @@ namespace mc68000
 		statusRegister.z = data == 0;
 		statusRegister.c = c ? 1 : 0;
 		if (shift) statusRegister.x = statusRegister.c;
-		statusRegister.v = v ? 1 : 0;
-		dRegisters[destinationRegister] = setSubPart<T>(dRegisters[destinationRegister], data);
+		statusRegister.v = (arithmetic && v) ? 1 : 0;	// LSL always clears V
+		registers[destinationRegister] = setSubPart<T>(registers[destinationRegister], data);
 	}
-	template void Cpu::shiftLeft<uint8_t>(uint16_t destinationRegister, uint32_t shift);
-	template void Cpu::shiftLeft<uint16_t>(uint16_t destinationRegister, uint32_t shift);
-	template void Cpu::shiftLeft<uint32_t>(uint16_t destinationRegister, uint32_t shift);
+	template void Cpu::shiftLeft<uint8_t>(uint16_t destinationRegister, uint32_t shift, bool arithmetic);
+	template void Cpu::shiftLeft<uint16_t>(uint16_t destinationRegister, uint32_t shift, bool arithmetic);
+	template void Cpu::shiftLeft<uint32_t>(uint16_t destinationRegister, uint32_t shift, bool arithmetic);
 
 	// ==========
 	// shiftRight ASR LSR
 	// ==========
 	template <typename T> void Cpu::shiftRight(uint16_t destinationRegister, uint32_t shift, bool logical)
 	{
-		T data = subPart<T>(dRegisters[destinationRegister]);
+		T data = subPart<T>(registers[destinationRegister]);
 		T c = 0;
 		T msb = logical ? 0 : mostSignificantBit(data); // LSR push 0 while ASR keep the msb
 		for (uint32_t i = 0; i < shift; i++)
@@ -158,7 +159,7 @@ namespace mc68000
 		statusRegister.c = c ? 1 : 0;
 		if (shift) statusRegister.x = statusRegister.c;
 		statusRegister.v = 0;
-		dRegisters[destinationRegister] = setSubPart<T>(dRegisters[destinationRegister], data);
+		registers[destinationRegister] = setSubPart<T>(registers[destinationRegister], data);
 	}
 	template void Cpu::shiftRight<uint8_t>(uint16_t destinationRegister, uint32_t shift, bool logical);
 	template void Cpu::shiftRight<uint16_t>(uint16_t destinationRegister, uint32_t shift, bool logical);
@@ -175,6 +176,10 @@ namespace mc68000
 		memory <<= 1;
 		writeAt<uint16_t>(effectiveAddress, memory, true);
 		statusRegister.c = statusRegister.x = bit15 ? 1 : 0;
+		statusRegister.n = (memory & 0x8000) ? 1 : 0;
+		statusRegister.z = memory == 0;
+		// ASL sets V when the most significant bit changes, LSL clears it
+		statusRegister.v = (instruction == instructions::ASL && bit15 != (memory & 0x8000)) ? 1 : 0;
 
 		return instruction;
 	}
@@ -188,23 +193,28 @@ namespace mc68000
 		uint16_t shift = numberOrRegister;
 		if (isFromRegister)
 		{
-			shift = dRegisters[numberOrRegister] % 64;
+			shift = registers[numberOrRegister] % 64;
+		}
+		else if (shift == 0)
+		{
+			// an immediate count of 0 stands for 8
+			shift = 8;
 		}
 		switch (size)
 		{
 			case 0:
 			{
-				shiftLeft<uint8_t>(destinationRegister, shift);
+				shiftLeft<uint8_t>(destinationRegister, shift, instruction == instructions::ASL);
 				break;
 			}
 			case 1:
 			{
-				shiftLeft<uint16_t>(destinationRegister, shift);
+				shiftLeft<uint16_t>(destinationRegister, shift, instruction == instructions::ASL);
 				break;
 			}
 			case 2:
 			{
-				shiftLeft<uint32_t>(destinationRegister, shift);
+				shiftLeft<uint32_t>(destinationRegister, shift, instruction == instructions::ASL);
 				break;
 			}
 			default:
@@ -225,7 +235,12 @@ namespace mc68000
 		uint16_t shift = numberOrRegister;
 		if (isFromRegister)
 		{
-			shift = dRegisters[numberOrRegister] % 64;
+			shift = registers[numberOrRegister] % 64;
+		}
+		else if (shift == 0)
+		{
+			// an immediate count of 0 stands for 8
+			shift = 8;
 		}
 		switch (size)
 		{
@@ -413,7 +428,7 @@ namespace mc68000
 		writeAt<T>(effectiveAdress, static_cast<T>(result), true);
 
 		statusRegister.n = signed_cast<T>(result) < 0;
-		if (result != 0) statusRegister.z = 0;
+		if (static_cast<T>(result) != 0) statusRegister.z = 0;
 		statusRegister.c = signed_cast<T>(result >> 1) < 0;
 		statusRegister.x = statusRegister.c;
 		statusRegister.v = signed_cast<T>((destination ^ 0) & (0 ^ result)) < 0;
@@ -432,7 +447,7 @@ namespace mc68000
 		writeAt<T>(effectiveAdress, result, true);
 
 		statusRegister.n = signed_cast<T>(result) < 0;
-		statusRegister.z = result == 0;
+		statusRegister.z = static_cast<T>(result) == 0;
 		statusRegister.c = 0;
 		statusRegister.v = 0;
 	}
@@ -445,19 +460,18 @@ namespace mc68000
 	// ==========
 	template <typename T> void Cpu::rotateLeft(uint16_t destinationRegister, uint32_t shift)
 	{
-		T data = subPart<T>(dRegisters[destinationRegister]);
+		T data = subPart<T>(registers[destinationRegister]);
 		uint16_t count = shift % (sizeof(T) * 8);
 		uint16_t lastBitOut = (sizeof(T) * 8) - count;
-		T lastBit = (data >> lastBitOut) & 1;
 
-		T result = (data << count) | (data >> lastBitOut);
+		T result = count ? static_cast<T>((data << count) | (data >> lastBitOut)) : data;
 
 		statusRegister.n = signed_cast<T>(result) < 0;
 		statusRegister.z = result == 0;
-		statusRegister.c = lastBit;
+		statusRegister.c = shift ? (result & 1) : 0;	// the last bit rotated out is the new bit 0
 		statusRegister.v = 0;
 
-		dRegisters[destinationRegister] = setSubPart<T>(dRegisters[destinationRegister], result);
+		registers[destinationRegister] = setSubPart<T>(registers[destinationRegister], result);
 	}
 	template void Cpu::rotateLeft<uint8_t>(uint16_t destinationRegister, uint32_t shift);
 	template void Cpu::rotateLeft<uint16_t>(uint16_t destinationRegister, uint32_t shift);
@@ -468,19 +482,18 @@ namespace mc68000
 	// ==========
 	template <typename T> void Cpu::rotateRight(uint16_t destinationRegister, uint32_t shift)
 	{
-		T data = subPart<T>(dRegisters[destinationRegister]);
+		T data = subPart<T>(registers[destinationRegister]);
 		uint16_t count = shift % (sizeof(T) * 8);
 		uint16_t lastBitOut = (sizeof(T) * 8) - count;
-		T lastBit = (data >> (count - 1)) & 1;
 
-		T result = (data >> count) | (data << lastBitOut);
+		T result = count ? static_cast<T>((data >> count) | (data << lastBitOut)) : data;
 
 		statusRegister.n = signed_cast<T>(result) < 0;
 		statusRegister.z = result == 0;
-		statusRegister.c = lastBit;
+		statusRegister.c = shift ? isMostSignificantBitSet(result) : 0;	// the last bit rotated out is the new most significant bit
 		statusRegister.v = 0;
 
-		dRegisters[destinationRegister] = setSubPart<T>(dRegisters[destinationRegister], result);
+		registers[destinationRegister] = setSubPart<T>(registers[destinationRegister], result);
 	}
 	template void Cpu::rotateRight<uint8_t>(uint16_t destinationRegister, uint32_t shift);
 	template void Cpu::rotateRight<uint16_t>(uint16_t destinationRegister, uint32_t shift);
@@ -491,7 +504,8 @@ namespace mc68000
 	// ==========
 	template <typename T> void Cpu::rotateLeftWithExtend(uint16_t destinationRegister, uint32_t shift)
 	{
-		T data = subPart<T>(dRegisters[destinationRegister]);
+		// on 64 bits: the rotation through X is one bit wider than the operand
+		uint64_t data = subPart<T>(registers[destinationRegister]);
 		uint16_t count = shift % (sizeof(T) * 8 + 1);
 		if (count != 0)
 		{
@@ -499,7 +513,7 @@ namespace mc68000
 			uint16_t middle = left - 1;
 			uint16_t right = sizeof(T) * 8 + 1 - count;
 
-			T result = (data << left) | (sr.x << middle) | (data >> right);
+			T result = static_cast<T>((data << left) | (static_cast<uint64_t>(sr.x) << middle) | (data >> right));
 			T lastBit = (data >> (sizeof(T) * 8 - count)) & 1;
 
 			statusRegister.n = signed_cast<T>(result) < 0;
@@ -508,7 +522,7 @@ namespace mc68000
 			statusRegister.v = 0;
 			statusRegister.x = lastBit;
 
-			dRegisters[destinationRegister] = setSubPart<T>(dRegisters[destinationRegister], result);
+			registers[destinationRegister] = setSubPart<T>(registers[destinationRegister], result);
 		}
 		else
 		{
@@ -527,7 +541,7 @@ namespace mc68000
 	// ==========
 	template <typename T> void Cpu::rotateRightWithExtend(uint16_t destinationRegister, uint32_t shift)
 	{
-		T data = subPart<T>(dRegisters[destinationRegister]);
+		uint64_t data = subPart<T>(registers[destinationRegister]);
 		uint16_t count = shift % (sizeof(T) * 8 + 1);
 		if (count != 0)
 		{
@@ -535,7 +549,7 @@ namespace mc68000
 			uint16_t middle = left - 1;
 			uint16_t right = count;
 
-			T result = (data << left) | (sr.x << middle) | (data >> right);
+			T result = static_cast<T>((data << left) | (static_cast<uint64_t>(sr.x) << middle) | (data >> right));
 			T lastBit = (data >> (count - 1)) & 1;
 
 			statusRegister.n = signed_cast<T>(result) < 0;
@@ -544,7 +558,7 @@ namespace mc68000
 			statusRegister.v = 0;
 			statusRegister.x = lastBit;
 
-			dRegisters[destinationRegister] = setSubPart<T>(dRegisters[destinationRegister], result);
+			registers[destinationRegister] = setSubPart<T>(registers[destinationRegister], result);
 		}
 		else
 		{
@@ -595,7 +609,7 @@ namespace mc68000
 			statusRegister.z = static_cast<T>(result) == 0;
 			statusRegister.c = signed_cast<T>(result >> 1) < 0;
 			statusRegister.x = statusRegister.c;
-			statusRegister.v = signed_cast<T>((data ^ result) & (destination ^ result)) < 0;
+			statusRegister.v = signed_cast<T>((destination ^ data) & (destination ^ result)) < 0;
 		}
 	}
 	template void Cpu::subq<uint8_t>(uint32_t data, uint16_t destinationEffectiveAdress);
@@ -622,10 +636,10 @@ namespace mc68000
 		}
 		else
 		{
-			opSource = subPart<T>(dRegisters[source]);
-			opDestination = subPart<T>(dRegisters[destination]);
+			opSource = subPart<T>(registers[source]);
+			opDestination = subPart<T>(registers[destination]);
 			result = (uint64_t)opDestination - (uint64_t)opSource - (uint64_t)statusRegister.x;
-			dRegisters[destination] = setSubPart<T>(dRegisters[destination], static_cast<T>(result));
+			registers[destination] = setSubPart<T>(registers[destination], static_cast<T>(result));
 		}
 		statusRegister.n = signed_cast<T>(result) < 0;
 		if (static_cast<T>(result) != 0) statusRegister.z = 0;
@@ -659,29 +673,29 @@ namespace mc68000
 		switch (eam)
 		{
 		case 0b000:
-			return static_cast<T>(dRegisters[reg]);
 		case 0b001:
-			return static_cast<T>(aRegisters[reg]);
+			// Dn or An: the low bit of the mode selects the address registers
+			return static_cast<T>(registers[ea & 0b1111]);
 		case 0b010:
 		{
-			uint32_t address = aRegisters[reg];
+			uint32_t address = registers[8 + reg];
 			T x = localMemory.get<T>(address);
 			return x;
 		}
 		case 0b011:
 		{
-			uint32_t address = aRegisters[reg];
+			uint32_t address = registers[8 + reg];
 			T x = localMemory.get<T>(address);
 			if (!readModifyWrite)
 			{
 				if (reg != 7)
 				{
-					aRegisters[reg] += sizeof(T);
+					registers[8 + reg] += sizeof(T);
 				}
 				else
 				{
 					// If the address register is the stack pointer and the operand size is byte, the address is incremented by two to keep the stack pointer aligned to a word boundary
-					aRegisters[reg] += sizeof(T) == 1 ? 2 : sizeof(T);
+					registers[8 + reg] += sizeof(T) == 1 ? 2 : sizeof(T);
 				}
 			}
 			return x;
@@ -690,112 +704,43 @@ namespace mc68000
 		{
 			if (reg != 7)
 			{
-				aRegisters[reg] -= sizeof(T);
+				registers[8 + reg] -= sizeof(T);
 			}
 			else
 			{
 				// If the address register is the stack pointer and the operand size is byte, the address is decremented by two to keep the stack pointer aligned to a word boundary
-				aRegisters[reg] -= sizeof(T) == 1 ? 2 : sizeof(T);
+				registers[8 + reg] -= sizeof(T) == 1 ? 2 : sizeof(T);
 			}
-			uint32_t address = aRegisters[reg];
+			uint32_t address = registers[8 + reg];
 			T x = localMemory.get<T>(address);
 			return x;
 		}
 		case 5:
-		{
-			uint32_t address = aRegisters[reg];
-
-			uint16_t extension = localMemory.get<uint16_t>(pc);
-			pc += 2;
-			int32_t offset = (int16_t)extension; // Displacements are always sign-extended to 32 bits prior to being used
-
-			T x = localMemory.get<T>(address + offset);
-			return x;
-		}
 		case 6:
 		{
-			uint32_t address = aRegisters[reg];
-
-			uint16_t extension = localMemory.get<uint16_t>(pc);
-			pc += 2;
-
-			// calculate the index
-			bool isAddressRegister = extension & 0x8000;
-			unsigned short extensionReg = (extension >> 12) & 7;
-			bool isLongIndexSize = (extension & 0x0800);
-			int32_t index;
-			if (isLongIndexSize)
+			uint32_t address = getEffectiveAddress(ea);
+			if (readModifyWrite)
 			{
-				index = (isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]);
+				// the write back uses this address instead of fetching the extension words again
+				readModifyWriteAddress = address;
 			}
-			else
-			{
-				index = (int16_t)((isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]) & 0xffff);
-			}
-
-			// Calculate the displacement
-			int32_t displacement = (int16_t)(extension & 0xff);
-
-			T x = localMemory.get<T>(address + displacement + index);
-			return x;
+			return localMemory.get<T>(address);
 		}
 		case 7:
 		{
 			switch (reg)
 			{
 			case 0:
-			{
-				uint16_t extension = localMemory.get<uint16_t>(pc);
-				pc += 2;
-				int32_t address = (int16_t)extension;
-
-				T x = localMemory.get<T>(address);
-				return x;
-			}
 			case 1:
-			{
-				uint32_t address = localMemory.get<uint32_t>(pc);
-				pc += 4;
-				T x = localMemory.get<T>(address);
-				return x;
-			}
 			case 2:
-			{
-				uint32_t address = pc;
-				uint16_t extension = localMemory.get<uint16_t>(pc);
-				pc += 2;
-				int32_t offset = (int16_t)extension;
-				address += offset;
-
-				T x = localMemory.get<T>(address);
-				return x;
-			}
 			case 3:
 			{
-				uint32_t address = pc;
-
-				uint16_t extension = localMemory.get<uint16_t>(pc);
-				pc += 2;
-
-				// calculate the index
-				bool isAddressRegister = extension & 0x8000;
-				unsigned short extensionReg = (extension >> 12) & 7;
-				bool isLongIndexSize = (extension & 0x0800);
-				int32_t index;
-				if (isLongIndexSize)
+				uint32_t address = getEffectiveAddress(ea);
+				if (readModifyWrite)
 				{
-					index = (isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]);
+					readModifyWriteAddress = address;
 				}
-				else
-				{
-					index = (int16_t)((isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]) & 0xffff);
-				}
-
-				// Calculate the displacement
-				int32_t displacement = (int16_t)(extension & 0xff);
-
-				T x = localMemory.get<T>(address + displacement + index);
-				return x;
+				return localMemory.get<T>(address);
 			}
 			case 4:
 			{
@@ -841,24 +786,24 @@ namespace mc68000
 		{
 			case 0b010:
 			{
-				address = aRegisters[reg];
+				address = registers[8 + reg];
 				break;
 			}
 			case 0b011:
 			{
 				// Post increment : the address is incremented after the operation
-				address = aRegisters[reg];
+				address = registers[8 + reg];
 				break;
 			}
 			case 0b100:
 			{
 				// Pre decrement : return the current address. Don't decrement the address since the size is unknown
-				address = aRegisters[reg];
+				address = registers[8 + reg];
 				break;
 			}
 			case 0b101:
 			{
-				uint32_t baseAddress = aRegisters[reg];
+				uint32_t baseAddress = registers[8 + reg];
 
 				uint16_t extension = localMemory.get<uint16_t>(pc);
 				pc += 2;
@@ -869,27 +814,26 @@ namespace mc68000
 			}
 			case 0b110:
 			{
-				uint32_t baseAddress = aRegisters[reg];
+				uint32_t baseAddress = registers[8 + reg];
 
 				uint16_t extension = localMemory.get<uint16_t>(pc);
 				pc += 2;
 
-				// calculate the index
-				bool isAddressRegister = extension & 0x8000;
-				unsigned short extensionReg = (extension >> 12) & 7;
+				// calculate the index, the D/A bit and the register number select the register
+				uint32_t indexRegister = registers[extension >> 12];
 				bool isLongIndexSize = (extension & 0x0800);
 				int32_t index;
 				if (isLongIndexSize)
 				{
-					index = (isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]);
+					index = indexRegister;
 				}
 				else
 				{
-					index = (int16_t)((isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]) & 0xffff);
+					index = (int16_t)(indexRegister & 0xffff);
 				}
 
 				// Calculate the displacement
-				int32_t displacement = (int16_t)(extension & 0xff);
+				int32_t displacement = (int8_t)(extension & 0xff);
 
 				address = baseAddress + displacement + index;
 				break;
@@ -927,22 +871,21 @@ namespace mc68000
 						uint16_t extension = localMemory.get<uint16_t>(pc);
 						pc += 2;
 
-						// calculate the index
-						bool isAddressRegister = extension & 0x8000;
-						unsigned short extensionReg = (extension >> 12) & 7;
+						// calculate the index, the D/A bit and the register number select the register
+						uint32_t indexRegister = registers[extension >> 12];
 						bool isLongIndexSize = (extension & 0x0800);
 						int32_t index;
 						if (isLongIndexSize)
 						{
-							index = (isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]);
+							index = indexRegister;
 						}
 						else
 						{
-							index = (int16_t)((isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]) & 0xffff);
+							index = (int16_t)(indexRegister & 0xffff);
 						}
 
 						// Calculate the displacement
-						int32_t displacement = (int16_t)(extension & 0xff);
+						int32_t displacement = (int8_t)(extension & 0xff);
 
 						address = baseAddress + displacement + index;
 						break;
@@ -994,29 +937,29 @@ namespace mc68000
 		switch (eam)
 		{
 		case 0b000:
-			dRegisters[reg] = maskDRegister(dRegisters[reg], sizeof(T)) | data;
+			registers[reg] = maskDRegister(registers[reg], sizeof(T)) | data;
 			break;
 		case 0b001:
-			aRegisters[reg] = data;
+			registers[8 + reg] = data;
 			break;
 		case 0b010:
 		{
-			uint32_t address = aRegisters[reg];
+			uint32_t address = registers[8 + reg];
 			localMemory.set<T>(address, data);
 			break;
 		}
 		case 0b011:
 		{
-			uint32_t address = aRegisters[reg];
+			uint32_t address = registers[8 + reg];
 			localMemory.set<T>(address, data);
 			if (reg != 7)
 			{
-				aRegisters[reg] += sizeof(T);
+				registers[8 + reg] += sizeof(T);
 			}
 			else
 			{
 				// If the address register is the stack pointer and the operand size is byte, the address is incremented by two to keep the stack pointer aligned to a word boundary
-				aRegisters[reg] += sizeof(T) == 1 ? 2 : sizeof(T);
+				registers[8 + reg] += sizeof(T) == 1 ? 2 : sizeof(T);
 			}
 			break;
 		}
@@ -1026,54 +969,23 @@ namespace mc68000
 			{
 				if (reg != 7)
 				{
-					aRegisters[reg] -= sizeof(T);
+					registers[8 + reg] -= sizeof(T);
 				}
 				else
 				{
 					// If the address register is the stack pointer and the operand size is byte, the address is decremented by two to keep the stack pointer aligned to a word boundary
-					aRegisters[reg] -= sizeof(T) == 1 ? 2 : sizeof(T);
+					registers[8 + reg] -= sizeof(T) == 1 ? 2 : sizeof(T);
 				}
 			}
-			uint32_t address = aRegisters[reg];
+			uint32_t address = registers[8 + reg];
 			localMemory.set<T>(address, data);
 			break;
 		}
 		case 0b101:
-		{
-			uint32_t address = aRegisters[reg];
-
-			uint16_t extension = localMemory.get<T>(pc);
-			pc += sizeof(T) == 1 ? 2 : sizeof(T); // pc must be aligned on a word boundary
-			int32_t offset = (int16_t)extension;
-
-			localMemory.set<T>(address + offset, data);
-			break;
-		}
 		case 0b110:
 		{
-			uint32_t address = aRegisters[reg];
-
-			uint16_t extension = localMemory.get<uint16_t>(pc);
-			pc += 2;
-
-			// calculate the index
-			bool isAddressRegister = extension & 0x8000;
-			unsigned short extensionReg = (extension >> 12) & 7;
-			bool isLongIndexSize = (extension & 0x0800);
-			int32_t index;
-			if (isLongIndexSize)
-			{
-				index = (isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]);
-			}
-			else
-			{
-				index = (int16_t)((isAddressRegister ? aRegisters[extensionReg] : dRegisters[extensionReg]) & 0xffff);
-			}
-
-			// Calculate the displacement
-			int32_t displacement = (int16_t)(extension & 0xff);
-
-			localMemory.set<T>(address + displacement + index, data);
+			uint32_t address = readModifyWrite ? readModifyWriteAddress : getEffectiveAddress(ea);
+			localMemory.set<T>(address, data);
 			break;
 		}
 		case 0b111:
@@ -1081,18 +993,9 @@ namespace mc68000
 			switch (reg)
 			{
 			case 0:
-			{
-				uint16_t extension = localMemory.get<uint16_t>(pc);
-				pc += 2;
-				int32_t address = (int16_t)extension;
-
-				localMemory.set<T>(address, data);
-				break;
-			}
 			case 1:
 			{
-				uint32_t address = localMemory.get<uint32_t>(pc);
-				pc += 4;
+				uint32_t address = readModifyWrite ? readModifyWriteAddress : getEffectiveAddress(ea);
 				localMemory.set<T>(address, data);
 				break;
 			}
@@ -1129,49 +1032,144 @@ namespace mc68000
 	// ==========
 	void Cpu::handleException(uint16_t vector)
 	{
-		try
+		if (localMemory.hasFault())
 		{
-            ssp -= 2;
-            localMemory.set<uint16_t>(ssp, sr);
-            ssp -= 4;
-            localMemory.set<uint32_t>(ssp, pc);
-			statusRegister.t = 0;
-			statusRegister.s = 1;
-			usp = aRegisters[7];
-			aRegisters[7] = ssp;
-
-            if (vector == Exceptions::RESET)
+			// the instruction already faulted: the bus error is raised at the next instruction boundary
+			return;
+		}
+		if (statistics != nullptr)
+		{
+			statistics->exception(vector);
+		}
+
+        // the caller pushed the arguments of a TRAP on its active stack
+        trapCallerIsSupervisor = statusRegister.s;
+        trapArgumentsAddress = registers[8 + 7];
+        if (fastTraps && vector >= Exceptions::TRAP && vector <= Exceptions::TRAP + 15 && trapHandlers[vector - Exceptions::TRAP] != nullptr)
+        {
+            // host handler: no exception frame, the handler returns to the instruction after the TRAP
+            callTrapHandler(vector - Exceptions::TRAP);
+            return;
+        }
+        ssp -= 2;
+        localMemory.set<uint16_t>(ssp, sr);
+        ssp -= 4;
+        localMemory.set<uint32_t>(ssp, pc);
+		if (localMemory.hasFault())
+		{
+			// no room for the frame: the CPU stops
+			ssp += 6;
+			done = true;
+			return;
+		}
+		statusRegister.t = 0;
+		statusRegister.s = 1;
+		usp = registers[8 + 7];
+		registers[8 + 7] = ssp;
+
+        if (vector == Exceptions::RESET)
+        {
+            // Reset
+            done = true;
+            return;
+        }
+        else if (vector >= Exceptions::TRAP && vector <= Exceptions::TRAP + 15)
+        {
+            // externaly managed Trap
+            if (trapHandlers[vector - Exceptions::TRAP] != nullptr)
             {
-                // Reset
-                done = true;
+                // external handler exists so call it
+                callTrapHandler(vector - Exceptions::TRAP);
+                // then return to the instruction after the TRAP
+                pc = localMemory.get<uint32_t>(ssp);
+                ssp += 4;
+                statusRegister = localMemory.get<uint16_t>(ssp);
+                ssp += 2;
+                registers[8 + 7] = usp;
                 return;
             }
-            else if (vector >= Exceptions::TRAP && vector <= Exceptions::TRAP + 15)
-            {
-                // externaly managed Trap
-                if (trapHandlers[vector - Exceptions::TRAP] != nullptr)
-                {
-                    // external handler exists so call it
-                    trapHandlers[vector - Exceptions::TRAP]->handle(*this, vector - Exceptions::TRAP);
-                    // then return to the instruction after the TRAP
-                    pc = localMemory.get<uint32_t>(ssp);
-                    ssp += 4;
-                    statusRegister = localMemory.get<uint16_t>(ssp);
-                    ssp += 2;
-                    aRegisters[7] = usp;
-                    return;
-                }
-            }
-            // other exceptions and traps not handled externally
-            uint32_t handler = vector * 4;
-            uint32_t newPc = localMemory.get<uint32_t>(handler);
-			pc = newPc;
+        }
+        // other exceptions and traps not handled externally
+        uint32_t handler = vector * 4;
+        uint32_t newPc = localMemory.get<uint32_t>(handler);
+		if (localMemory.hasFault())
+		{
+			// no vector table: the CPU stops
+			done = true;
 			return;
 		}
-		catch (...)
+		pc = newPc;
+	}
+
+	void Cpu::callTrapHandler(int trapNumber)
+	{
+		// arguments outside the memory latch a fault: handleFault delivers it at the next instruction boundary
+		trapHandlers[trapNumber]->handle(*this, trapNumber);
+	}
+
+	/// <summary>
+	/// Delivers the pending memory fault to the guest as a bus or address error, with the group 0 exception frame of the 68000:
+	/// status word, access address, instruction register, SR and PC.
+	/// A fault while building the frame or reading the vector halts the CPU as a double bus fault does.
+	/// </summary>
+	/// <param name="opcode">Instruction that was executing when the fault occurred</param>
+	void Cpu::handleFault(uint16_t opcode)
+	{
+		MemoryFault fault = localMemory.clearFault();
+		uint16_t vector = fault.misaligned ? Exceptions::ADDRESS_ERROR : Exceptions::BUS_ERROR;
+		if (statistics != nullptr)
+		{
+			statistics->exception(vector);
+		}
+		bool fetch = !fault.write && fault.address == pc;
+
+		// R/W (1 = read), I/N (1 = not an instruction fetch) and the function code
+		uint16_t status = (fault.write ? 0x00 : 0x10) | (fetch ? 0x00 : 0x08) | (statusRegister.s ? 0x04 : 0x00) | (fetch ? 0x02 : 0x01);
+		uint16_t savedSR = sr;
+		uint32_t frame = (statusRegister.s ? registers[8 + 7] : ssp) - 14;
+		localMemory.set<uint16_t>(frame, status);
+		localMemory.set<uint32_t>(frame + 2, fault.address);
+		localMemory.set<uint16_t>(frame + 6, opcode);
+		localMemory.set<uint16_t>(frame + 8, savedSR);
+		localMemory.set<uint32_t>(frame + 10, pc);
+		if (!statusRegister.s)
+		{
+			usp = registers[8 + 7];
+		}
+		statusRegister.t = 0;
+		statusRegister.s = 1;
+		ssp = frame;
+		registers[8 + 7] = frame;
+
+		uint32_t newPc = localMemory.get<uint32_t>(vector * 4);
+		if (localMemory.hasFault() || newPc == 0)
 		{
+			std::cerr << (vector == Exceptions::ADDRESS_ERROR ? "address error" : "bus error")
+				<< " at $" << std::hex << fault.address << std::dec << ", cpu halted" << std::endl;
 			done = true;
+			return;
+		}
+		pc = newPc;
+	}
+
+	/// <summary>
+	/// Counts the outcome of a conditional branch: taken when the pc is not the address of the next instruction.
+	/// </summary>
+	void Cpu::recordBranch(uint16_t opcode, uint16_t instructionId, uint32_t instructionPc)
+	{
+		uint32_t next;
+		if (instructionId >= instructions::BHI && instructionId <= instructions::BLE)
+		{
+			next = instructionPc + ((opcode & 0xff) == 0 ? 4 : 2);
+		}
+		else if (instructionId == instructions::DBCC)
+		{
+			next = instructionPc + 4;
+		}
+		else
+		{
+			return;
 		}
-		return;
+		statistics->branch(instructionId, pc != next);
 	}
 }
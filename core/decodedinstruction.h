@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+namespace mc68000
+{
+	/// <summary>
+	/// What an operand designates; the effective address modes come first, in the order of their encoding.
+	/// </summary>
+	enum class OperandKind : uint8_t
+	{
+		None,
+		DataRegister,           // dn
+		AddressRegister,        // an
+		Indirect,               // (an)
+		PostIncrement,          // (an)+
+		PreDecrement,           // -(an)
+		Displacement,           // d16(an), value is the displacement
+		Index,                  // d8(an,xn), value is the displacement
+		AbsoluteWord,           // (xxx).w, value is the sign extended address
+		AbsoluteLong,           // (xxx).l, value is the address
+		PcDisplacement,         // d16(pc), value is the displacement
+		PcIndex,                // d8(pc,xn), value is the displacement
+		Immediate,              // #xxx of an effective address, value is the data
+		InvalidAddress,         // mode 7 with a register above 4
+
+		Data,                   // immediate data outside of an effective address: xxxi, bit numbers, moveq, stop...
+		Quick,                  // small constant: addq, subq, shift counts, trap vector, link displacement
+		RegisterList,           // movem, value has d0-d7 in bits 0-7 and a0-a7 in bits 8-15 whatever the mode
+		BranchTarget,           // bcc, bra, bsr: value is the target address
+		BranchDisplacement,     // dbcc: value is the displacement from the extension word
+		PeripheralDisplacement, // movep d16(an), value is the displacement
+		Ccr,
+		Sr,
+	};
+
+	/// <summary>
+	/// One operand of a decoded instruction. Displacements are sign extended.
+	/// </summary>
+	struct Operand
+	{
+		OperandKind kind;
+		uint8_t reg;            // register number of the registers and address register modes
+		uint8_t index;          // index register of Index and PcIndex: 0-7 for d0-d7, 8-15 for a0-a7
+		uint8_t indexSize;      // 2 or 4 bytes for the index register
+		uint32_t value;
+	};
+
+	/// <summary>
+	/// An instruction decoded once by Decoder, for the disassembler to format when it needs the text and for
+	/// the tools that only need the operation and its operands.
+	/// </summary>
+	struct DecodedInstruction
+	{
+		uint32_t address;
+		uint16_t opcode;
+		uint16_t instruction;   // id from instructions
+		const char* mnemonic;   // with the condition of dbcc and scc, static storage
+		uint8_t size;           // size suffix in bytes, 0 when the syntax has none
+		uint8_t length;         // in words, opcode and extension words
+		uint8_t operandCount;
+		Operand operands[2];
+	};
+
+	static_assert(std::is_trivially_copyable_v<DecodedInstruction>, "DecodedInstruction is copied as raw memory");
+}
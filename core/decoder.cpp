@@ -0,0 +1,1167 @@
+#include <cstring>
+#include <vector>
+
+#include "decoder.h"
+#include "instructions.h"
+
+namespace mc68000
+{
+	namespace
+	{
+		const char* const DbConditions[] = { "dbt", "dbf", "dbhi", "dbls", "dbcc", "dbcs", "dbne", "dbeq", "dbvc", "dbvs", "dbpl", "dbmi", "dbge", "dblt", "dbgt", "dble" };
+		const char* const SConditions[] = { "st", "sf", "shi", "sls", "scc", "scs", "sne", "seq", "svc", "svs", "spl", "smi", "sge", "slt", "sgt", "sle" };
+	}
+
+	Decoder::Decoder()
+	{
+		handlers = setup<Decoder>();
+	}
+
+	Decoder::~Decoder()
+	{
+		delete[] handlers;
+	}
+
+	void Decoder::decode(const uint16_t* code, bool bigEndian, uint32_t address, DecodedInstruction& instruction)
+	{
+		this->code = code;
+		swapWords = bigEndian;
+		words = 0;
+		result = &instruction;
+
+		instruction = DecodedInstruction{};
+		instruction.address = address;
+		uint16_t x = fetchNextWord();
+		instruction.opcode = x;
+		instruction.instruction = (this->*handlers[x])(x);
+		instruction.length = static_cast<uint8_t>(words);
+		result = nullptr;
+	}
+
+	bool Decoder::decode(const uint16_t* code, uint32_t bytesAvailable, bool bigEndian, uint32_t address, DecodedInstruction& instruction)
+	{
+		if (bytesAvailable >= maxInstructionBytes)
+		{
+			decode(code, bigEndian, address, instruction);
+			return true;
+		}
+		uint16_t last[maxInstructionBytes / 2] = {};
+		memcpy(last, code, bytesAvailable);
+		decode(last, bigEndian, address, instruction);
+		return instruction.length * 2u <= bytesAvailable;
+	}
+
+	bool Decoder::isUnknown(uint16_t opcode)
+	{
+		static const std::vector<uint64_t> unknownOpcodes = []()
+		{
+			// the handlers only look at the opcode to reject an instruction, the extension words can be 0
+			std::vector<uint64_t> bits(65536 / 64);
+			Decoder decoder;
+			uint16_t code[maxInstructionBytes / 2] = {};
+			DecodedInstruction instruction;
+			for (uint32_t word = 0; word < 65536; word++)
+			{
+				code[0] = static_cast<uint16_t>(word);
+				decoder.decode(code, false, 0, instruction);
+				if (instruction.instruction == instructions::UNKNOWN)
+				{
+					bits[word / 64] |= uint64_t(1) << (word % 64);
+				}
+			}
+			return bits;
+		}();
+		return (unknownOpcodes[opcode / 64] >> (opcode % 64)) & 1;
+	}
+
+	uint16_t Decoder::fetchNextWord()
+	{
+		if (swapWords)
+		{
+			const uint8_t* p8 = reinterpret_cast<const uint8_t*>(code + words++);
+			return (*p8 << 8) | *(p8 + 1);
+		}
+		return code[words++];
+	}
+
+	void Decoder::addOperand(OperandKind kind, uint8_t reg, uint32_t value)
+	{
+		Operand& operand = result->operands[result->operandCount++];
+		operand.kind = kind;
+		operand.reg = reg;
+		operand.value = value;
+	}
+
+	/// <summary>
+	/// Sets the size suffix from the usual size field: 00 byte, 01 word, 10 long.
+	/// </summary>
+	void Decoder::setSize(uint16_t size)
+	{
+		static const uint8_t bytes[] = { 1, 2, 4, 0 };
+		result->size = bytes[size & 0b11];
+	}
+
+	void Decoder::addEffectiveAddress(uint16_t ea, bool isLongOperation)
+	{
+		uint8_t reg = ea & 7u;
+		switch (ea >> 3)
+		{
+		case 0:
+			addOperand(OperandKind::DataRegister, reg);
+			return;
+		case 1:
+			addOperand(OperandKind::AddressRegister, reg);
+			return;
+		case 2:
+			addOperand(OperandKind::Indirect, reg);
+			return;
+		case 3:
+			addOperand(OperandKind::PostIncrement, reg);
+			return;
+		case 4:
+			addOperand(OperandKind::PreDecrement, reg);
+			return;
+		case 5:
+			addOperand(OperandKind::Displacement, reg, static_cast<int16_t>(fetchNextWord()));
+			return;
+		case 6:
+		case 7:
+			break;
+		}
+
+		if ((ea >> 3) == 6 || reg == 3)
+		{
+			// brief extension word: d/a, register, w/l, displacement
+			uint16_t extension = fetchNextWord();
+			addOperand((ea >> 3) == 6 ? OperandKind::Index : OperandKind::PcIndex, reg, static_cast<int8_t>(extension & 0xff));
+			Operand& operand = result->operands[result->operandCount - 1];
+			operand.index = static_cast<uint8_t>(extension >> 12);
+			operand.indexSize = (extension & 0x0800) ? 4 : 2;
+			return;
+		}
+
+		switch (reg)
+		{
+		case 0: // (xxx).w
+			addOperand(OperandKind::AbsoluteWord, 0, static_cast<int16_t>(fetchNextWord()));
+			return;
+		case 1: // (xxx).l
+		{
+			uint32_t address = fetchNextWord() << 16;
+			address |= fetchNextWord();
+			addOperand(OperandKind::AbsoluteLong, 0, address);
+			return;
+		}
+		case 2: // d16(PC)
+			addOperand(OperandKind::PcDisplacement, 0, static_cast<int16_t>(fetchNextWord()));
+			return;
+		case 4: // #
+		{
+			uint32_t immediate = fetchNextWord();
+			if (isLongOperation)
+			{
+				immediate = (immediate << 16) | fetchNextWord();
+			}
+			addOperand(OperandKind::Immediate, 0, immediate);
+			return;
+		}
+		default:
+			addOperand(OperandKind::InvalidAddress);
+			return;
+		}
+	}
+
+	/// <summary>
+	/// ADDI, ANDI, CMPI, EORI, ORI, SUBI
+	/// </summary>
+	uint16_t Decoder::decodeImmediateInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode)
+	{
+		uint16_t size = (opcode >> 6) & 0b11;
+		result->mnemonic = instructionName;
+		setSize(size);
+
+		uint32_t immediate = fetchNextWord();
+		if (size == 0)
+		{
+			immediate &= 0xff;
+		}
+		else if (size == 2)
+		{
+			immediate = (immediate << 16) | fetchNextWord();
+		}
+		addOperand(OperandKind::Data, 0, immediate);
+		addEffectiveAddress(opcode & 0b111'111, size == 0b10);
+
+		return instructionId;
+	}
+
+	/// <summary>
+	/// Bcc familly instructions, BRA and BSR
+	/// </summary>
+	uint16_t Decoder::decodeBccInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode)
+	{
+		result->mnemonic = instructionName;
+
+		// relative to the end of the opcode
+		uint32_t target = result->address + 2;
+		uint8_t offset = opcode & 0xff;
+		if (offset == 0)
+		{
+			target += static_cast<int16_t>(fetchNextWord());
+		}
+		else
+		{
+			target += static_cast<int8_t>(offset);
+		}
+		addOperand(OperandKind::BranchTarget, 0, target);
+
+		return instructionId;
+	}
+
+	/// <summary>
+	/// ADDX and SUBX
+	/// </summary>
+	uint16_t Decoder::decodeAddxSubx(const char* instructionName, uint16_t instructionId, uint16_t opcode)
+	{
+		result->mnemonic = instructionName;
+		setSize((opcode >> 6) & 0b11);
+
+		uint8_t registerX = (opcode >> 9) & 7;
+		uint8_t registerY = opcode & 7;
+		OperandKind kind = (opcode & 8) ? OperandKind::PreDecrement : OperandKind::DataRegister;
+		addOperand(kind, registerY);
+		addOperand(kind, registerX);
+
+		return instructionId;
+	}
+
+	/// <summary>
+	/// BCHG, BCLR, BSET, BTST instructions when bit index is from register
+	/// </summary>
+	uint16_t Decoder::decodeBitRegisterInstruction(const char* name, uint16_t instruction, uint16_t opcode)
+	{
+		result->mnemonic = name;
+		addOperand(OperandKind::DataRegister, (opcode >> 9) & 0b111);
+		addEffectiveAddress(opcode & 0b111'111, Ignore);
+
+		return instruction;
+	}
+
+	/// <summary>
+	/// BCHG, BCLR, BSET, BTST instructions when bit index is from immediate data
+	/// </summary>
+	uint16_t Decoder::decodeBitImmediateInstruction(const char* name, uint16_t instruction, uint16_t opcode)
+	{
+		result->mnemonic = name;
+		addOperand(OperandKind::Data, 0, fetchNextWord());
+		addEffectiveAddress(opcode & 0b111'111, Ignore);
+
+		return instruction;
+	}
+
+	/// <summary>
+	/// AND, OR, EOR
+	/// </summary>
+	uint16_t Decoder::decodeLogical(const char* name, uint16_t instruction, uint16_t opcode)
+	{
+		result->mnemonic = name;
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+
+		uint8_t reg = (opcode >> 9) & 0b111;
+		bool fromRegister = opcode & (1 << 8);
+		if (fromRegister)
+		{
+			addOperand(OperandKind::DataRegister, reg);
+			addEffectiveAddress(opcode & 0b111'111, size == 2);
+		}
+		else
+		{
+			addEffectiveAddress(opcode & 0b111'111, size == 2);
+			addOperand(OperandKind::DataRegister, reg);
+		}
+		return instruction;
+	}
+
+	uint16_t Decoder::decodeToCcr(const char* name, uint16_t instruction, uint16_t)
+	{
+		result->mnemonic = name;
+		addOperand(OperandKind::Data, 0, fetchNextWord());
+		addOperand(OperandKind::Ccr);
+		return instruction;
+	}
+
+	uint16_t Decoder::decodeToSr(const char* name, uint16_t instruction, uint16_t)
+	{
+		result->mnemonic = name;
+		addOperand(OperandKind::Data, 0, fetchNextWord());
+		addOperand(OperandKind::Sr);
+		return instruction;
+	}
+
+	/// <summary>
+	/// DIVS, DIVU, MULS, MULU
+	/// </summary>
+	uint16_t Decoder::decodeMulDiv(const char* name, uint16_t instruction, uint16_t opcode)
+	{
+		result->mnemonic = name;
+		addEffectiveAddress(opcode & 0b111'111, AlwaysWord);
+		addOperand(OperandKind::DataRegister, (opcode >> 9) & 0b111);
+
+		return instruction;
+	}
+
+	/// <summary>
+	/// ASL, ASR, LSL, LSR, ROL, ROR, ROXL, ROXR on a register or on memory
+	/// </summary>
+	uint16_t Decoder::decodeShiftRotate(const char* instructionName, uint16_t instructionId, uint16_t opcode)
+	{
+		result->mnemonic = instructionName;
+		uint16_t size = (opcode >> 6) & 0b11;
+		if (size != 0b11)
+		{
+			setSize(size);
+
+			uint8_t source = (opcode >> 9) & 0b111;
+			uint8_t destination = opcode & 0b111;
+
+			bool fromRegister = opcode & (1 << 5);
+			if (fromRegister)
+			{
+				addOperand(OperandKind::DataRegister, source);
+			}
+			else
+			{
+				addOperand(OperandKind::Quick, 0, source ? source : 8);
+			}
+			addOperand(OperandKind::DataRegister, destination);
+		}
+		else
+		{
+			addEffectiveAddress(opcode & 0b111'111, Ignore);
+		}
+		return instructionId;
+	}
+
+	/// <summary>
+	/// ABCD: Add Binary Coded Decimal
+	/// </summary>
+	uint16_t Decoder::abcd(uint16_t opcode)
+	{
+		result->mnemonic = "abcd";
+		OperandKind kind = (opcode & 8) ? OperandKind::PreDecrement : OperandKind::DataRegister;
+		addOperand(kind, opcode & 7);
+		addOperand(kind, (opcode >> 9) & 7);
+
+		return instructions::ABCD;
+	}
+
+	/// <summary>
+	/// ADD: Add
+	/// </summary>
+	uint16_t Decoder::add(uint16_t opcode)
+	{
+		result->mnemonic = "add";
+		uint8_t reg = (opcode >> 9) & 7;
+		bool isMemoryDestination = opcode & 0x100;
+		uint16_t size = (opcode >> 6) & 3;
+
+		setSize(size);
+		if (isMemoryDestination)
+		{
+			addOperand(OperandKind::DataRegister, reg);
+			addEffectiveAddress(opcode & 0b111111u, size == 0b10);
+		}
+		else
+		{
+			addEffectiveAddress(opcode & 0b111111u, size == 0b10);
+			addOperand(OperandKind::DataRegister, reg);
+		}
+		return instructions::ADD;
+	}
+
+	/// <summary>
+	/// ADDA: Add Address
+	/// </summary>
+	uint16_t Decoder::adda(uint16_t opcode)
+	{
+		result->mnemonic = "adda";
+		uint16_t size = (opcode >> 8) & 1;
+		setSize(size + 1);
+		addEffectiveAddress(opcode & 0b111111u, size == 1);
+		addOperand(OperandKind::AddressRegister, (opcode >> 9) & 0b111);
+
+		return instructions::ADDA;
+	}
+
+	/// <summary>
+	/// ADDI: Add Immediate
+	/// </summary>
+	uint16_t Decoder::addi(uint16_t opcode)
+	{
+		return decodeImmediateInstruction("addi", instructions::ADDI, opcode);
+	}
+
+	/// <summary>
+	/// ADDQ: Add Quick
+	/// </summary>
+	uint16_t Decoder::addq(uint16_t opcode)
+	{
+		result->mnemonic = "addq";
+		uint16_t size = (opcode >> 6) & 0b11;
+		uint32_t data = (opcode >> 9) & 0b111;
+		if (data == 0) data = 8;
+
+		setSize(size);
+		addOperand(OperandKind::Quick, 0, data);
+		addEffectiveAddress(opcode & 0b111111u, size == 0b10);
+		return instructions::ADDQ;
+	}
+
+	/// <summary>
+	/// ADDX: Add extended
+	/// </summary>
+	uint16_t Decoder::addx(uint16_t opcode)
+	{
+		return decodeAddxSubx("addx", instructions::ADDX, opcode);
+	}
+
+	/// <summary>
+	/// AND: And logical
+	/// </summary>
+	uint16_t Decoder::and_(uint16_t opcode)
+	{
+		return decodeLogical("and", instructions::AND, opcode);
+	}
+
+	/// <summary>
+	/// ANDI: And immediate
+	/// </summary>
+	uint16_t Decoder::andi(uint16_t opcode)
+	{
+		return decodeImmediateInstruction("andi", instructions::ANDI, opcode);
+	}
+
+	uint16_t Decoder::andi2ccr(uint16_t opcode)
+	{
+		return decodeToCcr("andi", instructions::ANDI2CCR, opcode);
+	}
+
+	uint16_t Decoder::andi2sr(uint16_t opcode)
+	{
+		return decodeToSr("andi", instructions::ANDI2SR, opcode);
+	}
+
+	uint16_t Decoder::asl_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("asl", instructions::ASL, opcode);
+	}
+
+	uint16_t Decoder::asl_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("asl", instructions::ASL, opcode);
+	}
+
+	uint16_t Decoder::asr_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("asr", instructions::ASR, opcode);
+	}
+
+	uint16_t Decoder::asr_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("asr", instructions::ASR, opcode);
+	}
+
+	uint16_t Decoder::bra(uint16_t opcode)
+	{
+		return decodeBccInstruction("bra", instructions::BRA, opcode);
+	}
+	uint16_t Decoder::bhi(uint16_t opcode)
+	{
+		return decodeBccInstruction("bhi", instructions::BHI, opcode);
+	}
+	uint16_t Decoder::bls(uint16_t opcode)
+	{
+		return decodeBccInstruction("bls", instructions::BLS, opcode);
+	}
+	uint16_t Decoder::bcc(uint16_t opcode)
+	{
+		return decodeBccInstruction("bcc", instructions::BCC, opcode);
+	}
+	uint16_t Decoder::bcs(uint16_t opcode)
+	{
+		return decodeBccInstruction("bcs", instructions::BCS, opcode);
+	}
+	uint16_t Decoder::bne(uint16_t opcode)
+	{
+		return decodeBccInstruction("bne", instructions::BNE, opcode);
+	}
+	uint16_t Decoder::beq(uint16_t opcode)
+	{
+		return decodeBccInstruction("beq", instructions::BEQ, opcode);
+	}
+	uint16_t Decoder::bvc(uint16_t opcode)
+	{
+		return decodeBccInstruction("bvc", instructions::BVC, opcode);
+	}
+	uint16_t Decoder::bvs(uint16_t opcode)
+	{
+		return decodeBccInstruction("bvs", instructions::BVS, opcode);
+	}
+	uint16_t Decoder::bpl(uint16_t opcode)
+	{
+		return decodeBccInstruction("bpl", instructions::BPL, opcode);
+	}
+	uint16_t Decoder::bmi(uint16_t opcode)
+	{
+		return decodeBccInstruction("bmi", instructions::BMI, opcode);
+	}
+	uint16_t Decoder::bge(uint16_t opcode)
+	{
+		return decodeBccInstruction("bge", instructions::BGE, opcode);
+	}
+	uint16_t Decoder::blt(uint16_t opcode)
+	{
+		return decodeBccInstruction("blt", instructions::BLT, opcode);
+	}
+	uint16_t Decoder::bgt(uint16_t opcode)
+	{
+		return decodeBccInstruction("bgt", instructions::BGT, opcode);
+	}
+	uint16_t Decoder::ble(uint16_t opcode)
+	{
+		return decodeBccInstruction("ble", instructions::BLE, opcode);
+	}
+
+	uint16_t Decoder::bchg_r(uint16_t opcode)
+	{
+		return decodeBitRegisterInstruction("bchg", instructions::BCHG_R, opcode);
+	}
+
+	uint16_t Decoder::bchg_i(uint16_t opcode)
+	{
+		return decodeBitImmediateInstruction("bchg", instructions::BCHG_I, opcode);
+	}
+
+	uint16_t Decoder::bclr_r(uint16_t opcode)
+	{
+		return decodeBitRegisterInstruction("bclr", instructions::BCLR_R, opcode);
+	}
+
+	uint16_t Decoder::bclr_i(uint16_t opcode)
+	{
+		return decodeBitImmediateInstruction("bclr", instructions::BCLR_I, opcode);
+	}
+
+	uint16_t Decoder::bset_r(uint16_t opcode)
+	{
+		return decodeBitRegisterInstruction("bset", instructions::BSET_R, opcode);
+	}
+
+	uint16_t Decoder::bset_i(uint16_t opcode)
+	{
+		return decodeBitImmediateInstruction("bset", instructions::BSET_I, opcode);
+	}
+
+	uint16_t Decoder::bsr(uint16_t opcode)
+	{
+		return decodeBccInstruction("bsr", instructions::BSR, opcode);
+	}
+
+	uint16_t Decoder::btst_r(uint16_t opcode)
+	{
+		return decodeBitRegisterInstruction("btst", instructions::BTST_R, opcode);
+	}
+
+	uint16_t Decoder::btst_i(uint16_t opcode)
+	{
+		return decodeBitImmediateInstruction("btst", instructions::BTST_I, opcode);
+	}
+
+	uint16_t Decoder::chk(uint16_t opcode)
+	{
+		result->mnemonic = "chk";
+		addEffectiveAddress(opcode & 0b111'111, AlwaysWord);
+		addOperand(OperandKind::DataRegister, (opcode >> 9) & 0b111);
+
+		return instructions::CHK;
+	}
+
+	uint16_t Decoder::clr(uint16_t opcode)
+	{
+		result->mnemonic = "clr";
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+		addEffectiveAddress(opcode & 0b111'111, size == 0b10);
+
+		return instructions::CLR;
+	}
+
+	uint16_t Decoder::cmp(uint16_t opcode)
+	{
+		result->mnemonic = "cmp";
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+		addEffectiveAddress(opcode & 0b111'111, size == 0b10);
+		addOperand(OperandKind::DataRegister, (opcode >> 9) & 0b111);
+
+		return instructions::CMP;
+	}
+
+	uint16_t Decoder::cmpa(uint16_t opcode)
+	{
+		result->mnemonic = "cmpa";
+		uint16_t size = (opcode >> 8) & 1;
+		setSize(size + 1);
+		addEffectiveAddress(opcode & 0b111'111, size == 1);
+		addOperand(OperandKind::AddressRegister, (opcode >> 9) & 0b111);
+
+		return instructions::CMPA;
+	}
+
+	uint16_t Decoder::cmpi(uint16_t opcode)
+	{
+		return decodeImmediateInstruction("cmpi", instructions::CMPI, opcode);
+	}
+
+	uint16_t Decoder::cmpm(uint16_t opcode)
+	{
+		result->mnemonic = "cmpm";
+		setSize((opcode >> 6) & 0b11);
+		addOperand(OperandKind::PostIncrement, opcode & 0b111);
+		addOperand(OperandKind::PostIncrement, (opcode >> 9) & 0b111);
+
+		return instructions::CMPM;
+	}
+
+	uint16_t Decoder::dbcc(uint16_t opcode)
+	{
+		result->mnemonic = DbConditions[(opcode >> 8) & 0b1111];
+		addOperand(OperandKind::DataRegister, opcode & 0b111);
+		addOperand(OperandKind::BranchDisplacement, 0, static_cast<int16_t>(fetchNextWord()));
+
+		return instructions::DBCC;
+	}
+
+	uint16_t Decoder::divs(uint16_t opcode)
+	{
+		return decodeMulDiv("divs", instructions::DIVS, opcode);
+	}
+
+	uint16_t Decoder::divu(uint16_t opcode)
+	{
+		return decodeMulDiv("divu", instructions::DIVU, opcode);
+	}
+
+	uint16_t Decoder::eor(uint16_t opcode)
+	{
+		return decodeLogical("eor", instructions::EOR, opcode);
+	}
+
+	uint16_t Decoder::eori(uint16_t opcode)
+	{
+		return decodeImmediateInstruction("eori", instructions::EORI, opcode);
+	}
+
+	uint16_t Decoder::eori2ccr(uint16_t opcode)
+	{
+		return decodeToCcr("eori", instructions::EORI2CCR, opcode);
+	}
+
+	uint16_t Decoder::eori2sr(uint16_t opcode)
+	{
+		return decodeToSr("eori", instructions::EORI2SR, opcode);
+	}
+
+	uint16_t Decoder::exg(uint16_t opcode)
+	{
+		result->mnemonic = "exg";
+		uint8_t regx = (opcode >> 9) & 0b111;
+		uint8_t regy = opcode & 0b111;
+
+		switch ((opcode >> 3) & 0b11111)
+		{
+			case 0b01000:
+				addOperand(OperandKind::DataRegister, regx);
+				addOperand(OperandKind::DataRegister, regy);
+				break;
+			case 0b01001:
+				addOperand(OperandKind::AddressRegister, regx);
+				addOperand(OperandKind::AddressRegister, regy);
+				break;
+			case 0b10001:
+				addOperand(OperandKind::DataRegister, regx);
+				addOperand(OperandKind::AddressRegister, regy);
+				break;
+			default:
+				throw "exg: invalid mode";
+		}
+
+		return instructions::EXG;
+	}
+
+	uint16_t Decoder::ext(uint16_t opcode)
+	{
+		result->mnemonic = "ext";
+		result->size = ((opcode >> 6) & 0b1) ? 4 : 2;
+		addOperand(OperandKind::DataRegister, opcode & 0b111);
+
+		return instructions::EXT;
+	}
+
+	uint16_t Decoder::illegal(uint16_t)
+	{
+		result->mnemonic = "illegal";
+		return instructions::ILLEGAL;
+	}
+
+	uint16_t Decoder::jmp(uint16_t opcode)
+	{
+		result->mnemonic = "jmp";
+		addEffectiveAddress(opcode & 0b111'111, Ignore);
+
+		return instructions::JMP;
+	}
+
+	uint16_t Decoder::jsr(uint16_t opcode)
+	{
+		result->mnemonic = "jsr";
+		addEffectiveAddress(opcode & 0b111'111, Ignore);
+
+		return instructions::JSR;
+	}
+
+	uint16_t Decoder::lea(uint16_t opcode)
+	{
+		result->mnemonic = "lea";
+		addEffectiveAddress(opcode & 0b111'111, AlwaysLong);
+		addOperand(OperandKind::AddressRegister, (opcode >> 9) & 0b111);
+
+		return instructions::LEA;
+	}
+
+	uint16_t Decoder::link(uint16_t opcode)
+	{
+		result->mnemonic = "link";
+		addOperand(OperandKind::AddressRegister, opcode & 7u);
+		addOperand(OperandKind::Quick, 0, static_cast<int16_t>(fetchNextWord()));
+		return instructions::LINK;
+	}
+
+	uint16_t Decoder::lsl_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("lsl", instructions::LSL, opcode);
+	}
+
+	uint16_t Decoder::lsl_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("lsl", instructions::LSL, opcode);
+	}
+
+	uint16_t Decoder::lsr_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("lsr", instructions::LSR, opcode);
+	}
+
+	uint16_t Decoder::lsr_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("lsr", instructions::LSR, opcode);
+	}
+
+	uint16_t Decoder::move(uint16_t opcode)
+	{
+		// the size field of move is 01 byte, 11 word, 10 long
+		static const uint8_t sizes[4] = { 0, 1, 4, 2 };
+
+		result->mnemonic = "move";
+		uint16_t size = opcode >> 12;
+		result->size = sizes[size];
+		addEffectiveAddress(opcode & 0b111111u, size == 0b10);
+
+		uint16_t destination = (opcode >> 6) & 0b111111u;
+		// the destination is inverted: register - mode instead of mode - register
+		uint16_t destinationRegister = destination & 0b111u;
+		uint16_t destinationMode = destination >> 3;
+		addEffectiveAddress((destinationRegister << 3) | destinationMode, size == 0b10);
+
+		return instructions::MOVE;
+	}
+
+	uint16_t Decoder::movea(uint16_t opcode)
+	{
+		result->mnemonic = "movea";
+		bool isWordSize = opcode & 0b0001'0000'0000'0000u;
+		result->size = isWordSize ? 2 : 4;
+		addEffectiveAddress(opcode & 0b111111u, !isWordSize);
+		addOperand(OperandKind::AddressRegister, (opcode & 0b0000'1110'0000'0000u) >> 9);
+
+		return instructions::MOVEA;
+	}
+
+	uint16_t Decoder::move2ccr(uint16_t opcode)
+	{
+		result->mnemonic = "move";
+		addEffectiveAddress(opcode & 0b111'111u, AlwaysWord);
+		addOperand(OperandKind::Ccr);
+
+		return instructions::MOVE2CCR;
+	}
+
+	uint16_t Decoder::movesr(uint16_t opcode)
+	{
+		result->mnemonic = "move";
+		addOperand(OperandKind::Sr);
+		addEffectiveAddress(opcode & 0b111'111u, Ignore);
+
+		return instructions::MOVESR;
+	}
+
+	uint16_t Decoder::move2sr(uint16_t opcode)
+	{
+		result->mnemonic = "move";
+		addEffectiveAddress(opcode & 0b111'111u, AlwaysWord);
+		addOperand(OperandKind::Sr);
+
+		return instructions::MOVE2SR;
+	}
+
+	uint16_t Decoder::movem(uint16_t opcode)
+	{
+		result->mnemonic = "movem";
+		result->size = ((opcode >> 6) & 1) ? 4 : 2;
+		uint16_t registerList = fetchNextWord();
+		if ((opcode & 0b111'000) == 0b100'000)
+		{
+			// the predecrement mode lists a7 to a0 then d7 to d0: reverse the bits
+			uint16_t reversed = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				reversed |= ((registerList >> i) & 1) << (15 - i);
+			}
+			registerList = reversed;
+		}
+
+		if (((opcode >> 10) & 1) == 0)
+		{
+			// register to memory
+			addOperand(OperandKind::RegisterList, 0, registerList);
+			addEffectiveAddress(opcode & 0b111'111u, Ignore);
+		}
+		else
+		{
+			// memory to register
+			addEffectiveAddress(opcode & 0b111'111u, Ignore);
+			addOperand(OperandKind::RegisterList, 0, registerList);
+		}
+
+		return instructions::MOVEM;
+	}
+
+	uint16_t Decoder::movep(uint16_t opcode)
+	{
+		result->mnemonic = "movep";
+		uint8_t dRegister = (opcode >> 9) & 0b111;
+		uint8_t aRegister = opcode & 0b111;
+		uint32_t displacement = static_cast<int16_t>(fetchNextWord());
+		result->size = (opcode & 0b1'000'000) ? 4 : 2;
+
+		if (opcode & 0b10'000'000)
+		{
+			// register to memory
+			addOperand(OperandKind::DataRegister, dRegister);
+			addOperand(OperandKind::PeripheralDisplacement, aRegister, displacement);
+		}
+		else
+		{
+			addOperand(OperandKind::PeripheralDisplacement, aRegister, displacement);
+			addOperand(OperandKind::DataRegister, dRegister);
+		}
+
+		return instructions::MOVEP;
+	}
+
+	uint16_t Decoder::moveq(uint16_t opcode)
+	{
+		result->mnemonic = "moveq";
+		result->size = 4;
+		addOperand(OperandKind::Data, 0, static_cast<int8_t>(opcode & 0xff));
+		addOperand(OperandKind::DataRegister, (opcode >> 9) & 0x07);
+
+		return instructions::MOVEQ;
+	}
+
+	uint16_t Decoder::muls(uint16_t opcode)
+	{
+		return decodeMulDiv("muls", instructions::MULS, opcode);
+	}
+
+	uint16_t Decoder::mulu(uint16_t opcode)
+	{
+		return decodeMulDiv("mulu", instructions::MULU, opcode);
+	}
+
+	uint16_t Decoder::nbcd(uint16_t opcode)
+	{
+		result->mnemonic = "nbcd";
+		addEffectiveAddress(opcode & 0b111'111u, Ignore);
+		return instructions::NBCD;
+	}
+
+	uint16_t Decoder::neg(uint16_t opcode)
+	{
+		result->mnemonic = "neg";
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+		addEffectiveAddress(opcode & 0b111'111u, size == 0b10);
+		return instructions::NEG;
+	}
+
+	uint16_t Decoder::negx(uint16_t opcode)
+	{
+		result->mnemonic = "negx";
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+		addEffectiveAddress(opcode & 0b111'111u, size == 0b10);
+		return instructions::NEGX;
+	}
+
+	uint16_t Decoder::nop(uint16_t)
+	{
+		result->mnemonic = "nop";
+		return instructions::NOP;
+	}
+
+	uint16_t Decoder::not_(uint16_t opcode)
+	{
+		result->mnemonic = "not";
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+		addEffectiveAddress(opcode & 0b111'111u, size == 0b10);
+
+		return instructions::NOT;
+	}
+
+	uint16_t Decoder::or_(uint16_t opcode)
+	{
+		return decodeLogical("or", instructions::OR, opcode);
+	}
+
+	uint16_t Decoder::ori(uint16_t opcode)
+	{
+		return decodeImmediateInstruction("ori", instructions::ORI, opcode);
+	}
+
+	uint16_t Decoder::ori2ccr(uint16_t opcode)
+	{
+		return decodeToCcr("ori", instructions::ORI2CCR, opcode);
+	}
+
+	uint16_t Decoder::ori2sr(uint16_t opcode)
+	{
+		return decodeToSr("ori", instructions::ORI2SR, opcode);
+	}
+
+	uint16_t Decoder::pea(uint16_t opcode)
+	{
+		result->mnemonic = "pea";
+		addEffectiveAddress(opcode & 0b111'111, AlwaysLong);
+
+		return instructions::PEA;
+	}
+
+	uint16_t Decoder::rol_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("rol", instructions::ROL, opcode);
+	}
+
+	uint16_t Decoder::ror_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("ror", instructions::ROR, opcode);
+	}
+
+	uint16_t Decoder::roxl_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("roxl", instructions::ROXL, opcode);
+	}
+
+	uint16_t Decoder::roxr_memory(uint16_t opcode)
+	{
+		return decodeShiftRotate("roxr", instructions::ROXR, opcode);
+	}
+
+	uint16_t Decoder::rol_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("rol", instructions::ROL, opcode);
+	}
+
+	uint16_t Decoder::ror_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("ror", instructions::ROR, opcode);
+	}
+
+	uint16_t Decoder::roxl_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("roxl", instructions::ROXL, opcode);
+	}
+
+	uint16_t Decoder::roxr_register(uint16_t opcode)
+	{
+		return decodeShiftRotate("roxr", instructions::ROXR, opcode);
+	}
+
+	uint16_t Decoder::rte(uint16_t)
+	{
+		result->mnemonic = "rte";
+		return instructions::RTE;
+	}
+
+	uint16_t Decoder::rtr(uint16_t)
+	{
+		result->mnemonic = "rtr";
+		return instructions::RTR;
+	}
+
+	uint16_t Decoder::rts(uint16_t)
+	{
+		result->mnemonic = "rts";
+		return instructions::RTS;
+	}
+
+	uint16_t Decoder::sbcd(uint16_t opcode)
+	{
+		result->mnemonic = "sbcd";
+		OperandKind kind = (opcode & 0b1000) ? OperandKind::PreDecrement : OperandKind::DataRegister;
+		addOperand(kind, opcode & 0b111);
+		addOperand(kind, (opcode >> 9) & 0b111);
+		return instructions::SBCD;
+	}
+
+	uint16_t Decoder::scc(uint16_t opcode)
+	{
+		result->mnemonic = SConditions[(opcode >> 8) & 0b1111];
+		addEffectiveAddress(opcode & 0b111'111, Ignore);
+
+		return instructions::SCC;
+	}
+
+	uint16_t Decoder::stop(uint16_t)
+	{
+		result->mnemonic = "stop";
+		addOperand(OperandKind::Data, 0, fetchNextWord());
+
+		return instructions::STOP;
+	}
+
+	uint16_t Decoder::sub(uint16_t opcode)
+	{
+		result->mnemonic = "sub";
+		uint8_t reg = (opcode >> 9) & 7;
+		bool isMemoryDestination = opcode & 0x100;
+		uint16_t size = (opcode >> 6) & 3;
+
+		setSize(size);
+		if (isMemoryDestination)
+		{
+			addOperand(OperandKind::DataRegister, reg);
+			addEffectiveAddress(opcode & 0b111'111u, size == 0b10);
+		}
+		else
+		{
+			addEffectiveAddress(opcode & 0b111'111u, size == 0b10);
+			addOperand(OperandKind::DataRegister, reg);
+		}
+
+		return instructions::SUB;
+	}
+
+	uint16_t Decoder::suba(uint16_t opcode)
+	{
+		result->mnemonic = "suba";
+		bool isLongOperation = ((opcode >> 6) & 0b111) == 0b111;
+		result->size = isLongOperation ? 4 : 2;
+		addEffectiveAddress(opcode & 0b111'111u, isLongOperation);
+		addOperand(OperandKind::AddressRegister, (opcode >> 9) & 0b111);
+
+		return instructions::SUBA;
+	}
+
+	uint16_t Decoder::subi(uint16_t opcode)
+	{
+		return decodeImmediateInstruction("subi", instructions::SUBI, opcode);
+	}
+
+	uint16_t Decoder::subq(uint16_t opcode)
+	{
+		result->mnemonic = "subq";
+		uint16_t size = (opcode >> 6) & 0b11;
+		uint32_t source = (opcode >> 9) & 0b111;
+		if (source == 0) source = 8;
+
+		setSize(size);
+		addOperand(OperandKind::Quick, 0, source);
+		addEffectiveAddress(opcode & 0b111'111, size == 0b10);
+
+		return instructions::SUBQ;
+	}
+
+	/// <summary>
+	/// SUBX: Sub extended
+	/// </summary>
+	uint16_t Decoder::subx(uint16_t opcode)
+	{
+		return decodeAddxSubx("subx", instructions::SUBX, opcode);
+	}
+
+	uint16_t Decoder::swap(uint16_t opcode)
+	{
+		result->mnemonic = "swap";
+		addOperand(OperandKind::DataRegister, opcode & 0b111);
+
+		return instructions::SWAP;
+	}
+
+	uint16_t Decoder::tas(uint16_t opcode)
+	{
+		result->mnemonic = "tas";
+		addEffectiveAddress(opcode & 0b111'111, Ignore);
+		return instructions::TAS;
+	}
+
+	uint16_t Decoder::trap(uint16_t opcode)
+	{
+		result->mnemonic = "trap";
+		addOperand(OperandKind::Quick, 0, opcode & 0b1111);
+
+		return instructions::TRAP;
+	}
+
+	uint16_t Decoder::trapv(uint16_t)
+	{
+		result->mnemonic = "trapv";
+		return instructions::TRAPV;
+	}
+
+	uint16_t Decoder::tst(uint16_t opcode)
+	{
+		result->mnemonic = "tst";
+		uint16_t size = (opcode >> 6) & 0b11;
+		setSize(size);
+		addEffectiveAddress(opcode & 0b111'111, size == 0b10);
+
+		return instructions::TST;
+	}
+
+	uint16_t Decoder::unlk(uint16_t opcode)
+	{
+		result->mnemonic = "unlk";
+		addOperand(OperandKind::AddressRegister, opcode & 0b111u);
+		return instructions::UNLK;
+	}
+
+	uint16_t Decoder::unknown(uint16_t opcode)
+	{
+		// $ffff ends the listings of DisAsm::dasm
+		result->mnemonic = opcode == 0xffff ? "end" : "*** unknown instruction ***";
+		return instructions::UNKNOWN;
+	}
+}
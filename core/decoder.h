@@ -0,0 +1,219 @@
+#pragma once
+#include <cstdint>
+
+#include "core.h"
+#include "decodedinstruction.h"
+
+namespace mc68000
+{
+	/// <summary>
+	/// Decodes the instructions into DecodedInstruction records, without any text.
+	/// </summary>
+	class Decoder
+	{
+	public:
+		// longest instruction, in bytes: the opcode and two extension words for each operand
+		static const uint32_t maxInstructionBytes = 10;
+
+		Decoder();
+		~Decoder();
+		Decoder(const Decoder&) = delete;
+		Decoder& operator=(const Decoder&) = delete;
+
+		/// <summary>
+		/// Decodes the instruction whose words start at code and which is located at address.
+		/// </summary>
+		/// <param name="bigEndian">true when the words are in the memory order of the 68000, false for host words</param>
+		void decode(const uint16_t* code, bool bigEndian, uint32_t address, DecodedInstruction& instruction);
+
+		/// <summary>
+		/// Decodes the instruction like decode, reading no more than bytesAvailable bytes of code: the words
+		/// past them read as 0, so the end of an image or block can be decoded in place.
+		/// </summary>
+		/// <returns>false if the instruction is longer than bytesAvailable</returns>
+		bool decode(const uint16_t* code, uint32_t bytesAvailable, bool bigEndian, uint32_t address, DecodedInstruction& instruction);
+
+		/// <summary>
+		/// Indicates if the opcode word is decoded as UNKNOWN, like the line A and line F opcodes or a JMP with a
+		/// data register, from a table of the 65536 words built once.
+		/// </summary>
+		static bool isUnknown(uint16_t opcode);
+
+	private:
+		uint16_t unknown(uint16_t);
+
+		uint16_t abcd(uint16_t);
+		uint16_t sbcd(uint16_t);
+
+		uint16_t add(uint16_t);
+		uint16_t adda(uint16_t);
+		uint16_t cmp(uint16_t);
+		uint16_t cmpa(uint16_t);
+		uint16_t sub(uint16_t);
+		uint16_t suba(uint16_t);
+		uint16_t and_(uint16_t);
+		uint16_t or_(uint16_t);
+		uint16_t eor(uint16_t);
+
+		uint16_t addi(uint16_t);
+		uint16_t andi(uint16_t);
+		uint16_t cmpi(uint16_t);
+		uint16_t eori(uint16_t);
+		uint16_t ori(uint16_t);
+		uint16_t subi(uint16_t);
+
+		uint16_t addq(uint16_t);
+		uint16_t subq(uint16_t);
+
+		uint16_t addx(uint16_t);
+		uint16_t subx(uint16_t);
+
+		uint16_t andi2ccr(uint16_t);
+		uint16_t andi2sr(uint16_t);
+
+		uint16_t asl_register(uint16_t);
+		uint16_t asl_memory(uint16_t);
+		uint16_t asr_register(uint16_t);
+		uint16_t asr_memory(uint16_t);
+
+
+		uint16_t bra(uint16_t);
+		uint16_t bhi(uint16_t);
+		uint16_t bls(uint16_t);
+		uint16_t bcc(uint16_t);
+		uint16_t bcs(uint16_t);
+		uint16_t bne(uint16_t);
+		uint16_t beq(uint16_t);
+		uint16_t bvc(uint16_t);
+		uint16_t bvs(uint16_t);
+		uint16_t bpl(uint16_t);
+		uint16_t bmi(uint16_t);
+		uint16_t bge(uint16_t);
+		uint16_t blt(uint16_t);
+		uint16_t bgt(uint16_t);
+		uint16_t ble(uint16_t);
+		uint16_t bsr(uint16_t);
+
+		uint16_t bchg_r(uint16_t);
+		uint16_t bset_r(uint16_t);
+		uint16_t bclr_r(uint16_t);
+		uint16_t bchg_i(uint16_t);
+		uint16_t bset_i(uint16_t);
+		uint16_t bclr_i(uint16_t);
+
+		uint16_t btst_r(uint16_t);
+		uint16_t btst_i(uint16_t);
+
+		uint16_t chk(uint16_t);
+
+		uint16_t clr(uint16_t);
+
+		uint16_t cmpm(uint16_t);
+
+		uint16_t dbcc(uint16_t);
+
+		uint16_t divs(uint16_t);
+		uint16_t divu(uint16_t);
+		uint16_t muls(uint16_t);
+		uint16_t mulu(uint16_t);
+
+		uint16_t eori2ccr(uint16_t);
+		uint16_t eori2sr(uint16_t);
+
+		uint16_t exg(uint16_t);
+
+		uint16_t ext(uint16_t);
+
+		uint16_t illegal(uint16_t);
+
+		uint16_t jmp(uint16_t);
+		uint16_t jsr(uint16_t);
+
+		uint16_t lea(uint16_t);
+
+		uint16_t link(uint16_t);
+
+		uint16_t lsl_register(uint16_t);
+		uint16_t lsl_memory(uint16_t);
+		uint16_t lsr_register(uint16_t);
+		uint16_t lsr_memory(uint16_t);
+
+		uint16_t move(uint16_t);
+		uint16_t movea(uint16_t);
+		uint16_t move2ccr(uint16_t);
+		uint16_t movesr(uint16_t);
+		uint16_t move2sr(uint16_t);
+		uint16_t movem(uint16_t);
+		uint16_t movep(uint16_t);
+		uint16_t moveq(uint16_t);
+
+		uint16_t nbcd(uint16_t);
+
+		uint16_t neg(uint16_t);
+		uint16_t negx(uint16_t);
+		uint16_t nop(uint16_t);
+		uint16_t not_(uint16_t);
+
+		uint16_t ori2ccr(uint16_t);
+		uint16_t ori2sr(uint16_t);
+
+		uint16_t pea(uint16_t);
+
+		uint16_t rol_register(uint16_t);
+		uint16_t ror_register(uint16_t);
+		uint16_t roxl_register(uint16_t);
+		uint16_t roxr_register(uint16_t);
+
+		uint16_t rol_memory(uint16_t);
+		uint16_t ror_memory(uint16_t);
+		uint16_t roxl_memory(uint16_t);
+		uint16_t roxr_memory(uint16_t);
+
+		uint16_t rte(uint16_t);
+		uint16_t rtr(uint16_t);
+		uint16_t rts(uint16_t);
+
+		uint16_t scc(uint16_t);
+		uint16_t stop(uint16_t);
+		uint16_t swap(uint16_t);
+		uint16_t tas(uint16_t);
+
+		uint16_t trap(uint16_t);
+		uint16_t trapv(uint16_t);
+		uint16_t tst(uint16_t);
+		uint16_t unlk(uint16_t);
+
+		using t_handler = uint16_t (Decoder::*)(uint16_t);
+		friend t_handler* setup<Decoder>();
+
+		t_handler* handlers;
+
+	private:
+		uint16_t fetchNextWord();
+		void addOperand(OperandKind kind, uint8_t reg = 0, uint32_t value = 0);
+		void addEffectiveAddress(uint16_t ea, bool isLongOperation);
+		void setSize(uint16_t size);
+		uint16_t decodeBccInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeImmediateInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeBitRegisterInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeBitImmediateInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeAddxSubx(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeMulDiv(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeShiftRotate(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeLogical(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeToCcr(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		uint16_t decodeToSr(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+
+	private:
+		// the instruction being decoded
+		const uint16_t* code = nullptr;
+		bool swapWords = false;
+		uint32_t words = 0;
+		DecodedInstruction* result = nullptr;
+
+		// effective address size options
+		const bool Ignore = false;
+		const bool AlwaysWord = false;
+		const bool AlwaysLong = true;
+	};
+}
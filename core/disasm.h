@@ -2,9 +2,12 @@
 #include <string>
 #include <iostream>
 #include <sstream>
-#include <map>
+#include <memory>
 
 #include "core.h"
+#include "decoder.h"
+#include "symboltable.h"
+#include "textbuffer.h"
 
 namespace mc68000
 {
@@ -27,209 +30,108 @@ namespace mc68000
 	class DisAsm
 	{
 	private:
-		uint16_t unknown(uint16_t);
-
-		uint16_t abcd(uint16_t);
-		uint16_t sbcd(uint16_t);
-
-		uint16_t add(uint16_t);
-		uint16_t adda(uint16_t);
-		uint16_t cmp(uint16_t);
-		uint16_t cmpa(uint16_t);
-		uint16_t sub(uint16_t);
-		uint16_t suba(uint16_t);
-		uint16_t and_(uint16_t);
-		uint16_t or_(uint16_t);
-		uint16_t eor(uint16_t);
-
-		uint16_t addi(uint16_t);
-		uint16_t andi(uint16_t);
-		uint16_t cmpi(uint16_t);
-		uint16_t eori(uint16_t);
-		uint16_t ori(uint16_t);
-		uint16_t subi(uint16_t);
-
-		uint16_t addq(uint16_t);
-		uint16_t subq(uint16_t);
-
-		uint16_t addx(uint16_t);
-		uint16_t subx(uint16_t);
-
-		uint16_t andi2ccr(uint16_t);
-		uint16_t andi2sr(uint16_t);
-
-		uint16_t asl_register(uint16_t);
-		uint16_t asl_memory(uint16_t);
-		uint16_t asr_register(uint16_t);
-		uint16_t asr_memory(uint16_t);
-
-
-		uint16_t bra(uint16_t);
-		uint16_t bhi(uint16_t);
-		uint16_t bls(uint16_t);
-		uint16_t bcc(uint16_t);
-		uint16_t bcs(uint16_t);
-		uint16_t bne(uint16_t);
-		uint16_t beq(uint16_t);
-		uint16_t bvc(uint16_t);
-		uint16_t bvs(uint16_t);
-		uint16_t bpl(uint16_t);
-		uint16_t bmi(uint16_t);
-		uint16_t bge(uint16_t);
-		uint16_t blt(uint16_t);
-		uint16_t bgt(uint16_t);
-		uint16_t ble(uint16_t);
-		uint16_t bsr(uint16_t);
-
-		uint16_t bchg_r(uint16_t);
-		uint16_t bset_r(uint16_t);
-		uint16_t bclr_r(uint16_t);
-		uint16_t bchg_i(uint16_t);
-		uint16_t bset_i(uint16_t);
-		uint16_t bclr_i(uint16_t);
-
-		uint16_t btst_r(uint16_t);
-		uint16_t btst_i(uint16_t);
-
-		uint16_t chk(uint16_t);
-
-		uint16_t clr(uint16_t);
-
-		uint16_t cmpm(uint16_t);
-
-		uint16_t dbcc(uint16_t);
-
-		uint16_t divs(uint16_t);
-		uint16_t divu(uint16_t);
-		uint16_t muls(uint16_t);
-		uint16_t mulu(uint16_t);
-
-		uint16_t eori2ccr(uint16_t);
-		uint16_t eori2sr(uint16_t);
-
-		uint16_t exg(uint16_t);
-
-		uint16_t ext(uint16_t);
-
-		uint16_t illegal(uint16_t);
-
-		uint16_t jmp(uint16_t);
-		uint16_t jsr(uint16_t);
-
-		uint16_t lea(uint16_t);
-
-		uint16_t link(uint16_t);
-
-		uint16_t lsl_register(uint16_t);
-		uint16_t lsl_memory(uint16_t);
-		uint16_t lsr_register(uint16_t);
-		uint16_t lsr_memory(uint16_t);
-
-		uint16_t move(uint16_t);
-		uint16_t movea(uint16_t);
-		uint16_t move2ccr(uint16_t);
-		uint16_t movesr(uint16_t);
-		uint16_t move2sr(uint16_t);
-		uint16_t movem(uint16_t);
-		uint16_t movep(uint16_t);
-		uint16_t moveq(uint16_t);
-
-		uint16_t nbcd(uint16_t);
-
-		uint16_t neg(uint16_t);
-		uint16_t negx(uint16_t);
-		uint16_t nop(uint16_t);
-		uint16_t not_(uint16_t);
-
-		uint16_t ori2ccr(uint16_t);
-		uint16_t ori2sr(uint16_t);
-
-		uint16_t pea(uint16_t);
-
-		uint16_t rol_register(uint16_t);
-		uint16_t ror_register(uint16_t);
-		uint16_t roxl_register(uint16_t);
-		uint16_t roxr_register(uint16_t);
-
-		uint16_t rol_memory(uint16_t);
-		uint16_t ror_memory(uint16_t);
-		uint16_t roxl_memory(uint16_t);
-		uint16_t roxr_memory(uint16_t);
-
-		uint16_t rte(uint16_t);
-		uint16_t rtr(uint16_t);
-		uint16_t rts(uint16_t);
-
-		uint16_t scc(uint16_t);
-		uint16_t stop(uint16_t);
-		uint16_t swap(uint16_t);
-		uint16_t tas(uint16_t);
-
-		uint16_t trap(uint16_t);
-		uint16_t trapv(uint16_t);
-		uint16_t tst(uint16_t);
-		uint16_t unlk(uint16_t);
-
-		using t_handler = uint16_t (DisAsm::*)(uint16_t);
-		friend t_handler* setup<DisAsm>();
-
-		t_handler* handlers;
-
-	private:
-		uint16_t fetchNextWord();
-		uint32_t fetchRelativeAddress();
-		std::string decodeEffectiveAddress(uint16_t ea, bool isLongOperation);
-		std::string registersToString(uint16_t registers, bool isPredecrement);
-		uint16_t disassembleBccInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleImmediateInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleBitRegisterInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleBitImmediateInstruction(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleAddxSubx(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleMulDiv(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleShiftRotate(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassembleLogical(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassemble2ccr(const char* instructionName, uint16_t instructionId, uint16_t opcode);
-		uint16_t disassemble2sr(const char* instructionName, uint16_t instructionId, uint16_t opcode);
+		void decodeNext(DecodedInstruction& instruction);
+		void render(const DecodedInstruction& instruction);
+		void appendOperand(const Operand& operand);
+		void appendRegisterList(uint16_t registers);
+		bool appendSymbol(uint32_t address);
 		void reset(const uint16_t* memory);
 
 	private:
+		Decoder decoder;
 		uint32_t pc = 0;
 		const uint16_t* memory = nullptr;
 		uint32_t origin = 0;
-		std::string disassembly;
+		// the text is rendered in disassembly, over line or over the buffer of the caller
+		char line[256];
+		TextBuffer disassembly{ line, sizeof(line) };
 		bool done = false;
 		bool swapMemory = false;
 
-		// DecodeEffectiveAddress size options
-		const bool Ignore = false;
-		const bool AlwaysByte = false;
-		const bool AlwaysWord = false;
-		const bool AlwaysLong = true;
-
-        // symbol table
-        std::map<uint32_t, std::string> symbolTable;
+        // symbol table, possibly shared with other DisAsm
+        std::shared_ptr<const SymbolTable> symbols = std::make_shared<const SymbolTable>();
 
 	public:
 		DisAsm();
 		DisAsm(const uint16_t* memory, uint32_t origin);
         bool loadSymbols(const char* filename);
-		~DisAsm();
 		std::string disassemble(const uint16_t*);
 		std::string disassembleInstruction(uint32_t pc);
 		std::string dasm(const uint16_t*, uint32_t org);
+
+		/// <summary>
+		/// Disassembles the instruction at code into buffer without allocating; the text is null terminated
+		/// and truncated to size - 1 characters.
+		/// </summary>
+		/// <returns>The length of the text</returns>
+		size_t disassemble(const uint16_t* code, char* buffer, size_t size);
+
+		/// <summary>
+		/// Disassembles the instruction at the address pc of the memory given to the constructor into buffer,
+		/// like disassemble.
+		/// </summary>
+		/// <returns>The length of the text</returns>
+		size_t disassembleInstruction(uint32_t pc, char* buffer, size_t size);
+
+		/// <summary>
+		/// Appends the disassembly of the code up to the end marker to arena, one instruction per line.
+		/// Reusing the same arena keeps its capacity, so listings stop allocating once it is large enough.
+		/// </summary>
+		/// <returns>The number of instructions</returns>
+		size_t dasm(const uint16_t* code, uint32_t org, std::string& arena);
+
+		/// <summary>
+		/// Appends the disassembly of the instructions starting from start up to end, in the memory given to
+		/// the constructor, like dasm. The last instruction may go past end, and its words must be readable.
+		/// </summary>
+		/// <returns>The number of instructions</returns>
+		size_t dasm(uint32_t start, uint32_t end, std::string& arena);
+
+		/// <summary>
+		/// Decodes the instruction at the address pc of the memory given to the constructor, without its text.
+		/// </summary>
+		DecodedInstruction decodeInstruction(uint32_t pc);
+
+		/// <summary>
+		/// Decodes the instruction at the address pc like decodeInstruction, reading no more than bytesAvailable
+		/// bytes of the memory; the instruction doesn't fit when its length is larger.
+		/// </summary>
+		DecodedInstruction decodeInstruction(uint32_t pc, uint32_t bytesAvailable);
+
+		/// <summary>
+		/// Writes the text of a decoded instruction into buffer, with the symbols of this DisAsm.
+		/// </summary>
+		/// <returns>The length of the text</returns>
+		size_t format(const DecodedInstruction& instruction, char* buffer, size_t size);
+
         uint32_t getPc() const { return pc; }
-        void addSymbol(uint32_t address, const std::string& name)
+
+        /// <summary>
+        /// Adds a label to a copy of the table, which is fine for a few labels; many are better added to a
+        /// SymbolTable given to setSymbols.
+        /// </summary>
+        void addSymbol(uint32_t address, const std::string& name);
+
+        void setSymbols(std::shared_ptr<const SymbolTable> table)
         {
-            symbolTable[address] = name;
+            symbols = table ? std::move(table) : std::make_shared<const SymbolTable>();
         }
-        std::string findSymbol(uint32_t address)
+        const std::shared_ptr<const SymbolTable>& getSymbols() const
+        {
+            return symbols;
+        }
+        std::string findSymbol(uint32_t address) const
+        {
+            size_t index = symbols->find(address);
+            return index != SymbolTable::npos ? std::string(symbols->getName(index)) : std::string();
+        }
+
+        /// <summary>
+        /// Label at address or closest before it with the offset, like START+0x12, for the traces.
+        /// </summary>
+        std::string findLocation(uint32_t address) const
         {
-            auto it = symbolTable.find(address);
-            if (it != symbolTable.end())
-            {
-                return it->second;
-            }
-            return std::string();
+            return symbols->locate(address);
         }
 	};
 }
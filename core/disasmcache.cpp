@@ -0,0 +1,33 @@
+#include "disasmcache.h"
+
+using namespace mc68000;
+
+DisAsmCache::DisAsmCache(Memory& memory, DisAsm& disAsm) :
+    memory(memory),
+    disAsm(disAsm)
+{
+}
+
+const std::string& DisAsmCache::disassemble(uint32_t pc)
+{
+    Entry& entry = entries[pc];
+    // a new entry has no text, an instruction always has some
+    if (!entry.text.empty() && memory.getGeneration(pc) == entry.firstGeneration &&
+        memory.getGeneration(entry.last) == entry.lastGeneration)
+    {
+        return entry.text;
+    }
+
+    misses++;
+    char line[256];
+    DecodedInstruction instruction = disAsm.decodeInstruction(pc);
+    size_t length = disAsm.format(instruction, line, sizeof(line));
+    uint32_t bytes = instruction.length * 2u;
+    // marked before the generations are read, the writes from now on change them
+    memory.markCode(pc, bytes);
+    entry.text.assign(line, length);
+    entry.last = pc + bytes - 1;
+    entry.firstGeneration = memory.getGeneration(pc);
+    entry.lastGeneration = memory.getGeneration(entry.last);
+    return entry.text;
+}
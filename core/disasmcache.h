@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "disasm.h"
+#include "memory.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Text of the instructions by address for the traces of the debugger, which disassemble the same loops
+    /// over and over: each instruction is disassembled the first time it is seen and again only when the guest
+    /// writes to its words. The pages of the cached instructions are marked as code in the memory, and an entry
+    /// is stale once the generation of one of its pages has changed.
+    /// </summary>
+    class DisAsmCache
+    {
+    public:
+        /// <summary>
+        /// disAsm must disassemble memory; its symbols are part of the text, so the cache is cleared when
+        /// they change.
+        /// </summary>
+        DisAsmCache(Memory& memory, DisAsm& disAsm);
+
+        /// <summary>
+        /// Text of the instruction at pc, valid until the cache is cleared or the instruction disassembled again.
+        /// </summary>
+        const std::string& disassemble(uint32_t pc);
+
+        void clear() { entries.clear(); }
+        size_t size() const { return entries.size(); }
+
+        /// <summary>
+        /// Number of instructions actually disassembled, the first time or after a write.
+        /// </summary>
+        uint64_t getMisses() const { return misses; }
+
+    private:
+        struct Entry
+        {
+            std::string text;
+            uint32_t last;                  // address of the last byte of the instruction
+            uint32_t firstGeneration;       // generations of the pages of the first and last bytes
+            uint32_t lastGeneration;
+        };
+
+        Memory& memory;
+        DisAsm& disAsm;
+        std::unordered_map<uint32_t, Entry> entries;
+        uint64_t misses = 0;
+    };
+}
@@ -0,0 +1,153 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "imagefile.h"
+
+using namespace mc68000;
+
+#ifdef _WIN32
+
+ImageFile::ImageFile(const std::string& fileName, bool raw, uint32_t rawBase)
+{
+    std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+    if (!f)
+    {
+        std::cerr << "ImageFile error: failed to open " << fileName << std::endl;
+        throw std::string("failed to open image file");
+    }
+    content.resize(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(content.data()), content.size());
+    data = content.data();
+    size = content.size();
+    parse(raw, rawBase);
+}
+
+ImageFile::~ImageFile()
+{
+}
+
+void ImageFile::release()
+{
+}
+
+#else
+
+ImageFile::ImageFile(const std::string& fileName, bool raw, uint32_t rawBase)
+{
+    fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) != 0)
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        std::cerr << "ImageFile error: failed to open " << fileName << std::endl;
+        throw std::string("failed to open image file");
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    if (size != 0)
+    {
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            std::cerr << "ImageFile error: failed to map " << fileName << std::endl;
+            throw std::string("failed to map image file");
+        }
+        // the tools read the image once from start to end
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t*>(p);
+    }
+    try
+    {
+        parse(raw, rawBase);
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+ImageFile::~ImageFile()
+{
+    release();
+}
+
+void ImageFile::release()
+{
+    if (data)
+    {
+        munmap(const_cast<uint8_t*>(data), size);
+        data = nullptr;
+    }
+    if (fd != -1)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+#endif
+
+/// <summary>
+/// Finds the blocks: magic number, start, lowest and highest memory addresses and number of blocks,
+/// then for each block its size in bytes, its address and its code, all in the byte order of the host.
+/// </summary>
+void ImageFile::parse(bool raw, uint32_t rawBase)
+{
+    auto read32 = [this](uint64_t offset)
+    {
+        uint32_t value;
+        memcpy(&value, data + offset, sizeof(value));
+        return value;
+    };
+
+    const uint64_t headerSize = 5 * sizeof(uint32_t);
+    if (raw || size < headerSize || read32(0) != magicNumber)
+    {
+        start = rawBase;
+        if (size != 0)
+        {
+            if (size > UINT32_MAX)
+            {
+                throw std::string("image file too large");
+            }
+            blocks.push_back({ rawBase, data, static_cast<uint32_t>(size & ~1ull) });
+        }
+        return;
+    }
+
+    header = true;
+    start = read32(4);
+    memoryStart = read32(8);
+    memoryEnd = read32(12);
+    uint32_t blocksCount = read32(16);
+    uint64_t offset = headerSize;
+    for (uint32_t i = 0; i < blocksCount; i++)
+    {
+        if (offset + 2 * sizeof(uint32_t) > size)
+        {
+            throw std::string("truncated image file");
+        }
+        uint32_t codeSize = read32(offset);
+        uint32_t codeAddress = read32(offset + 4);
+        offset += 2 * sizeof(uint32_t);
+        if (offset + codeSize > size)
+        {
+            throw std::string("truncated image file");
+        }
+        blocks.push_back({ codeAddress, data + offset, codeSize & ~1u });
+        offset += codeSize;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mc68000
+{
+    /// <summary>
+    /// Code at an address in an ImageFile, the bytes are in the memory order of the 68000.
+    /// </summary>
+    struct ImageBlock
+    {
+        uint32_t address;
+        const uint8_t* data;
+        uint32_t size;
+    };
+
+    /// <summary>
+    /// Program file opened read only for the tools, without loading it in a Memory: the file is memory mapped
+    /// when the platform allows it, so images larger than the memory are paged in as they are read.
+    /// A file with the header written by the assembler gives its blocks, any other file is one raw block.
+    /// </summary>
+    class ImageFile
+    {
+    public:
+        static const uint32_t magicNumber = 0x69344059;
+
+        /// <summary>
+        /// Opens the file, throws a std::string when it cannot be read or its header is invalid.
+        /// </summary>
+        /// <param name="raw">Ignore the header, the whole file is code</param>
+        /// <param name="rawBase">Address of the code of a raw file</param>
+        ImageFile(const std::string& fileName, bool raw = false, uint32_t rawBase = 0);
+        ImageFile(const ImageFile&) = delete;
+        ImageFile& operator=(const ImageFile&) = delete;
+        ~ImageFile();
+
+        const std::vector<ImageBlock>& getBlocks() const { return blocks; }
+        bool hasHeader() const { return header; }
+
+        /// <summary>
+        /// Start of execution given by the header, the base of a raw file.
+        /// </summary>
+        uint32_t getStart() const { return start; }
+
+        /// <summary>
+        /// Lowest and highest addresses of the MEMORY directive given by the header, both 0 without it.
+        /// </summary>
+        uint32_t getMemoryStart() const { return memoryStart; }
+        uint32_t getMemoryEnd() const { return memoryEnd; }
+
+    private:
+        void parse(bool raw, uint32_t rawBase);
+        void release();
+
+    private:
+        const uint8_t* data = nullptr;
+        uint64_t size = 0;
+        std::vector<ImageBlock> blocks;
+        bool header = false;
+        uint32_t start = 0;
+        uint32_t memoryStart = 0;
+        uint32_t memoryEnd = 0;
+#ifdef _WIN32
+        std::vector<uint8_t> content;
+#else
+        int fd = -1;
+#endif
+    };
+}
@@ -169,6 +169,7 @@ namespace mc68000
             names[EOR] = L"EOR";
             names[EORI] = L"EORI";
             names[EORI2CCR] = L"EORI2CCR";
+            names[EORI2SR] = L"EORI2SR";
             names[EXG] = L"EXG";
             names[EXT] = L"EXT";
             names[EXTB] = L"EXTB";
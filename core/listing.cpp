@@ -0,0 +1,127 @@
+#include <algorithm>
+
+#include "listing.h"
+#include "disasm.h"
+#include "textbuffer.h"
+
+using namespace mc68000;
+
+namespace
+{
+    // room left in the buffer for each line: address, words, label or text of the longest instruction
+    const size_t maxLineSize = 512;
+
+    // the text starts after the address and the room for five words
+    const size_t textColumn = 8 + 2 + 5 * 5;
+
+    void appendHex(TextBuffer& text, uint32_t value, int digits)
+    {
+        char hex[8];
+        for (int i = digits - 1; i >= 0; i--, value >>= 4)
+        {
+            hex[i] = "0123456789abcdef"[value & 0xf];
+        }
+        text.append(hex, digits);
+    }
+}
+
+Listing::Listing(std::ostream& out, size_t bufferSize) :
+    out(out),
+    buffer(std::max(bufferSize, 2 * maxLineSize))
+{
+}
+
+Listing::~Listing()
+{
+    flush();
+}
+
+void Listing::flush()
+{
+    out.write(buffer.data(), used);
+    used = 0;
+}
+
+/// <summary>
+/// Makes room for one more line, at the end of the buffer.
+/// </summary>
+char* Listing::reserveLine()
+{
+    if (buffer.size() - used < maxLineSize)
+    {
+        flush();
+    }
+    return buffer.data() + used;
+}
+
+void Listing::writeLabel(uint32_t address)
+{
+    if (!symbols)
+    {
+        return;
+    }
+    size_t index = symbols->find(address);
+    if (index != SymbolTable::npos)
+    {
+        TextBuffer line(reserveLine(), maxLineSize);
+        line += symbols->getName(index);
+        line += ":\n";
+        used += line.length();
+    }
+}
+
+/// <summary>
+/// Writes the line of count words at address with their text.
+/// </summary>
+void Listing::writeWords(uint32_t address, const uint8_t* words, uint32_t count, const char* text, size_t length)
+{
+    TextBuffer line(reserveLine(), maxLineSize);
+    appendHex(line, address, 8);
+    line += "  ";
+    for (uint32_t i = 0; i < count; i++)
+    {
+        appendHex(line, (words[2 * i] << 8) | words[2 * i + 1], 4);
+        line += ' ';
+    }
+    while (line.length() < textColumn)
+    {
+        line += ' ';
+    }
+    line.append(text, length);
+    line += '\n';
+    used += line.length();
+}
+
+uint64_t Listing::write(const ImageBlock& block, uint32_t from, uint32_t to)
+{
+    uint32_t blockEnd = block.address + block.size;
+    uint32_t address = std::max(from, block.address);
+    uint32_t end = std::min(to, blockEnd);
+    address += (address - block.address) & 1;
+
+    DisAsm disAsm(reinterpret_cast<const uint16_t*>(block.data), block.address);
+    disAsm.setSymbols(symbols);
+    char text[256];
+    uint64_t count = 0;
+
+    // the decoder reads no more than the bytes left in the block
+    while (address < end)
+    {
+        const uint8_t* words = block.data + (address - block.address);
+        DecodedInstruction instruction = disAsm.decodeInstruction(address, blockEnd - address);
+        writeLabel(address);
+        if (address + instruction.length * 2 > blockEnd)
+        {
+            TextBuffer data(text, sizeof(text));
+            data += "dc.w $";
+            data.appendHex((words[0] << 8) | words[1]);
+            writeWords(address, words, 1, data.c_str(), data.length());
+            address += 2;
+            continue;
+        }
+        writeWords(address, words, instruction.length, text, disAsm.format(instruction, text, sizeof(text)));
+        address += instruction.length * 2;
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "imagefile.h"
+#include "symboltable.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Streams the disassembly of image blocks to an output, one line per instruction with its address, its
+    /// words and its text, and a line for each label. The lines are written in a large buffer handed to the
+    /// output when full, so the listing of an image of any size never builds in memory.
+    /// </summary>
+    class Listing
+    {
+    public:
+        Listing(std::ostream& out, size_t bufferSize = 1 << 20);
+        Listing(const Listing&) = delete;
+        Listing& operator=(const Listing&) = delete;
+        ~Listing();
+
+        void setSymbols(std::shared_ptr<const SymbolTable> table) { symbols = std::move(table); }
+
+        /// <summary>
+        /// Writes the instructions of block starting from from up to to, clamped to the block. The words at the
+        /// end of the block that do not make a whole instruction are written as dc.w.
+        /// </summary>
+        /// <returns>The number of instructions</returns>
+        uint64_t write(const ImageBlock& block, uint32_t from = 0, uint32_t to = UINT32_MAX);
+
+        /// <summary>
+        /// Hands the lines in the buffer to the output.
+        /// </summary>
+        void flush();
+
+    private:
+        char* reserveLine();
+        void writeLabel(uint32_t address);
+        void writeWords(uint32_t address, const uint8_t* words, uint32_t count, const char* text, size_t length);
+
+        std::ostream& out;
+        std::vector<char> buffer;
+        size_t used = 0;
+        std::shared_ptr<const SymbolTable> symbols;
+    };
+}
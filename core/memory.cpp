@@ -4,14 +4,20 @@ namespace mc68000
 {
 	template<> uint8_t Memory::get<uint8_t>(uint32_t address) const
 	{
-		verifyAddress(address, sizeof(uint8_t));
+		if (!verifyAddress(address, sizeof(uint8_t), false))
+		{
+			return 0;
+		}
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		return *(p8 + 0); // TODO: why was it +1
 	}
 
 	template<> uint16_t Memory::get<uint16_t>(uint32_t address) const
 	{
-		verifyAddress(address, sizeof(uint16_t));
+		if (!verifyAddress(address, sizeof(uint16_t), false))
+		{
+			return 0;
+		}
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		uint16_t word = (*p8 << 8) | *(p8 + 1);
 		return word;
@@ -19,7 +25,10 @@ namespace mc68000
 
 	template<> uint32_t Memory::get<uint32_t>(uint32_t address) const
 	{
-		verifyAddress(address, sizeof(uint32_t));
+		if (!verifyAddress(address, sizeof(uint32_t), false))
+		{
+			return 0;
+		}
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		uint32_t longWord = (*p8 << 24) | (*(p8 + 1) << 16) | (*(p8 + 2) << 8) | *(p8 + 3);
 		return longWord;
@@ -27,21 +36,32 @@ namespace mc68000
 
 	template<> void* Memory::get<void*>(uint32_t address) const
 	{
-		verifyAddress(address, 0);
+		if (!verifyAddress(address, 0, false))
+		{
+			return nullptr;
+		}
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		return p8;
 	}
 
 	template<> void Memory::set<uint8_t>(uint32_t address, uint8_t data)
 	{
-		verifyAddress(address, sizeof(uint8_t));
+		if (!verifyAddress(address, sizeof(uint8_t), true))
+		{
+			return;
+		}
+		noteWrite(address, sizeof(uint8_t));
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		*p8 = data;
 	}
 
 	template<> void Memory::set<uint16_t>(uint32_t address, uint16_t data)
 	{
-		verifyAddress(address, sizeof(uint16_t));
+		if (!verifyAddress(address, sizeof(uint16_t), true))
+		{
+			return;
+		}
+		noteWrite(address, sizeof(uint16_t));
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		*p8++ = data >> 8;
 		*p8 = data & 0xff;
@@ -49,7 +69,11 @@ namespace mc68000
 
 	template<> void Memory::set<uint32_t>(uint32_t address, uint32_t data)
 	{
-		verifyAddress(address, sizeof(uint32_t));
+		if (!verifyAddress(address, sizeof(uint32_t), true))
+		{
+			return;
+		}
+		noteWrite(address, sizeof(uint32_t));
 		uint8_t* p8 = rawMemory + (address - baseAddress);
 		*p8++ = (data >> 24) & 0xff;
 		*p8++ = (data >> 16) & 0xff;
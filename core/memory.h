@@ -3,9 +3,20 @@
 #include <stddef.h>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 namespace mc68000
 {
+	/// <summary>
+	/// First failed access since the fault was last cleared.
+	/// </summary>
+	struct MemoryFault
+	{
+		uint32_t address = 0;
+		bool write = false;
+		bool misaligned = false;    // word or long access to an odd address (address error)
+	};
+
 	class Memory
 	{
 	public:
@@ -128,7 +139,9 @@ namespace mc68000
 		Memory(const Memory& rhs) :
 			rawMemory(nullptr),
 			size(rhs.size),
-			baseAddress(rhs.baseAddress)
+			baseAddress(rhs.baseAddress),
+			codePages(rhs.codePages),
+			generations(rhs.generations)
 		{
 			if (size)
 			{
@@ -144,8 +157,11 @@ namespace mc68000
 
 		Memory& operator=(const Memory& rhs)
 		{
+			faulted = false;
 			size = rhs.size;
 			baseAddress = rhs.baseAddress;
+			codePages = rhs.codePages;
+			generations = rhs.generations;
 			delete[] rawMemory;
 
 			if (size)
@@ -176,6 +192,10 @@ namespace mc68000
 
 		uint16_t getWord(uint32_t address)
 		{
+			if (!verifyAddress(address, sizeof(uint16_t), false))
+			{
+				return 0;
+			}
 			uint8_t* p8 = rawMemory + (address - baseAddress);
 
 			uint16_t word = (*p8 << 8) | *(p8 + 1);
@@ -183,28 +203,139 @@ namespace mc68000
 			return word;
 		}
 
+		/// <summary>
+		/// Indicates if an access failed, outside the memory or misaligned, since the last call to clearFault.
+		/// Failed reads return 0 and failed writes are ignored so the CPU only checks this between instructions.
+		/// </summary>
+		bool hasFault() const
+		{
+			return faulted;
+		}
+
+		MemoryFault clearFault()
+		{
+			faulted = false;
+			return fault;
+		}
+
         std::pair<uint32_t, uint32_t> getMemoryRange() const
 		{
 			return { baseAddress, size };
 		}
 
+		//
+		// code tracking for the caches of decoded code: a cache marks the pages it decoded with markCode and
+		// remembers their generation. A write to a marked page increments its generation and unmarks it, so
+		// what was decoded from it is stale and the next writes to the page are plain data writes again.
+		// Nothing is tracked, and the writes only test one pointer, until a page is marked.
+		//
+		static const uint32_t pageShift = 8;	// 256 byte pages
+
+		/// <summary>
+		/// Marks the pages of the length bytes at address as holding cached code.
+		/// </summary>
+		void markCode(uint32_t address, uint32_t length)
+		{
+			uint32_t offset = address - baseAddress;
+			if (length == 0 || offset >= size)
+			{
+				return;
+			}
+			if (codePages.empty())
+			{
+				uint32_t pages = (size >> pageShift) + 1;
+				codePages.resize((pages + 63) / 64);
+				generations.resize(pages);
+			}
+			uint32_t last = (length > size - offset) ? size - 1 : offset + length - 1;
+			for (uint32_t page = offset >> pageShift; page <= (last >> pageShift); page++)
+			{
+				codePages[page / 64] |= uint64_t(1) << (page % 64);
+			}
+		}
+
+		bool isCode(uint32_t address) const
+		{
+			uint32_t page = (address - baseAddress) >> pageShift;
+			return page / 64 < codePages.size() && (codePages[page / 64] >> (page % 64)) & 1;
+		}
+
+		/// <summary>
+		/// Number of writes to the page of address since it first held cached code.
+		/// </summary>
+		uint32_t getGeneration(uint32_t address) const
+		{
+			uint32_t page = (address - baseAddress) >> pageShift;
+			return page < generations.size() ? generations[page] : 0;
+		}
+
+		/// <summary>
+		/// Invalidates the code pages among the length bytes written at address. Called by set; host code
+		/// writing into the guest memory through get&lt;void*&gt; must call it too.
+		/// </summary>
+		void noteWrite(uint32_t address, uint32_t length) const
+		{
+			if (codePages.empty())
+			{
+				return;
+			}
+			uint32_t offset = address - baseAddress;
+			if (length == 0 || offset >= size)
+			{
+				return;
+			}
+			uint32_t last = (length > size - offset) ? size - 1 : offset + length - 1;
+			for (uint32_t page = offset >> pageShift; page <= (last >> pageShift); page++)
+			{
+				uint64_t bit = uint64_t(1) << (page % 64);
+				if (codePages[page / 64] & bit)
+				{
+					codePages[page / 64] &= ~bit;
+					generations[page]++;
+				}
+			}
+		}
+
 		~Memory()
 		{
 			delete[] rawMemory;
 		}
 
 	private:
-		void verifyAddress(uint32_t address, uint32_t size) const
+		bool verifyAddress(uint32_t address, uint32_t size, bool write) const
+		{
+			// one test for both faults: the offset is out of range (it wraps below the base address)
+			// or a word or long access is at an odd address; size is a constant once inlined
+			uint64_t offset = static_cast<uint32_t>(address - baseAddress);
+			uint32_t alignmentMask = size > 1 ? 1 : 0;
+			if ((offset + size > this->size) | ((address & alignmentMask) != 0))
+			{
+				latchFault(address, write, (address & alignmentMask) != 0);
+				return false;
+			}
+			return true;
+		}
+
+		void latchFault(uint32_t address, bool write, bool misaligned) const
 		{
-			if (address < baseAddress || address > (baseAddress + this->size) || (address + size) >(baseAddress + this->size))
+			// keep the first fault, it is the one the instruction stopped on
+			if (!faulted)
 			{
-				throw "memory:verifyAddress: illegal address";
+				faulted = true;
+				fault.address = address;
+				fault.write = write;
+				fault.misaligned = misaligned;
 			}
 		}
 	private:
 		uint8_t* rawMemory = nullptr;
 		uint32_t size = 0;
 		uint32_t baseAddress = 0;
+		mutable bool faulted = false;
+		mutable MemoryFault fault;
+		// host code writes through the const view the Cpu gives, like the fault latch the tracking is mutable
+		mutable std::vector<uint64_t> codePages;	// one bit per page
+		mutable std::vector<uint32_t> generations;	// one counter per page
 	};
 
 	template<> uint8_t Memory::get<uint8_t>(uint32_t address) const;
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include "memory.h"
+
+namespace mc68000
+{
+    class Cpu;
+
+    /// <summary>
+    /// Host implementation of a guest subroutine, registered with Cpu::registerNativeRoutine at the address
+    /// of its first instruction. When a JSR or BSR reaches that address, execute is called with the return
+    /// address already pushed; it applies the registers, condition codes and memory effects the guest code
+    /// would have had up to its RTS, which the Cpu then performs.
+    /// </summary>
+    class NativeRoutine
+    {
+    public:
+        virtual ~NativeRoutine() = default;
+        virtual const char* name() const = 0;
+
+        /// <summary>
+        /// Runs the routine. An input the routine does not handle, such as an access outside the memory,
+        /// must return false without changing anything: the guest code runs instead.
+        /// </summary>
+        virtual bool execute(Cpu& cpu, Memory& memory) = 0;
+    };
+}
@@ -161,7 +161,7 @@ namespace mc68000
 
 		~NoOpCpu()
 		{
-			delete handlers;
+			delete[] handlers;
 		}
 
 		int operator()(uint16_t opcode)
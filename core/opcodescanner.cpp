@@ -0,0 +1,220 @@
+#include <algorithm>
+#include "opcodescanner.h"
+#include "instructions.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OPCODESCANNER_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace mc68000;
+
+namespace
+{
+    struct Pattern
+    {
+        uint32_t classes;
+        uint16_t mask;
+        uint16_t value;
+    };
+
+    const Pattern patterns[] = {
+        { BranchOpcodes, 0xf000, 0x6000 },      // Bcc, BRA, BSR
+        { BranchOpcodes, 0xf0f8, 0x50c8 },      // DBcc
+        { JumpOpcodes, 0xff80, 0x4e80 },        // JSR 4e80-4ebf, JMP 4ec0-4eff
+        { TrapOpcodes, 0xfff0, 0x4e40 },
+        { IllegalOpcodes, 0xffff, 0x4afc },     // the other illegal opcodes are in the table of the Decoder
+    };
+    const size_t maxPatterns = sizeof(patterns) / sizeof(patterns[0]);
+
+    /// <summary>
+    /// Patterns of the classes, returns their number.
+    /// </summary>
+    size_t selectPatterns(uint32_t classes, Pattern* selected)
+    {
+        size_t count = 0;
+        for (const auto& pattern : patterns)
+        {
+            if (pattern.classes & classes)
+            {
+                selected[count++] = pattern;
+            }
+        }
+        return count;
+    }
+
+    bool matches(const Pattern* selected, size_t count, uint16_t opcode)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if ((opcode & selected[i].mask) == selected[i].value)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+#ifdef OPCODESCANNER_SSE2
+    uint16_t swapBytes(uint16_t value)
+    {
+        return static_cast<uint16_t>((value >> 8) | (value << 8));
+    }
+
+    /// <summary>
+    /// Index of the lowest set bit, bits isn't 0.
+    /// </summary>
+    uint32_t lowestBit(uint32_t bits)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, bits);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctz(bits));
+#endif
+    }
+
+    /// <summary>
+    /// Scans the 16 byte groups of the image, returns the offset where the words left start.
+    /// The words are loaded in the order of the host, so the masks and values are swapped instead of the words.
+    /// </summary>
+    uint32_t scanVectors(const uint8_t* image, uint32_t size, const Pattern* selected, size_t count,
+        uint32_t base, std::vector<uint32_t>& addresses)
+    {
+        __m128i masks[maxPatterns];
+        __m128i values[maxPatterns];
+        for (size_t i = 0; i < count; i++)
+        {
+            masks[i] = _mm_set1_epi16(static_cast<short>(swapBytes(selected[i].mask)));
+            values[i] = _mm_set1_epi16(static_cast<short>(swapBytes(selected[i].value)));
+        }
+        uint32_t offset = 0;
+        for (; offset + 16 <= size; offset += 16)
+        {
+            __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(image + offset));
+            __m128i hits = _mm_setzero_si128();
+            for (size_t i = 0; i < count; i++)
+            {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi16(_mm_and_si128(words, masks[i]), values[i]));
+            }
+            // two bits per word, the words without a match are the common case
+            uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            while (bits)
+            {
+                uint32_t byte = lowestBit(bits);
+                addresses.push_back(base + offset + byte);
+                bits &= ~(3u << byte);
+            }
+        }
+        return offset;
+    }
+#endif
+}
+
+OpcodeScanner::OpcodeScanner(const uint8_t* image, uint32_t base, uint32_t size) :
+    image(image),
+    base(base),
+    size(size & ~1u)
+{
+}
+
+bool OpcodeScanner::isVectorized()
+{
+#ifdef OPCODESCANNER_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<uint32_t> OpcodeScanner::findCandidates(uint32_t classes) const
+{
+    std::vector<uint32_t> addresses;
+    Pattern selected[maxPatterns];
+    size_t count = selectPatterns(classes, selected);
+    bool unknown = (classes & IllegalOpcodes) != 0;
+    if (count == 0 && !unknown)
+    {
+        return addresses;
+    }
+    uint32_t offset = 0;
+#ifdef OPCODESCANNER_SSE2
+    offset = scanVectors(image, size, selected, count, base, addresses);
+#endif
+    for (; offset < size; offset += 2)
+    {
+        uint16_t opcode = static_cast<uint16_t>((image[offset] << 8) | image[offset + 1]);
+        if (matches(selected, count, opcode))
+        {
+            addresses.push_back(base + offset);
+        }
+    }
+    if (unknown)
+    {
+        // the table of the Decoder has no mask form, its words are merged in address order
+        size_t patternHits = addresses.size();
+        for (offset = 0; offset < size; offset += 2)
+        {
+            uint16_t opcode = static_cast<uint16_t>((image[offset] << 8) | image[offset + 1]);
+            if (Decoder::isUnknown(opcode) && !matches(selected, count, opcode))
+            {
+                addresses.push_back(base + offset);
+            }
+        }
+        std::inplace_merge(addresses.begin(), addresses.begin() + patternHits, addresses.end());
+    }
+    return addresses;
+}
+
+std::vector<uint32_t> OpcodeScanner::find(uint32_t classes)
+{
+    std::vector<uint32_t> addresses = findCandidates(classes);
+    size_t kept = 0;
+    for (uint32_t address : addresses)
+    {
+        if (confirm(address, classes))
+        {
+            addresses[kept++] = address;
+        }
+    }
+    addresses.resize(kept);
+    return addresses;
+}
+
+/// <summary>
+/// Decodes the candidate at address, true if it is an instruction of the classes which fits in the image.
+/// </summary>
+bool OpcodeScanner::confirm(uint32_t address, uint32_t classes)
+{
+    uint32_t offset = address - base;
+    DecodedInstruction instruction;
+    if (!decoder.decode(reinterpret_cast<const uint16_t*>(image + offset), size - offset, true, address, instruction))
+    {
+        return false;
+    }
+
+    switch (instruction.instruction)
+    {
+    case instructions::BRA:
+    case instructions::BSR:
+    case instructions::DBCC:
+        return (classes & BranchOpcodes) != 0;
+    case instructions::JMP:
+    case instructions::JSR:
+        return (classes & JumpOpcodes) != 0;
+    case instructions::TRAP:
+        return (classes & TrapOpcodes) != 0;
+    case instructions::ILLEGAL:
+        return (classes & IllegalOpcodes) != 0;
+    case instructions::UNKNOWN:
+        // the 68000 raises an illegal instruction or a line A or line F exception for them
+        return (classes & IllegalOpcodes) != 0;
+    default:
+        // Bcc
+        return (classes & BranchOpcodes) != 0 && instruction.operands[0].kind == OperandKind::BranchTarget;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "decoder.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Kinds of instructions an image can be scanned for, combined as flags.
+    /// </summary>
+    enum OpcodeClass : uint32_t
+    {
+        BranchOpcodes = 1,              // Bcc, BRA, BSR and DBcc
+        JumpOpcodes = 2,                // JMP and JSR
+        TrapOpcodes = 4,                // TRAP #n
+        IllegalOpcodes = 8,             // ILLEGAL and the words the decoder doesn't know, line A and line F included
+    };
+
+    /// <summary>
+    /// Finds the instructions of some kinds in a whole image without decoding every word: the opcode words are
+    /// compared to the bit patterns of the kinds, 8 words at a time with SSE2 where available, or looked up one at
+    /// a time in the table of the unknown opcodes of the Decoder for IllegalOpcodes, and only the candidates are
+    /// decoded to confirm them. Every word is a candidate, not only the starts of the
+    /// instructions, so the results include the extension words and data that look like these opcodes;
+    /// ControlFlowGraph tells which ones are instructions.
+    /// </summary>
+    class OpcodeScanner
+    {
+    public:
+        /// <summary>
+        /// The image is in the memory order of the 68000 and is not copied.
+        /// </summary>
+        OpcodeScanner(const uint8_t* image, uint32_t base, uint32_t size);
+
+        /// <summary>
+        /// Addresses of the words whose bits match one of the classes, in increasing order.
+        /// </summary>
+        std::vector<uint32_t> findCandidates(uint32_t classes) const;
+
+        /// <summary>
+        /// Addresses of the candidates that the decoder confirms as instructions of the classes, which fit in
+        /// the image.
+        /// </summary>
+        std::vector<uint32_t> find(uint32_t classes);
+
+        /// <summary>
+        /// Indicates if the words are compared with SIMD instructions in this build.
+        /// </summary>
+        static bool isVectorized();
+
+    private:
+        bool confirm(uint32_t address, uint32_t classes);
+
+        const uint8_t* image;
+        uint32_t base;
+        uint32_t size;
+        Decoder decoder;
+    };
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "paralleldisasm.h"
+#include "disasm.h"
+
+using namespace mc68000;
+
+namespace
+{
+    // ranges per thread, so the threads that end first take the remaining ones
+    const unsigned rangesPerThread = 8;
+}
+
+ParallelDisAsm::ParallelDisAsm(const uint16_t* image, uint32_t base, uint32_t size) :
+    image(image),
+    base(base),
+    size(size & ~1u)
+{
+}
+
+void ParallelDisAsm::addBoundary(uint32_t address)
+{
+    if ((address & 1) == 0 && address - base < size)
+    {
+        boundaries.push_back(address);
+    }
+}
+
+void ParallelDisAsm::setSymbols(std::shared_ptr<const SymbolTable> symbols)
+{
+    this->symbols = std::move(symbols);
+}
+
+/// <summary>
+/// Cuts the image at the boundaries into ranges of about the same size.
+/// </summary>
+std::vector<ParallelDisAsm::Range> ParallelDisAsm::split(unsigned threadCount) const
+{
+    std::vector<uint32_t> cuts(boundaries);
+    std::sort(cuts.begin(), cuts.end());
+    uint32_t rangeSize = std::max(size / (threadCount * rangesPerThread), 2u);
+
+    std::vector<Range> ranges;
+    uint32_t start = base;
+    for (uint32_t cut : cuts)
+    {
+        if (cut - start >= rangeSize)
+        {
+            ranges.push_back({ start, cut });
+            start = cut;
+        }
+    }
+    if (start - base < size)
+    {
+        ranges.push_back({ start, base + size });
+    }
+    return ranges;
+}
+
+/// <summary>
+/// Disassembles the instructions starting in range; the ones near the end of the image are decoded
+/// with the bytes left so the decoder never reads past it.
+/// </summary>
+size_t ParallelDisAsm::disassembleRange(DisAsm& disAsm, const Range& range, std::string& text) const
+{
+    uint32_t imageEnd = base + size;
+    uint32_t lastSafe = size >= Decoder::maxInstructionBytes ? imageEnd - Decoder::maxInstructionBytes + 2 : base;
+    size_t count = 0;
+    uint32_t address = range.start;
+    if (address < lastSafe)
+    {
+        count = disAsm.dasm(address, std::min(range.end, lastSafe), text);
+        address = base + disAsm.getPc() * 2;
+    }
+    if (address >= range.end || address >= imageEnd)
+    {
+        return count;
+    }
+
+    char line[256];
+    while (address < range.end)
+    {
+        DecodedInstruction instruction = disAsm.decodeInstruction(address, imageEnd - address);
+        if (address + instruction.length * 2 > imageEnd)
+        {
+            break;
+        }
+        text.append(line, disAsm.format(instruction, line, sizeof(line)));
+        text += '\n';
+        address += instruction.length * 2;
+        count++;
+    }
+    return count;
+}
+
+size_t ParallelDisAsm::disassemble(std::string& output)
+{
+    unsigned threadCount = threads ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<Range> ranges = split(threadCount);
+    std::vector<std::string> texts(ranges.size());
+    std::vector<size_t> counts(ranges.size());
+    std::atomic<size_t> next = 0;
+
+    auto work = [&]()
+    {
+        DisAsm disAsm(image, base);
+        disAsm.setSymbols(symbols);
+        for (size_t index = next++; index < ranges.size(); index = next++)
+        {
+            counts[index] = disassembleRange(disAsm, ranges[index], texts[index]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < std::min<size_t>(threadCount, ranges.size()); i++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    size_t length = 0;
+    size_t count = 0;
+    for (size_t index = 0; index < ranges.size(); index++)
+    {
+        length += texts[index].size();
+        count += counts[index];
+    }
+    output.reserve(output.size() + length);
+    for (const auto& text : texts)
+    {
+        output += text;
+    }
+    return count;
+}
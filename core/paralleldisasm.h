@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "symboltable.h"
+
+namespace mc68000
+{
+    class DisAsm;
+
+    /// <summary>
+    /// Disassembles a large image on several threads. The image is cut at the boundaries, which must be
+    /// addresses where an instruction starts, like the starts of the basic blocks or the symbols of the code,
+    /// so the ranges are independent. Each thread has its own DisAsm and the text of the ranges is merged
+    /// in address order, the same as a single linear disassembly of the image.
+    /// </summary>
+    class ParallelDisAsm
+    {
+    public:
+        /// <summary>
+        /// The image is in the memory order of the 68000 and is not copied.
+        /// </summary>
+        ParallelDisAsm(const uint16_t* image, uint32_t base, uint32_t size);
+
+        /// <summary>
+        /// Adds an address where the image can be cut, ignored if odd or outside of the image.
+        /// </summary>
+        void addBoundary(uint32_t address);
+
+        /// <summary>
+        /// Symbols shared by the DisAsm of every thread.
+        /// </summary>
+        void setSymbols(std::shared_ptr<const SymbolTable> symbols);
+
+        /// <summary>
+        /// Number of threads, 0 for one per hardware thread.
+        /// </summary>
+        void setThreads(unsigned count) { threads = count; }
+
+        /// <summary>
+        /// Appends the disassembly of the whole image to output, one instruction per line like DisAsm::dasm.
+        /// An instruction that would go past the end of the image is left out.
+        /// </summary>
+        /// <returns>The number of instructions</returns>
+        size_t disassemble(std::string& output);
+
+    private:
+        struct Range
+        {
+            uint32_t start;
+            uint32_t end;
+        };
+
+        std::vector<Range> split(unsigned threadCount) const;
+        size_t disassembleRange(DisAsm& disAsm, const Range& range, std::string& text) const;
+
+        const uint16_t* image;
+        uint32_t base;
+        uint32_t size;
+        std::vector<uint32_t> boundaries;
+        std::shared_ptr<const SymbolTable> symbols;
+        unsigned threads = 0;
+    };
+}
@@ -0,0 +1,634 @@
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+#include "sourcewriter.h"
+#include "instructions.h"
+
+using namespace mc68000;
+
+namespace
+{
+    const size_t maxLineSize = 512;
+
+    // the operands start after the indentation and the mnemonic with its size
+    const size_t operandColumn = 8 + 8;
+
+    void appendHex(TextBuffer& text, uint32_t value, int digits)
+    {
+        char hex[8];
+        for (int i = digits - 1; i >= 0; i--, value >>= 4)
+        {
+            hex[i] = "0123456789abcdef"[value & 0xf];
+        }
+        text.append(hex, digits);
+    }
+
+    void appendSigned(TextBuffer& text, int32_t value)
+    {
+        if (value < 0)
+        {
+            text += '-';
+        }
+        text.appendDecimal(value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value));
+    }
+
+    void appendRegister(TextBuffer& text, uint8_t reg)
+    {
+        text += reg < 8 ? 'd' : 'a';
+        text += static_cast<char>('0' + (reg & 7));
+    }
+
+    /// <summary>
+    /// Register list of movem, d0-d7 in bits 0-7 and a0-a7 in bits 8-15, with the runs written as ranges.
+    /// </summary>
+    void appendRegisterList(TextBuffer& text, uint16_t list)
+    {
+        const char* separator = "";
+        for (uint8_t reg = 0; reg < 16; reg++)
+        {
+            if (!(list & (1 << reg)))
+            {
+                continue;
+            }
+            uint8_t last = reg;
+            while ((last & 7) != 7 && (list & (1 << (last + 1))))
+            {
+                last++;
+            }
+            text += separator;
+            appendRegister(text, reg);
+            if (last != reg)
+            {
+                text += '-';
+                appendRegister(text, last);
+            }
+            separator = "/";
+            reg = last;
+        }
+    }
+
+    /// <summary>
+    /// Indicates if the assembler reads name as a label: an identifier that is not a register.
+    /// </summary>
+    bool isIdentifier(std::string_view name)
+    {
+        if (name.empty() || !(isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_'))
+        {
+            return false;
+        }
+        for (char c : name)
+        {
+            if (!(isalnum(static_cast<unsigned char>(c)) || c == '_'))
+            {
+                return false;
+            }
+        }
+        std::string lower(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        if (lower.size() == 2 && (lower[0] == 'd' || lower[0] == 'a') && lower[1] >= '0' && lower[1] <= '7')
+        {
+            return false;
+        }
+        return lower != "sp" && lower != "pc" && lower != "sr" && lower != "ccr" && lower != "usp";
+    }
+
+    /// <summary>
+    /// Number of extension words of operand, in the order they follow the opcode.
+    /// </summary>
+    uint32_t extensionWords(const DecodedInstruction& instruction, const Operand& operand)
+    {
+        switch (operand.kind)
+        {
+        case OperandKind::Displacement:
+        case OperandKind::Index:
+        case OperandKind::AbsoluteWord:
+        case OperandKind::PcDisplacement:
+        case OperandKind::PcIndex:
+        case OperandKind::BranchDisplacement:
+        case OperandKind::PeripheralDisplacement:
+        case OperandKind::RegisterList:
+            return 1;
+        case OperandKind::AbsoluteLong:
+            return 2;
+        case OperandKind::Immediate:
+            return instruction.size == 4 ? 2 : 1;
+        case OperandKind::Data:
+            if (instruction.instruction == instructions::MOVEQ)
+            {
+                return 0;
+            }
+            return instruction.size == 4 ? 2 : 1;
+        case OperandKind::Quick:
+            return instruction.instruction == instructions::LINK ? 1 : 0;
+        case OperandKind::BranchTarget:
+            return (instruction.opcode & 0xff) ? 0 : 1;
+        default:
+            return 0;
+        }
+    }
+}
+
+SourceWriter::SourceWriter(std::ostream& out) :
+    out(out)
+{
+}
+
+void SourceWriter::setHeader(uint32_t start, uint32_t memoryStart, uint32_t memoryEnd)
+{
+    header = true;
+    this->start = start;
+    this->memoryStart = memoryStart;
+    this->memoryEnd = memoryEnd;
+}
+
+/// <summary>
+/// Decodes the instruction at address, false when it does not fit in the block.
+/// </summary>
+bool SourceWriter::decodeAt(const ImageBlock& block, uint32_t address, DecodedInstruction& instruction)
+{
+    uint32_t offset = address - block.address;
+    uint32_t size = block.size & ~1u;
+    return decoder.decode(reinterpret_cast<const uint16_t*>(block.data + offset), size - offset, true, address, instruction);
+}
+
+const SourceWriter::Block* SourceWriter::findBlock(uint32_t address) const
+{
+    for (const auto& block : blocks)
+    {
+        if (address - block.image->address < (block.image->size & ~1u))
+        {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+/// <summary>
+/// Indicates if a line of the source starts at address, where a label can be written.
+/// </summary>
+bool SourceWriter::isLineStart(uint32_t address) const
+{
+    const Block* block = findBlock(address);
+    return block && (address & 1) == 0 && block->starts[(address - block->image->address) / 2];
+}
+
+/// <summary>
+/// Indicates if address has a name, a label or an equ when it is not at the start of a line.
+/// </summary>
+bool SourceWriter::isLabel(uint32_t address) const
+{
+    if (!std::binary_search(labels.begin(), labels.end(), address))
+    {
+        return false;
+    }
+    // the assembler does not accept the negative values of equ as addresses
+    return address <= INT32_MAX || isLineStart(address);
+}
+
+void SourceWriter::collectTargets(const DecodedInstruction& instruction)
+{
+    for (int i = 0; i < instruction.operandCount; i++)
+    {
+        const Operand& operand = instruction.operands[i];
+        switch (operand.kind)
+        {
+        case OperandKind::BranchTarget:
+            targets.push_back(operand.value);
+            break;
+        case OperandKind::BranchDisplacement:
+            targets.push_back(instruction.address + 2 + operand.value);
+            break;
+        case OperandKind::AbsoluteWord:
+        case OperandKind::AbsoluteLong:
+            // the addresses outside of the image are kept as numbers
+            if (findBlock(operand.value))
+            {
+                targets.push_back(operand.value);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/// <summary>
+/// Merges the targets with the symbols at the start of a line.
+/// </summary>
+void SourceWriter::findLabels()
+{
+    labels.swap(targets);
+    targets.clear();
+    if (symbols)
+    {
+        for (size_t index = 0; index < symbols->size(); index++)
+        {
+            if (usableSymbols[index] && isLineStart(symbols->getAddress(index)))
+            {
+                labels.push_back(symbols->getAddress(index));
+            }
+        }
+    }
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+}
+
+void SourceWriter::appendName(TextBuffer& text, uint32_t address) const
+{
+    size_t index = symbols ? symbols->find(address) : SymbolTable::npos;
+    if (index != SymbolTable::npos && usableSymbols[index])
+    {
+        text += symbols->getName(index);
+        return;
+    }
+    text += "L_";
+    appendHex(text, address, 8);
+}
+
+/// <summary>
+/// Appends the operand in the syntax of the assembler, false when the assembler would not encode it with the
+/// same words.
+/// </summary>
+/// <param name="extension">First extension word of the operand</param>
+bool SourceWriter::appendOperand(TextBuffer& text, const DecodedInstruction& instruction, const Operand& operand,
+    const uint8_t* extension) const
+{
+    uint32_t value = operand.value;
+    switch (operand.kind)
+    {
+    case OperandKind::DataRegister:
+        appendRegister(text, operand.reg);
+        return true;
+    case OperandKind::AddressRegister:
+        appendRegister(text, operand.reg + 8);
+        return true;
+    case OperandKind::Indirect:
+    case OperandKind::PostIncrement:
+    case OperandKind::PreDecrement:
+        text += operand.kind == OperandKind::PreDecrement ? "-(" : "(";
+        appendRegister(text, operand.reg + 8);
+        text += operand.kind == OperandKind::PostIncrement ? ")+" : ")";
+        return true;
+    case OperandKind::Displacement:
+    case OperandKind::PeripheralDisplacement:
+        appendSigned(text, static_cast<int32_t>(value));
+        text += '(';
+        appendRegister(text, operand.reg + 8);
+        text += ')';
+        return true;
+    case OperandKind::Index:
+    case OperandKind::PcIndex:
+        // the assembler writes 0 in the bits 8-10 of the brief extension word
+        if (extension[0] & 0x07)
+        {
+            return false;
+        }
+        appendSigned(text, static_cast<int32_t>(value));
+        text += '(';
+        if (operand.kind == OperandKind::Index)
+        {
+            appendRegister(text, operand.reg + 8);
+        }
+        else
+        {
+            text += "pc";
+        }
+        text += ',';
+        appendRegister(text, operand.index);
+        text += operand.indexSize == 4 ? ".l)" : ".w)";
+        return true;
+    case OperandKind::AbsoluteWord:
+    case OperandKind::AbsoluteLong:
+        // the size is explicit, the assembler would choose the shortest one
+        if (isLabel(value))
+        {
+            appendName(text, value);
+        }
+        else
+        {
+            text += '$';
+            text.appendHex(value);
+        }
+        text += operand.kind == OperandKind::AbsoluteWord ? ".w" : ".l";
+        return true;
+    case OperandKind::PcDisplacement:
+        appendSigned(text, static_cast<int32_t>(value));
+        text += "(pc)";
+        return true;
+    case OperandKind::Immediate:
+        if (instruction.size == 1 && value > 0xff)
+        {
+            return false;
+        }
+        text += "#$";
+        text.appendHex(value);
+        return true;
+    case OperandKind::Data:
+        switch (instruction.instruction)
+        {
+        case instructions::MOVEQ:
+            text += '#';
+            appendSigned(text, static_cast<int32_t>(value));
+            return true;
+        case instructions::BCHG_I:
+        case instructions::BCLR_I:
+        case instructions::BSET_I:
+        case instructions::BTST_I:
+            // the assembler checks the bit number against the size of the destination
+            if (value > (instruction.operands[1].kind == OperandKind::DataRegister ? 31u : 7u))
+            {
+                return false;
+            }
+            text += '#';
+            text.appendDecimal(value);
+            return true;
+        case instructions::ANDI2CCR:
+        case instructions::EORI2CCR:
+        case instructions::ORI2CCR:
+            if (value > 0xff)
+            {
+                return false;
+            }
+            break;
+        default:
+            // the high byte of a byte immediate is written as 0
+            if (instruction.size == 1 && extension[0] != 0)
+            {
+                return false;
+            }
+            break;
+        }
+        text += "#$";
+        text.appendHex(value);
+        return true;
+    case OperandKind::Quick:
+        text += '#';
+        appendSigned(text, static_cast<int32_t>(value));
+        return true;
+    case OperandKind::RegisterList:
+        if (value == 0)
+        {
+            return false;
+        }
+        appendRegisterList(text, static_cast<uint16_t>(value));
+        return true;
+    case OperandKind::BranchTarget:
+        if (instruction.opcode & 0xff)
+        {
+            // a number keeps the displacement on a byte
+            text += '$';
+            text.appendHex(value);
+            return true;
+        }
+        // a label is always a word displacement
+        if (!isLabel(value))
+        {
+            return false;
+        }
+        appendName(text, value);
+        return true;
+    case OperandKind::BranchDisplacement:
+        value += instruction.address + 2;
+        if (isLabel(value))
+        {
+            appendName(text, value);
+        }
+        else
+        {
+            text += '$';
+            text.appendHex(value);
+        }
+        return true;
+    case OperandKind::Ccr:
+        text += "ccr";
+        return true;
+    case OperandKind::Sr:
+        text += "sr";
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// <summary>
+/// Appends the line of the instruction, false when the assembler has no syntax for it or would encode it
+/// with other words.
+/// </summary>
+bool SourceWriter::appendInstruction(TextBuffer& text, const DecodedInstruction& instruction, const uint8_t* words) const
+{
+    switch (instruction.instruction)
+    {
+    case instructions::UNKNOWN:
+    case instructions::MOVE2CCR:
+        return false;
+    }
+
+    text += "        ";
+    text += instruction.mnemonic;
+    // moveq is always long and has no size in the syntax of the assembler
+    if (instruction.size && instruction.instruction != instructions::MOVEQ)
+    {
+        text += instruction.size == 1 ? ".b" : instruction.size == 2 ? ".w" : ".l";
+    }
+    if (instruction.operandCount == 0)
+    {
+        return true;
+    }
+    do
+    {
+        text += ' ';
+    } while (text.length() < operandColumn);
+
+    // the register list of movem comes before the extension words of its effective address
+    const uint8_t* extension = words + (instruction.instruction == instructions::MOVEM ? 4 : 2);
+    for (int i = 0; i < instruction.operandCount; i++)
+    {
+        const Operand& operand = instruction.operands[i];
+        if (i > 0)
+        {
+            text += ',';
+        }
+        if (operand.kind == OperandKind::RegisterList)
+        {
+            if (!appendOperand(text, instruction, operand, words + 2))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (!appendOperand(text, instruction, operand, extension))
+        {
+            return false;
+        }
+        extension += extensionWords(instruction, operand) * 2;
+    }
+    return !text.isTruncated();
+}
+
+/// <summary>
+/// Writes count words as dc.w, with the disassembly of the instruction they make as a comment.
+/// </summary>
+void SourceWriter::writeData(const uint8_t* words, uint32_t count, const char* comment)
+{
+    char buffer[maxLineSize];
+    TextBuffer line(buffer, sizeof(buffer));
+    line += "        dc.w    ";
+    for (uint32_t i = 0; i < count; i++)
+    {
+        line += i ? ",$" : "$";
+        appendHex(line, (words[2 * i] << 8) | words[2 * i + 1], 4);
+    }
+    if (comment)
+    {
+        line += " ; ";
+        line += comment;
+    }
+    line += '\n';
+    out.write(line.c_str(), line.length());
+}
+
+uint64_t SourceWriter::writeBlock(const Block& block)
+{
+    const ImageBlock& image = *block.image;
+    char buffer[maxLineSize];
+    char comment[256];
+    TextBuffer line(buffer, sizeof(buffer));
+    line += "        org     $";
+    line.appendHex(image.address);
+    line += '\n';
+    out.write(line.c_str(), line.length());
+
+    uint64_t count = 0;
+    uint32_t end = image.address + (image.size & ~1u);
+    uint32_t address = image.address;
+    DecodedInstruction instruction;
+    while (address < end)
+    {
+        const uint8_t* words = image.data + (address - image.address);
+        if (!decodeAt(image, address, instruction))
+        {
+            // the words that do not make a whole instruction at the end of the block
+            writeData(words, (end - address) / 2, nullptr);
+            break;
+        }
+        if (isLabel(address))
+        {
+            line.clear();
+            appendName(line, address);
+            line += '\n';
+            out.write(line.c_str(), line.length());
+        }
+        line.clear();
+        if (appendInstruction(line, instruction, words))
+        {
+            line += '\n';
+            out.write(line.c_str(), line.length());
+            count++;
+        }
+        else if (instruction.instruction == instructions::UNKNOWN)
+        {
+            writeData(words, instruction.length, nullptr);
+        }
+        else
+        {
+            disAsm.format(instruction, comment, sizeof(comment));
+            writeData(words, instruction.length, comment);
+        }
+        address += instruction.length * 2;
+    }
+    if (image.size & 1)
+    {
+        // the assembler pads the block to a word
+        line.clear();
+        line += "        dc.b    $";
+        appendHex(line, image.data[image.size - 1], 2);
+        line += '\n';
+        out.write(line.c_str(), line.length());
+    }
+    return count;
+}
+
+uint64_t SourceWriter::write(const std::vector<ImageBlock>& images)
+{
+    // the first occurrence of a name is kept, the labels of the assembler are unique
+    usableSymbols.assign(symbols ? symbols->size() : 0, false);
+    std::unordered_set<std::string> names;
+    for (size_t index = 0; index < usableSymbols.size(); index++)
+    {
+        std::string_view name = symbols->getName(index);
+        bool synthesized = name.size() == 10 && name.compare(0, 2, "L_") == 0;
+        usableSymbols[index] = isIdentifier(name) && !synthesized && names.emplace(name).second;
+    }
+
+    blocks.clear();
+    for (const auto& image : images)
+    {
+        blocks.push_back({ &image, std::vector<uint8_t>(image.size / 2) });
+    }
+
+    // first pass: where the instructions start and what they refer to
+    DecodedInstruction instruction;
+    for (auto& block : blocks)
+    {
+        const ImageBlock& image = *block.image;
+        uint32_t end = image.address + (image.size & ~1u);
+        for (uint32_t address = image.address; address < end && decodeAt(image, address, instruction);)
+        {
+            block.starts[(address - image.address) / 2] = 1;
+            collectTargets(instruction);
+            address += instruction.length * 2;
+        }
+    }
+    findLabels();
+
+    char buffer[maxLineSize];
+    TextBuffer line(buffer, sizeof(buffer));
+    if (header && (memoryStart != 0 || memoryEnd != 0))
+    {
+        line += "        memory  $";
+        line.appendHex(memoryStart);
+        line += ",$";
+        line.appendHex(memoryEnd);
+        line += '\n';
+        out.write(line.c_str(), line.length());
+    }
+
+    // the names that are not at the start of a line are defined first
+    for (uint32_t address : labels)
+    {
+        if (!isLineStart(address) && address <= INT32_MAX)
+        {
+            line.clear();
+            appendName(line, address);
+            line += " equ $";
+            line.appendHex(address);
+            line += '\n';
+            out.write(line.c_str(), line.length());
+        }
+    }
+
+    uint64_t count = 0;
+    for (const auto& block : blocks)
+    {
+        count += writeBlock(block);
+    }
+
+    if (header)
+    {
+        line.clear();
+        line += "        end     ";
+        if (isLabel(start))
+        {
+            appendName(line, start);
+        }
+        else
+        {
+            line += '$';
+            line.appendHex(start);
+        }
+        line += '\n';
+        out.write(line.c_str(), line.length());
+    }
+    return count;
+}
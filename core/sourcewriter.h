@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "decoder.h"
+#include "disasm.h"
+#include "imagefile.h"
+#include "symboltable.h"
+#include "textbuffer.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Writes image blocks as source for the assembler of asm/, that assembles back to the same words:
+    /// an org directive per block, labels at the targets of the branches and jumps, dc.w for the words that
+    /// are not an instruction and for the instructions the assembler would encode differently.
+    /// The branches whose displacement is a word refer to a label, the assembler always encodes a word for
+    /// them, the others keep their numeric target so they are encoded on a byte again.
+    /// </summary>
+    class SourceWriter
+    {
+    public:
+        SourceWriter(std::ostream& out);
+
+        /// <summary>
+        /// The symbols name the labels at their address, the other labels are L_ followed by the address.
+        /// </summary>
+        void setSymbols(std::shared_ptr<const SymbolTable> table) { symbols = std::move(table); }
+
+        /// <summary>
+        /// Gives the header of the image: the start of execution is written by an END directive after the blocks,
+        /// the address space by a MEMORY directive before them unless both its addresses are 0.
+        /// </summary>
+        void setHeader(uint32_t start, uint32_t memoryStart, uint32_t memoryEnd);
+
+        /// <summary>
+        /// Writes the blocks, the labels may refer from one block to another.
+        /// </summary>
+        /// <returns>The number of instructions written as instructions, the others are dc.w</returns>
+        uint64_t write(const std::vector<ImageBlock>& blocks);
+
+    private:
+        struct Block
+        {
+            const ImageBlock* image;
+            std::vector<uint8_t> starts;    // one per word, set at the first word of each instruction
+        };
+
+        bool decodeAt(const ImageBlock& block, uint32_t address, DecodedInstruction& instruction);
+        const Block* findBlock(uint32_t address) const;
+        bool isLineStart(uint32_t address) const;
+        bool isLabel(uint32_t address) const;
+        void findLabels();
+        void collectTargets(const DecodedInstruction& instruction);
+        void appendName(TextBuffer& text, uint32_t address) const;
+        bool appendOperand(TextBuffer& text, const DecodedInstruction& instruction, const Operand& operand,
+            const uint8_t* extension) const;
+        bool appendInstruction(TextBuffer& text, const DecodedInstruction& instruction, const uint8_t* words) const;
+        uint64_t writeBlock(const Block& block);
+        void writeData(const uint8_t* words, uint32_t count, const char* comment);
+
+        std::ostream& out;
+        std::shared_ptr<const SymbolTable> symbols;
+        bool header = false;
+        uint32_t start = 0;
+        uint32_t memoryStart = 0;
+        uint32_t memoryEnd = 0;
+        std::vector<bool> usableSymbols;
+        std::vector<Block> blocks;
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> labels;       // sorted, the targets and symbols that get a name
+        Decoder decoder;
+        DisAsm disAsm;
+    };
+}
@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "statistics.h"
+#include "instructions.h"
+
+using namespace mc68000;
+
+namespace
+{
+    enum Size
+    {
+        BYTE,
+        WORD,
+        LONG,
+        UNSIZED,
+        SIZES
+    };
+    const char* const sizeNames[SIZES] = { "byte", "word", "long", "unsized" };
+
+    enum Mode
+    {
+        DATA_REGISTER,
+        ADDRESS_REGISTER,
+        INDIRECT,
+        POSTINCREMENT,
+        PREDECREMENT,
+        DISPLACEMENT,
+        INDEX,
+        ABSOLUTE_WORD,
+        ABSOLUTE_LONG,
+        PC_DISPLACEMENT,
+        PC_INDEX,
+        IMMEDIATE,
+        MODES
+    };
+    const char* const modeNames[MODES] = {
+        "Dn", "An", "(An)", "(An)+", "-(An)", "d16(An)", "d8(An,Xn)",
+        "abs.w", "abs.l", "d16(PC)", "d8(PC,Xn)", "#imm" };
+
+    /// <summary>
+    /// Operand size and addressing modes of one opcode.
+    /// </summary>
+    struct OperandInfo
+    {
+        Size size = UNSIZED;
+        int modes[2] = { -1, -1 };
+        int count = 0;
+
+        void add(int mode)
+        {
+            modes[count++] = mode;
+        }
+    };
+
+    int effectiveAddressMode(unsigned ea)
+    {
+        unsigned mode = (ea >> 3) & 7;
+        if (mode != 7)
+        {
+            return static_cast<int>(mode);
+        }
+        unsigned reg = ea & 7;
+        return reg <= 4 ? ABSOLUTE_WORD + static_cast<int>(reg) : -1;
+    }
+
+    Size standardSize(uint16_t opcode)
+    {
+        static const Size sizes[] = { BYTE, WORD, LONG, UNSIZED };
+        return sizes[(opcode >> 6) & 3];
+    }
+
+    OperandInfo decode(uint16_t id, uint16_t opcode)
+    {
+        OperandInfo info;
+        int ea = effectiveAddressMode(opcode & 0x3f);
+        switch (id)
+        {
+            case instructions::ADD:
+            case instructions::SUB:
+            case instructions::AND:
+            case instructions::OR:
+            case instructions::CMP:
+            case instructions::EOR:
+                info.size = standardSize(opcode);
+                info.add(ea);
+                info.add(DATA_REGISTER);
+                break;
+
+            case instructions::ADDA:
+            case instructions::SUBA:
+            case instructions::CMPA:
+                info.size = (opcode & 0x0100) ? LONG : WORD;
+                info.add(ea);
+                info.add(ADDRESS_REGISTER);
+                break;
+
+            case instructions::ADDI:
+            case instructions::ANDI:
+            case instructions::CMPI:
+            case instructions::EORI:
+            case instructions::ORI:
+            case instructions::SUBI:
+                info.size = standardSize(opcode);
+                info.add(IMMEDIATE);
+                info.add(ea);
+                break;
+
+            case instructions::ADDQ:
+            case instructions::SUBQ:
+                info.size = standardSize(opcode);
+                info.add(IMMEDIATE);
+                info.add(ea);
+                break;
+
+            case instructions::ADDX:
+            case instructions::SUBX:
+            case instructions::ABCD:
+            case instructions::SBCD:
+                info.size = (id == instructions::ABCD || id == instructions::SBCD) ? BYTE : standardSize(opcode);
+                info.add((opcode & 0x0008) ? PREDECREMENT : DATA_REGISTER);
+                info.add((opcode & 0x0008) ? PREDECREMENT : DATA_REGISTER);
+                break;
+
+            case instructions::CMPM:
+                info.size = standardSize(opcode);
+                info.add(POSTINCREMENT);
+                info.add(POSTINCREMENT);
+                break;
+
+            case instructions::CLR:
+            case instructions::NEG:
+            case instructions::NEGX:
+            case instructions::NOT:
+            case instructions::TST:
+                info.size = standardSize(opcode);
+                info.add(ea);
+                break;
+
+            case instructions::MOVE:
+            case instructions::MOVEA:
+            {
+                static const Size sizes[] = { UNSIZED, BYTE, LONG, WORD };
+                info.size = sizes[(opcode >> 12) & 3];
+                info.add(ea);
+                info.add(effectiveAddressMode(((opcode >> 3) & 0x38) | ((opcode >> 9) & 7)));
+                break;
+            }
+
+            case instructions::MOVEQ:
+                info.size = LONG;
+                info.add(IMMEDIATE);
+                info.add(DATA_REGISTER);
+                break;
+
+            case instructions::MOVEM:
+                info.size = (opcode & 0x0040) ? LONG : WORD;
+                info.add(ea);
+                break;
+
+            case instructions::MOVEP:
+                info.size = (opcode & 0x0040) ? LONG : WORD;
+                info.add(DATA_REGISTER);
+                info.add(DISPLACEMENT);
+                break;
+
+            case instructions::ASL:
+            case instructions::ASR:
+            case instructions::LSL:
+            case instructions::LSR:
+            case instructions::ROL:
+            case instructions::ROR:
+            case instructions::ROXL:
+            case instructions::ROXR:
+                if (((opcode >> 6) & 3) == 3)
+                {
+                    // memory shift by one bit
+                    info.size = WORD;
+                    info.add(ea);
+                }
+                else
+                {
+                    info.size = standardSize(opcode);
+                    info.add((opcode & 0x0020) ? DATA_REGISTER : IMMEDIATE);
+                    info.add(DATA_REGISTER);
+                }
+                break;
+
+            case instructions::BCHG_R:
+            case instructions::BCLR_R:
+            case instructions::BSET_R:
+            case instructions::BTST_R:
+                info.size = ea == DATA_REGISTER ? LONG : BYTE;
+                info.add(DATA_REGISTER);
+                info.add(ea);
+                break;
+
+            case instructions::BCHG_I:
+            case instructions::BCLR_I:
+            case instructions::BSET_I:
+            case instructions::BTST_I:
+                info.size = ea == DATA_REGISTER ? LONG : BYTE;
+                info.add(IMMEDIATE);
+                info.add(ea);
+                break;
+
+            case instructions::LEA:
+                info.size = LONG;
+                info.add(ea);
+                info.add(ADDRESS_REGISTER);
+                break;
+
+            case instructions::PEA:
+                info.size = LONG;
+                info.add(ea);
+                break;
+
+            case instructions::JMP:
+            case instructions::JSR:
+                info.add(ea);
+                break;
+
+            case instructions::CHK:
+            case instructions::DIVS:
+            case instructions::DIVU:
+            case instructions::MULS:
+            case instructions::MULU:
+                info.size = WORD;
+                info.add(ea);
+                info.add(DATA_REGISTER);
+                break;
+
+            case instructions::SCC:
+            case instructions::TAS:
+            case instructions::NBCD:
+                info.size = BYTE;
+                info.add(ea);
+                break;
+
+            case instructions::MOVECCR:
+            case instructions::MOVE2CCR:
+            case instructions::MOVESR:
+            case instructions::MOVE2SR:
+                info.size = WORD;
+                info.add(ea);
+                break;
+
+            case instructions::ANDI2CCR:
+            case instructions::EORI2CCR:
+            case instructions::ORI2CCR:
+                info.size = BYTE;
+                info.add(IMMEDIATE);
+                break;
+
+            case instructions::ANDI2SR:
+            case instructions::EORI2SR:
+            case instructions::ORI2SR:
+                info.size = WORD;
+                info.add(IMMEDIATE);
+                break;
+
+            case instructions::EXT:
+                info.size = (opcode & 0x0040) ? LONG : WORD;
+                info.add(DATA_REGISTER);
+                break;
+
+            case instructions::SWAP:
+                info.size = WORD;
+                info.add(DATA_REGISTER);
+                break;
+
+            case instructions::EXG:
+                info.size = LONG;
+                info.add((opcode & 0x00f8) == 0x0048 ? ADDRESS_REGISTER : DATA_REGISTER);
+                info.add((opcode & 0x00f8) == 0x0040 ? DATA_REGISTER : ADDRESS_REGISTER);
+                break;
+
+            case instructions::DBCC:
+                info.size = WORD;
+                info.add(DATA_REGISTER);
+                break;
+
+            case instructions::LINK:
+            case instructions::UNLK:
+                info.add(ADDRESS_REGISTER);
+                break;
+
+            default:
+                // branches, TRAP, RTS, NOP...: no operand
+                break;
+        }
+        return info;
+    }
+
+    std::string narrow(const wchar_t* name)
+    {
+        std::string result;
+        for (; name != nullptr && *name != 0; name++)
+        {
+            result += static_cast<char>(*name);
+        }
+        return result;
+    }
+
+    std::string instructionName(uint16_t id)
+    {
+        std::string name = id < instructions::MAX_INSTRUCTIONS ? narrow(instructions::names[id]) : std::string();
+        return name.empty() ? "#" + std::to_string(id) : name;
+    }
+
+    void writeCounters(std::ostream& out, const char* const* names, const uint64_t* counts, size_t size)
+    {
+        out << "{";
+        const char* separator = "";
+        for (size_t i = 0; i < size; i++)
+        {
+            if (counts[i])
+            {
+                out << separator << "\"" << names[i] << "\":" << counts[i];
+                separator = ",";
+            }
+        }
+        out << "}";
+    }
+}
+
+Statistics::Statistics() :
+    opcodeCounts(0x10000),
+    opcodeIds(0x10000),
+    branchTaken(instructions::MAX_INSTRUCTIONS),
+    branchNotTaken(instructions::MAX_INSTRUCTIONS),
+    exceptionCounts(256)
+{
+}
+
+void Statistics::clear()
+{
+    std::fill(opcodeCounts.begin(), opcodeCounts.end(), 0);
+    std::fill(opcodeIds.begin(), opcodeIds.end(), 0);
+    std::fill(branchTaken.begin(), branchTaken.end(), 0);
+    std::fill(branchNotTaken.begin(), branchNotTaken.end(), 0);
+    std::fill(exceptionCounts.begin(), exceptionCounts.end(), 0);
+}
+
+uint64_t Statistics::getInstructionCount() const
+{
+    uint64_t total = 0;
+    for (uint64_t count : opcodeCounts)
+    {
+        total += count;
+    }
+    return total;
+}
+
+uint64_t Statistics::getInstructionCount(uint16_t instructionId) const
+{
+    uint64_t total = 0;
+    for (size_t opcode = 0; opcode < opcodeCounts.size(); opcode++)
+    {
+        if (opcodeIds[opcode] == instructionId)
+        {
+            total += opcodeCounts[opcode];
+        }
+    }
+    return total;
+}
+
+uint64_t Statistics::getBranchCount(uint16_t instructionId, bool taken) const
+{
+    return instructionId < branchTaken.size() ? (taken ? branchTaken : branchNotTaken)[instructionId] : 0;
+}
+
+uint64_t Statistics::getExceptionCount(uint16_t vector) const
+{
+    return exceptionCounts[vector & 0xff];
+}
+
+void Statistics::writeJson(std::ostream& out, size_t hotOpcodes) const
+{
+    std::vector<uint64_t> byInstruction(instructions::MAX_INSTRUCTIONS);
+    uint64_t bySize[SIZES] = {};
+    uint64_t byMode[MODES] = {};
+    std::vector<uint16_t> executed;
+    uint64_t total = 0;
+
+    for (size_t opcode = 0; opcode < opcodeCounts.size(); opcode++)
+    {
+        uint64_t count = opcodeCounts[opcode];
+        if (count == 0)
+        {
+            continue;
+        }
+        uint16_t id = opcodeIds[opcode];
+        executed.push_back(static_cast<uint16_t>(opcode));
+        total += count;
+        byInstruction[id < byInstruction.size() ? id : 0] += count;
+
+        OperandInfo info = decode(id, static_cast<uint16_t>(opcode));
+        bySize[info.size] += count;
+        for (int i = 0; i < info.count; i++)
+        {
+            if (info.modes[i] >= 0)
+            {
+                byMode[info.modes[i]] += count;
+            }
+        }
+    }
+
+    out << "{\"instructions\":" << total;
+
+    out << ",\"by_instruction\":{";
+    const char* separator = "";
+    for (size_t id = 0; id < byInstruction.size(); id++)
+    {
+        if (byInstruction[id])
+        {
+            out << separator << "\"" << instructionName(static_cast<uint16_t>(id)) << "\":" << byInstruction[id];
+            separator = ",";
+        }
+    }
+    out << "}";
+
+    out << ",\"by_size\":";
+    writeCounters(out, sizeNames, bySize, SIZES);
+    out << ",\"by_addressing_mode\":";
+    writeCounters(out, modeNames, byMode, MODES);
+
+    out << ",\"branches\":{";
+    separator = "";
+    for (size_t id = 0; id < branchTaken.size(); id++)
+    {
+        if (branchTaken[id] || branchNotTaken[id])
+        {
+            out << separator << "\"" << instructionName(static_cast<uint16_t>(id)) << "\":{\"taken\":" << branchTaken[id]
+                << ",\"not_taken\":" << branchNotTaken[id] << "}";
+            separator = ",";
+        }
+    }
+    out << "}";
+
+    out << ",\"exceptions\":{";
+    separator = "";
+    for (size_t vector = 0; vector < exceptionCounts.size(); vector++)
+    {
+        if (exceptionCounts[vector])
+        {
+            out << separator << "\"" << vector << "\":" << exceptionCounts[vector];
+            separator = ",";
+        }
+    }
+    out << "}";
+
+    // most executed opcodes first
+    size_t hot = std::min(hotOpcodes, executed.size());
+    std::partial_sort(executed.begin(), executed.begin() + hot, executed.end(),
+        [this](uint16_t a, uint16_t b) { return opcodeCounts[a] > opcodeCounts[b]; });
+    out << ",\"hot_opcodes\":[";
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < hot; i++)
+    {
+        uint16_t opcode = executed[i];
+        std::string text = "0x";
+        for (int shift = 12; shift >= 0; shift -= 4)
+        {
+            text += hex[(opcode >> shift) & 0xf];
+        }
+        out << (i ? "," : "") << "{\"opcode\":\"" << text << "\",\"instruction\":\"" << instructionName(opcodeIds[opcode])
+            << "\",\"count\":" << opcodeCounts[opcode] << "}";
+    }
+    out << "]}" << std::endl;
+}
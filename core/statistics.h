@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace mc68000
+{
+    /// <summary>
+    /// Execution statistics collected by the Cpu when attached with Cpu::setStatistics.
+    /// The Cpu only counts executed opcodes, branch outcomes and exceptions; the instruction mix
+    /// by size and addressing mode is decoded from the opcode counts when the report is written.
+    /// </summary>
+    class Statistics
+    {
+    public:
+        Statistics();
+
+        void instruction(uint16_t opcode, uint16_t instructionId)
+        {
+            opcodeCounts[opcode]++;
+            opcodeIds[opcode] = instructionId;
+        }
+
+        void branch(uint16_t instructionId, bool taken)
+        {
+            (taken ? branchTaken : branchNotTaken)[instructionId]++;
+        }
+
+        void exception(uint16_t vector)
+        {
+            exceptionCounts[vector & 0xff]++;
+        }
+
+        void clear();
+        uint64_t getInstructionCount() const;
+        uint64_t getInstructionCount(uint16_t instructionId) const;
+        uint64_t getBranchCount(uint16_t instructionId, bool taken) const;
+        uint64_t getExceptionCount(uint16_t vector) const;
+
+        /// <summary>
+        /// Writes the statistics as one JSON object: totals by instruction, size and addressing mode,
+        /// branch outcomes, exceptions by vector and the most executed opcodes.
+        /// </summary>
+        void writeJson(std::ostream& out, size_t hotOpcodes = 32) const;
+
+    private:
+        std::vector<uint64_t> opcodeCounts;
+        std::vector<uint16_t> opcodeIds;
+        std::vector<uint64_t> branchTaken;
+        std::vector<uint64_t> branchNotTaken;
+        std::vector<uint64_t> exceptionCounts;
+    };
+}
@@ -64,7 +64,7 @@ namespace mc68000
 		bool hi() const { return !c && !z; }
 		bool le() const { return (z || n && !v || !n && v); }
 		bool ls() const { return c || z; }
-		bool lt() const { return (n && v) | (!n && v); }
+		bool lt() const { return (n && !v) || (!n && v); }
 		bool mi() const { return n; }
 		bool pl() const { return !n; }
 		bool vc() const { return !v; }
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "symboltable.h"
+#include "imagefile.h"
+
+using namespace mc68000;
+
+bool SymbolTable::load(const char* filename)
+{
+    uint32_t magic = 0;
+    {
+        std::ifstream binaryFile(filename, std::ios::binary);
+        if (!binaryFile)
+        {
+            return false;
+        }
+        binaryFile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    }
+    if (magic == binaryMagicNumber)
+    {
+        return loadBinary(filename);
+    }
+
+    std::ifstream inputFile(filename);
+    if (!inputFile)
+    {
+        return false;
+    }
+    std::vector<std::pair<uint32_t, std::string>> labels;
+    std::string line;
+    enum class Section { None, Labels, Symbols };
+    Section currentSection = Section::None;
+    while (std::getline(inputFile, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            if (line == "# Labels")
+            {
+                currentSection = Section::Labels;
+            }
+            else if (line == "# Symbols")
+            {
+                currentSection = Section::Symbols;
+            }
+            continue;
+        }
+        std::istringstream iss(line);
+        std::string name;
+        iss >> name;
+        if (currentSection == Section::Labels)
+        {
+            uint32_t address;
+            iss >> address;
+            labels.emplace_back(address, name);
+        }
+    }
+
+    // sorted once; of the labels at the same address the last one read is kept, like add
+    std::stable_sort(labels.begin(), labels.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    clear();
+    addresses.reserve(labels.size());
+    names.reserve(labels.size());
+    for (size_t i = 0; i < labels.size(); i++)
+    {
+        if (i + 1 < labels.size() && labels[i + 1].first == labels[i].first)
+        {
+            continue;
+        }
+        addresses.push_back(labels[i].first);
+        names.push_back(std::move(labels[i].second));
+    }
+    return true;
+}
+
+/// <summary>
+/// Maps the file and checks that its tables are inside it; the addresses are expected in increasing order.
+/// </summary>
+bool SymbolTable::loadBinary(const char* filename)
+{
+    std::shared_ptr<const ImageFile> image;
+    try
+    {
+        image = std::make_shared<const ImageFile>(filename, true);
+    }
+    catch (const std::string&)
+    {
+        return false;
+    }
+    const ImageBlock& block = image->getBlocks()[0];
+    const uint32_t* header = reinterpret_cast<const uint32_t*>(block.data);
+    const uint64_t headerSize = 4 * sizeof(uint32_t);
+    if (block.size < headerSize)
+    {
+        return false;
+    }
+    uint64_t labels = header[1];
+    uint64_t symbolsSize = header[2] * 3ull * sizeof(uint32_t);
+    uint64_t poolSize = header[3];
+    if (headerSize + labels * 2 * sizeof(uint32_t) + symbolsSize + poolSize != block.size ||
+        poolSize == 0 || block.data[block.size - 1] != 0)
+    {
+        return false;
+    }
+    const uint32_t* names = header + 4 + labels;
+    for (uint64_t i = 0; i < labels; i++)
+    {
+        if (names[i] >= poolSize)
+        {
+            return false;
+        }
+    }
+
+    clear();
+    fileAddresses = header + 4;
+    fileNames = names;
+    filePool = reinterpret_cast<const char*>(block.data + block.size - poolSize);
+    fileCount = static_cast<size_t>(labels);
+    file = std::move(image);
+    return true;
+}
+
+/// <summary>
+/// Copies the labels of the mapped file in the vectors, before they are changed.
+/// </summary>
+void SymbolTable::copyFile()
+{
+    std::vector<uint32_t> fileLabels(fileAddresses, fileAddresses + fileCount);
+    std::vector<std::string> fileLabelNames;
+    fileLabelNames.reserve(fileCount);
+    for (size_t i = 0; i < fileCount; i++)
+    {
+        fileLabelNames.emplace_back(filePool + fileNames[i]);
+    }
+    clear();
+    for (size_t i = 0; i < fileLabels.size(); i++)
+    {
+        if (i + 1 < fileLabels.size() && fileLabels[i + 1] == fileLabels[i])
+        {
+            continue;
+        }
+        addresses.push_back(fileLabels[i]);
+        names.push_back(std::move(fileLabelNames[i]));
+    }
+}
+
+void SymbolTable::add(uint32_t address, const std::string& name)
+{
+    if (file)
+    {
+        copyFile();
+    }
+    auto it = std::lower_bound(addresses.begin(), addresses.end(), address);
+    size_t index = it - addresses.begin();
+    if (it != addresses.end() && *it == address)
+    {
+        names[index] = name;
+        return;
+    }
+    addresses.insert(it, address);
+    names.insert(names.begin() + index, name);
+}
+
+void SymbolTable::clear()
+{
+    addresses.clear();
+    names.clear();
+    file.reset();
+    fileAddresses = nullptr;
+    fileNames = nullptr;
+    filePool = nullptr;
+    fileCount = 0;
+}
+
+std::string SymbolTable::locate(uint32_t address) const
+{
+    size_t index = findPreceding(address);
+    if (index == npos)
+    {
+        return std::string();
+    }
+    if (getAddress(index) == address)
+    {
+        return std::string(getName(index));
+    }
+    std::ostringstream stream;
+    stream << getName(index) << "+0x" << std::hex << (address - getAddress(index));
+    return stream.str();
+}
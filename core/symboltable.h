@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mc68000
+{
+    class ImageFile;
+
+    /// <summary>
+    /// Labels of a program sorted by address in flat arrays, for the exact lookups of the disassembler and the
+    /// nearest preceding lookups that give label+0x12 in traces. Loaded once, a table can be shared read only
+    /// by several DisAsm and threads with a std::shared_ptr&lt;const SymbolTable&gt;.
+    /// A binary symbols file is memory mapped and its tables are used in place, without parsing.
+    /// </summary>
+    class SymbolTable
+    {
+    public:
+        static const size_t npos = SIZE_MAX;
+
+        /// <summary>
+        /// First word of the binary symbols files. They follow the byte order of the host, like the binary files:
+        /// magic number, number of labels, number of symbols, size of the string pool, the addresses of the labels
+        /// in increasing order, the offsets of their names in the pool, for each symbol the offset of its name,
+        /// its kind and its value, then the pool of null terminated names padded to 4 bytes.
+        /// </summary>
+        static const uint32_t binaryMagicNumber = 0x69344053;
+
+        enum class SymbolKind : uint32_t
+        {
+            Integer,                // value is an int32_t
+            Unsigned,               // value is an uint32_t
+            String,                 // value is the offset of the string in the pool
+        };
+
+        /// <summary>
+        /// Reads the labels of a symbols file written by the assembler, replacing the current ones.
+        /// The binary format is recognized from its magic number, any other file is read as text.
+        /// </summary>
+        /// <returns>false if the file cannot be opened or its binary tables are invalid</returns>
+        bool load(const char* filename);
+
+        /// <summary>
+        /// Adds a label, replacing the name of a label already at address.
+        /// </summary>
+        void add(uint32_t address, const std::string& name);
+
+        void clear();
+        size_t size() const { return file ? fileCount : addresses.size(); }
+        bool empty() const { return size() == 0; }
+        uint32_t getAddress(size_t index) const { return file ? fileAddresses[index] : addresses[index]; }
+        std::string_view getName(size_t index) const
+        {
+            return file ? std::string_view(filePool + fileNames[index]) : std::string_view(names[index]);
+        }
+
+        /// <summary>
+        /// Index of the label at address, npos if none.
+        /// </summary>
+        size_t find(uint32_t address) const
+        {
+            size_t index = findPreceding(address);
+            return index != npos && getAddress(index) == address ? index : npos;
+        }
+
+        /// <summary>
+        /// Index of the label at address or the closest before it, npos if none.
+        /// The search halves the range without a data dependent branch.
+        /// </summary>
+        size_t findPreceding(uint32_t address) const
+        {
+            const uint32_t* table = file ? fileAddresses : addresses.data();
+            size_t length = size();
+            if (length == 0)
+            {
+                return npos;
+            }
+            const uint32_t* first = table;
+            while (length > 1)
+            {
+                size_t half = length / 2;
+                first = first[half] <= address ? first + half : first;
+                length -= half;
+            }
+            return *first <= address ? static_cast<size_t>(first - table) : npos;
+        }
+
+        /// <summary>
+        /// Name of the label at address, or of the closest before it followed by +0x and the offset in hexadecimal;
+        /// empty if no label precedes address.
+        /// </summary>
+        std::string locate(uint32_t address) const;
+
+    private:
+        bool loadBinary(const char* filename);
+        void copyFile();
+
+        std::vector<uint32_t> addresses;
+        std::vector<std::string> names;
+
+        // tables of a binary file, the mapping is shared by the copies of the table so the pointers stay valid;
+        // of the labels at the same address the last one is found, like the text files
+        std::shared_ptr<const ImageFile> file;
+        const uint32_t* fileAddresses = nullptr;
+        const uint32_t* fileNames = nullptr;
+        const char* filePool = nullptr;
+        size_t fileCount = 0;
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace mc68000
+{
+	/// <summary>
+	/// Appends text to a fixed char array owned by the caller, always keeping it null terminated.
+	/// Text that does not fit is dropped and the buffer is marked as truncated; it never allocates.
+	/// </summary>
+	class TextBuffer
+	{
+	public:
+		TextBuffer(char* data, size_t capacity) : data(data), capacity(capacity)
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			size = 0;
+			truncated = false;
+			if (capacity)
+			{
+				data[0] = 0;
+			}
+		}
+
+		TextBuffer& operator=(const char* text)
+		{
+			clear();
+			return *this += text;
+		}
+
+		TextBuffer& operator+=(const char* text)
+		{
+			append(text, strlen(text));
+			return *this;
+		}
+
+		TextBuffer& operator+=(std::string_view text)
+		{
+			append(text.data(), text.size());
+			return *this;
+		}
+
+		TextBuffer& operator+=(char c)
+		{
+			append(&c, 1);
+			return *this;
+		}
+
+		/// <summary>
+		/// Lower case hexadecimal without leading zeroes, like std::hex.
+		/// </summary>
+		void appendHex(uint32_t value)
+		{
+			char digits[8];
+			size_t count = 0;
+			do
+			{
+				digits[7 - count++] = "0123456789abcdef"[value & 0xf];
+				value >>= 4;
+			} while (value);
+			append(digits + 8 - count, count);
+		}
+
+		void appendDecimal(uint32_t value)
+		{
+			char digits[10];
+			size_t count = 0;
+			do
+			{
+				digits[9 - count++] = static_cast<char>('0' + value % 10);
+				value /= 10;
+			} while (value);
+			append(digits + 10 - count, count);
+		}
+
+		void append(const char* text, size_t length)
+		{
+			if (size + length >= capacity)
+			{
+				truncated = true;
+				length = capacity ? capacity - 1 - size : 0;
+			}
+			if (length)
+			{
+				memcpy(data + size, text, length);
+				size += length;
+			}
+			if (capacity)
+			{
+				data[size] = 0;
+			}
+		}
+
+		const char* c_str() const { return data; }
+		size_t length() const { return size; }
+		bool isTruncated() const { return truncated; }
+
+	private:
+		char* data;
+		size_t capacity;
+		size_t size = 0;
+		bool truncated = false;
+	};
+}
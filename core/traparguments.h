@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include "memory.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Arguments of a TRAP handled by the host, read directly from the caller's stack.
+    /// The arguments are indexed in words because the stack can have a mix of word and long arguments:
+    /// the function number is usually word 0 and a long argument following it starts at word 1.
+    /// </summary>
+    class TrapArguments
+    {
+    public:
+        TrapArguments(const Memory& memory, uint32_t stackPointer, bool callerIsSupervisor) :
+            memory(memory),
+            stackPointer(stackPointer),
+            supervisor(callerIsSupervisor)
+        {
+        }
+
+        uint16_t getWord(unsigned wordIndex) const
+        {
+            return memory.get<uint16_t>(stackPointer + wordIndex * 2);
+        }
+
+        uint32_t getLong(unsigned wordIndex) const
+        {
+            return memory.get<uint32_t>(stackPointer + wordIndex * 2);
+        }
+
+        /// <summary>
+        /// Indicates if an argument was outside the guest memory. Its value is 0 and the fault stays latched in the Memory,
+        /// so the handler returns without running the function and the CPU raises the bus error after the TRAP.
+        /// </summary>
+        bool hasFault() const { return memory.hasFault(); }
+
+        /// <summary>
+        /// Address of the first argument in the guest memory.
+        /// </summary>
+        uint32_t getAddress() const { return stackPointer; }
+
+        /// <summary>
+        /// Indicates if the caller was running in supervisor mode.
+        /// </summary>
+        bool callerIsSupervisor() const { return supervisor; }
+
+    private:
+        const Memory& memory;
+        uint32_t stackPointer;
+        bool supervisor;
+    };
+}
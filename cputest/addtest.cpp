@@ -774,4 +774,28 @@ BOOST_AUTO_TEST_CASE(addx_memory_l)
 			BOOST_CHECK_EQUAL(1, cpu.sr.x);
 		});
 }
+
+BOOST_AUTO_TEST_CASE(addq_displacement_and_index)
+{
+	unsigned char code[] = {
+		0x41, 0xfa, 0x00, 0x12, // lea value(pc), a0
+		0x70, 0x02,             // moveq #2, d0
+		0x52, 0x68, 0x00, 0x02, // addq.w #1, 2(a0)
+		0x54, 0x70, 0x00, 0xfe, // addq.w #2, -2(a0,d0.w)
+		0x72, 0x2a,             // moveq #42, d1
+		0x4e, 0x40,             // trap #0
+		0xff, 0xff,             //
+		0x12, 0x34,             // value: dc.w $1234
+		0x56, 0x78,             // dc.w $5678
+	};
+
+	// the extension word of a read modify write operand is fetched once, an 8 bits displacement is signed
+	verifyExecution(code, sizeof(code), [](const Cpu& cpu)
+		{
+			BOOST_CHECK_EQUAL(0x14, cpu.a0);
+			BOOST_CHECK_EQUAL(42, cpu.d1);
+			BOOST_CHECK_EQUAL(0x1236, cpu.mem.get<uint16_t>(0x14));
+			BOOST_CHECK_EQUAL(0x5679, cpu.mem.get<uint16_t>(0x16));
+		});
+}
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
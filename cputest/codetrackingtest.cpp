@@ -0,0 +1,94 @@
+#include <boost/test/unit_test.hpp>
+#include "../core/cpu.h"
+#include "../core/memory.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(cpuSuite_codeTracking)
+
+BOOST_AUTO_TEST_CASE(untracked_memory)
+{
+	Memory memory(1024, 0);
+
+	memory.set<uint32_t>(0x100, 0x12345678);
+
+	BOOST_CHECK(!memory.isCode(0x100));
+	BOOST_CHECK_EQUAL(0, memory.getGeneration(0x100));
+}
+
+BOOST_AUTO_TEST_CASE(write_to_code_page)
+{
+	// Arrange
+	Memory memory(1024, 0);
+	memory.markCode(0x110, 0x10);
+
+	// Act
+	memory.set<uint8_t>(0x300, 1);
+	bool wasCode = memory.isCode(0x100);
+	memory.set<uint16_t>(0x1fe, 2);
+	memory.set<uint16_t>(0x120, 3);
+	memory.set<uint16_t>(0x122, 4);
+
+	// Assert
+	BOOST_CHECK(wasCode);
+	BOOST_CHECK(!memory.isCode(0x100));
+	BOOST_CHECK_EQUAL(1, memory.getGeneration(0x100));
+	BOOST_CHECK_EQUAL(0, memory.getGeneration(0x300));
+}
+
+BOOST_AUTO_TEST_CASE(write_across_two_code_pages)
+{
+	// Arrange
+	Memory memory(1024, 0);
+	memory.markCode(0x1f0, 0x20);
+
+	// Act
+	memory.set<uint32_t>(0x1fe, 0);
+
+	// Assert
+	BOOST_CHECK_EQUAL(1, memory.getGeneration(0x100));
+	BOOST_CHECK_EQUAL(1, memory.getGeneration(0x200));
+	BOOST_CHECK(!memory.isCode(0x1f0));
+	BOOST_CHECK(!memory.isCode(0x200));
+}
+
+BOOST_AUTO_TEST_CASE(host_write)
+{
+	// Arrange
+	Memory memory(1024, 0);
+	memory.markCode(0, 0x400);
+
+	// Act
+	memory.noteWrite(0x280, 0x100);
+
+	// Assert
+	BOOST_CHECK_EQUAL(0, memory.getGeneration(0x100));
+	BOOST_CHECK_EQUAL(1, memory.getGeneration(0x200));
+	BOOST_CHECK_EQUAL(1, memory.getGeneration(0x300));
+	BOOST_CHECK(memory.isCode(0x100));
+}
+
+BOOST_AUTO_TEST_CASE(guest_patches_its_code)
+{
+	// Arrange
+	unsigned char code[] = {
+		0x33, 0xfc, 0x70, 0x02, 0x00, 0x00, 0x00, 0x0e,     // move.w  #$7002,patch
+		0x31, 0xfc, 0x12, 0x34, 0x02, 0x00,                 // move.w  #$1234,$200.w
+		0x70, 0x01,                                         // patch:  moveq #1,d0
+		0xff, 0xff };
+	Memory memory(1024, 0, code, sizeof(code));
+	memory.markCode(0, sizeof(code));
+	Cpu cpu(memory);
+
+	// Act
+	cpu.reset();
+	cpu.start(0, 1024, 1024);
+
+	// Assert
+	BOOST_CHECK_EQUAL(2, cpu.d0);
+	BOOST_CHECK_EQUAL(1, cpu.mem.getGeneration(0));
+	BOOST_CHECK(!cpu.mem.isCode(0));
+	BOOST_CHECK_EQUAL(0, cpu.mem.getGeneration(0x200));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -144,11 +144,11 @@ BOOST_AUTO_TEST_CASE(cmpa)
 	cpu.reset();
 	cpu.start(100);
 
-	// Assert
+	// Assert: the source is sign-extended, $00007070 - $ffff8181 is computed on 32 bits
 	BOOST_CHECK_EQUAL(1, cpu.sr.c);
 	BOOST_CHECK_EQUAL(0, cpu.sr.z);
-	BOOST_CHECK_EQUAL(1, cpu.sr.n);
-	BOOST_CHECK_EQUAL(1, cpu.sr.v);
+	BOOST_CHECK_EQUAL(0, cpu.sr.n);
+	BOOST_CHECK_EQUAL(0, cpu.sr.v);
 }
 
 BOOST_AUTO_TEST_CASE(cmpa_165f)
@@ -86,7 +86,7 @@ BOOST_AUTO_TEST_CASE(bls)
 BOOST_AUTO_TEST_CASE(blt)
 {
 	//                   XNZVC
-	verifyBccExecution(0b01011, 0x6d); // N=1 V=1
+	verifyBccExecution(0b01001, 0x6d); // N=1 V=0
 }
 
 BOOST_AUTO_TEST_CASE(bmi)
@@ -527,4 +527,29 @@ BOOST_AUTO_TEST_CASE(addressMode_w111_001)
 			BOOST_CHECK_EQUAL(0x21, cpu.mem.get<uint16_t>(0x3200a));
 		});
 }
+BOOST_AUTO_TEST_CASE(threaded_and_table_dispatch)
+{
+	unsigned char code[] = {
+		0x72, 0x09,             // moveq   #9,d1
+		0x70, 0x00,             // moveq   #0,d0
+		0xd0, 0x81,             // loop:   add.l   d1,d0
+		0x61, 0x06,             //         bsr.s   sub
+		0x51, 0xc9, 0xff, 0xfa, //         dbra    d1,loop
+		0xff, 0xff,
+		0x52, 0x82,             // sub:    addq.l  #1,d2
+		0x4e, 0x75 };           //         rts
+	for (bool threaded : { true, false })
+	{
+		Memory memory(64, 0, code, sizeof(code));
+		Cpu cpu(memory);
+		cpu.setThreadedDispatch(threaded);
+		cpu.reset();
+		cpu.start(0, 64, 64);
+
+		BOOST_CHECK_EQUAL(45, cpu.d0);
+		BOOST_CHECK_EQUAL(0xffff, cpu.d1);
+		BOOST_CHECK_EQUAL(10, cpu.d2);
+		BOOST_CHECK_EQUAL(64, cpu.a7);
+	}
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -45,6 +45,165 @@ BOOST_AUTO_TEST_CASE(illegal)
 	BOOST_CHECK_EQUAL(23, cpu.d0);
 }
 
+// ===================================================
+// BUS ERROR tests
+// ===================================================
+
+BOOST_AUTO_TEST_CASE(bus_error_frame)
+{
+	unsigned char code[] = {
+		0x00, 0x00, 0x00, 0x00,             // reset - SSP
+		0x00, 0x00, 0x00, 0x00,             // reset - PC
+		0x00, 0x00, 0x00, 0x16,             // Bus error
+		0x00, 0x00, 0x00, 0x00,             // Address error
+
+		0x22, 0x39, 0x00, 0x01, 0x00, 0x00, // move.l $10000, d1
+
+		                                    // BUS_ERROR:
+		0x34, 0x17,                         // move.w (sp), d2
+		0x26, 0x2f, 0x00, 0x02,             // move.l 2(sp), d3
+		0x38, 0x2f, 0x00, 0x06,             // move.w 6(sp), d4
+		0x2a, 0x2f, 0x00, 0x0a,             // move.l 10(sp), d5
+		0xff, 0xff
+	};
+
+	// Arrange
+	Memory memory(256, 0, code, sizeof(code));
+	Cpu cpu(memory);
+
+	// Act
+	cpu.reset();
+	cpu.start(0x10, 256, 192);
+
+	// Assert
+	BOOST_CHECK_EQUAL(0x19, cpu.d2);        // read, not an instruction fetch, user data
+	BOOST_CHECK_EQUAL(0x10000, cpu.d3);
+	BOOST_CHECK_EQUAL(0x2239, cpu.d4);
+	BOOST_CHECK_EQUAL(0x16, cpu.d5);
+	BOOST_CHECK_EQUAL(192 - 14, cpu.a7);
+}
+
+BOOST_AUTO_TEST_CASE(bus_error_write)
+{
+	unsigned char code[] = {
+		0x00, 0x00, 0x00, 0x00,             // reset - SSP
+		0x00, 0x00, 0x00, 0x00,             // reset - PC
+		0x00, 0x00, 0x00, 0x16,             // Bus error
+		0x00, 0x00, 0x00, 0x00,             // Address error
+
+		0x23, 0xc0, 0x00, 0x01, 0x00, 0x00, // move.l d0, $10000
+
+		                                    // BUS_ERROR:
+		0x34, 0x17,                         // move.w (sp), d2
+		0x26, 0x2f, 0x00, 0x02,             // move.l 2(sp), d3
+		0xff, 0xff
+	};
+
+	// Arrange
+	Memory memory(256, 0, code, sizeof(code));
+	Cpu cpu(memory);
+
+	// Act
+	cpu.reset();
+	cpu.setSupervisorMode(true);
+	cpu.start(0x10, 192, 192);
+
+	// Assert
+	BOOST_CHECK_EQUAL(0x0d, cpu.d2);        // write, not an instruction fetch, supervisor data
+	BOOST_CHECK_EQUAL(0x10000, cpu.d3);
+}
+
+BOOST_AUTO_TEST_CASE(bus_error_without_handler)
+{
+	unsigned char code[] = {
+		0x00, 0x00, 0x00, 0x00,             // reset - SSP
+		0x00, 0x00, 0x00, 0x00,             // reset - PC
+		0x00, 0x00, 0x00, 0x00,             // Bus error
+		0x00, 0x00, 0x00, 0x00,             // Address error
+
+		0x70, 0x01,                         // moveq.l #1, d0
+		0x22, 0x39, 0x00, 0x01, 0x00, 0x00, // move.l $10000, d1
+		0x70, 0x02,                         // moveq.l #2, d0
+		0xff, 0xff
+	};
+
+	// Arrange
+	Memory memory(256, 0, code, sizeof(code));
+	Cpu cpu(memory);
+
+	// Act
+	cpu.reset();
+	cpu.start(0x10, 256, 192);
+
+	// Assert: the cpu halts on the fault
+	BOOST_CHECK_EQUAL(1, cpu.d0);
+}
+
+// ===================================================
+// ADDRESS ERROR tests
+// ===================================================
+
+BOOST_AUTO_TEST_CASE(address_error_odd_word)
+{
+	unsigned char code[] = {
+		0x00, 0x00, 0x00, 0x00,             // reset - SSP
+		0x00, 0x00, 0x00, 0x00,             // reset - PC
+		0x00, 0x00, 0x00, 0x00,             // Bus error
+		0x00, 0x00, 0x00, 0x1a,             // Address error
+
+		0x70, 0x01,                         // moveq.l #1, d0
+		0x32, 0x39, 0x00, 0x00, 0x00, 0x11, // move.w $11, d1
+		0x70, 0x02,                         // moveq.l #2, d0
+
+		                                    // ADDRESS_ERROR:
+		0x34, 0x17,                         // move.w (sp), d2
+		0x26, 0x2f, 0x00, 0x02,             // move.l 2(sp), d3
+		0xff, 0xff
+	};
+
+	// Arrange
+	Memory memory(256, 0, code, sizeof(code));
+	Cpu cpu(memory);
+
+	// Act
+	cpu.reset();
+	cpu.start(0x10, 256, 192);
+
+	// Assert
+	BOOST_CHECK_EQUAL(1, cpu.d0);
+	BOOST_CHECK_EQUAL(0x19, cpu.d2);        // read, not an instruction fetch, user data
+	BOOST_CHECK_EQUAL(0x11, cpu.d3);
+}
+
+BOOST_AUTO_TEST_CASE(address_error_odd_pc)
+{
+	unsigned char code[] = {
+		0x00, 0x00, 0x00, 0x00,             // reset - SSP
+		0x00, 0x00, 0x00, 0x00,             // reset - PC
+		0x00, 0x00, 0x00, 0x00,             // Bus error
+		0x00, 0x00, 0x00, 0x16,             // Address error
+
+		0x4e, 0xf9, 0x00, 0x00, 0x00, 0x21, // jmp $21
+
+		                                    // ADDRESS_ERROR:
+		0x34, 0x17,                         // move.w (sp), d2
+		0x26, 0x2f, 0x00, 0x02,             // move.l 2(sp), d3
+		0xff, 0xff
+	};
+
+	// Arrange
+	Memory memory(256, 0, code, sizeof(code));
+	Cpu cpu(memory);
+
+	// Act
+	cpu.reset();
+	cpu.start(0x10, 256, 192);
+
+	// Assert
+	BOOST_CHECK_EQUAL(0x12, cpu.d2);        // read, instruction fetch, user program
+	BOOST_CHECK_EQUAL(0x21, cpu.d3);
+}
+
 // ===================================================
 // RTE tests
 // ===================================================
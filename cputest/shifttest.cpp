@@ -287,7 +287,7 @@ BOOST_AUTO_TEST_CASE(lsl_b)
 	BOOST_CHECK_EQUAL(0, cpu.sr.x);
 	BOOST_CHECK_EQUAL(1, cpu.sr.n);
 	BOOST_CHECK_EQUAL(0, cpu.sr.z);
-	BOOST_CHECK_EQUAL(1, cpu.sr.v);
+	BOOST_CHECK_EQUAL(0, cpu.sr.v);	// LSL always clears V
 	BOOST_CHECK_EQUAL(0, cpu.sr.c);
 }
 
@@ -313,7 +313,7 @@ BOOST_AUTO_TEST_CASE(lsl_w)
 	BOOST_CHECK_EQUAL(0, cpu.sr.x);
 	BOOST_CHECK_EQUAL(1, cpu.sr.n);
 	BOOST_CHECK_EQUAL(0, cpu.sr.z);
-	BOOST_CHECK_EQUAL(1, cpu.sr.v);
+	BOOST_CHECK_EQUAL(0, cpu.sr.v);	// LSL always clears V
 	BOOST_CHECK_EQUAL(0, cpu.sr.c);
 }
 
@@ -340,7 +340,7 @@ BOOST_AUTO_TEST_CASE(lsl_l)
 	BOOST_CHECK_EQUAL(1, cpu.sr.x);
 	BOOST_CHECK_EQUAL(0, cpu.sr.n);
 	BOOST_CHECK_EQUAL(0, cpu.sr.z);
-	BOOST_CHECK_EQUAL(1, cpu.sr.v);
+	BOOST_CHECK_EQUAL(0, cpu.sr.v);	// LSL always clears V
 	BOOST_CHECK_EQUAL(1, cpu.sr.c);
 }
 
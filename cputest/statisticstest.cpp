@@ -0,0 +1,53 @@
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include "../core/cpu.h"
+#include "../core/memory.h"
+#include "../core/instructions.h"
+#include "../core/exceptions.h"
+#include "../core/statistics.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(statistics)
+
+BOOST_AUTO_TEST_CASE(instruction_mix)
+{
+	unsigned char code[] = {
+		0x00, 0x00, 0x00, 0x00,             // reset - SSP
+		0x00, 0x00, 0x00, 0x00,             // reset - PC
+		0x00, 0x00, 0x00, 0x00,             // Bus error
+		0x00, 0x00, 0x00, 0x00,             // Address error
+
+		0x7e, 0x03,                         //      moveq.l #3, d7
+		0x52, 0x80,                         // loop addq.l  #1, d0
+		0x51, 0xcf, 0xff, 0xfc,             //      dbra    d7, loop
+		0x22, 0x39, 0x00, 0x01, 0x00, 0x00, //      move.l  $10000, d1
+		0xff, 0xff
+	};
+
+	// Arrange
+	Memory memory(256, 0, code, sizeof(code));
+	Cpu cpu(memory);
+	Statistics stats;
+	cpu.setStatistics(&stats);
+
+	// Act
+	cpu.reset();
+	cpu.start(0x10, 256, 192);
+
+	// Assert
+	BOOST_CHECK_EQUAL(4, cpu.d0);
+	BOOST_CHECK_EQUAL(10, stats.getInstructionCount());
+	BOOST_CHECK_EQUAL(1, stats.getInstructionCount(instructions::MOVEQ));
+	BOOST_CHECK_EQUAL(4, stats.getInstructionCount(instructions::ADDQ));
+	BOOST_CHECK_EQUAL(3, stats.getBranchCount(instructions::DBCC, true));
+	BOOST_CHECK_EQUAL(1, stats.getBranchCount(instructions::DBCC, false));
+	BOOST_CHECK_EQUAL(1, stats.getExceptionCount(Exceptions::BUS_ERROR));
+
+	std::ostringstream json;
+	stats.writeJson(json);
+	BOOST_CHECK(json.str().find("\"by_size\":{\"word\":4,\"long\":6}") != std::string::npos);
+	BOOST_CHECK(json.str().find("\"abs.l\":1") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,186 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "imagefile.h"
+#include "listing.h"
+#include "sourcewriter.h"
+#include "symboltable.h"
+
+using namespace mc68000;
+
+int usage()
+{
+    std::cout << "Usage: dasm68000 [options] binaryFile" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -h, --help                   Show this help message" << std::endl;
+    std::cout << "  -s, --symbols <symbols file> Load the labels from the file, default binaryFile.symb or .sym if it exists" << std::endl;
+    std::cout << "  -o, --output <listing file>  Write the listing to the file instead of the console" << std::endl;
+    std::cout << "  --from <address>             Start the listing at the address" << std::endl;
+    std::cout << "  --to <address>               Stop the listing before the address" << std::endl;
+    std::cout << "  --raw <address>              The file has no header, its code is loaded at the address" << std::endl;
+    std::cout << "  --source                     Write the whole image as source that asm68000 assembles to the same code" << std::endl;
+    std::cout << "Addresses are decimal, or hexadecimal with a 0x or $ prefix" << std::endl;
+    return 0;
+}
+
+namespace
+{
+    bool parseAddress(const char* text, uint32_t& address)
+    {
+        int base = 10;
+        if (text[0] == '$')
+        {
+            text++;
+            base = 16;
+        }
+        else if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+        {
+            text += 2;
+            base = 16;
+        }
+        char* end;
+        unsigned long value = strtoul(text, &end, base);
+        if (*text == 0 || *end != 0 || value > UINT32_MAX)
+        {
+            return false;
+        }
+        address = static_cast<uint32_t>(value);
+        return true;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    std::string symbolsFilename;
+    std::string outputFilename;
+    uint32_t from = 0;
+    uint32_t to = UINT32_MAX;
+    bool raw = false;
+    uint32_t rawBase = 0;
+    bool source = false;
+
+    if (argc < 2)
+    {
+        std::cerr << "No binary file specified. Use -h or --help for usage information." << std::endl;
+        return 1;
+    }
+    const char* lastArgument = argv[argc - 1];
+    if (strcmp(lastArgument, "-h") == 0 || strcmp(lastArgument, "--help") == 0)
+    {
+        return usage();
+    }
+    if (lastArgument[0] == '-')
+    {
+        std::cerr << "No binary file specified. Use -h or --help for usage information." << std::endl;
+        return 1;
+    }
+    std::string binaryFilename = lastArgument;
+
+    for (int i = 1; i < argc - 1; i++)
+    {
+        bool hasValue = i + 1 < argc - 1;
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            return usage();
+        }
+        else if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--symbols") == 0) && hasValue)
+        {
+            symbolsFilename = argv[++i];
+        }
+        else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && hasValue)
+        {
+            outputFilename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--from") == 0 && hasValue && parseAddress(argv[i + 1], from))
+        {
+            i++;
+        }
+        else if (strcmp(argv[i], "--to") == 0 && hasValue && parseAddress(argv[i + 1], to))
+        {
+            i++;
+        }
+        else if (strcmp(argv[i], "--raw") == 0 && hasValue && parseAddress(argv[i + 1], rawBase))
+        {
+            raw = true;
+            i++;
+        }
+        else if (strcmp(argv[i], "--source") == 0)
+        {
+            source = true;
+        }
+        else
+        {
+            std::cerr << "Invalid option: " << argv[i] << std::endl;
+            std::cerr << "Use -h or --help to see available options" << std::endl;
+            return 1;
+        }
+    }
+    if (source && (from != 0 || to != UINT32_MAX))
+    {
+        std::cerr << "--from and --to cannot be used with --source" << std::endl;
+        return 1;
+    }
+    if (symbolsFilename.empty())
+    {
+        // the binary symbols are used in place, the text ones are parsed
+        for (const char* extension : { ".symb", ".sym" })
+        {
+            std::string defaultSymbols = std::filesystem::path(binaryFilename).replace_extension(extension).string();
+            if (std::filesystem::exists(defaultSymbols))
+            {
+                symbolsFilename = defaultSymbols;
+                break;
+            }
+        }
+    }
+
+    try
+    {
+        ImageFile image(binaryFilename, raw, rawBase);
+        auto symbols = std::make_shared<SymbolTable>();
+        if (!symbolsFilename.empty() && !symbols->load(symbolsFilename.c_str()))
+        {
+            std::cerr << "cannot read the symbols from " << symbolsFilename << std::endl;
+            return 1;
+        }
+
+        std::ofstream outputFile;
+        if (!outputFilename.empty())
+        {
+            outputFile.open(outputFilename, std::ios::binary);
+            if (!outputFile)
+            {
+                std::cerr << "cannot write the listing to " << outputFilename << std::endl;
+                return 1;
+            }
+        }
+        std::ios::sync_with_stdio(false);
+        std::ostream& out = outputFilename.empty() ? std::cout : outputFile;
+        if (source)
+        {
+            SourceWriter writer(out);
+            writer.setSymbols(symbols);
+            if (image.hasHeader())
+            {
+                writer.setHeader(image.getStart(), image.getMemoryStart(), image.getMemoryEnd());
+            }
+            writer.write(image.getBlocks());
+            return 0;
+        }
+        Listing listing(out);
+        listing.setSymbols(symbols);
+        for (const auto& block : image.getBlocks())
+        {
+            listing.write(block, from, to);
+        }
+    }
+    catch (const std::string& error)
+    {
+        std::cerr << "dasm68000: " << error << std::endl;
+        return 1;
+    }
+    return 0;
+}
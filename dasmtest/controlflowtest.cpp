@@ -0,0 +1,96 @@
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include "../core/controlflow.h"
+#include "../core/disasm.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(ControlFlow)
+
+namespace
+{
+	// the word at $1012 is data between two routines
+	const uint8_t program[] = {
+		0x70, 0x05,               // 1000  moveq   #5,d0
+		0x61, 0x00, 0x00, 0x0a,   // 1002  bsr     $100e
+		0x51, 0xc8, 0xff, 0xfa,   // 1006  dbf     d0,$1002
+		0x60, 0x00, 0x00, 0x08,   // 100a  bra     $1014
+		0x52, 0x81,               // 100e  addq.l  #1,d1
+		0x4e, 0x75,               // 1010  rts
+		0xff, 0xff,               // 1012  dc.w    $ffff
+		0x4e, 0x71,               // 1014  nop
+		0x4e, 0x75,               // 1016  rts
+	};
+}
+
+BOOST_AUTO_TEST_CASE(blocks_and_edges)
+{
+	// Arrange
+	ControlFlowGraph graph(program, 0x1000, sizeof(program));
+	graph.addEntryPoint(0x1000);
+
+	// Act
+	graph.build();
+
+	// Assert
+	const auto& blocks = graph.getBlocks();
+	BOOST_REQUIRE_EQUAL(5, blocks.size());
+	BOOST_CHECK_EQUAL(0x1000, blocks[0].start);
+	BOOST_CHECK_EQUAL(0x1002, blocks[0].end);
+	BOOST_CHECK_EQUAL(0x1002, blocks[1].start);
+	BOOST_CHECK_EQUAL(0x100a, blocks[1].end);
+	BOOST_CHECK_EQUAL(2, blocks[1].instructions);
+	BOOST_CHECK_EQUAL(0x100e, blocks[3].start);
+	BOOST_CHECK_EQUAL(0x1012, blocks[3].end);
+	BOOST_CHECK_EQUAL(0x1014, blocks[4].start);
+	BOOST_CHECK(!graph.isInstruction(0x1012));
+	BOOST_CHECK(graph.isInstruction(0x1016));
+
+	const auto& edges = graph.getEdges();
+	BOOST_REQUIRE_EQUAL(5, edges.size());
+	BOOST_CHECK(edges[0].kind == FlowEdgeKind::FallThrough && edges[0].from == 0x1000 && edges[0].to == 0x1002);
+	BOOST_CHECK(edges[1].kind == FlowEdgeKind::Call && edges[1].from == 0x1002 && edges[1].to == 0x100e);
+	BOOST_CHECK(edges[2].kind == FlowEdgeKind::Branch && edges[2].from == 0x1002 && edges[2].to == 0x1002);
+	BOOST_CHECK(edges[3].kind == FlowEdgeKind::FallThrough && edges[3].from == 0x1002 && edges[3].to == 0x100a);
+	BOOST_CHECK(edges[4].kind == FlowEdgeKind::Jump && edges[4].from == 0x100a && edges[4].to == 0x1014);
+}
+
+BOOST_AUTO_TEST_CASE(entry_points_outside_of_the_image)
+{
+	// Arrange
+	ControlFlowGraph graph(program, 0x1000, sizeof(program));
+	graph.addEntryPoint(0x0ffe);
+	graph.addEntryPoint(0x1001);
+	graph.addEntryPoint(0x1018);
+
+	// Act
+	graph.build();
+
+	// Assert
+	BOOST_CHECK(graph.getBlocks().empty());
+}
+
+BOOST_AUTO_TEST_CASE(dot_and_json)
+{
+	// Arrange
+	ControlFlowGraph graph(program, 0x1000, sizeof(program));
+	graph.addEntryPoint(0x1000);
+	graph.build();
+	DisAsm disAsm(reinterpret_cast<const uint16_t*>(program), 0x1000);
+	disAsm.addSymbol(0x100e, "INC");
+	std::ostringstream dot;
+	std::ostringstream json;
+
+	// Act
+	graph.writeDot(dot, disAsm);
+	graph.writeJson(json, disAsm);
+
+	// Assert
+	BOOST_CHECK(dot.str().find("\"0000100a\" -> \"00001014\" [label=\"jump\"];") != std::string::npos);
+	BOOST_CHECK(dot.str().find("INC:\\l0000100e  addq.l #1,d1\\l") != std::string::npos);
+	BOOST_CHECK(json.str().find("{\"start\":4110,\"end\":4114,\"label\":\"INC\",\"instructions\":[{\"address\":4110,\"text\":\"addq.l #1,d1\"}") != std::string::npos);
+	BOOST_CHECK(json.str().find("{\"from\":4098,\"to\":4110,\"kind\":\"call\"}") != std::string::npos);
+	BOOST_CHECK(json.str().find("\"text\":\"bsr INC\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+#include <boost/test/unit_test.hpp>
+#include "../core/decoder.h"
+#include "../core/disasm.h"
+#include "../core/instructions.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(Decoding)
+
+BOOST_AUTO_TEST_CASE(indexed_source)
+{
+	// Arrange
+	Decoder decoder;
+	uint16_t code[] = { 0x2030, 0xa8fc };   // move.l -4(a0,a2.l),d0
+	DecodedInstruction instruction;
+
+	// Act
+	decoder.decode(code, false, 0x1000, instruction);
+
+	// Assert
+	BOOST_CHECK(instructions::MOVE == instruction.instruction);
+	BOOST_CHECK_EQUAL("move", instruction.mnemonic);
+	BOOST_CHECK_EQUAL(4, instruction.size);
+	BOOST_CHECK_EQUAL(2, instruction.length);
+	BOOST_CHECK_EQUAL(2, instruction.operandCount);
+	BOOST_CHECK(OperandKind::Index == instruction.operands[0].kind);
+	BOOST_CHECK_EQUAL(0, instruction.operands[0].reg);
+	BOOST_CHECK_EQUAL(10, instruction.operands[0].index);
+	BOOST_CHECK_EQUAL(4, instruction.operands[0].indexSize);
+	BOOST_CHECK_EQUAL(-4, static_cast<int32_t>(instruction.operands[0].value));
+	BOOST_CHECK(OperandKind::DataRegister == instruction.operands[1].kind);
+}
+
+BOOST_AUTO_TEST_CASE(branch_target)
+{
+	// Arrange
+	Decoder decoder;
+	uint8_t code[] = { 0x66, 0x00, 0xff, 0xf0 };   // bne.w *-14, big endian
+	DecodedInstruction instruction;
+
+	// Act
+	decoder.decode(reinterpret_cast<const uint16_t*>(code), true, 0x1000, instruction);
+
+	// Assert
+	BOOST_CHECK(instructions::BNE == instruction.instruction);
+	BOOST_CHECK_EQUAL(2, instruction.length);
+	BOOST_CHECK(OperandKind::BranchTarget == instruction.operands[0].kind);
+	BOOST_CHECK_EQUAL(0xff2, instruction.operands[0].value);
+}
+
+BOOST_AUTO_TEST_CASE(predecrement_register_list)
+{
+	// Arrange
+	Decoder decoder;
+	uint16_t code[] = { 0x48e7, 0xc080 };   // movem.l d0-d1/a0,-(a7)
+	DecodedInstruction instruction;
+
+	// Act
+	decoder.decode(code, false, 0, instruction);
+
+	// Assert
+	BOOST_CHECK(OperandKind::RegisterList == instruction.operands[0].kind);
+	BOOST_CHECK_EQUAL(0x0103, instruction.operands[0].value);
+	BOOST_CHECK(OperandKind::PreDecrement == instruction.operands[1].kind);
+	BOOST_CHECK_EQUAL(7, instruction.operands[1].reg);
+}
+
+BOOST_AUTO_TEST_CASE(format_decoded_instruction)
+{
+	// Arrange
+	uint8_t code[] = { 0x50, 0x41, 0x4e, 0x75 };   // addq.w #8,d1; rts
+	DisAsm disAsm(reinterpret_cast<const uint16_t*>(code), 0x2000);
+	char buffer[32];
+
+	// Act
+	DecodedInstruction addq = disAsm.decodeInstruction(0x2000);
+	DecodedInstruction rts = disAsm.decodeInstruction(0x2002);
+	size_t length = disAsm.format(addq, buffer, sizeof(buffer));
+
+	// Assert
+	BOOST_CHECK_EQUAL(12, length);
+	BOOST_CHECK_EQUAL("addq.w #8,d1", buffer);
+	BOOST_CHECK(instructions::RTS == rts.instruction);
+	BOOST_CHECK_EQUAL(0, rts.operandCount);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_decode)
+{
+	// Arrange
+	Decoder decoder;
+	uint16_t code[] = { 0x2039, 0x0001, 0x0002 };   // move.l $10002.l,d0
+	DecodedInstruction instruction;
+
+	// Act & Assert
+	BOOST_CHECK(decoder.decode(code, 6, false, 0, instruction));
+	BOOST_CHECK_EQUAL(3, instruction.length);
+	BOOST_CHECK_EQUAL(0x10002, instruction.operands[0].value);
+	BOOST_CHECK(!decoder.decode(code, 4, false, 0, instruction));
+	BOOST_CHECK_EQUAL(3, instruction.length);
+	BOOST_CHECK_EQUAL(0x10000, instruction.operands[0].value);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
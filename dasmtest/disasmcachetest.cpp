@@ -0,0 +1,57 @@
+#include <boost/test/unit_test.hpp>
+#include "../core/disasmcache.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(DisAsmCaches)
+
+BOOST_AUTO_TEST_CASE(disassembled_once)
+{
+	// Arrange
+	Memory memory(1024, 0);
+	memory.set<uint16_t>(0x10, 0x7005);         // moveq #5,d0
+	memory.set<uint16_t>(0x12, 0x4e71);         // nop
+	DisAsm disAsm(static_cast<const uint16_t*>(memory.get<void*>(0)), 0);
+	DisAsmCache cache(memory, disAsm);
+
+	// Act
+	std::string first = cache.disassemble(0x10);
+	std::string second = cache.disassemble(0x10);
+	std::string nop = cache.disassemble(0x12);
+
+	// Assert
+	BOOST_CHECK_EQUAL("moveq.l #$5,d0", first);
+	BOOST_CHECK_EQUAL(first, second);
+	BOOST_CHECK_EQUAL("nop", nop);
+	BOOST_CHECK_EQUAL(2, cache.getMisses());
+	BOOST_CHECK_EQUAL(2, cache.size());
+	BOOST_CHECK(memory.isCode(0x10));
+}
+
+BOOST_AUTO_TEST_CASE(invalidated_by_writes)
+{
+	// Arrange
+	Memory memory(1024, 0);
+	memory.set<uint16_t>(0x10, 0x4e71);         // nop
+	memory.set<uint16_t>(0xfc, 0x203c);         // move.l #$12345678,d0 across two pages
+	memory.set<uint32_t>(0xfe, 0x12345678);
+	DisAsm disAsm(static_cast<const uint16_t*>(memory.get<void*>(0)), 0);
+	DisAsmCache cache(memory, disAsm);
+	cache.disassemble(0x10);
+	cache.disassemble(0xfc);
+
+	// Act
+	memory.set<uint16_t>(0x10, 0x4e75);         // rts
+	std::string patched = cache.disassemble(0x10);
+	memory.set<uint16_t>(0x100, 0);             // last word of the move, in the second page
+	std::string move = cache.disassemble(0xfc);
+	std::string again = cache.disassemble(0xfc);
+
+	// Assert
+	BOOST_CHECK_EQUAL("rts", patched);
+	BOOST_CHECK_EQUAL("move.l #$12340000,d0", move);
+	BOOST_CHECK_EQUAL(move, again);
+	BOOST_CHECK_EQUAL(4, cache.getMisses());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
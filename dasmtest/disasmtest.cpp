@@ -870,4 +870,49 @@ BOOST_AUTO_TEST_CASE(tolower13)
 
 
 
+BOOST_AUTO_TEST_CASE(disassemble_into_buffer)
+{
+    // Arrange
+    DisAsm d;
+    unsigned short memory[2] = { 0x0640, 0x0020 };
+    char buffer[32];
+
+    // Act
+    size_t length = d.disassemble(memory, buffer, sizeof(buffer));
+
+    // Assert
+    BOOST_CHECK_EQUAL(14, length);
+    BOOST_CHECK_EQUAL("addi.w #$20,d0", buffer);
+}
+
+BOOST_AUTO_TEST_CASE(disassemble_into_short_buffer)
+{
+    // Arrange
+    DisAsm d;
+    unsigned short memory[2] = { 0x0640, 0x0020 };
+    char buffer[8];
+
+    // Act
+    size_t length = d.disassemble(memory, buffer, sizeof(buffer));
+
+    // Assert
+    BOOST_CHECK_EQUAL(7, length);
+    BOOST_CHECK_EQUAL("addi.w ", buffer);
+}
+
+BOOST_AUTO_TEST_CASE(dasm_appends_to_arena)
+{
+    // Arrange
+    DisAsm d;
+    unsigned short code[] = { 0x4e71, 0x4e75, 0xffff, 0xffff };
+    std::string arena = "; listing\n";
+
+    // Act
+    size_t count = d.dasm(code, 0x1000, arena);
+
+    // Assert
+    BOOST_CHECK_EQUAL(3, count);
+    BOOST_CHECK_EQUAL("; listing\nnop\nrts\nend\n", arena);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
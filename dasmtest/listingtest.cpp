@@ -0,0 +1,115 @@
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+#include "../core/imagefile.h"
+#include "../core/listing.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(Listings)
+
+namespace
+{
+	const uint8_t code[] = {
+		0x70, 0x05,                         // 1000  moveq   #5,d0
+		0x4e, 0xb9, 0x00, 0x00, 0x10, 0x00, // 1002  jsr     $1000.l
+		0x4e, 0x75,                         // 1008  rts
+		0x20, 0x3c, 0x12, 0x34,             // 100a  move.l  #$1234xxxx,d0 cut by the end of the block
+	};
+
+	/// <summary>
+	/// Writes a binary file in the format of the assembler with code at 0x1000 and 4 bytes at 0x2000.
+	/// </summary>
+	void writeBinary(const char* fileName)
+	{
+		std::ofstream file(fileName, std::ios::binary);
+		uint32_t header[] = { ImageFile::magicNumber, 0x1000, 0x1000, 0x3000, 2, sizeof(code), 0x1000 };
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(code), sizeof(code));
+		uint32_t second[] = { 4, 0x2000 };
+		file.write(reinterpret_cast<const char*>(second), sizeof(second));
+		file.write("\x4e\x71\x4e\x75", 4);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(binary_file_with_header)
+{
+	// Arrange
+	writeBinary("listing.bin");
+
+	// Act
+	ImageFile image("listing.bin");
+
+	// Assert
+	BOOST_CHECK(image.hasHeader());
+	BOOST_CHECK_EQUAL(0x1000, image.getStart());
+	BOOST_REQUIRE_EQUAL(2, image.getBlocks().size());
+	BOOST_CHECK_EQUAL(0x1000, image.getBlocks()[0].address);
+	BOOST_CHECK_EQUAL(sizeof(code), image.getBlocks()[0].size);
+	BOOST_CHECK_EQUAL(0x2000, image.getBlocks()[1].address);
+	BOOST_CHECK_EQUAL(0x4e, image.getBlocks()[1].data[0]);
+}
+
+BOOST_AUTO_TEST_CASE(raw_file)
+{
+	// Arrange
+	writeBinary("listing.bin");
+
+	// Act
+	ImageFile image("listing.bin", true, 0x400);
+
+	// Assert
+	BOOST_CHECK(!image.hasHeader());
+	BOOST_REQUIRE_EQUAL(1, image.getBlocks().size());
+	BOOST_CHECK_EQUAL(0x400, image.getBlocks()[0].address);
+	BOOST_CHECK_EQUAL(28 + sizeof(code) + 12, image.getBlocks()[0].size);
+	BOOST_CHECK_THROW(ImageFile("missing.bin"), std::string);
+}
+
+BOOST_AUTO_TEST_CASE(lines_with_words_and_labels)
+{
+	// Arrange
+	ImageBlock block = { 0x1000, code, sizeof(code) };
+	auto symbols = std::make_shared<SymbolTable>();
+	symbols->add(0x1000, "START");
+	std::ostringstream out;
+	uint64_t instructions;
+
+	// Act
+	{
+		// a small buffer is flushed after every line
+		Listing listing(out, 16);
+		listing.setSymbols(symbols);
+		instructions = listing.write(block);
+	}
+
+	// Assert
+	BOOST_CHECK_EQUAL(3, instructions);
+	BOOST_CHECK_EQUAL(
+		"START:\n"
+		"00001000  7005                     moveq.l #$5,d0\n"
+		"00001002  4eb9 0000 1000           jsr START\n"
+		"00001008  4e75                     rts\n"
+		"0000100a  203c                     dc.w $203c\n"
+		"0000100c  1234                     dc.w $1234\n", out.str());
+}
+
+BOOST_AUTO_TEST_CASE(address_range)
+{
+	// Arrange
+	ImageBlock block = { 0x1000, code, sizeof(code) };
+	std::ostringstream out;
+	Listing listing(out);
+
+	// Act
+	uint64_t instructions = listing.write(block, 0x1001, 0x1009);
+	listing.flush();
+
+	// Assert
+	BOOST_CHECK_EQUAL(2, instructions);
+	BOOST_CHECK_EQUAL(
+		"00001002  4eb9 0000 1000           jsr $1000.l\n"
+		"00001008  4e75                     rts\n", out.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
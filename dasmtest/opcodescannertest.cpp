@@ -0,0 +1,104 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <vector>
+#include "../core/opcodescanner.h"
+#include "../core/instructions.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(OpcodeScans)
+
+namespace
+{
+	const uint8_t code[] = {
+		0x60, 0x02,                         // 1000  bra.s   $1004
+		0x4e, 0x41,                         // 1002  trap    #1
+		0x4e, 0xb9, 0x00, 0x00, 0x10, 0x00, // 1004  jsr     $1000.l
+		0x4e, 0xc0,                         // 100a  jmp     d0 is an illegal instruction
+		0x51, 0xc8, 0x00, 0x02,             // 100c  dbf     d0,$1010
+		0x4a, 0xfc,                         // 1010  illegal
+		0xa1, 0x23,                         // 1012  line A
+		0x60, 0x00,                         // 1014  bra.w   cut by the end of the image
+	};
+}
+
+BOOST_AUTO_TEST_CASE(candidates_like_a_word_by_word_scan)
+{
+	// Arrange
+	std::mt19937 random(68000);
+	std::vector<uint8_t> image(2 * 1000 + 13);
+	for (auto& byte : image)
+	{
+		byte = static_cast<uint8_t>(random());
+	}
+	std::vector<uint32_t> expected;
+	for (uint32_t offset = 0; offset + 1 < image.size(); offset += 2)
+	{
+		uint16_t opcode = static_cast<uint16_t>((image[offset] << 8) | image[offset + 1]);
+		if ((opcode & 0xf000) == 0x6000 || (opcode & 0xf0f8) == 0x50c8 || (opcode & 0xfff0) == 0x4e40)
+		{
+			expected.push_back(0x400 + offset);
+		}
+	}
+	OpcodeScanner scanner(image.data(), 0x400, static_cast<uint32_t>(image.size()));
+
+	// Act
+	std::vector<uint32_t> candidates = scanner.findCandidates(BranchOpcodes | TrapOpcodes);
+
+	// Assert
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), candidates.begin(), candidates.end());
+	BOOST_CHECK(scanner.findCandidates(0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(illegal_opcodes_like_the_decoder)
+{
+	// Arrange
+	std::mt19937 random(68000);
+	std::vector<uint8_t> image(2 * 1000);
+	for (auto& byte : image)
+	{
+		byte = static_cast<uint8_t>(random());
+	}
+	std::vector<uint32_t> expected;
+	Decoder decoder;
+	DecodedInstruction instruction;
+	for (uint32_t offset = 0; offset < image.size(); offset += 2)
+	{
+		uint16_t code[5] = { static_cast<uint16_t>((image[offset] << 8) | image[offset + 1]) };
+		decoder.decode(code, false, 0, instruction);
+		if (instruction.instruction == instructions::UNKNOWN || instruction.instruction == instructions::ILLEGAL)
+		{
+			expected.push_back(0x400 + offset);
+		}
+	}
+	OpcodeScanner scanner(image.data(), 0x400, static_cast<uint32_t>(image.size()));
+
+	// Act
+	std::vector<uint32_t> candidates = scanner.findCandidates(IllegalOpcodes);
+
+	// Assert
+	BOOST_CHECK(!expected.empty());
+	BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), candidates.begin(), candidates.end());
+}
+
+BOOST_AUTO_TEST_CASE(candidates_confirmed_by_the_decoder)
+{
+	// Arrange
+	OpcodeScanner scanner(code, 0x1000, sizeof(code));
+	const uint32_t all = BranchOpcodes | JumpOpcodes | TrapOpcodes | IllegalOpcodes;
+	const uint32_t candidates[] = { 0x1000, 0x1002, 0x1004, 0x100a, 0x100c, 0x1010, 0x1012, 0x1014 };
+	const uint32_t instructions[] = { 0x1000, 0x1002, 0x1004, 0x100a, 0x100c, 0x1010, 0x1012 };
+	const uint32_t jumps[] = { 0x1004 };
+
+	// Act
+	std::vector<uint32_t> foundCandidates = scanner.findCandidates(all);
+	std::vector<uint32_t> foundInstructions = scanner.find(all);
+	std::vector<uint32_t> foundJumps = scanner.find(JumpOpcodes);
+
+	// Assert
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(candidates), std::end(candidates), foundCandidates.begin(), foundCandidates.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(instructions), std::end(instructions), foundInstructions.begin(), foundInstructions.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(jumps), std::end(jumps), foundJumps.begin(), foundJumps.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "../core/paralleldisasm.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(ParallelDisassembly)
+
+namespace
+{
+	const uint8_t routine[] = {
+		0x70, 0x05,                         // moveq   #5,d0
+		0x20, 0x3c, 0x12, 0x34, 0x56, 0x78, // move.l  #$12345678,d0
+		0x51, 0xc8, 0xff, 0xf6,             // dbf     d0,start
+		0x4e, 0x75,                         // rts
+	};
+
+	const char* const routineText = "moveq.l #$5,d0\nmove.l #$12345678,d0\ndbf d0,offset_0xfff6\nrts\n";
+
+	/// <summary>
+	/// Image made of copies of routine, with a boundary at the start of each copy.
+	/// </summary>
+	std::vector<uint8_t> copies(size_t count)
+	{
+		std::vector<uint8_t> image;
+		for (size_t i = 0; i < count; i++)
+		{
+			image.insert(image.end(), routine, routine + sizeof(routine));
+		}
+		return image;
+	}
+
+	std::string expected(size_t count)
+	{
+		std::string text;
+		for (size_t i = 0; i < count; i++)
+		{
+			text += routineText;
+		}
+		return text;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(merged_in_address_order)
+{
+	// Arrange
+	const size_t count = 100;
+	std::vector<uint8_t> image = copies(count);
+
+	for (unsigned threads : { 1u, 4u })
+	{
+		ParallelDisAsm disAsm(reinterpret_cast<const uint16_t*>(image.data()), 0x1000, static_cast<uint32_t>(image.size()));
+		for (size_t i = 0; i < count; i++)
+		{
+			disAsm.addBoundary(0x1000 + static_cast<uint32_t>(i * sizeof(routine)));
+		}
+		disAsm.setThreads(threads);
+		std::string output;
+
+		// Act
+		size_t instructions = disAsm.disassemble(output);
+
+		// Assert
+		BOOST_CHECK_EQUAL(4 * count, instructions);
+		BOOST_CHECK_EQUAL(expected(count), output);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(symbols_and_end_of_image)
+{
+	// Arrange
+	std::vector<uint8_t> image = copies(2);
+	// bsr to the second copy, then move.l #xxx,d0 cut after its first extension word
+	image.insert(image.end(), { 0x61, 0x00, 0xff, 0xf0, 0x20, 0x3c, 0x12, 0x34 });
+	ParallelDisAsm disAsm(reinterpret_cast<const uint16_t*>(image.data()), 0x2000, static_cast<uint32_t>(image.size()));
+	disAsm.addBoundary(0x2000 + sizeof(routine));
+	disAsm.addBoundary(0x2001);
+	disAsm.addBoundary(0x3000);
+	auto symbols = std::make_shared<SymbolTable>();
+	symbols->add(0x2000 + sizeof(routine), "LOOP");
+	disAsm.setSymbols(symbols);
+	disAsm.setThreads(2);
+	std::string output;
+
+	// Act
+	size_t instructions = disAsm.disassemble(output);
+
+	// Assert
+	BOOST_CHECK_EQUAL(9, instructions);
+	BOOST_CHECK_EQUAL(expected(2) + "bsr LOOP\n", output);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include "../core/sourcewriter.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(Sources)
+
+namespace
+{
+	const uint8_t code[] = {
+		0x70, 0x05,                         // 1000  moveq   #5,d0
+		0x66, 0xfc,                         // 1002  bne.s   $1000
+		0x60, 0x00, 0x00, 0x08,             // 1004  bra.w   $100e
+		0x4e, 0xb9, 0x00, 0x00, 0x10, 0x00, // 1008  jsr     $1000.l
+		0x51, 0xc8, 0xff, 0xf0,             // 100e  dbf     d0,$1000
+		0x44, 0xfc, 0x00, 0x12,             // 1012  move    #$12,ccr has no syntax in the assembler
+		0x30, 0x30, 0x01, 0x02,             // 1016  move.w  2(a0,d0.w),d0 with the bit 8 of the extension set
+		0x48, 0xe7, 0xc0, 0xc0,             // 101a  movem.l d0-d1/a0-a1,-(a7)
+		0x02, 0x00, 0x00, 0x0f,             // 101e  andi.b  #$f,d0
+		0x61, 0x00, 0x10, 0x00,             // 1022  bsr.w   $2024 outside of the image
+		0x4a, 0xfc,                         // 1026  illegal
+		0xff, 0xff,                         // 1028  unknown
+		0x20, 0x3c, 0x12, 0x34,             // 102a  move.l  #$1234xxxx,d0 cut by the end of the block
+	};
+}
+
+BOOST_AUTO_TEST_CASE(labels_and_data)
+{
+	// Arrange
+	std::vector<ImageBlock> blocks = { { 0x1000, code, sizeof(code) } };
+	auto symbols = std::make_shared<SymbolTable>();
+	symbols->add(0x1000, "START");
+	std::ostringstream out;
+	SourceWriter writer(out);
+	writer.setSymbols(symbols);
+
+	// Act
+	uint64_t instructions = writer.write(blocks);
+
+	// Assert
+	BOOST_CHECK_EQUAL(9, instructions);
+	BOOST_CHECK_EQUAL(
+		"L_00002024 equ $2024\n"
+		"        org     $1000\n"
+		"START\n"
+		"        moveq   #5,d0\n"
+		"        bne     $1000\n"
+		"        bra     L_0000100e\n"
+		"        jsr     START.l\n"
+		"L_0000100e\n"
+		"        dbf     d0,START\n"
+		"        dc.w    $44fc,$0012 ; move #$12,ccr\n"
+		"        dc.w    $3030,$0102 ; move.w 2(a0,d0),d0\n"
+		"        movem.l d0-d1/a0-a1,-(a7)\n"
+		"        andi.b  #$f,d0\n"
+		"        bsr     L_00002024\n"
+		"        illegal\n"
+		"        dc.w    $ffff\n"
+		"        dc.w    $203c,$1234\n", out.str());
+}
+
+BOOST_AUTO_TEST_CASE(blocks_and_symbol_names)
+{
+	// Arrange
+	const uint8_t first[] = { 0x4e, 0xb8, 0x20, 0x00, 0x4e, 0x75 };   // jsr $2000.w, rts
+	const uint8_t second[] = { 0x4e, 0x71, 0x4e, 0x75, 0x12 };        // nop, rts and an odd byte
+	std::vector<ImageBlock> blocks = { { 0x1000, first, sizeof(first) }, { 0x2000, second, sizeof(second) } };
+	auto symbols = std::make_shared<SymbolTable>();
+	symbols->add(0x1000, "d0");         // a register
+	symbols->add(0x1004, "MAIN");
+	symbols->add(0x2000, "MAIN");       // a duplicate
+	symbols->add(0x2002, "LOOP");
+	std::ostringstream out;
+	SourceWriter writer(out);
+	writer.setSymbols(symbols);
+
+	// Act
+	uint64_t instructions = writer.write(blocks);
+
+	// Assert
+	BOOST_CHECK_EQUAL(4, instructions);
+	BOOST_CHECK_EQUAL(
+		"        org     $1000\n"
+		"        jsr     L_00002000.w\n"
+		"MAIN\n"
+		"        rts\n"
+		"        org     $2000\n"
+		"L_00002000\n"
+		"        nop\n"
+		"LOOP\n"
+		"        rts\n"
+		"        dc.b    $12\n", out.str());
+}
+
+BOOST_AUTO_TEST_CASE(header_directives)
+{
+	// Arrange
+	const uint8_t program[] = { 0x70, 0x05, 0x4e, 0x75 };             // moveq #5,d0, rts
+	std::vector<ImageBlock> blocks = { { 0x900, program, sizeof(program) } };
+	auto symbols = std::make_shared<SymbolTable>();
+	symbols->add(0x900, "START");
+	std::ostringstream out;
+	SourceWriter writer(out);
+	writer.setSymbols(symbols);
+	writer.setHeader(0x900, 0x900, 0x8000);
+	std::ostringstream unnamed;
+	SourceWriter unnamedWriter(unnamed);
+	unnamedWriter.setHeader(0x902, 0, 0);
+
+	// Act
+	writer.write(blocks);
+	unnamedWriter.write(blocks);
+
+	// Assert
+	BOOST_CHECK_EQUAL(
+		"        memory  $900,$8000\n"
+		"        org     $900\n"
+		"START\n"
+		"        moveq   #5,d0\n"
+		"        rts\n"
+		"        end     START\n", out.str());
+	BOOST_CHECK_EQUAL(
+		"        org     $900\n"
+		"        moveq   #5,d0\n"
+		"        rts\n"
+		"        end     $902\n", unnamed.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
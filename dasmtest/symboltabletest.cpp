@@ -0,0 +1,130 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <fstream>
+#include "../core/disasm.h"
+#include "../core/symboltable.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(Symbols)
+
+namespace
+{
+	/// <summary>
+	/// Binary symbols file as written by asm68000, with its tables in increasing order of addresses.
+	/// </summary>
+	void writeBinarySymbols(const char* fileName, size_t size = SIZE_MAX)
+	{
+		const char pool[] = "ALIAS\0CSTART\0WSTART\0CR\0\0";
+		const uint32_t tables[] = {
+			SymbolTable::binaryMagicNumber, 3, 1, sizeof(pool) - 1,
+			2344, 2344, 2372,               // addresses
+			0, 6, 13,                       // names
+			20, 0, 13,                      // CR, Integer, 13
+		};
+		std::string content(reinterpret_cast<const char*>(tables), sizeof(tables));
+		content.append(pool, sizeof(pool) - 1);
+		std::ofstream file(fileName, std::ios::binary);
+		file.write(content.data(), std::min(size, content.size()));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(exact_and_preceding_lookups)
+{
+	// Arrange
+	SymbolTable symbols;
+	symbols.add(0x2000, "MAIN");
+	symbols.add(0x1000, "START");
+	symbols.add(0x3000, "END");
+	symbols.add(0x2000, "LOOP");
+
+	// Act
+	size_t exact = symbols.find(0x2000);
+	size_t preceding = symbols.findPreceding(0x2fff);
+
+	// Assert
+	BOOST_REQUIRE_EQUAL(3, symbols.size());
+	BOOST_CHECK_EQUAL(0x1000, symbols.getAddress(0));
+	BOOST_CHECK_EQUAL("LOOP", symbols.getName(exact));
+	BOOST_CHECK_EQUAL("LOOP", symbols.getName(preceding));
+	BOOST_CHECK_EQUAL(2, symbols.findPreceding(0xffffffff));
+	BOOST_CHECK(symbols.find(0x2002) == SymbolTable::npos);
+	BOOST_CHECK(symbols.findPreceding(0x0fff) == SymbolTable::npos);
+	BOOST_CHECK(SymbolTable().findPreceding(0x1000) == SymbolTable::npos);
+	BOOST_CHECK_EQUAL("START", symbols.locate(0x1000));
+	BOOST_CHECK_EQUAL("LOOP+0x12", symbols.locate(0x2012));
+	BOOST_CHECK_EQUAL("", symbols.locate(0x10));
+}
+
+BOOST_AUTO_TEST_CASE(load_labels)
+{
+	// Arrange
+	{
+		std::ofstream file("symboltable.sym");
+		file << "# Labels" << std::endl << "WSTART 2372" << std::endl << "CSTART 2344" << std::endl << "ALIAS 2344" << std::endl
+			<< "# Symbols" << std::endl << "CR 13" << std::endl;
+	}
+	SymbolTable symbols;
+	symbols.add(0x10, "OLD");
+
+	// Act
+	bool loaded = symbols.load("symboltable.sym");
+
+	// Assert
+	BOOST_CHECK(loaded);
+	BOOST_REQUIRE_EQUAL(2, symbols.size());
+	BOOST_CHECK_EQUAL("ALIAS", symbols.getName(symbols.find(2344)));
+	BOOST_CHECK_EQUAL("WSTART", symbols.getName(symbols.find(2372)));
+	BOOST_CHECK(!symbols.load("missing.sym"));
+}
+
+BOOST_AUTO_TEST_CASE(load_binary_labels)
+{
+	// Arrange
+	writeBinarySymbols("symboltable.symb");
+	writeBinarySymbols("truncated.symb", 40);
+	SymbolTable symbols;
+	symbols.add(0x10, "OLD");
+
+	// Act
+	bool loaded = symbols.load("symboltable.symb");
+	SymbolTable copy = symbols;
+	copy.add(0x10, "NEW");
+
+	// Assert
+	BOOST_CHECK(loaded);
+	BOOST_REQUIRE_EQUAL(3, symbols.size());
+	BOOST_CHECK_EQUAL("CSTART", symbols.getName(symbols.find(2344)));
+	BOOST_CHECK_EQUAL("WSTART", symbols.getName(symbols.find(2372)));
+	BOOST_CHECK_EQUAL("CSTART+0x2", symbols.locate(2346));
+	BOOST_CHECK(symbols.find(0x10) == SymbolTable::npos);
+	BOOST_REQUIRE_EQUAL(3, copy.size());
+	BOOST_CHECK_EQUAL("NEW", copy.getName(copy.find(0x10)));
+	BOOST_CHECK_EQUAL("CSTART", copy.getName(copy.find(2344)));
+	BOOST_CHECK_EQUAL("WSTART", copy.getName(copy.find(2372)));
+	BOOST_CHECK(!symbols.load("truncated.symb"));
+}
+
+BOOST_AUTO_TEST_CASE(shared_between_disassemblers)
+{
+	// Arrange
+	auto symbols = std::make_shared<SymbolTable>();
+	symbols->add(0x12345678, "target");
+	unsigned short memory[3] = { 0x3079, 0x1234, 0x5678 };
+	DisAsm first;
+	DisAsm second;
+	first.setSymbols(symbols);
+	second.setSymbols(symbols);
+
+	// Act
+	second.addSymbol(0x12345680, "other");
+
+	// Assert
+	BOOST_CHECK_EQUAL("movea.w target,a0", first.disassemble(memory));
+	BOOST_CHECK_EQUAL("movea.w target,a0", second.disassemble(memory));
+	BOOST_CHECK_EQUAL(1, symbols->size());
+	BOOST_CHECK_EQUAL("target+0x4", first.findLocation(0x1234567c));
+	BOOST_CHECK_EQUAL("other", second.findSymbol(0x12345680));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
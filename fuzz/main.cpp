@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "referencecpu.h"
+#include "../core/cpu.h"
+#include "../core/disasm.h"
+#include "../core/instructions.h"
+
+using namespace mc68000;
+
+namespace
+{
+    // memory map of a case: the exception vectors point to halting stubs, the instruction sits
+    // in a sea of halting words and only the data area is random
+    const uint32_t MEMORY_SIZE = 0x10000;
+    const uint32_t STUBS = 0x0400;              // vector v halts at STUBS + 2 * v
+    const uint32_t CODE = 0x1000;
+    const uint32_t DATA = 0x2000;
+    const uint32_t SUPERVISOR_STACK = 0xfff0;
+    const unsigned MAX_WORDS = 5;               // move.l abs.l,abs.l
+
+    /// <summary>
+    /// The state after one instruction, from either CPU.
+    /// </summary>
+    struct Result
+    {
+        MachineState state;
+        int vector = -1;
+        uint16_t undefinedFlags = 0;
+        std::string error;              // thrown by Cpu
+    };
+
+    /// <summary>
+    /// The instruction being fuzzed with the state in which it starts.
+    /// </summary>
+    struct FuzzCase
+    {
+        MachineState state;
+        Result reference;
+        Result cpu;
+        std::vector<std::string> differences;
+    };
+
+    void writeWord(MachineState& state, uint32_t address, uint16_t word)
+    {
+        state.memory[address] = static_cast<uint8_t>(word >> 8);
+        state.memory[address + 1] = static_cast<uint8_t>(word);
+    }
+
+    uint16_t readWord(const MachineState& state, uint32_t address)
+    {
+        return static_cast<uint16_t>((state.memory[address] << 8) | state.memory[address + 1]);
+    }
+
+    std::string hex(uint32_t value, int width)
+    {
+        std::ostringstream text;
+        text << std::hex << std::setfill('0') << std::setw(width) << value;
+        return text.str();
+    }
+
+    std::string narrow(const wchar_t* name)
+    {
+        std::string text;
+        for (; *name; name++)
+        {
+            text += static_cast<char>(std::tolower(static_cast<unsigned char>(*name)));
+        }
+        return text;
+    }
+
+    class Fuzzer
+    {
+    public:
+        Fuzzer(uint32_t seed, const std::vector<std::string>& only, const std::vector<std::string>& skipped) :
+            random(seed)
+        {
+            // the valid opcodes, grouped by instruction so that MOVE does not drown the others
+            NoOpCpu decoder;
+            std::vector<std::vector<uint16_t>> byInstruction(instructions::MAX_INSTRUCTIONS);
+            for (uint32_t opcode = 0; opcode < 0x10000; opcode++)
+            {
+                uint16_t id = static_cast<uint16_t>(decoder(static_cast<uint16_t>(opcode)));
+                if (id != instructions::UNKNOWN && isSelected(id, only, skipped))
+                {
+                    byInstruction[id].push_back(static_cast<uint16_t>(opcode));
+                }
+            }
+            for (auto& group : byInstruction)
+            {
+                if (!group.empty())
+                {
+                    opcodes.push_back(std::move(group));
+                }
+            }
+        }
+
+        bool hasOpcodes() const
+        {
+            return !opcodes.empty();
+        }
+
+        /// <summary>
+        /// Draws a case that both CPUs can run to a halt.
+        /// </summary>
+        FuzzCase generate()
+        {
+            for (;;)
+            {
+                FuzzCase fuzzCase;
+                MachineState& state = fuzzCase.state;
+                state.memory.resize(MEMORY_SIZE);
+                for (uint32_t address = DATA; address < MEMORY_SIZE; address++)
+                {
+                    state.memory[address] = static_cast<uint8_t>(random());
+                }
+                const auto& group = opcodes[random() % opcodes.size()];
+                writeWord(state, CODE, group[random() % group.size()]);
+                for (unsigned i = 1; i < MAX_WORDS; i++)
+                {
+                    writeWord(state, CODE + 2 * i, extensionWord());
+                }
+                for (unsigned i = 0; i < 8; i++)
+                {
+                    state.d[i] = dataValue();
+                    state.a[i] = i < 7 ? address() : (DATA + 0x6000 + random() % 0x6000) & ~1u;
+                }
+                state.sr = random() & 0x1f;
+                state.pc = CODE;
+                if (prepare(fuzzCase))
+                {
+                    return fuzzCase;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Runs the case through both CPUs and lists the differences of their architectural state.
+        /// </summary>
+        /// <returns>false if the case can't be run: it writes into the code or branches into it</returns>
+        bool prepare(FuzzCase& fuzzCase)
+        {
+            MachineState& state = fuzzCase.state;
+            initializeCode(state);
+
+            fuzzCase.reference = runReference(state);
+            if (fuzzCase.reference.vector < 0)
+            {
+                uint32_t target = fuzzCase.reference.state.pc;
+                if (target < CODE || (target >= CODE && target < instructionEnd))
+                {
+                    return false;
+                }
+                if (target >= DATA)
+                {
+                    // the halting word at the target, then check that the instruction didn't read it
+                    writeWord(state, target, 0xffff);
+                    fuzzCase.reference = runReference(state);
+                    if (fuzzCase.reference.vector >= 0 || fuzzCase.reference.state.pc != target)
+                    {
+                        return false;
+                    }
+                }
+            }
+            if (lowestWrite < DATA)
+            {
+                return false;
+            }
+
+            fuzzCase.cpu = runCpu(state);
+            fuzzCase.differences = compare(fuzzCase.reference, fuzzCase.cpu);
+            return true;
+        }
+
+        /// <summary>
+        /// Simplifies a diverging case: registers, flags, extension words and memory are cleared
+        /// as long as the CPUs still disagree.
+        /// </summary>
+        FuzzCase minimize(const FuzzCase& diverging)
+        {
+            FuzzCase best = diverging;
+            auto attempt = [&](auto change)
+            {
+                FuzzCase candidate;
+                candidate.state = best.state;
+                change(candidate.state);
+                if (prepare(candidate) && !candidate.differences.empty())
+                {
+                    best = candidate;
+                }
+            };
+
+            for (unsigned i = 0; i < 8; i++)
+            {
+                attempt([i](MachineState& state) { state.d[i] = 0; });
+            }
+            for (unsigned i = 0; i < 7; i++)
+            {
+                attempt([i](MachineState& state) { state.a[i] = DATA; });
+            }
+            attempt([](MachineState& state) { state.sr = 0; });
+            for (uint32_t address = CODE + 2; address < CODE + 2 * MAX_WORDS; address += 2)
+            {
+                attempt([address](MachineState& state) { writeWord(state, address, 0); });
+            }
+            for (uint32_t block = MEMORY_SIZE - DATA; block >= 1; block /= 8)
+            {
+                for (uint32_t address = DATA; address < MEMORY_SIZE; address += block)
+                {
+                    if (!isZero(best.state, address, block))
+                    {
+                        attempt([address, block](MachineState& state)
+                        {
+                            std::fill(state.memory.begin() + address, state.memory.begin() + address + block, 0);
+                        });
+                    }
+                }
+            }
+            return best;
+        }
+
+        void report(std::ostream& out, const FuzzCase& fuzzCase)
+        {
+            const MachineState& state = fuzzCase.state;
+            runReference(state);
+            DisAsm disAsm(reinterpret_cast<const uint16_t*>(state.memory.data()), 0);
+            out << "instruction at " << hex(CODE, 4) << ":";
+            for (uint32_t address = CODE; address < instructionEnd; address += 2)
+            {
+                out << " " << hex(readWord(state, address), 4);
+            }
+            out << "    " << disAsm.disassembleInstruction(CODE) << std::endl;
+
+            out << "initial state:" << std::endl;
+            for (unsigned i = 0; i < 8; i++)
+            {
+                out << "  d" << i << "=" << hex(state.d[i], 8) << "  a" << i << "=" << hex(state.a[i], 8) << std::endl;
+            }
+            out << "  ccr=" << hex(state.sr & 0x1f, 2) << " (xnzvc)" << std::endl;
+            out << "  non zero data bytes:";
+            unsigned shown = 0;
+            for (uint32_t address = DATA; address < MEMORY_SIZE; address++)
+            {
+                if (state.memory[address] != 0 && shown++ < 64)
+                {
+                    out << " " << hex(address, 4) << ":" << hex(state.memory[address], 2);
+                }
+            }
+            out << (shown > 64 ? " ..." : "") << std::endl;
+
+            out << "differences (reference / cpu):" << std::endl;
+            for (const auto& difference : fuzzCase.differences)
+            {
+                out << "  " << difference << std::endl;
+            }
+        }
+
+    private:
+        bool isSelected(uint16_t id, const std::vector<std::string>& only, const std::vector<std::string>& skipped)
+        {
+            std::string name = narrow(instructions::names[id]);
+            auto contains = [&name](const std::vector<std::string>& names)
+            {
+                return std::find(names.begin(), names.end(), name) != names.end();
+            };
+            return (only.empty() || contains(only)) && !contains(skipped);
+        }
+
+        /// <summary>
+        /// Extension words: displacements, addresses in the data area or anything.
+        /// </summary>
+        uint16_t extensionWord()
+        {
+            switch (random() % 4)
+            {
+                case 0:
+                    return static_cast<uint16_t>(random() % 0x20);
+                case 1:
+                    return static_cast<uint16_t>((DATA + random() % (0x8000 - DATA)) & ~1u);
+                case 2:
+                    return static_cast<uint16_t>(random() % 2 ? 0 : 0xffff);
+                default:
+                    return static_cast<uint16_t>(random());
+            }
+        }
+
+        /// <summary>
+        /// Data register values around the boundaries of the sizes and the flags.
+        /// </summary>
+        uint32_t dataValue()
+        {
+            static const uint32_t edges[] = {
+                0, 1, 2, 0x7f, 0x80, 0xff, 0x7fff, 0x8000, 0xffff, 0x7fffffff, 0x80000000, 0xffffffff
+            };
+            switch (random() % 4)
+            {
+                case 0:
+                    return edges[random() % std::size(edges)];
+                case 1:
+                    return random() % 64;
+                default:
+                    return static_cast<uint32_t>(random());
+            }
+        }
+
+        /// <summary>
+        /// Address register values: in the data area, sometimes odd or anywhere.
+        /// </summary>
+        uint32_t address()
+        {
+            switch (random() % 16)
+            {
+                case 0:
+                    return static_cast<uint32_t>(random());
+                case 1:
+                    return (DATA + random() % (MEMORY_SIZE - DATA)) | 1;
+                default:
+                    return (DATA + 0x100 + random() % (MEMORY_SIZE - DATA - 0x200)) & ~1u;
+            }
+        }
+
+        /// <summary>
+        /// Vectors, halting stubs and the sea of halting words around the instruction.
+        /// </summary>
+        void initializeCode(MachineState& state)
+        {
+            for (uint32_t vector = 0; vector < 256; vector++)
+            {
+                uint32_t stub = STUBS + 2 * vector;
+                writeWord(state, vector * 4, static_cast<uint16_t>(stub >> 16));
+                writeWord(state, vector * 4 + 2, static_cast<uint16_t>(stub));
+            }
+            for (uint32_t address = STUBS; address < DATA; address += 2)
+            {
+                if (address < CODE || address >= CODE + 2 * MAX_WORDS)
+                {
+                    writeWord(state, address, 0xffff);
+                }
+            }
+            // the extension words the instruction doesn't use halt too
+            runReference(state);
+            for (uint32_t address = instructionEnd; address < CODE + 2 * MAX_WORDS; address += 2)
+            {
+                writeWord(state, address, 0xffff);
+            }
+        }
+
+        Result runReference(const MachineState& state)
+        {
+            Result result;
+            result.state = state;
+            ReferenceOutcome outcome = reference.step(result.state);
+            result.vector = outcome.vector;
+            result.undefinedFlags = outcome.undefinedFlags;
+            instructionEnd = outcome.instructionEnd;
+            lowestWrite = outcome.lowestWrite;
+            return result;
+        }
+
+        Result runCpu(const MachineState& state)
+        {
+            Memory memory(MEMORY_SIZE, 0, state.memory.data(), MEMORY_SIZE);
+            Cpu cpu(memory);
+            cpu.reset();
+            for (int i = 0; i < 8; i++)
+            {
+                cpu.setDRegister(i, state.d[i]);
+                cpu.setARegister(i, state.a[i]);
+            }
+            cpu.setCCR(static_cast<uint8_t>(state.sr));
+            Result result;
+            try
+            {
+                cpu.start(state.pc, state.a[7], SUPERVISOR_STACK);
+            }
+            catch (const char* error)
+            {
+                result.error = error;
+                return result;
+            }
+
+            uint32_t halt = cpu.getPc() - 2;
+            if (halt >= STUBS && halt < STUBS + 2 * 256)
+            {
+                result.vector = static_cast<int>((halt - STUBS) / 2);
+            }
+            const uint32_t* d[] = { &cpu.d0, &cpu.d1, &cpu.d2, &cpu.d3, &cpu.d4, &cpu.d5, &cpu.d6, &cpu.d7 };
+            const uint32_t* a[] = { &cpu.a0, &cpu.a1, &cpu.a2, &cpu.a3, &cpu.a4, &cpu.a5, &cpu.a6, &cpu.a7 };
+            for (int i = 0; i < 8; i++)
+            {
+                result.state.d[i] = *d[i];
+                result.state.a[i] = *a[i];
+            }
+            result.state.pc = halt;
+            result.state.sr = static_cast<uint16_t>(cpu.sr);
+            result.state.memory.resize(MEMORY_SIZE);
+            for (uint32_t address = 0; address < MEMORY_SIZE; address++)
+            {
+                result.state.memory[address] = cpu.mem.get<uint8_t>(address);
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// After an exception only the vector is compared: the frame and the partial updates
+        /// of a faulting instruction are not specified precisely enough.
+        /// </summary>
+        std::vector<std::string> compare(const Result& expected, const Result& actual)
+        {
+            std::vector<std::string> differences;
+            auto check = [&differences](const std::string& name, uint32_t expectedValue, uint32_t actualValue, int width)
+            {
+                if (expectedValue != actualValue)
+                {
+                    differences.push_back(name + ": " + hex(expectedValue, width) + " / " + hex(actualValue, width));
+                }
+            };
+
+            if (!actual.error.empty())
+            {
+                differences.push_back("cpu threw \"" + actual.error + "\"");
+                return differences;
+            }
+            if (expected.vector != actual.vector)
+            {
+                auto vector = [](int value) { return value < 0 ? std::string("none") : std::to_string(value); };
+                differences.push_back("exception vector: " + vector(expected.vector) + " / " + vector(actual.vector));
+                return differences;
+            }
+            if (expected.vector >= 0)
+            {
+                return differences;
+            }
+
+            check("pc", expected.state.pc, actual.state.pc, 8);
+            for (unsigned i = 0; i < 8; i++)
+            {
+                check("d" + std::to_string(i), expected.state.d[i], actual.state.d[i], 8);
+            }
+            for (unsigned i = 0; i < 8; i++)
+            {
+                check("a" + std::to_string(i), expected.state.a[i], actual.state.a[i], 8);
+            }
+            uint16_t mask = static_cast<uint16_t>(~expected.undefinedFlags);
+            check("sr (xnzvc)", expected.state.sr & mask, actual.state.sr & mask, 4);
+            for (uint32_t address = DATA; address < MEMORY_SIZE; address++)
+            {
+                // the name is only formatted for a difference: this loop runs for every case
+                if (expected.state.memory[address] != actual.state.memory[address])
+                {
+                    check("memory " + hex(address, 4), expected.state.memory[address], actual.state.memory[address], 2);
+                }
+            }
+            return differences;
+        }
+
+        static bool isZero(const MachineState& state, uint32_t address, uint32_t size)
+        {
+            for (uint32_t i = address; i < address + size && i < MEMORY_SIZE; i++)
+            {
+                if (state.memory[i] != 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::mt19937 random;
+        std::vector<std::vector<uint16_t>> opcodes;
+        ReferenceCpu reference;
+        uint32_t instructionEnd = CODE;
+        uint32_t lowestWrite = 0xffffffff;
+    };
+
+    int usage()
+    {
+        std::cout << "Usage: cpufuzz [options]" << std::endl;
+        std::cout << "Runs random valid instructions through Cpu and a reference interpreter and compares the results." << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  -h, --help                   Show this help message" << std::endl;
+        std::cout << "  --seed <n>                   Seed of the random generator (default 1)" << std::endl;
+        std::cout << "  --cases <n>                  Number of cases (default 100000)" << std::endl;
+        std::cout << "  --only <instruction>         Fuzz this instruction only, may be repeated (e.g. --only divs)" << std::endl;
+        std::cout << "  --skip <instruction>         Don't fuzz this instruction, may be repeated" << std::endl;
+        std::cout << "  --keep-going                 Count the divergences instead of stopping at the first one" << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    uint32_t seed = 1;
+    unsigned long cases = 100000;
+    bool keepGoing = false;
+    std::vector<std::string> only;
+    std::vector<std::string> skipped;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            return usage();
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--cases") == 0 && hasValue)
+        {
+            cases = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--only") == 0 && hasValue)
+        {
+            only.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--skip") == 0 && hasValue)
+        {
+            skipped.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--keep-going") == 0)
+        {
+            keepGoing = true;
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            std::cerr << "Use -h or --help to see available options" << std::endl;
+            return 1;
+        }
+    }
+
+    Fuzzer fuzzer(seed, only, skipped);
+    if (!fuzzer.hasOpcodes())
+    {
+        std::cerr << "no instruction selected" << std::endl;
+        return 1;
+    }
+
+    unsigned long divergences = 0;
+    for (unsigned long i = 0; i < cases; i++)
+    {
+        FuzzCase fuzzCase = fuzzer.generate();
+        if (fuzzCase.differences.empty())
+        {
+            continue;
+        }
+        divergences++;
+        std::cout << "divergence in case " << i << " (seed " << seed << ")" << std::endl;
+        fuzzer.report(std::cout, fuzzer.minimize(fuzzCase));
+        std::cout << std::endl;
+        if (!keepGoing)
+        {
+            return 1;
+        }
+    }
+    std::cout << cases << " cases, " << divergences << " divergences" << std::endl;
+    return divergences == 0 ? 0 : 1;
+}
@@ -0,0 +1,1147 @@
+#include <algorithm>
+#include <utility>
+#include "referencecpu.h"
+#include "../core/instructions.h"
+#include "../core/exceptions.h"
+
+using namespace mc68000;
+
+namespace
+{
+    uint32_t maskOf(unsigned size)
+    {
+        return size == 1 ? 0xffu : size == 2 ? 0xffffu : 0xffffffffu;
+    }
+
+    uint32_t msbOf(unsigned size)
+    {
+        return 1u << (size * 8 - 1);
+    }
+
+    uint32_t signExtend(uint32_t value, unsigned size)
+    {
+        if (size == 1)
+        {
+            return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(value)));
+        }
+        if (size == 2)
+        {
+            return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(value)));
+        }
+        return value;
+    }
+
+    /// <summary>
+    /// Size in bytes of the usual 2 bits size field: 00 byte, 01 word, 10 long.
+    /// </summary>
+    unsigned sizeField(uint16_t opcode)
+    {
+        static const unsigned sizes[] = { 1, 2, 4, 4 };
+        return sizes[(opcode >> 6) & 3];
+    }
+
+    enum ShiftKind { ARITHMETIC, LOGICAL, ROTATE_EXTEND, ROTATE };
+}
+
+/// <summary>
+/// Executes the instruction at machine.pc and updates the state as the 68000 would.
+/// After an exception, the state is left as it was when the exception was raised.
+/// </summary>
+ReferenceOutcome ReferenceCpu::step(MachineState& machine)
+{
+    state = &machine;
+    outcome = ReferenceOutcome();
+    try
+    {
+        uint16_t opcode = fetch();
+        execute(opcode, decoder(opcode));
+        // the next instruction is fetched from there
+        if (state->pc & 1)
+        {
+            throw Fault{ Exceptions::ADDRESS_ERROR };
+        }
+        if (static_cast<uint64_t>(state->pc) + 2 > state->memory.size())
+        {
+            throw Fault{ Exceptions::BUS_ERROR };
+        }
+    }
+    catch (const Fault& fault)
+    {
+        outcome.vector = fault.vector;
+    }
+    return outcome;
+}
+
+void ReferenceCpu::execute(uint16_t opcode, uint16_t instruction)
+{
+    unsigned mode = (opcode >> 3) & 7;
+    unsigned reg = opcode & 7;
+    unsigned reg2 = (opcode >> 9) & 7;
+    uint32_t* d = state->d;
+    uint32_t* a = state->a;
+
+    switch (instruction)
+    {
+        case instructions::ABCD:
+        case instructions::SBCD:
+        case instructions::NBCD:
+            bcd(opcode, instruction);
+            break;
+
+        case instructions::ADD:
+        case instructions::SUB:
+        case instructions::CMP:
+        case instructions::AND:
+        case instructions::OR:
+        case instructions::EOR:
+        case instructions::ADDA:
+        case instructions::SUBA:
+        case instructions::CMPA:
+            arithmetic(opcode, instruction);
+            break;
+
+        case instructions::ADDI:
+        case instructions::SUBI:
+        case instructions::CMPI:
+        case instructions::ANDI:
+        case instructions::ORI:
+        case instructions::EORI:
+            immediate(opcode, instruction);
+            break;
+
+        case instructions::ADDQ:
+        case instructions::SUBQ:
+        {
+            uint32_t data = reg2 == 0 ? 8 : reg2;
+            bool isAdd = instruction == instructions::ADDQ;
+            if (mode == 1)
+            {
+                // the whole address register and no flag whatever the size
+                a[reg] = isAdd ? a[reg] + data : a[reg] - data;
+                break;
+            }
+            unsigned size = sizeField(opcode);
+            Operand destination = operand(mode, reg, size);
+            uint32_t value = get(destination, size);
+            set(destination, size, isAdd ? add(data, value, size, false) : sub(data, value, size, false, false));
+            break;
+        }
+
+        case instructions::ADDX:
+        case instructions::SUBX:
+        {
+            unsigned size = sizeField(opcode);
+            unsigned operandMode = (opcode & 0x0008) ? 4 : 0;
+            Operand source = operand(operandMode, reg, size);
+            uint32_t s = get(source, size);
+            Operand destination = operand(operandMode, reg2, size);
+            uint32_t value = get(destination, size);
+            if (instruction == instructions::ADDX)
+            {
+                set(destination, size, add(s, value, size, true));
+            }
+            else
+            {
+                set(destination, size, sub(s, value, size, true, false));
+            }
+            break;
+        }
+
+        case instructions::ANDI2CCR:
+            state->sr = (state->sr & 0xff00) | (state->sr & fetch() & 0x1f);
+            break;
+        case instructions::ORI2CCR:
+            state->sr = (state->sr & 0xff00) | ((state->sr | fetch()) & 0x1f);
+            break;
+        case instructions::EORI2CCR:
+            state->sr = (state->sr & 0xff00) | ((state->sr ^ fetch()) & 0x1f);
+            break;
+        case instructions::ANDI2SR:
+        case instructions::ORI2SR:
+        case instructions::EORI2SR:
+        case instructions::MOVE2SR:
+        case instructions::RTE:
+        case instructions::STOP:
+            // privileged: the fuzzer runs user code only
+            throw Fault{ Exceptions::PRIVILEGE_VIOLATION };
+
+        case instructions::ASL:
+        case instructions::ASR:
+        case instructions::LSL:
+        case instructions::LSR:
+        case instructions::ROL:
+        case instructions::ROR:
+        case instructions::ROXL:
+        case instructions::ROXR:
+        {
+            bool left = (opcode & 0x0100) != 0;
+            if ((opcode & 0x00c0) == 0x00c0)
+            {
+                // memory: one bit of a word, the kind is in bits 9-10
+                Operand destination = operand(mode, reg, 2);
+                uint32_t value = get(destination, 2);
+                set(destination, 2, shift((opcode >> 9) & 3, left, value, 1, 2));
+            }
+            else
+            {
+                unsigned size = sizeField(opcode);
+                unsigned count = (opcode & 0x0020) ? d[reg2] % 64 : (reg2 == 0 ? 8 : reg2);
+                uint32_t result = shift((opcode >> 3) & 3, left, d[reg] & maskOf(size), count, size);
+                d[reg] = (d[reg] & ~maskOf(size)) | result;
+            }
+            break;
+        }
+
+        case instructions::BRA:
+        case instructions::BSR:
+        case instructions::BHI:
+        case instructions::BLS:
+        case instructions::BCC:
+        case instructions::BCS:
+        case instructions::BNE:
+        case instructions::BEQ:
+        case instructions::BVC:
+        case instructions::BVS:
+        case instructions::BPL:
+        case instructions::BMI:
+        case instructions::BGE:
+        case instructions::BLT:
+        case instructions::BGT:
+        case instructions::BLE:
+        {
+            uint32_t base = state->pc;
+            uint32_t displacement = signExtend(opcode & 0xff, 1);
+            if (displacement == 0)
+            {
+                displacement = signExtend(fetch(), 2);
+            }
+            if (instruction == instructions::BSR)
+            {
+                push(state->pc);
+                state->pc = base + displacement;
+            }
+            else if (instruction == instructions::BRA || condition((opcode >> 8) & 0xf))
+            {
+                state->pc = base + displacement;
+            }
+            break;
+        }
+
+        case instructions::BCHG_R:
+        case instructions::BCHG_I:
+        case instructions::BCLR_R:
+        case instructions::BCLR_I:
+        case instructions::BSET_R:
+        case instructions::BSET_I:
+        case instructions::BTST_R:
+        case instructions::BTST_I:
+            bit(opcode, instruction);
+            break;
+
+        case instructions::CHK:
+        {
+            int16_t bound = static_cast<int16_t>(get(operand(mode, reg, 2), 2));
+            int16_t value = static_cast<int16_t>(d[reg2]);
+            outcome.undefinedFlags = N | Z | V | C;
+            if (value < 0 || value > bound)
+            {
+                throw Fault{ Exceptions::CHK };
+            }
+            break;
+        }
+
+        case instructions::CLR:
+        {
+            unsigned size = sizeField(opcode);
+            set(operand(mode, reg, size), size, 0);
+            setLogicalFlags(0, size);
+            break;
+        }
+
+        case instructions::CMPM:
+        {
+            unsigned size = sizeField(opcode);
+            uint32_t source = get(operand(3, reg, size), size);
+            uint32_t destination = get(operand(3, reg2, size), size);
+            sub(source, destination, size, false, true);
+            break;
+        }
+
+        case instructions::DBCC:
+        {
+            uint32_t base = state->pc;
+            uint32_t displacement = signExtend(fetch(), 2);
+            if (!condition((opcode >> 8) & 0xf))
+            {
+                uint32_t counter = (d[reg] - 1) & 0xffff;
+                d[reg] = (d[reg] & 0xffff0000) | counter;
+                if (counter != 0xffff)
+                {
+                    state->pc = base + displacement;
+                }
+            }
+            break;
+        }
+
+        case instructions::DIVU:
+            divide(opcode, false);
+            break;
+        case instructions::DIVS:
+            divide(opcode, true);
+            break;
+
+        case instructions::MULU:
+        {
+            uint32_t source = get(operand(mode, reg, 2), 2);
+            d[reg2] = (d[reg2] & 0xffff) * source;
+            setLogicalFlags(d[reg2], 4);
+            break;
+        }
+        case instructions::MULS:
+        {
+            int32_t source = static_cast<int16_t>(get(operand(mode, reg, 2), 2));
+            d[reg2] = static_cast<uint32_t>(static_cast<int16_t>(d[reg2]) * source);
+            setLogicalFlags(d[reg2], 4);
+            break;
+        }
+
+        case instructions::EXG:
+        {
+            switch ((opcode >> 3) & 0x1f)
+            {
+                case 0x08: std::swap(d[reg2], d[reg]); break;
+                case 0x09: std::swap(a[reg2], a[reg]); break;
+                case 0x11: std::swap(d[reg2], a[reg]); break;
+            }
+            break;
+        }
+
+        case instructions::EXT:
+            if (((opcode >> 6) & 7) == 2)
+            {
+                d[reg] = (d[reg] & 0xffff0000) | (signExtend(d[reg], 1) & 0xffff);
+                setLogicalFlags(d[reg], 2);
+            }
+            else
+            {
+                d[reg] = signExtend(d[reg], 2);
+                setLogicalFlags(d[reg], 4);
+            }
+            break;
+
+        case instructions::ILLEGAL:
+            throw Fault{ Exceptions::ILLEGAL_INSTRUCTION };
+
+        case instructions::JMP:
+            state->pc = operand(mode, reg, 4).address;
+            break;
+        case instructions::JSR:
+        {
+            uint32_t target = operand(mode, reg, 4).address;
+            push(state->pc);
+            state->pc = target;
+            break;
+        }
+
+        case instructions::LEA:
+            a[reg2] = operand(mode, reg, 4).address;
+            break;
+        case instructions::PEA:
+            push(operand(mode, reg, 4).address);
+            break;
+
+        case instructions::LINK:
+        {
+            uint32_t displacement = signExtend(fetch(), 2);
+            // LINK A7 saves the decremented stack pointer
+            a[7] -= 4;
+            write(a[7], 4, a[reg]);
+            a[reg] = a[7];
+            a[7] += displacement;
+            break;
+        }
+        case instructions::UNLK:
+        {
+            uint32_t frame = read(a[reg], 4);
+            a[7] = a[reg] + 4;
+            a[reg] = frame;
+            break;
+        }
+
+        case instructions::MOVE:
+        {
+            static const unsigned sizes[] = { 0, 1, 4, 2 };
+            unsigned size = sizes[(opcode >> 12) & 3];
+            uint32_t value = get(operand(mode, reg, size), size);
+            set(operand((opcode >> 6) & 7, reg2, size), size, value);
+            setLogicalFlags(value, size);
+            break;
+        }
+        case instructions::MOVEA:
+        {
+            unsigned size = ((opcode >> 12) & 3) == 3 ? 2 : 4;
+            a[reg2] = signExtend(get(operand(mode, reg, size), size), size);
+            break;
+        }
+        case instructions::MOVE2CCR:
+            state->sr = (state->sr & 0xff00) | (get(operand(mode, reg, 2), 2) & 0x1f);
+            break;
+        case instructions::MOVESR:
+            // not privileged on the 68000
+            set(operand(mode, reg, 2), 2, state->sr);
+            break;
+        case instructions::MOVEM:
+            movem(opcode);
+            break;
+        case instructions::MOVEP:
+            movep(opcode);
+            break;
+        case instructions::MOVEQ:
+            d[reg2] = signExtend(opcode & 0xff, 1);
+            setLogicalFlags(d[reg2], 4);
+            break;
+
+        case instructions::NEG:
+        case instructions::NEGX:
+        {
+            unsigned size = sizeField(opcode);
+            Operand destination = operand(mode, reg, size);
+            uint32_t value = get(destination, size);
+            set(destination, size, sub(value, 0, size, instruction == instructions::NEGX, false));
+            break;
+        }
+        case instructions::NOT:
+        {
+            unsigned size = sizeField(opcode);
+            Operand destination = operand(mode, reg, size);
+            uint32_t value = ~get(destination, size) & maskOf(size);
+            set(destination, size, value);
+            setLogicalFlags(value, size);
+            break;
+        }
+        case instructions::NOP:
+            break;
+
+        case instructions::RTR:
+        {
+            uint16_t ccr = static_cast<uint16_t>(read(a[7], 2));
+            a[7] += 2;
+            state->sr = (state->sr & 0xff00) | (ccr & 0x1f);
+            state->pc = pop();
+            break;
+        }
+        case instructions::RTS:
+            state->pc = pop();
+            break;
+
+        case instructions::SCC:
+            set(operand(mode, reg, 1), 1, condition((opcode >> 8) & 0xf) ? 0xff : 0);
+            break;
+
+        case instructions::SWAP:
+            d[reg] = (d[reg] << 16) | (d[reg] >> 16);
+            setLogicalFlags(d[reg], 4);
+            break;
+
+        case instructions::TAS:
+        {
+            Operand destination = operand(mode, reg, 1);
+            uint32_t value = get(destination, 1);
+            setLogicalFlags(value, 1);
+            set(destination, 1, value | 0x80);
+            break;
+        }
+
+        case instructions::TRAP:
+            throw Fault{ Exceptions::TRAP + (opcode & 0xf) };
+        case instructions::TRAPV:
+            if (flag(V))
+            {
+                throw Fault{ Exceptions::TRAPV };
+            }
+            break;
+
+        case instructions::TST:
+        {
+            unsigned size = sizeField(opcode);
+            setLogicalFlags(get(operand(mode, reg, size), size), size);
+            break;
+        }
+
+        default:
+            throw Fault{ Exceptions::ILLEGAL_INSTRUCTION };
+    }
+}
+
+// ============================================================================
+// Instruction families
+// ============================================================================
+
+/// <summary>
+/// ADD SUB CMP AND OR EOR and the address forms ADDA SUBA CMPA.
+/// </summary>
+void ReferenceCpu::arithmetic(uint16_t opcode, uint16_t instruction)
+{
+    unsigned mode = (opcode >> 3) & 7;
+    unsigned reg = opcode & 7;
+    unsigned dn = (opcode >> 9) & 7;
+    unsigned opmode = (opcode >> 6) & 7;
+
+    if (instruction == instructions::ADDA || instruction == instructions::SUBA || instruction == instructions::CMPA)
+    {
+        unsigned size = opmode == 3 ? 2 : 4;
+        uint32_t source = signExtend(get(operand(mode, reg, size), size), size);
+        uint32_t& an = state->a[dn];
+        if (instruction == instructions::ADDA)
+        {
+            an += source;
+        }
+        else if (instruction == instructions::SUBA)
+        {
+            an -= source;
+        }
+        else
+        {
+            sub(source, an, 4, false, true);
+        }
+        return;
+    }
+
+    unsigned size = sizeField(opcode);
+    uint32_t mask = maskOf(size);
+    bool toRegister = opmode < 4;
+    Operand ea = operand(mode, reg, size);
+    uint32_t eaValue = get(ea, size);
+    uint32_t source = toRegister ? eaValue : state->d[dn] & mask;
+    uint32_t destination = toRegister ? state->d[dn] & mask : eaValue;
+
+    uint32_t result;
+    switch (instruction)
+    {
+        case instructions::ADD:
+            result = add(source, destination, size, false);
+            break;
+        case instructions::SUB:
+            result = sub(source, destination, size, false, false);
+            break;
+        case instructions::CMP:
+            sub(source, destination, size, false, true);
+            return;
+        case instructions::AND:
+            result = source & destination;
+            setLogicalFlags(result, size);
+            break;
+        case instructions::OR:
+            result = source | destination;
+            setLogicalFlags(result, size);
+            break;
+        default:
+            result = source ^ destination;
+            setLogicalFlags(result, size);
+            break;
+    }
+    if (toRegister)
+    {
+        state->d[dn] = (state->d[dn] & ~mask) | result;
+    }
+    else
+    {
+        set(ea, size, result);
+    }
+}
+
+/// <summary>
+/// ADDI SUBI CMPI ANDI ORI EORI: the immediate data comes before the extension words of the destination.
+/// </summary>
+void ReferenceCpu::immediate(uint16_t opcode, uint16_t instruction)
+{
+    unsigned size = sizeField(opcode);
+    uint32_t data = fetchImmediate(size);
+    Operand destination = operand((opcode >> 3) & 7, opcode & 7, size);
+    uint32_t value = get(destination, size);
+
+    uint32_t result;
+    switch (instruction)
+    {
+        case instructions::ADDI:
+            result = add(data, value, size, false);
+            break;
+        case instructions::SUBI:
+            result = sub(data, value, size, false, false);
+            break;
+        case instructions::CMPI:
+            sub(data, value, size, false, true);
+            return;
+        case instructions::ANDI:
+            result = data & value;
+            setLogicalFlags(result, size);
+            break;
+        case instructions::ORI:
+            result = data | value;
+            setLogicalFlags(result, size);
+            break;
+        default:
+            result = data ^ value;
+            setLogicalFlags(result, size);
+            break;
+    }
+    set(destination, size, result);
+}
+
+/// <summary>
+/// ABCD SBCD NBCD with the digit corrections of the 68000, invalid digits included. N and V are undefined.
+/// </summary>
+void ReferenceCpu::bcd(uint16_t opcode, uint16_t instruction)
+{
+    unsigned x = flag(X) ? 1 : 0;
+    Operand destination;
+    uint32_t source = 0;
+    if (instruction == instructions::NBCD)
+    {
+        destination = operand((opcode >> 3) & 7, opcode & 7, 1);
+    }
+    else
+    {
+        unsigned operandMode = (opcode & 0x0008) ? 4 : 0;
+        source = get(operand(operandMode, opcode & 7, 1), 1);
+        destination = operand(operandMode, (opcode >> 9) & 7, 1);
+    }
+    uint32_t value = get(destination, 1);
+    outcome.undefinedFlags = N | V;
+
+    uint32_t result;
+    bool carry;
+    if (instruction == instructions::ABCD)
+    {
+        result = (source & 0x0f) + (value & 0x0f) + x;
+        if (result > 9)
+        {
+            result += 6;
+        }
+        result += (source & 0xf0) + (value & 0xf0);
+        carry = result > 0x99;
+        if (carry)
+        {
+            result -= 0xa0;
+        }
+    }
+    else
+    {
+        if (instruction == instructions::NBCD)
+        {
+            source = value;
+            value = 0;
+        }
+        result = (value & 0x0f) - (source & 0x0f) - x;
+        if (result > 9)
+        {
+            result -= 6;
+        }
+        result += (value & 0xf0) - (source & 0xf0);
+        carry = result > 0x99;
+        if (carry)
+        {
+            result += 0xa0;
+        }
+    }
+    result &= 0xff;
+    setFlag(C, carry);
+    setFlag(X, carry);
+    if (result != 0)
+    {
+        setFlag(Z, false);
+    }
+    set(destination, 1, result);
+}
+
+/// <summary>
+/// BTST BCHG BCLR BSET: long on a data register with the bit number modulo 32, byte in memory modulo 8.
+/// </summary>
+void ReferenceCpu::bit(uint16_t opcode, uint16_t instruction)
+{
+    bool isImmediate = instruction == instructions::BTST_I || instruction == instructions::BCHG_I
+        || instruction == instructions::BCLR_I || instruction == instructions::BSET_I;
+    uint32_t number = isImmediate ? fetch() & 0xff : state->d[(opcode >> 9) & 7];
+    unsigned mode = (opcode >> 3) & 7;
+    unsigned size = mode == 0 ? 4 : 1;
+    uint32_t mask = 1u << (number % (size * 8));
+
+    Operand destination = operand(mode, opcode & 7, size);
+    uint32_t value = get(destination, size);
+    setFlag(Z, (value & mask) == 0);
+    switch (instruction)
+    {
+        case instructions::BCHG_R:
+        case instructions::BCHG_I:
+            set(destination, size, value ^ mask);
+            break;
+        case instructions::BCLR_R:
+        case instructions::BCLR_I:
+            set(destination, size, value & ~mask);
+            break;
+        case instructions::BSET_R:
+        case instructions::BSET_I:
+            set(destination, size, value | mask);
+            break;
+    }
+}
+
+/// <summary>
+/// DIVU DIVS: 32 by 16 bits, quotient in the low word and remainder in the high word.
+/// On overflow the register is unchanged, V is set and N Z are undefined.
+/// </summary>
+void ReferenceCpu::divide(uint16_t opcode, bool isSigned)
+{
+    uint32_t& dn = state->d[(opcode >> 9) & 7];
+    uint32_t divisor = get(operand((opcode >> 3) & 7, opcode & 7, 2), 2);
+    if (divisor == 0)
+    {
+        throw Fault{ Exceptions::DIVISION_BY_ZERO };
+    }
+    setFlag(C, false);
+
+    int64_t quotient;
+    int64_t remainder;
+    if (isSigned)
+    {
+        int64_t dividend = static_cast<int32_t>(dn);
+        int64_t signedDivisor = static_cast<int16_t>(divisor);
+        quotient = dividend / signedDivisor;
+        remainder = dividend % signedDivisor;
+    }
+    else
+    {
+        quotient = dn / divisor;
+        remainder = dn % divisor;
+    }
+    bool overflow = isSigned ? quotient < -32768 || quotient > 32767 : quotient > 0xffff;
+    if (overflow)
+    {
+        setFlag(V, true);
+        outcome.undefinedFlags = N | Z;
+        return;
+    }
+    dn = (static_cast<uint32_t>(remainder) << 16) | (static_cast<uint32_t>(quotient) & 0xffff);
+    setLogicalFlags(dn & 0xffff, 2);
+}
+
+/// <summary>
+/// MOVEM: the mask follows the opcode. Words loaded in registers are sign extended.
+/// With -(An) the mask is reversed and the initial value of An is stored.
+/// </summary>
+void ReferenceCpu::movem(uint16_t opcode)
+{
+    unsigned size = (opcode & 0x0040) ? 4 : 2;
+    unsigned mode = (opcode >> 3) & 7;
+    unsigned reg = opcode & 7;
+    uint16_t mask = fetch();
+
+    if ((opcode & 0x0400) == 0)
+    {
+        if (mode == 4)
+        {
+            uint32_t address = state->a[reg];
+            for (unsigned i = 0; i < 16; i++)
+            {
+                if (mask & (1u << i))
+                {
+                    address -= size;
+                    write(address, size, registerAt(15 - i));
+                }
+            }
+            state->a[reg] = address;
+            return;
+        }
+        uint32_t address = operand(mode, reg, size).address;
+        for (unsigned i = 0; i < 16; i++)
+        {
+            if (mask & (1u << i))
+            {
+                write(address, size, registerAt(i));
+                address += size;
+            }
+        }
+        return;
+    }
+
+    uint32_t address = mode == 3 ? state->a[reg] : operand(mode, reg, size).address;
+    for (unsigned i = 0; i < 16; i++)
+    {
+        if (mask & (1u << i))
+        {
+            registerAt(i) = signExtend(read(address, size), size);
+            address += size;
+        }
+    }
+    if (mode == 3)
+    {
+        state->a[reg] = address;
+    }
+}
+
+/// <summary>
+/// MOVEP: the bytes of a data register to or from every other byte in memory, high byte first.
+/// </summary>
+void ReferenceCpu::movep(uint16_t opcode)
+{
+    uint32_t& dn = state->d[(opcode >> 9) & 7];
+    uint32_t address = state->a[opcode & 7] + signExtend(fetch(), 2);
+    unsigned opmode = (opcode >> 6) & 7;
+    unsigned size = (opmode & 1) ? 4 : 2;
+
+    if (opmode < 6)
+    {
+        uint32_t value = 0;
+        for (unsigned i = 0; i < size; i++)
+        {
+            value = (value << 8) | read(address + 2 * i, 1);
+        }
+        dn = size == 4 ? value : (dn & 0xffff0000) | value;
+    }
+    else
+    {
+        for (unsigned i = 0; i < size; i++)
+        {
+            write(address + 2 * i, 1, dn >> (8 * (size - 1 - i)));
+        }
+    }
+}
+
+/// <summary>
+/// Shifts and rotates one bit at a time.
+/// </summary>
+/// <returns>The result, the flags being set</returns>
+uint32_t ReferenceCpu::shift(unsigned kind, bool left, uint32_t value, unsigned count, unsigned size)
+{
+    uint32_t msb = msbOf(size);
+    uint32_t mask = maskOf(size);
+    bool x = flag(X);
+    bool carry = false;
+    bool overflow = false;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        bool out = left ? (value & msb) != 0 : (value & 1) != 0;
+        uint32_t in = 0;
+        switch (kind)
+        {
+            case ARITHMETIC:
+                in = left ? 0 : (value & msb);
+                break;
+            case LOGICAL:
+                in = 0;
+                break;
+            case ROTATE_EXTEND:
+                in = x ? (left ? 1 : msb) : 0;
+                break;
+            case ROTATE:
+                in = out ? (left ? 1 : msb) : 0;
+                break;
+        }
+        uint32_t shifted = left ? ((value << 1) & mask) | in : (value >> 1) | in;
+        if (kind == ARITHMETIC && left && ((shifted ^ value) & msb))
+        {
+            overflow = true;
+        }
+        value = shifted;
+        carry = out;
+        if (kind != ROTATE)
+        {
+            x = out;
+        }
+    }
+
+    if (count == 0)
+    {
+        carry = kind == ROTATE_EXTEND ? x : false;
+    }
+    setFlag(C, carry);
+    setFlag(X, x);
+    setFlag(V, overflow);
+    setFlag(N, (value & msb) != 0);
+    setFlag(Z, value == 0);
+    return value;
+}
+
+// ============================================================================
+// Arithmetic and flags
+// ============================================================================
+
+/// <summary>
+/// destination + source (+ X), with the flags of ADD or ADDX: Z is only cleared by ADDX.
+/// </summary>
+uint32_t ReferenceCpu::add(uint32_t source, uint32_t destination, unsigned size, bool extend)
+{
+    uint32_t mask = maskOf(size);
+    uint32_t msb = msbOf(size);
+    source &= mask;
+    destination &= mask;
+    uint64_t sum = static_cast<uint64_t>(source) + destination + (extend && flag(X) ? 1 : 0);
+    uint32_t result = static_cast<uint32_t>(sum) & mask;
+
+    bool carry = sum > mask;
+    setFlag(C, carry);
+    setFlag(X, carry);
+    setFlag(V, (~(source ^ destination) & (source ^ result) & msb) != 0);
+    setFlag(N, (result & msb) != 0);
+    if (!extend || result != 0)
+    {
+        setFlag(Z, result == 0);
+    }
+    return result;
+}
+
+/// <summary>
+/// destination - source (- X), with the flags of SUB, SUBX or CMP: X is not changed by a compare.
+/// </summary>
+uint32_t ReferenceCpu::sub(uint32_t source, uint32_t destination, unsigned size, bool extend, bool compare)
+{
+    uint32_t mask = maskOf(size);
+    uint32_t msb = msbOf(size);
+    source &= mask;
+    destination &= mask;
+    uint64_t subtrahend = static_cast<uint64_t>(source) + (extend && flag(X) ? 1 : 0);
+    uint32_t result = static_cast<uint32_t>(destination - subtrahend) & mask;
+
+    bool borrow = subtrahend > destination;
+    setFlag(C, borrow);
+    if (!compare)
+    {
+        setFlag(X, borrow);
+    }
+    setFlag(V, ((source ^ destination) & (destination ^ result) & msb) != 0);
+    setFlag(N, (result & msb) != 0);
+    if (!extend || result != 0)
+    {
+        setFlag(Z, result == 0);
+    }
+    return result;
+}
+
+bool ReferenceCpu::flag(uint16_t bit) const
+{
+    return (state->sr & bit) != 0;
+}
+
+void ReferenceCpu::setFlag(uint16_t bit, bool value)
+{
+    state->sr = value ? (state->sr | bit) : (state->sr & ~bit);
+}
+
+/// <summary>
+/// N and Z from the result, V and C cleared, X unchanged.
+/// </summary>
+void ReferenceCpu::setLogicalFlags(uint32_t result, unsigned size)
+{
+    setFlag(N, (result & msbOf(size)) != 0);
+    setFlag(Z, (result & maskOf(size)) == 0);
+    setFlag(V, false);
+    setFlag(C, false);
+}
+
+bool ReferenceCpu::condition(unsigned code) const
+{
+    bool c = flag(C);
+    bool v = flag(V);
+    bool z = flag(Z);
+    bool n = flag(N);
+    switch (code)
+    {
+        case 0x0: return true;
+        case 0x1: return false;
+        case 0x2: return !c && !z;      // HI
+        case 0x3: return c || z;        // LS
+        case 0x4: return !c;            // CC
+        case 0x5: return c;             // CS
+        case 0x6: return !z;            // NE
+        case 0x7: return z;             // EQ
+        case 0x8: return !v;            // VC
+        case 0x9: return v;             // VS
+        case 0xa: return !n;            // PL
+        case 0xb: return n;             // MI
+        case 0xc: return n == v;        // GE
+        case 0xd: return n != v;        // LT
+        case 0xe: return !z && n == v;  // GT
+        default:  return z || n != v;   // LE
+    }
+}
+
+// ============================================================================
+// Memory and effective addresses
+// ============================================================================
+
+uint32_t ReferenceCpu::read(uint32_t address, unsigned size)
+{
+    if (size > 1 && (address & 1))
+    {
+        throw Fault{ Exceptions::ADDRESS_ERROR };
+    }
+    if (static_cast<uint64_t>(address) + size > state->memory.size())
+    {
+        throw Fault{ Exceptions::BUS_ERROR };
+    }
+    uint32_t value = 0;
+    for (unsigned i = 0; i < size; i++)
+    {
+        value = (value << 8) | state->memory[address + i];
+    }
+    return value;
+}
+
+void ReferenceCpu::write(uint32_t address, unsigned size, uint32_t value)
+{
+    if (size > 1 && (address & 1))
+    {
+        throw Fault{ Exceptions::ADDRESS_ERROR };
+    }
+    if (static_cast<uint64_t>(address) + size > state->memory.size())
+    {
+        throw Fault{ Exceptions::BUS_ERROR };
+    }
+    outcome.lowestWrite = std::min(outcome.lowestWrite, address);
+    for (unsigned i = 0; i < size; i++)
+    {
+        state->memory[address + i] = static_cast<uint8_t>(value >> (8 * (size - 1 - i)));
+    }
+}
+
+uint16_t ReferenceCpu::fetch()
+{
+    uint16_t word = static_cast<uint16_t>(read(state->pc, 2));
+    state->pc += 2;
+    outcome.instructionEnd = state->pc;
+    return word;
+}
+
+uint32_t ReferenceCpu::fetchImmediate(unsigned size)
+{
+    if (size == 4)
+    {
+        uint32_t high = fetch();
+        return (high << 16) | fetch();
+    }
+    return fetch() & maskOf(size);
+}
+
+void ReferenceCpu::push(uint32_t value)
+{
+    state->a[7] -= 4;
+    write(state->a[7], 4, value);
+}
+
+uint32_t ReferenceCpu::pop()
+{
+    uint32_t value = read(state->a[7], 4);
+    state->a[7] += 4;
+    return value;
+}
+
+/// <summary>
+/// Decodes an effective address, fetching its extension words and applying the increments and decrements.
+/// A byte access through a7 moves it by 2 to keep the stack aligned.
+/// </summary>
+ReferenceCpu::Operand ReferenceCpu::operand(unsigned mode, unsigned reg, unsigned size)
+{
+    uint32_t* a = state->a;
+    unsigned step = (size == 1 && reg == 7) ? 2 : size;
+    switch (mode)
+    {
+        case 0:
+            return { Operand::DATA_REGISTER, reg, 0, 0 };
+        case 1:
+            return { Operand::ADDRESS_REGISTER, reg, 0, 0 };
+        case 2:
+            return { Operand::MEMORY, reg, a[reg], 0 };
+        case 3:
+        {
+            uint32_t address = a[reg];
+            a[reg] += step;
+            return { Operand::MEMORY, reg, address, 0 };
+        }
+        case 4:
+            a[reg] -= step;
+            return { Operand::MEMORY, reg, a[reg], 0 };
+        case 5:
+            return { Operand::MEMORY, reg, a[reg] + signExtend(fetch(), 2), 0 };
+        case 6:
+            return { Operand::MEMORY, reg, indexed(a[reg]), 0 };
+    }
+    switch (reg)
+    {
+        case 0:
+            return { Operand::MEMORY, 0, signExtend(fetch(), 2), 0 };
+        case 1:
+        {
+            uint32_t high = fetch();
+            return { Operand::MEMORY, 0, (high << 16) | fetch(), 0 };
+        }
+        case 2:
+        {
+            // relative to the address of the extension word
+            uint32_t base = state->pc;
+            return { Operand::MEMORY, 0, base + signExtend(fetch(), 2), 0 };
+        }
+        case 3:
+            return { Operand::MEMORY, 0, indexed(state->pc), 0 };
+        case 4:
+            return { Operand::IMMEDIATE, 0, 0, fetchImmediate(size) };
+    }
+    throw Fault{ Exceptions::ILLEGAL_INSTRUCTION };
+}
+
+/// <summary>
+/// d8(base, Xn.size): base + 8 bits displacement + index register, word or long.
+/// </summary>
+uint32_t ReferenceCpu::indexed(uint32_t base)
+{
+    uint16_t extension = fetch();
+    unsigned index = (extension >> 12) & 7;
+    uint32_t value = (extension & 0x8000) ? state->a[index] : state->d[index];
+    if (!(extension & 0x0800))
+    {
+        value = signExtend(value, 2);
+    }
+    return base + signExtend(extension & 0xff, 1) + value;
+}
+
+uint32_t ReferenceCpu::get(const Operand& op, unsigned size)
+{
+    switch (op.kind)
+    {
+        case Operand::DATA_REGISTER:
+            return state->d[op.reg] & maskOf(size);
+        case Operand::ADDRESS_REGISTER:
+            return state->a[op.reg] & maskOf(size);
+        case Operand::MEMORY:
+            return read(op.address, size);
+        default:
+            return op.value;
+    }
+}
+
+void ReferenceCpu::set(const Operand& op, unsigned size, uint32_t value)
+{
+    uint32_t mask = maskOf(size);
+    switch (op.kind)
+    {
+        case Operand::DATA_REGISTER:
+            state->d[op.reg] = (state->d[op.reg] & ~mask) | (value & mask);
+            break;
+        case Operand::ADDRESS_REGISTER:
+            state->a[op.reg] = signExtend(value & mask, size);
+            break;
+        case Operand::MEMORY:
+            write(op.address, size, value & mask);
+            break;
+        default:
+            break;
+    }
+}
+
+/// <summary>
+/// Registers in the order of the MOVEM mask: d0-d7 then a0-a7.
+/// </summary>
+uint32_t& ReferenceCpu::registerAt(unsigned index)
+{
+    return index < 8 ? state->d[index] : state->a[index - 8];
+}
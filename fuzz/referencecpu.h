@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../core/noopcpu.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Architectural state compared by the fuzzer. The CPU runs in user mode: a[7] is the user stack pointer.
+    /// </summary>
+    struct MachineState
+    {
+        uint32_t d[8] = {};
+        uint32_t a[8] = {};
+        uint32_t pc = 0;
+        uint16_t sr = 0;
+        std::vector<uint8_t> memory;
+    };
+
+    /// <summary>
+    /// How one instruction ended in the reference interpreter.
+    /// </summary>
+    struct ReferenceOutcome
+    {
+        int vector = -1;                // exception raised by the instruction, -1 if none
+        uint16_t undefinedFlags = 0;    // CCR bits left undefined by the 68000
+        uint32_t instructionEnd = 0;    // address after the last instruction word fetched
+        uint32_t lowestWrite = 0xffffffff;
+    };
+
+    /// <summary>
+    /// A 68000 interpreter written for the fuzzer: one function per instruction family, following the
+    /// Programmer's Reference Manual step by step, flags computed bit by bit. It favours being obviously
+    /// correct over speed and shares nothing with Cpu except the opcode table built by setup().
+    /// Memory is flat like in Memory: an access outside it is a bus error, an odd word or long access
+    /// an address error.
+    /// </summary>
+    class ReferenceCpu
+    {
+    public:
+        static const uint16_t C = 0x01;
+        static const uint16_t V = 0x02;
+        static const uint16_t Z = 0x04;
+        static const uint16_t N = 0x08;
+        static const uint16_t X = 0x10;
+
+        ReferenceOutcome step(MachineState& machine);
+
+    private:
+        struct Operand
+        {
+            enum Kind { DATA_REGISTER, ADDRESS_REGISTER, MEMORY, IMMEDIATE } kind;
+            unsigned reg;
+            uint32_t address;
+            uint32_t value;
+        };
+
+        struct Fault
+        {
+            int vector;
+        };
+
+        void execute(uint16_t opcode, uint16_t instruction);
+
+        uint32_t read(uint32_t address, unsigned size);
+        void write(uint32_t address, unsigned size, uint32_t value);
+        uint16_t fetch();
+        uint32_t fetchImmediate(unsigned size);
+        void push(uint32_t value);
+        uint32_t pop();
+
+        Operand operand(unsigned mode, unsigned reg, unsigned size);
+        uint32_t indexed(uint32_t base);
+        uint32_t get(const Operand& op, unsigned size);
+        void set(const Operand& op, unsigned size, uint32_t value);
+        uint32_t& registerAt(unsigned index);
+
+        bool flag(uint16_t bit) const;
+        void setFlag(uint16_t bit, bool value);
+        void setLogicalFlags(uint32_t result, unsigned size);
+        bool condition(unsigned code) const;
+
+        uint32_t add(uint32_t source, uint32_t destination, unsigned size, bool extend);
+        uint32_t sub(uint32_t source, uint32_t destination, unsigned size, bool extend, bool compare);
+        uint32_t shift(unsigned kind, bool left, uint32_t value, unsigned count, unsigned size);
+
+        void arithmetic(uint16_t opcode, uint16_t instruction);
+        void immediate(uint16_t opcode, uint16_t instruction);
+        void bcd(uint16_t opcode, uint16_t instruction);
+        void bit(uint16_t opcode, uint16_t instruction);
+        void divide(uint16_t opcode, bool isSigned);
+        void movem(uint16_t opcode);
+        void movep(uint16_t opcode);
+
+        MachineState* state = nullptr;
+        ReferenceOutcome outcome;
+        NoOpCpu decoder;
+    };
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include "emulator.h"
 extern void game(bool);
 extern void game(const char*, bool);
@@ -12,7 +13,11 @@ int usage()
     std::cout << "  -h, --help                   Show this help message" << std::endl;
     std::cout << "  -d, --debug                  Debug mode" << std::endl;
     std::cout << "  -s, --symbols <symbols file> Load the symbols from the file" << std::endl;
-    std::cout << "  -b, --bios <bios name> " << std::endl;
+    std::cout << "  -b, --bios <bios name>       simple, atari or os (overrides run68000.conf)" << std::endl;
+    std::cout << "  --stats <json file>          Write the execution statistics at exit, - for the console" << std::endl;
+    std::cout << "  --native                     Run known guest routines (block moves...) natively, found" << std::endl;
+    std::cout << "                               by their labels in the symbols file, else by their code" << std::endl;
+    std::cout << "  --native-verify              Like --native, also running the guest code and reporting differences" << std::endl;
     return 0;
 }
 
@@ -20,7 +25,10 @@ int main(int argc, const char* argv[])
 {
 	bool debugMode = false;
     std::string symbolsFilename;
-    std::string biosName = "simple";
+    std::string biosName;           // default: bios in run68000.conf, else simple
+    std::string statsFilename;
+    bool nativeRoutines = false;
+    bool verifyNativeRoutines = false;
 
     if (argc < 2)
     {
@@ -74,6 +82,23 @@ int main(int argc, const char* argv[])
                     i++;
                 }
             }
+            else if (strcmp(argv[i], "--stats") == 0)
+            {
+                if (i + 1 < argc - 1)
+                {
+                    statsFilename = argv[i + 1];
+                    i++;
+                }
+            }
+            else if (strcmp(argv[i], "--native") == 0)
+            {
+                nativeRoutines = true;
+            }
+            else if (strcmp(argv[i], "--native-verify") == 0)
+            {
+                nativeRoutines = true;
+                verifyNativeRoutines = true;
+            }
             else
             {
                 std::cerr << "Unknown option: " << argv[i] << std::endl;
@@ -110,6 +135,36 @@ int main(int argc, const char* argv[])
         emulator.setBios(biosName);
     }
     emulator.debug(debugMode);
+    if (!statsFilename.empty())
+    {
+        emulator.enableStatistics();
+    }
+    if (nativeRoutines && emulator.enableNativeRoutines(verifyNativeRoutines) == 0)
+    {
+        std::cerr << "no native routine found" << std::endl;
+    }
     emulator.run(0, 1024, 1024);
+    if (verifyNativeRoutines)
+    {
+        std::cerr << "native routines: " << emulator.getNativeMismatches() << " mismatches" << std::endl;
+    }
+
+    if (!statsFilename.empty())
+    {
+        if (statsFilename == "-")
+        {
+            emulator.getStatistics()->writeJson(std::cout);
+        }
+        else
+        {
+            std::ofstream statsFile(statsFilename);
+            if (!statsFile)
+            {
+                std::cerr << "cannot write the statistics to " << statsFilename << std::endl;
+                return 1;
+            }
+            emulator.getStatistics()->writeJson(statsFile);
+        }
+    }
     return 0;
 }
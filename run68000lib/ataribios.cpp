@@ -1,10 +1,4 @@
-#ifdef _WIN32
-#include <conio.h>
-#else
-#include <termios.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#endif
+#include <algorithm>
 #include <string>
 
 #include "ataribios.h"
@@ -15,7 +9,40 @@ using namespace mc68000;
 
 void AtariBios::setup()
 {
-    getConfig("ataribios.conf", settings);
+    setup(BiosConfig::load(configFile()));
+}
+
+void AtariBios::setup(const BiosConfig& config)
+{
+    consoleBufferSize = config.consoleBufferSize;
+    files.setBufferSizes(config.readAhead, config.writeBehind);
+    files.setRoot(config.fileRoot);
+    heapStart = config.heapStart;
+    heapSize = config.heapSize;
+    stackReserve = config.stackReserve;
+}
+
+/// <summary>
+/// Sets up the GEMDOS heap on the first allocation, once the guest memory is known.
+/// By default the heap is the upper half of the memory, without the stack at the top.
+/// </summary>
+void AtariBios::prepareHeap(Cpu& cpu)
+{
+    if (heap.isInitialized())
+    {
+        return;
+    }
+    auto [base, size] = cpu.mem.getMemoryRange();
+    uint32_t start = heapStart != 0 ? heapStart : base + size / 2;
+    uint32_t end = base + size - std::min(stackReserve, size / 2);
+    if (heapSize != 0)
+    {
+        end = std::min(end, start + heapSize);
+    }
+    if (start >= base && start < end)
+    {
+        heap.reset(start, end - start);
+    }
 }
 
 
@@ -26,6 +53,21 @@ void AtariBios::registerTrapHandlers(Cpu* cpu)
     cpu->registerTrapHandler(14, this);
 }
 
+void AtariBios::setConsoleInput(std::shared_ptr<ConsoleInput> input)
+{
+    console = std::move(input);
+}
+
+ConsoleInput& AtariBios::consoleInput()
+{
+    if (!console)
+    {
+        // the terminal is only switched to raw mode when the guest starts reading the keyboard
+        console = std::make_shared<TerminalInput>(consoleBufferSize);
+    }
+    return *console;
+}
+
 void AtariBios::bios(Cpu& cpu)
 {
     // see also https://freemint.github.io/tos.hyp/en/About_the_BIOS.html
@@ -43,14 +85,19 @@ void AtariBios::bios(Cpu& cpu)
         DRVMAP = 10,
         KBSHIFT = 11,
     };
-    bool isSupervisor = callerIsSupervisor(cpu);
-    uint16_t func = argWord(cpu, isSupervisor, 0);
+    TrapArguments args = cpu.trapArguments();
+    uint16_t func = args.getWord(0);
+    if (args.hasFault())
+    {
+        // the stack is outside the memory: the bus error is raised after the trap
+        return;
+    }
 
     switch (func)
     {
         case GETMPB: // getmpb(uint32_t buffer)
         {
-            uint32_t buffer = argLong(cpu, isSupervisor, 1);
+            uint32_t buffer = args.getLong(1);
             getmpb(buffer);
             // no return value
             break;
@@ -58,7 +105,7 @@ void AtariBios::bios(Cpu& cpu)
 
         case BCONSTAT: // bconstat(uint16_t devnum) -> int32_t
         {
-            uint16_t devnum = argWord(cpu, isSupervisor, 1);
+            uint16_t devnum = args.getWord(1);
             int32_t ret = bconstat(devnum);
             cpu.setDRegister(0, static_cast<uint32_t>(ret));
             break;
@@ -66,7 +113,7 @@ void AtariBios::bios(Cpu& cpu)
 
         case BCONIN: // bconin(uint16_t devnum) -> uint32_t (character/errno)
         {
-            uint16_t devnum = argWord(cpu, isSupervisor, 1);
+            uint16_t devnum = args.getWord(1);
             uint32_t ch = bconin(devnum);
             cpu.setDRegister(0, ch);
             break;
@@ -74,19 +121,19 @@ void AtariBios::bios(Cpu& cpu)
 
         case BCONOUT: // bconout(uint16_t devnum, uint16_t chr)
         {
-            uint16_t devnum = argWord(cpu, isSupervisor, 1);
-            uint16_t chr = argWord(cpu, isSupervisor, 2);
+            uint16_t devnum = args.getWord(1);
+            uint16_t chr = args.getWord(2);
             bconout(devnum, chr);
             break;
         }
 
         case RWABS: // rwabs(uint16_t mode, uint32_t buffer, uint16_t sectors, uint16_t start, uint16_t drivenum) -> uint32_t
         {
-            uint16_t mode = argWord(cpu, isSupervisor, 1);
-            uint32_t buffer = argLong(cpu, isSupervisor, 2); // occupies word indices 2 and 3
-            uint16_t sectors = argWord(cpu, isSupervisor, 4);
-            uint16_t start = argWord(cpu, isSupervisor, 5);
-            uint16_t drivenum = argWord(cpu, isSupervisor, 6);
+            uint16_t mode = args.getWord(1);
+            uint32_t buffer = args.getLong(2); // occupies word indices 2 and 3
+            uint16_t sectors = args.getWord(4);
+            uint16_t start = args.getWord(5);
+            uint16_t drivenum = args.getWord(6);
             uint32_t ret = rwabs(mode, buffer, sectors, start, drivenum);
             cpu.setDRegister(0, ret);
             break;
@@ -94,8 +141,8 @@ void AtariBios::bios(Cpu& cpu)
 
         case SETEXC: // setexec(uint16_t vecnum, uint32_t vecaddr) -> uint32_t
         {
-            uint16_t vecnum = argWord(cpu, isSupervisor, 1);
-            uint32_t vecaddr = argLong(cpu, isSupervisor, 2);
+            uint16_t vecnum = args.getWord(1);
+            uint32_t vecaddr = args.getLong(2);
             uint32_t ret = setexec(vecnum, vecaddr);
             cpu.setDRegister(0, ret);
             break;
@@ -110,7 +157,7 @@ void AtariBios::bios(Cpu& cpu)
 
         case GETBPB: // getbpb(uint16_t drivenum) -> uint32_t
         {
-            uint16_t drivenum = argWord(cpu, isSupervisor, 1);
+            uint16_t drivenum = args.getWord(1);
             uint32_t ret = getbpb(drivenum);
             cpu.setDRegister(0, ret);
             break;
@@ -118,7 +165,7 @@ void AtariBios::bios(Cpu& cpu)
 
         case BCOSTAT: // bcostat(uint16_t devnum) -> uint32_t
         {
-            uint16_t devnum = argWord(cpu, isSupervisor, 1);
+            uint16_t devnum = args.getWord(1);
             uint32_t ret = bcostat(devnum);
             cpu.setDRegister(0, ret);
             break;
@@ -126,7 +173,7 @@ void AtariBios::bios(Cpu& cpu)
 
         case MEDIACH: // mediach(uint16_t drivenum) -> uint32_t
         {
-            uint16_t drivenum = argWord(cpu, isSupervisor, 1);
+            uint16_t drivenum = args.getWord(1);
             uint32_t ret = mediach(drivenum);
             cpu.setDRegister(0, ret);
             break;
@@ -141,7 +188,7 @@ void AtariBios::bios(Cpu& cpu)
 
         case KBSHIFT: // kbshift(uint16_t mode) -> uint32_t
         {
-            uint16_t mode = argWord(cpu, isSupervisor, 1);
+            uint16_t mode = args.getWord(1);
             uint32_t ret = kbshift(mode);
             cpu.setDRegister(0, ret);
             break;
@@ -149,15 +196,15 @@ void AtariBios::bios(Cpu& cpu)
 
         default:
             // For testing, return the given argument
-            uint16_t arg1 = argWord(cpu, isSupervisor, 1);
+            uint16_t arg1 = args.getWord(1);
             if (func & 1)
             {
-                uint16_t result = argWord(cpu, isSupervisor, arg1);
+                uint16_t result = args.getWord(arg1);
                 cpu.setDRegister(0, static_cast<uint32_t>(result));
             }
             else
             {
-                uint32_t result = argLong(cpu, isSupervisor, arg1);
+                uint32_t result = args.getLong(arg1);
                 cpu.setDRegister(0, result);
             }
             break;
@@ -183,28 +230,11 @@ int32_t AtariBios::bconstat(uint16_t devnum)
 {
     if (devnum == 2) // keyboard
     {
-#ifdef _WIN32
-        if (_kbhit())
+        if (consoleInput().available())
         {
             return 0xffff;
         }
         return 0;
-#else
-        struct termios oldt, newt;
-        tcgetattr(STDIN_FILENO, &oldt);          // Get current terminal settings
-        newt = oldt;
-        newt.c_lflag &= ~(ICANON | ECHO);        // Disable canonical mode and echo
-        tcsetattr(STDIN_FILENO, TCSANOW, &newt); // Apply new settings
-
-        int bytesWaiting;
-        ioctl(STDIN_FILENO, FIONREAD, &bytesWaiting);
-        tcsetattr(STDIN_FILENO, TCSANOW, &oldt); // Restore old settings
-        if (bytesWaiting > 0)
-        {
-            return 0xffff;
-        }
-        return 0;
-#endif
     }
     return 0;
 }
@@ -219,30 +249,12 @@ uint32_t AtariBios::bconin(uint16_t devnum)
 {
     if (devnum == 2) // keyboard
     {
-#ifdef _WIN32
-        int ch = _getch();  // Windows: no Enter required
-        if (ch == '\n')
-        {
-            ch = '\r';    // Convert newline to carriage return
-        }
-#else
-        struct termios oldt, newt;
-        char ch;
-        tcgetattr(STDIN_FILENO, &oldt);          // Get current terminal settings
-        newt = oldt;
-        newt.c_lflag &= ~(ICANON | ECHO);        // Disable canonical mode and echo
-        tcsetattr(STDIN_FILENO, TCSANOW, &newt); // Apply new settings
-        read(STDIN_FILENO, &ch, 1);              // Read one char    tcsetattr(STDIN_FILENO, TCSANOW, &oldt); // Restore old settings
-        if (ch == '\n')
-        {
-            ch = '\r';                          // Convert newline to carriage return
-        }
-        else if (ch == 127)
+        int32_t ch = consoleInput().read();
+        if (ch == ConsoleInput::END_OF_INPUT)
         {
-            ch = 8;                             // convert backspace
+            return 0;
         }
-#endif
-        return ch;
+        return static_cast<uint32_t>(ch);
     }
     return 0;
 }
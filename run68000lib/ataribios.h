@@ -1,6 +1,8 @@
 #pragma once
 #include <unordered_map>
 #include "ibios.h"
+#include "gemdosfiles.h"
+#include "guestheap.h"
 
 namespace mc68000
 {
@@ -8,35 +10,46 @@ namespace mc68000
     {
     public:
         void setup() override;
+        const char* configFile() const override { return "ataribios.conf"; }
+        void setup(const BiosConfig& config) override;
         void registerTrapHandlers(Cpu* cpu) override;
+        void setConsoleInput(std::shared_ptr<ConsoleInput> input) override;
         void handle(Cpu& cpu, uint16_t vector) override
         {
             switch (vector)
             {
             case 1:
-                bios(cpu);
+                gemdos(cpu);
                 break;
             case 13:
-                xbios(cpu);
+                bios(cpu);
                 break;
             case 14:
-                gemdos(cpu);
+                xbios(cpu);
                 break;
             default:
                 throw "AtariBios: unhandled trap vector";
             }
         }
     private:
-        std::unordered_map<std::string, std::string> settings;
+        std::shared_ptr<ConsoleInput> console;
+        uint32_t consoleBufferSize = 4096;
+        GemdosFiles files;
+        GuestHeap heap;
+        uint32_t heapStart = 0;     // 0: upper half of the guest memory
+        uint32_t heapSize = 0;
+        uint32_t stackReserve = 4096;
     private:
-        static void bios(Cpu& cpu);
+        void bios(Cpu& cpu);
         static void xbios(Cpu& cpu);
-        static void gemdos(Cpu& cpu);
+        void gemdos(Cpu& cpu);
+        ConsoleInput& consoleInput();
+        void prepareHeap(Cpu& cpu);
 
         // BIOS methods
         static void getmpb(uint32_t buffer);
-        static int32_t bconstat(uint16_t devnum);
-        static uint32_t bconin(uint16_t devnum);
+        int32_t bconstat(uint16_t devnum);
+        uint32_t bconin(uint16_t devnum);
         static void bconout(uint16_t devnum, uint16_t chr);
         static uint32_t rwabs(uint16_t mode, uint32_t buffer, uint16_t sectors, uint16_t start, uint16_t drivenum);
         static uint32_t setexec(uint16_t vecnum, uint32_t vecaddr);
@@ -89,10 +102,10 @@ namespace mc68000
 
         // GEMDOS methods
         static void pterm0();
-        static uint32_t cconin();
+        uint32_t cconin();
         static void cconout(uint16_t c);
         static void cconws(const char* s);
-        static uint16_t cconis();
+        uint16_t cconis();
         static uint16_t dsetdrv(uint16_t drv);
         static uint16_t dgetdrv();
 
@@ -110,18 +123,18 @@ namespace mc68000
         static uint16_t dcreate(const char* path);
         static uint16_t ddelete(const char* path);
         static uint16_t dsetpath(const char* path);
-        static uint16_t fcreate(const char* name, uint16_t attr);
-        static uint16_t fopen(const char* name, uint16_t mode);
-        static uint16_t fclose(uint16_t handle);
-        static uint32_t fread(uint16_t handle, uint32_t count, void* buf);
-        static uint32_t fwrite(uint16_t handle, uint32_t count, const void* buf);
+        int32_t fcreate(const char* name, uint16_t attr);
+        int32_t fopen(const char* name, uint16_t mode);
+        int32_t fclose(uint16_t handle);
+        int32_t fread(uint16_t handle, uint32_t count, void* buf);
+        int32_t fwrite(uint16_t handle, uint32_t count, const void* buf);
         static uint16_t fdelete(const char* name);
-        static uint32_t fseek(uint32_t offset, uint16_t handle, uint16_t mode);
+        int32_t fseek(int32_t offset, uint16_t handle, uint16_t mode);
         static uint16_t fattrib(const char* name, uint16_t wflag, uint16_t attrib);
         static uint16_t dgetpath(char* buf, uint16_t drv);
-        static void* malloc(uint32_t size);
-        static uint16_t mfree(void* ptr);
-        static uint16_t mshrink(void* base, uint32_t size);
+        uint32_t malloc(uint32_t size);
+        int32_t mfree(uint32_t block);
+        int32_t mshrink(uint32_t block, uint32_t size);
         static uint16_t fsfirst(const char* pattern, uint16_t attr);
         static uint16_t fsnext();
         static uint16_t frename(uint16_t zero, const char* old, const char* neu);
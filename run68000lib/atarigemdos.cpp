@@ -60,8 +60,13 @@ void AtariBios::gemdos(Cpu& cpu)
         GEMDOS_FDATIME = 87
     };
 
-    bool isSupervisor = callerIsSupervisor(cpu);
-    uint16_t func = argWord(cpu, isSupervisor, 0);
+    TrapArguments args = cpu.trapArguments();
+    uint16_t func = args.getWord(0);
+    if (args.hasFault())
+    {
+        // the stack is outside the memory: the bus error is raised after the trap
+        return;
+    }
 
     // Dispatch GEMDOS functions
     switch (func)
@@ -81,16 +86,15 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_CCONOUT: // cconout(uint16_t c)
     {
-        uint16_t c = argWord(cpu, isSupervisor, 1);
+        uint16_t c = args.getWord(1);
         cconout(c);
         break;
     }
 
     case GEMDOS_CCONWS: // cconws(const char* str)
     {
-        uint32_t address = argLong(cpu, isSupervisor, 1);
-        char* str = static_cast<char*>(cpu.mem.get<void*>(address));
-        cconws(str);
+        std::string str = guestString(cpu, args.getLong(1));
+        cconws(str.c_str());
         break;
     }
 
@@ -103,7 +107,7 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_DSETDRV: // dsetdrv(uint16_t drv) -> uint16_t
     {
-        uint16_t drv = argWord(cpu, isSupervisor, 1);
+        uint16_t drv = args.getWord(1);
         uint16_t ret = dsetdrv(drv);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -118,7 +122,7 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_FSETDTA: // fsetdta(DTA* dta)
     {
-        DTA* dta = reinterpret_cast<DTA*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
+        DTA* dta = reinterpret_cast<DTA*>(static_cast<uintptr_t>(args.getLong(1)));
         fsetdta(dta);
         break;
     }
@@ -132,15 +136,15 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_PTERMRES: // ptermres(uint32_t keep, uint16_t rc)
     {
-        uint32_t keep = argLong(cpu, isSupervisor, 1);
-        uint16_t rc = argWord(cpu, isSupervisor, 3);
+        uint32_t keep = args.getLong(1);
+        uint16_t rc = args.getWord(3);
         ptermres(keep, rc);
         break;
     }
 
     case GEMDOS_DCREATE: // dcreate(const char* path) -> uint16_t
     {
-        const char* path = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
+        const char* path = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(1)));
         uint16_t ret = dcreate(path);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -148,7 +152,7 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_DDELETE: // ddelete(const char* path) -> uint16_t
     {
-        const char* path = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
+        const char* path = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(1)));
         uint16_t ret = ddelete(path);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -156,81 +160,81 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_DSETPATH: // dsetpath(const char* path) -> uint16_t
     {
-        const char* path = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
+        const char* path = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(1)));
         uint16_t ret = dsetpath(path);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_FCREATE: // fcreate(const char* name, uint16_t attr) -> uint16_t
+    case GEMDOS_FCREATE: // fcreate(const char* name, uint16_t attr) -> int32_t
     {
-        const char* name = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t attr = argWord(cpu, isSupervisor, 3);
-        uint16_t ret = fcreate(name, attr);
+        std::string name = guestString(cpu, args.getLong(1));
+        uint16_t attr = args.getWord(3);
+        int32_t ret = fcreate(name.c_str(), attr);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_FOPEN: // fopen(const char* name, uint16_t mode) -> uint16_t
+    case GEMDOS_FOPEN: // fopen(const char* name, uint16_t mode) -> int32_t
     {
-        const char* name = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t mode = argWord(cpu, isSupervisor, 3);
-        uint16_t ret = fopen(name, mode);
+        std::string name = guestString(cpu, args.getLong(1));
+        uint16_t mode = args.getWord(3);
+        int32_t ret = fopen(name.c_str(), mode);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_FCLOSE: // fclose(uint16_t handle) -> uint16_t
+    case GEMDOS_FCLOSE: // fclose(uint16_t handle) -> int32_t
     {
-        uint16_t handle = argWord(cpu, isSupervisor, 1);
-        uint16_t ret = fclose(handle);
+        uint16_t handle = args.getWord(1);
+        int32_t ret = fclose(handle);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_FREAD: // fread(uint16_t handle, uint32_t count, void* buf) -> uint32_t
+    case GEMDOS_FREAD: // fread(uint16_t handle, uint32_t count, void* buf) -> int32_t
     {
-        uint16_t handle = argWord(cpu, isSupervisor, 1);
-        uint32_t count = argLong(cpu, isSupervisor, 2);
-        void* buf = reinterpret_cast<void*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 4)));
-        uint32_t ret = fread(handle, count, buf);
-        cpu.setDRegister(0, ret);
+        uint16_t handle = args.getWord(1);
+        uint32_t count = args.getLong(2);
+        void* buf = writableGuestBuffer(cpu, args.getLong(4), count);
+        int32_t ret = buf != nullptr ? fread(handle, count, buf) : E_RANGE;
+        cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_FWRITE: // fwrite(uint16_t handle, uint32_t count, const void* buf) -> uint32_t
+    case GEMDOS_FWRITE: // fwrite(uint16_t handle, uint32_t count, const void* buf) -> int32_t
     {
-        uint16_t handle = argWord(cpu, isSupervisor, 1);
-        uint32_t count = argLong(cpu, isSupervisor, 2);
-        const void* buf = reinterpret_cast<const void*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 4)));
-        uint32_t ret = fwrite(handle, count, buf);
-        cpu.setDRegister(0, ret);
+        uint16_t handle = args.getWord(1);
+        uint32_t count = args.getLong(2);
+        const void* buf = guestBuffer(cpu, args.getLong(4), count);
+        int32_t ret = buf != nullptr ? fwrite(handle, count, buf) : E_RANGE;
+        cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
     case GEMDOS_FDELETE: // fdelete(const char* name) -> uint16_t
     {
-        const char* name = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
+        const char* name = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(1)));
         uint16_t ret = fdelete(name);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_FSEEK: // fseek(uint32_t offset, uint16_t handle, uint16_t mode) -> uint32_t
+    case GEMDOS_FSEEK: // fseek(int32_t offset, uint16_t handle, uint16_t mode) -> int32_t
     {
-        uint32_t offset = argLong(cpu, isSupervisor, 1);
-        uint16_t handle = argWord(cpu, isSupervisor, 3);
-        uint16_t mode = argWord(cpu, isSupervisor, 4);
-        uint32_t ret = fseek(offset, handle, mode);
-        cpu.setDRegister(0, ret);
+        int32_t offset = static_cast<int32_t>(args.getLong(1));
+        uint16_t handle = args.getWord(3);
+        uint16_t mode = args.getWord(4);
+        int32_t ret = fseek(offset, handle, mode);
+        cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
     case GEMDOS_FATTRIB: // fattrib(const char* name, uint16_t wflag, uint16_t attrib) -> uint16_t
     {
-        const char* name = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t wflag = argWord(cpu, isSupervisor, 3);
-        uint16_t attrib = argWord(cpu, isSupervisor, 4);
+        const char* name = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(1)));
+        uint16_t wflag = args.getWord(3);
+        uint16_t attrib = args.getWord(4);
         uint16_t ret = fattrib(name, wflag, attrib);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -238,42 +242,43 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_DGET_PATH: // dgetpath(char* buf, uint16_t drv) -> uint16_t
     {
-        char* buf = reinterpret_cast<char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t drv = argWord(cpu, isSupervisor, 3);
+        char* buf = reinterpret_cast<char*>(static_cast<uintptr_t>(args.getLong(1)));
+        uint16_t drv = args.getWord(3);
         uint16_t ret = dgetpath(buf, drv);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_MALLOC: // malloc(uint32_t size) -> void*
+    case GEMDOS_MALLOC: // malloc(int32_t size) -> uint32_t
     {
-        uint32_t size = argLong(cpu, isSupervisor, 1);
-        void* ptr = malloc(size);
-        cpu.setDRegister(0, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr)));
+        uint32_t size = args.getLong(1);
+        prepareHeap(cpu);
+        uint32_t ret = malloc(size);
+        cpu.setDRegister(0, ret);
         break;
     }
 
-    case GEMDOS_MFREE: // mfree(void* ptr) -> uint16_t
+    case GEMDOS_MFREE: // mfree(uint32_t block) -> int32_t
     {
-        void* ptr = reinterpret_cast<void*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t ret = mfree(ptr);
+        uint32_t block = args.getLong(1);
+        int32_t ret = mfree(block);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
-    case GEMDOS_MSHRINK: // mshrink(void* base, uint32_t size) -> uint16_t
+    case GEMDOS_MSHRINK: // mshrink(0, uint32_t block, uint32_t size) -> int32_t
     {
-        void* base = reinterpret_cast<void*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint32_t size = argLong(cpu, isSupervisor, 3);
-        uint16_t ret = mshrink(base, size);
+        uint32_t block = args.getLong(2);
+        uint32_t size = args.getLong(4);
+        int32_t ret = mshrink(block, size);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
     }
 
     case GEMDOS_FSFIRST: // fsfirst(const char* pattern, uint16_t attr) -> uint16_t
     {
-        const char* pattern = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t attr = argWord(cpu, isSupervisor, 3);
+        const char* pattern = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(1)));
+        uint16_t attr = args.getWord(3);
         uint16_t ret = fsfirst(pattern, attr);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -288,9 +293,9 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_FRENAME: // frename(uint16_t zero, const char* old, const char* neu) -> uint16_t
     {
-        uint16_t zero = argWord(cpu, isSupervisor, 1);
-        const char* oldp = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 2)));
-        const char* neu = reinterpret_cast<const char*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 4)));
+        uint16_t zero = args.getWord(1);
+        const char* oldp = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(2)));
+        const char* neu = reinterpret_cast<const char*>(static_cast<uintptr_t>(args.getLong(4)));
         uint16_t ret = frename(zero, oldp, neu);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -298,10 +303,10 @@ void AtariBios::gemdos(Cpu& cpu)
 
     case GEMDOS_FDATIME: // fdatime(uint16_t* time, uint16_t* date, uint16_t handle, uint16_t rwflag) -> uint16_t
     {
-        uint16_t* timep = reinterpret_cast<uint16_t*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 1)));
-        uint16_t* datep = reinterpret_cast<uint16_t*>(static_cast<uintptr_t>(argLong(cpu, isSupervisor, 3)));
-        uint16_t handle = argWord(cpu, isSupervisor, 5);
-        uint16_t rwflag = argWord(cpu, isSupervisor, 6);
+        uint16_t* timep = reinterpret_cast<uint16_t*>(static_cast<uintptr_t>(args.getLong(1)));
+        uint16_t* datep = reinterpret_cast<uint16_t*>(static_cast<uintptr_t>(args.getLong(3)));
+        uint16_t handle = args.getWord(5);
+        uint16_t rwflag = args.getWord(6);
         uint16_t ret = fdatime(timep, datep, handle, rwflag);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -318,9 +323,18 @@ void AtariBios::pterm0()
 {
 }
 
+/// <summary>
+/// Read a character from the standard input device and echo it to the standard output device
+/// </summary>
+/// <returns>The character read</returns>
 uint32_t AtariBios::cconin()
 {
-    return 0;
+    uint32_t ch = bconin(2);
+    if (ch != 0)
+    {
+        std::cout << static_cast<char>(ch) << std::flush;
+    }
+    return ch;
 }
 
 void AtariBios::cconout(uint16_t c)
@@ -336,9 +350,13 @@ void AtariBios::cconws(const char* s)
     std::cout << s << std::flush;
 }
 
+/// <summary>
+/// Check the status of the standard input device
+/// </summary>
+/// <returns>0xffff if a character is available, 0 otherwise</returns>
 uint16_t AtariBios::cconis()
 {
-    return 0;
+    return static_cast<uint16_t>(bconstat(2));
 }
 
 uint16_t AtariBios::dsetdrv(uint16_t drv)
@@ -379,29 +397,49 @@ uint16_t AtariBios::dsetpath(const char* path)
     return 0;
 }
 
-uint16_t AtariBios::fcreate(const char* name, uint16_t attr)
+/// <summary>
+/// Create a file and open it for reading and writing
+/// </summary>
+/// <returns>The handle or a negative error code</returns>
+int32_t AtariBios::fcreate(const char* name, uint16_t attr)
 {
-    return 0;
+    return files.create(name, attr);
 }
 
-uint16_t AtariBios::fopen(const char* name, uint16_t mode)
+/// <summary>
+/// Open an existing file
+/// </summary>
+/// <returns>The handle or a negative error code</returns>
+int32_t AtariBios::fopen(const char* name, uint16_t mode)
 {
-    return 0;
+    return files.open(name, mode);
 }
 
-uint16_t AtariBios::fclose(uint16_t handle)
+/// <summary>
+/// Close a file
+/// </summary>
+/// <returns>0 or a negative error code</returns>
+int32_t AtariBios::fclose(uint16_t handle)
 {
-    return 0;
+    return files.close(handle);
 }
 
-uint32_t AtariBios::fread(uint16_t handle, uint32_t count, void* buf)
+/// <summary>
+/// Read bytes from a file into the guest memory
+/// </summary>
+/// <returns>The number of bytes read or a negative error code</returns>
+int32_t AtariBios::fread(uint16_t handle, uint32_t count, void* buf)
 {
-    return 0;
+    return files.read(handle, count, buf);
 }
 
-uint32_t AtariBios::fwrite(uint16_t handle, uint32_t count, const void* buf)
+/// <summary>
+/// Write bytes from the guest memory into a file
+/// </summary>
+/// <returns>The number of bytes written or a negative error code</returns>
+int32_t AtariBios::fwrite(uint16_t handle, uint32_t count, const void* buf)
 {
-    return 0;
+    return files.write(handle, count, buf);
 }
 
 uint16_t AtariBios::fdelete(const char* name)
@@ -409,9 +447,13 @@ uint16_t AtariBios::fdelete(const char* name)
     return 0;
 }
 
-uint32_t AtariBios::fseek(uint32_t offset, uint16_t handle, uint16_t mode)
+/// <summary>
+/// Move the position in a file
+/// </summary>
+/// <returns>The new position or a negative error code</returns>
+int32_t AtariBios::fseek(int32_t offset, uint16_t handle, uint16_t mode)
 {
-    return 0;
+    return files.seek(offset, handle, mode);
 }
 
 uint16_t AtariBios::fattrib(const char* name, uint16_t wflag, uint16_t attrib)
@@ -424,19 +466,40 @@ uint16_t AtariBios::dgetpath(char* buf, uint16_t drv)
     return 0;
 }
 
-void* AtariBios::malloc(uint32_t size)
+/// <summary>
+/// Allocate a block of the guest memory
+/// </summary>
+/// <param name="size">Size in bytes, -1 to query the largest free block</param>
+/// <returns>The address of the block, 0 if there is not enough memory, or the size of the largest free block</returns>
+uint32_t AtariBios::malloc(uint32_t size)
 {
-    return nullptr;
+    if (size == 0xffffffff)
+    {
+        return heap.largestFree();
+    }
+    return heap.allocate(size);
 }
 
-uint16_t AtariBios::mfree(void* ptr)
+/// <summary>
+/// Release a block allocated by Malloc
+/// </summary>
+/// <returns>0 or a negative error code</returns>
+int32_t AtariBios::mfree(uint32_t block)
 {
-    return 0;
+    return heap.release(block) ? E_OK : E_IMBA;
 }
 
-uint16_t AtariBios::mshrink(void* base, uint32_t size)
+/// <summary>
+/// Reduce the size of a block allocated by Malloc, the block is not moved
+/// </summary>
+/// <returns>0 or a negative error code</returns>
+int32_t AtariBios::mshrink(uint32_t block, uint32_t size)
 {
-    return 0;
+    if (!heap.isAllocated(block))
+    {
+        return E_IMBA;
+    }
+    return heap.shrink(block, size) ? E_OK : E_GSBF;
 }
 
 uint16_t AtariBios::fsfirst(const char* pattern, uint16_t attr)
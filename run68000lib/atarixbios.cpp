@@ -47,16 +47,21 @@ void AtariBios::xbios(Cpu& cpu)
         BLITMODE = 39,
     };
 
-    bool isSupervisor = callerIsSupervisor(cpu);
-    uint16_t func = argWord(cpu, isSupervisor, 0);
+    TrapArguments args = cpu.trapArguments();
+    uint16_t func = args.getWord(0);
+    if (args.hasFault())
+    {
+        // the stack is outside the memory: the bus error is raised after the trap
+        return;
+    }
 
     switch (func)
     {
     case INITMOUS: // initmous(uint16_t mode, uint32_t param, uint32_t vector)
     {
-        uint16_t mode = argWord(cpu, isSupervisor,1);
-        uint32_t param = argLong(cpu, isSupervisor, 2);
-        uint32_t vector = argLong(cpu, isSupervisor, 4);
+        uint16_t mode = args.getWord(1);
+        uint32_t param = args.getLong(2);
+        uint32_t vector = args.getLong(4);
         initmous(mode, param, vector);
         break;
     }
@@ -84,9 +89,9 @@ void AtariBios::xbios(Cpu& cpu)
 
     case SETSCREEN: // setScreen(uint32_t logaddr, uint32_t physaddr, uint16_t rez) -> uint32_t
     {
-        uint32_t logaddr = argLong(cpu, isSupervisor, 1);
-        uint32_t physaddr = argLong(cpu, isSupervisor, 3);
-        uint16_t rez = argWord(cpu, isSupervisor,5);
+        uint32_t logaddr = args.getLong(1);
+        uint32_t physaddr = args.getLong(3);
+        uint16_t rez = args.getWord(5);
         uint32_t ret = setScreen(logaddr, physaddr, rez);
         cpu.setDRegister(0, ret);
         break;
@@ -94,15 +99,15 @@ void AtariBios::xbios(Cpu& cpu)
 
     case SETPALETTE: // setpalette(uint32_t palette)
     {
-        uint32_t palette = argLong(cpu, isSupervisor, 1);
+        uint32_t palette = args.getLong(1);
         setpalette(palette);
         break;
     }
 
     case SETCOLOR: // setcolor(uint16_t reg, uint16_t newcolor) -> uint16_t
     {
-        uint16_t reg = argWord(cpu, isSupervisor,1);
-        uint16_t newcolor = argWord(cpu, isSupervisor,2);
+        uint16_t reg = args.getWord(1);
+        uint16_t newcolor = args.getWord(2);
         uint16_t ret = setcolor(reg, newcolor);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -110,13 +115,13 @@ void AtariBios::xbios(Cpu& cpu)
 
     case FLOPRD: // floprd(uint32_t buf, uint32_t resvd, uint16_t devnum, uint16_t secnum, uint16_t tracknum, uint16_t sidenum, uint16_t numsecs) -> uint16_t
     {
-        uint32_t buf = argLong(cpu, isSupervisor, 1);
-        uint32_t resvd = argLong(cpu, isSupervisor, 3);
-        uint16_t devnum = argWord(cpu, isSupervisor,5);
-        uint16_t secnum = argWord(cpu, isSupervisor,6);
-        uint16_t tracknum = argWord(cpu, isSupervisor,7);
-        uint16_t sidenum = argWord(cpu, isSupervisor,8);
-        uint16_t numsecs = argWord(cpu, isSupervisor,9);
+        uint32_t buf = args.getLong(1);
+        uint32_t resvd = args.getLong(3);
+        uint16_t devnum = args.getWord(5);
+        uint16_t secnum = args.getWord(6);
+        uint16_t tracknum = args.getWord(7);
+        uint16_t sidenum = args.getWord(8);
+        uint16_t numsecs = args.getWord(9);
         uint16_t ret = floprd(buf, resvd, devnum, secnum, tracknum, sidenum, numsecs);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -124,13 +129,13 @@ void AtariBios::xbios(Cpu& cpu)
 
     case FLOPWR: // flopwr(...) -> uint16_t
     {
-        uint32_t buf = argLong(cpu, isSupervisor, 1);
-        uint32_t resvd = argLong(cpu, isSupervisor, 3);
-        uint16_t devnum = argWord(cpu, isSupervisor,5);
-        uint16_t secnum = argWord(cpu, isSupervisor,6);
-        uint16_t tracknum = argWord(cpu, isSupervisor,7);
-        uint16_t sidenum = argWord(cpu, isSupervisor,8);
-        uint16_t numsecs = argWord(cpu, isSupervisor,9);
+        uint32_t buf = args.getLong(1);
+        uint32_t resvd = args.getLong(3);
+        uint16_t devnum = args.getWord(5);
+        uint16_t secnum = args.getWord(6);
+        uint16_t tracknum = args.getWord(7);
+        uint16_t sidenum = args.getWord(8);
+        uint16_t numsecs = args.getWord(9);
         uint16_t ret = flopwr(buf, resvd, devnum, secnum, tracknum, sidenum, numsecs);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -138,15 +143,15 @@ void AtariBios::xbios(Cpu& cpu)
 
     case FLOPFMT: // flopfmt(uint32_t buffer, uint32_t skewtabl, uint16_t devnum, uint16_t spt, uint16_t tracknum, uint16_t sidenum, uint16_t intrlev, uint32_t magic, uint16_t initial) -> uint16_t
     {
-        uint32_t buffer = argLong(cpu, isSupervisor, 1);
-        uint32_t skewtabl = argLong(cpu, isSupervisor, 3);
-        uint16_t devnum = argWord(cpu, isSupervisor,5);
-        uint16_t spt = argWord(cpu, isSupervisor,6);
-        uint16_t tracknum = argWord(cpu, isSupervisor,7);
-        uint16_t sidenum = argWord(cpu, isSupervisor,8);
-        uint16_t intrlev = argWord(cpu, isSupervisor,9);
-        uint32_t magic = argLong(cpu, isSupervisor, 10);
-        uint16_t initial = argWord(cpu, isSupervisor,12);
+        uint32_t buffer = args.getLong(1);
+        uint32_t skewtabl = args.getLong(3);
+        uint16_t devnum = args.getWord(5);
+        uint16_t spt = args.getWord(6);
+        uint16_t tracknum = args.getWord(7);
+        uint16_t sidenum = args.getWord(8);
+        uint16_t intrlev = args.getWord(9);
+        uint32_t magic = args.getLong(10);
+        uint16_t initial = args.getWord(12);
         uint16_t ret = flopfmt(buffer, skewtabl, devnum, spt, tracknum, sidenum, intrlev, magic, initial);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -154,23 +159,23 @@ void AtariBios::xbios(Cpu& cpu)
 
     case MIDIWS: // midiws(uint16_t bytes, uint32_t buffer)
     {
-        uint16_t bytes = argWord(cpu, isSupervisor,1);
-        uint32_t buffer = argLong(cpu, isSupervisor, 2);
+        uint16_t bytes = args.getWord(1);
+        uint32_t buffer = args.getLong(2);
         midiws(bytes, buffer);
         break;
     }
 
     case MFPINT: // mfpint(uint16_t number, uint32_t vector)
     {
-        uint16_t number = argWord(cpu, isSupervisor,1);
-        uint32_t vector = argLong(cpu, isSupervisor, 2);
+        uint16_t number = args.getWord(1);
+        uint32_t vector = args.getLong(2);
         mfpint(number, vector);
         break;
     }
 
     case IOREC: // iorec(uint16_t dev) -> uint32_t
     {
-        uint16_t dev = argWord(cpu, isSupervisor,1);
+        uint16_t dev = args.getWord(1);
         uint32_t ret = iorec(dev);
         cpu.setDRegister(0, ret);
         break;
@@ -178,20 +183,20 @@ void AtariBios::xbios(Cpu& cpu)
 
     case RSCONF: // rsconf(uint16_t speed, uint16_t ucr, uint16_t rsr, uint16_t tsr, uint16_t scr)
     {
-        uint16_t speed = argWord(cpu, isSupervisor,1);
-        uint16_t ucr = argWord(cpu, isSupervisor,2);
-        uint16_t rsr = argWord(cpu, isSupervisor,3);
-        uint16_t tsr = argWord(cpu, isSupervisor,4);
-        uint16_t scr = argWord(cpu, isSupervisor,5);
+        uint16_t speed = args.getWord(1);
+        uint16_t ucr = args.getWord(2);
+        uint16_t rsr = args.getWord(3);
+        uint16_t tsr = args.getWord(4);
+        uint16_t scr = args.getWord(5);
         rsconf(speed, ucr, rsr, tsr, scr);
         break;
     }
 
     case KEYTBL: // keytbl(uint32_t unshift, uint32_t shift, uint32_t capslock) -> uint32_t
     {
-        uint32_t unshift = argLong(cpu, isSupervisor, 1);
-        uint32_t shift = argLong(cpu, isSupervisor, 3);
-        uint32_t capslock = argLong(cpu, isSupervisor, 5);
+        uint32_t unshift = args.getLong(1);
+        uint32_t shift = args.getLong(3);
+        uint32_t capslock = args.getLong(5);
         uint32_t ret = keytbl(unshift, shift, capslock);
         cpu.setDRegister(0, ret);
         break;
@@ -206,23 +211,23 @@ void AtariBios::xbios(Cpu& cpu)
 
     case PROTOTB: // protobt(uint32_t buffer, uint32_t serialnum, uint16_t disktype, uint16_t execflag)
     {
-        uint32_t buffer = argLong(cpu, isSupervisor, 1);
-        uint32_t serialnum = argLong(cpu, isSupervisor, 3);
-        uint16_t disktype = argWord(cpu, isSupervisor,5);
-        uint16_t execflag = argWord(cpu, isSupervisor,6);
+        uint32_t buffer = args.getLong(1);
+        uint32_t serialnum = args.getLong(3);
+        uint16_t disktype = args.getWord(5);
+        uint16_t execflag = args.getWord(6);
         protobt(buffer, serialnum, disktype, execflag);
         break;
     }
 
     case FLOPVER: // flopver(...) -> uint16_t
     {
-        uint32_t buf = argLong(cpu, isSupervisor, 1);
-        uint32_t resvd = argLong(cpu, isSupervisor, 3);
-        uint16_t devnum = argWord(cpu, isSupervisor,5);
-        uint16_t secnum = argWord(cpu, isSupervisor,6);
-        uint16_t tracknum = argWord(cpu, isSupervisor,7);
-        uint16_t sidenum = argWord(cpu, isSupervisor,8);
-        uint16_t numsec = argWord(cpu, isSupervisor,9);
+        uint32_t buf = args.getLong(1);
+        uint32_t resvd = args.getLong(3);
+        uint16_t devnum = args.getWord(5);
+        uint16_t secnum = args.getWord(6);
+        uint16_t tracknum = args.getWord(7);
+        uint16_t sidenum = args.getWord(8);
+        uint16_t numsec = args.getWord(9);
         uint16_t ret = flopver(buf, resvd, devnum, secnum, tracknum, sidenum, numsec);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -236,8 +241,8 @@ void AtariBios::xbios(Cpu& cpu)
 
     case CURSCONF: // cursconf(uint16_t mode, uint16_t newrate) -> uint16_t
     {
-        uint16_t mode = argWord(cpu, isSupervisor,1);
-        uint16_t newrate = argWord(cpu, isSupervisor,2);
+        uint16_t mode = args.getWord(1);
+        uint16_t newrate = args.getWord(2);
         uint16_t ret = cursconf(mode, newrate);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -245,7 +250,7 @@ void AtariBios::xbios(Cpu& cpu)
 
     case SETTIME: // settime(uint32_t datetime)
     {
-        uint32_t datetime = argLong(cpu, isSupervisor, 1);
+        uint32_t datetime = args.getLong(1);
         settime(datetime);
         break;
     }
@@ -265,22 +270,22 @@ void AtariBios::xbios(Cpu& cpu)
 
     case IKBDWS: // ikbdws(uint16_t bytes, uint32_t buffer)
     {
-        uint16_t bytes = argWord(cpu, isSupervisor,1);
-        uint32_t buffer = argLong(cpu, isSupervisor, 2);
+        uint16_t bytes = args.getWord(1);
+        uint32_t buffer = args.getLong(2);
         ikbdws(bytes, buffer);
         break;
     }
 
     case JDISINT: // jdisint(uint16_t intnum)
     {
-        uint16_t intnum = argWord(cpu, isSupervisor,1);
+        uint16_t intnum = args.getWord(1);
         jdisint(intnum);
         break;
     }
 
     case JENABINT: // jenabint(uint16_t intnum) -> uint16_t
     {
-        uint16_t intnum = argWord(cpu, isSupervisor,1);
+        uint16_t intnum = args.getWord(1);
         uint16_t ret = jenabint(intnum);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -288,8 +293,8 @@ void AtariBios::xbios(Cpu& cpu)
 
     case GIACCESS: // giaccess(uint8_t value, uint16_t regnum) -> uint8_t
     {
-        uint8_t value = static_cast<uint8_t>(argWord(cpu, isSupervisor,1) & 0xFF);
-        uint16_t regnum = argWord(cpu, isSupervisor,2);
+        uint8_t value = static_cast<uint8_t>(args.getWord(1) & 0xFF);
+        uint16_t regnum = args.getWord(2);
         uint8_t ret = giaccess(value, regnum);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -297,38 +302,38 @@ void AtariBios::xbios(Cpu& cpu)
 
     case OFFGIBIT: // offgibit(uint16_t bitnum)
     {
-        uint16_t bitnum = argWord(cpu, isSupervisor,1);
+        uint16_t bitnum = args.getWord(1);
         offgibit(bitnum);
         break;
     }
 
     case ONGIBIT: // ongibit(uint16_t bitnum)
     {
-        uint16_t bitnum = argWord(cpu, isSupervisor,1);
+        uint16_t bitnum = args.getWord(1);
         ongibit(bitnum);
         break;
     }
 
     case XBTIMER: // xbtimer(uint16_t timernum, uint16_t control, uint16_t data, uint32_t vector)
     {
-        uint16_t timernum = argWord(cpu, isSupervisor,1);
-        uint16_t control = argWord(cpu, isSupervisor,2);
-        uint16_t data = argWord(cpu, isSupervisor,3);
-        uint32_t vector = argLong(cpu, isSupervisor, 4);
+        uint16_t timernum = args.getWord(1);
+        uint16_t control = args.getWord(2);
+        uint16_t data = args.getWord(3);
+        uint32_t vector = args.getLong(4);
         xbtimer(timernum, control, data, vector);
         break;
     }
 
     case DOSOUND: // dosound(uint32_t commandlist)
     {
-        uint32_t commandlist = argLong(cpu, isSupervisor, 1);
+        uint32_t commandlist = args.getLong(1);
         dosound(commandlist);
         break;
     }
 
     case SETPRT: // setprt(uint16_t newcode) -> uint16_t
     {
-        uint16_t newcode = argWord(cpu, isSupervisor,1);
+        uint16_t newcode = args.getWord(1);
         uint16_t ret = setprt(newcode);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -342,8 +347,8 @@ void AtariBios::xbios(Cpu& cpu)
 
     case KBRATE: // kbrate(uint16_t delay, uint16_t rate) -> uint16_t
     {
-        uint16_t delay = argWord(cpu, isSupervisor,1);
-        uint16_t rate = argWord(cpu, isSupervisor,2);
+        uint16_t delay = args.getWord(1);
+        uint16_t rate = args.getWord(2);
         uint16_t ret = kbrate(delay, rate);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -351,7 +356,7 @@ void AtariBios::xbios(Cpu& cpu)
 
     case PRTBLK: // prtblk(uint32_t prtable)
     {
-        uint32_t prtable = argLong(cpu, isSupervisor, 1);
+        uint32_t prtable = args.getLong(1);
         prtblk(prtable);
         break;
     }
@@ -364,14 +369,14 @@ void AtariBios::xbios(Cpu& cpu)
 
     case SUPEXEC: // supexec(uint32_t sub)
     {
-        uint32_t sub = argLong(cpu, isSupervisor, 1);
+        uint32_t sub = args.getLong(1);
         supexec(sub);
         break;
     }
 
     case BLITMODE: // blitmode(uint16_t value) -> uint16_t
     {
-        uint16_t value = argWord(cpu, isSupervisor,1);
+        uint16_t value = args.getWord(1);
         uint16_t ret = blitmode(value);
         cpu.setDRegister(0, static_cast<uint32_t>(ret));
         break;
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <unordered_map>
+
+#include "biosconfig.h"
+#include "trapargs.h"
+
+using namespace mc68000;
+
+namespace
+{
+    void readNumber(const std::unordered_map<std::string, std::string>& settings, const char* key, uint32_t& value)
+    {
+        auto it = settings.find(key);
+        if (it == settings.end())
+        {
+            return;
+        }
+        try
+        {
+            value = static_cast<uint32_t>(std::stoul(it->second, nullptr, 0));
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "configuration error: " << key << " = " << it->second << " is not a number" << std::endl;
+        }
+    }
+
+    void readString(const std::unordered_map<std::string, std::string>& settings, const char* key, std::string& value)
+    {
+        auto it = settings.find(key);
+        if (it != settings.end())
+        {
+            value = it->second;
+        }
+    }
+}
+
+/// <summary>
+/// Reads the configuration file. Missing file or keys keep the default values.
+/// </summary>
+/// <param name="defaultsFile">File read for the keys that configFile doesn't set, nullptr for none</param>
+BiosConfig BiosConfig::load(const char* configFile, const char* defaultsFile)
+{
+    std::unordered_map<std::string, std::string> settings;
+    getConfig(configFile, settings);
+    if (defaultsFile != nullptr)
+    {
+        // the keys already read are kept
+        getConfig(defaultsFile, settings);
+    }
+
+    BiosConfig config;
+    readString(settings, "bios", config.bios);
+    for (const auto& [key, value] : settings)
+    {
+        if (key.size() > 4 && key.compare(0, 4, "disk") == 0 && key.find_first_not_of("0123456789", 4) == std::string::npos)
+        {
+            config.disks[static_cast<uint16_t>(std::stoul(key.substr(4)))] = value;
+        }
+    }
+    readNumber(settings, "consolebuffer", config.consoleBufferSize);
+    readString(settings, "root", config.fileRoot);
+    readNumber(settings, "readahead", config.readAhead);
+    readNumber(settings, "writebehind", config.writeBehind);
+    readNumber(settings, "heapstart", config.heapStart);
+    readNumber(settings, "heapsize", config.heapSize);
+    readNumber(settings, "stackreserve", config.stackReserve);
+    return config;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace mc68000
+{
+    /// <summary>
+    /// Settings of the BIOS layer, parsed once from a "key = value" file and then read as plain fields.
+    /// run68000 reads run68000.conf, then the keys it doesn't set from the file of the BIOS: osbios.conf or
+    /// ataribios.conf.
+    /// Keys:
+    ///     bios            simple, atari or os
+    ///     disk{n}         disk image file of device n
+    ///     consolebuffer   size of the keyboard queue in characters
+    ///     root            host directory of the GEMDOS files
+    ///     readahead       GEMDOS file read buffer in bytes, 0 to disable
+    ///     writebehind     GEMDOS file write buffer in bytes, 0 to disable
+    ///     heapstart       first address of the GEMDOS heap, 0 for the upper half of the memory
+    ///     heapsize        size of the GEMDOS heap, 0 up to the stack reserve
+    ///     stackreserve    bytes kept for the stack at the top of the memory
+    /// Numbers can be decimal or hexadecimal (0x...).
+    /// </summary>
+    struct BiosConfig
+    {
+        std::string bios = "simple";
+        std::map<uint16_t, std::string> disks;
+        uint32_t consoleBufferSize = 4096;
+
+        std::string fileRoot;
+        uint32_t readAhead = 16 * 1024;
+        uint32_t writeBehind = 16 * 1024;
+
+        uint32_t heapStart = 0;
+        uint32_t heapSize = 0;
+        uint32_t stackReserve = 4096;
+
+        static BiosConfig load(const char* configFile, const char* defaultsFile = nullptr);
+    };
+}
@@ -0,0 +1,229 @@
+#include <chrono>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "consoleinput.h"
+
+using namespace mc68000;
+
+// ============================================================================
+// ConsoleInput
+// ============================================================================
+
+ConsoleInput::ConsoleInput(uint32_t capacity)
+{
+    // round the capacity up to a power of 2 so that the positions can be wrapped with a mask
+    uint32_t size = 16;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+/// <summary>
+/// Indicates if at least one character is waiting in the queue.
+/// </summary>
+bool ConsoleInput::available() const
+{
+    return head.load(std::memory_order_relaxed) != tail.load(std::memory_order_acquire);
+}
+
+/// <summary>
+/// Retrieves the next character if there is one, without blocking.
+/// </summary>
+/// <param name="ch">The character read</param>
+/// <returns>true if a character was read</returns>
+bool ConsoleInput::tryRead(int32_t& ch)
+{
+    uint32_t position = head.load(std::memory_order_relaxed);
+    if (position == tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    ch = buffer[position & mask];
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+/// <summary>
+/// Waits until a character is available and returns it.
+/// </summary>
+/// <returns>The character read or END_OF_INPUT when the source is exhausted</returns>
+int32_t ConsoleInput::read()
+{
+    int32_t ch;
+    for (;;)
+    {
+        uint32_t seen = events.load(std::memory_order_acquire);
+        if (tryRead(ch))
+        {
+            return ch;
+        }
+        if (closed.load(std::memory_order_acquire))
+        {
+            return END_OF_INPUT;
+        }
+        events.wait(seen);
+    }
+}
+
+/// <summary>
+/// Adds a character to the queue. Only called by the producer.
+/// When the queue is full it waits for the consumer, and drops the character if the producer is stopping.
+/// </summary>
+void ConsoleInput::push(uint8_t ch)
+{
+    if (ch == '\n')
+    {
+        ch = '\r';  // Convert newline to carriage return
+    }
+    else if (ch == 127)
+    {
+        ch = 8;     // convert backspace
+    }
+
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    while (position - head.load(std::memory_order_acquire) > mask)
+    {
+        if (stopping.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        // the guest doesn't consume its input: wait for some room
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    buffer[position & mask] = ch;
+    tail.store(position + 1, std::memory_order_release);
+    events.fetch_add(1, std::memory_order_release);
+    events.notify_one();
+}
+
+/// <summary>
+/// Signals that no more character will be pushed. Only called by the producer.
+/// </summary>
+void ConsoleInput::close()
+{
+    closed.store(true, std::memory_order_release);
+    events.fetch_add(1, std::memory_order_release);
+    events.notify_one();
+}
+
+// ============================================================================
+// TerminalInput
+// ============================================================================
+
+TerminalInput::TerminalInput(uint32_t capacity) : ConsoleInput(capacity)
+{
+#ifndef _WIN32
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &savedTerminal) == 0)
+    {
+        struct termios raw = savedTerminal;
+        raw.c_lflag &= ~(ICANON | ECHO);        // Disable canonical mode and echo
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        restoreTerminal = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    if (pipe(wakeup) != 0)
+    {
+        wakeup[0] = wakeup[1] = -1;
+    }
+#endif
+    reader = std::thread(&TerminalInput::readLoop, this);
+}
+
+TerminalInput::~TerminalInput()
+{
+    stopping = true;
+#ifndef _WIN32
+    if (wakeup[1] != -1)
+    {
+        char stop = 0;
+        (void)write(wakeup[1], &stop, 1);
+    }
+#endif
+    if (reader.joinable())
+    {
+        reader.join();
+    }
+#ifndef _WIN32
+    if (wakeup[0] != -1)
+    {
+        ::close(wakeup[0]);
+        ::close(wakeup[1]);
+    }
+    if (restoreTerminal)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+    }
+#endif
+}
+
+void TerminalInput::readLoop()
+{
+#ifdef _WIN32
+    while (!stopping)
+    {
+        if (_kbhit())
+        {
+            push(static_cast<uint8_t>(_getch()));
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+#else
+    struct pollfd fds[2] = {
+        { STDIN_FILENO, POLLIN, 0 },
+        { wakeup[0], POLLIN, 0 }
+    };
+    nfds_t count = wakeup[0] != -1 ? 2 : 1;
+    uint8_t chunk[256];
+    while (!stopping)
+    {
+        int ready = poll(fds, count, wakeup[0] != -1 ? -1 : 50);
+        if (ready <= 0 || (count == 2 && fds[1].revents))
+        {
+            continue;
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP))
+        {
+            ssize_t bytes = ::read(STDIN_FILENO, chunk, sizeof(chunk));
+            if (bytes <= 0)
+            {
+                break;
+            }
+            for (ssize_t i = 0; i < bytes; i++)
+            {
+                push(chunk[i]);
+            }
+        }
+        else if (fds[0].revents & (POLLERR | POLLNVAL))
+        {
+            break;
+        }
+    }
+#endif
+    close();
+}
+
+// ============================================================================
+// ScriptedInput
+// ============================================================================
+
+ScriptedInput::ScriptedInput(const std::string& script) :
+    ConsoleInput(static_cast<uint32_t>(script.size()))
+{
+    for (char ch : script)
+    {
+        push(static_cast<uint8_t>(ch));
+    }
+    close();
+}
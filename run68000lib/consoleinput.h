@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <termios.h>
+#endif
+
+namespace mc68000
+{
+    /// <summary>
+    /// Queue of the characters typed for a guest.
+    /// The queue has a single producer (the input source) and a single consumer (the emulation thread)
+    /// so the BIOS status and read calls are answered from memory without any system call.
+    /// </summary>
+    class ConsoleInput
+    {
+    public:
+        static constexpr int32_t END_OF_INPUT = -1;
+
+        explicit ConsoleInput(uint32_t capacity = 4096);
+        virtual ~ConsoleInput() = default;
+
+        bool available() const;
+        bool tryRead(int32_t& ch);
+        int32_t read();
+
+    protected:
+        void push(uint8_t ch);
+        void close();
+
+        // set by the owner of the producer to stop it: a push waiting for room gives up
+        std::atomic<bool> stopping{ false };
+
+    private:
+        std::vector<uint8_t> buffer;
+        uint32_t mask;
+        std::atomic<uint32_t> head{ 0 };    // next position to read, owned by the consumer
+        std::atomic<uint32_t> tail{ 0 };    // next position to write, owned by the producer
+        std::atomic<uint32_t> events{ 0 };  // bumped on every push and on close to wake up a blocked reader
+        std::atomic<bool> closed{ false };
+    };
+
+    /// <summary>
+    /// Console input read from the host terminal.
+    /// The terminal is switched to raw mode once and a background thread feeds the queue.
+    /// </summary>
+    class TerminalInput : public ConsoleInput
+    {
+    public:
+        explicit TerminalInput(uint32_t capacity = 4096);
+        ~TerminalInput() override;
+
+    private:
+        void readLoop();
+
+        std::thread reader;
+#ifndef _WIN32
+        int wakeup[2] = { -1, -1 };
+        bool restoreTerminal = false;
+        struct termios savedTerminal {};
+#endif
+    };
+
+    /// <summary>
+    /// Console input replaying a fixed script, mainly for tests and benchmarks.
+    /// </summary>
+    class ScriptedInput : public ConsoleInput
+    {
+    public:
+        explicit ScriptedInput(const std::string& script);
+    };
+}
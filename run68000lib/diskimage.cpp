@@ -0,0 +1,175 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "diskimage.h"
+
+using namespace mc68000;
+
+#ifdef _WIN32
+
+DiskImage::DiskImage(const std::string& fileName) :
+    fileName(fileName)
+{
+    std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+    if (!f)
+    {
+        std::cerr << "DiskImage error: failed to open disk file " << fileName << std::endl;
+        throw std::string("failed to open disk file");
+    }
+    content.resize(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(content.data()), content.size());
+    data = content.data();
+    size = content.size();
+
+    if (size < sizeof(BiosParameterBlock))
+    {
+        std::cerr << "DiskImage error: failed to read BPB from disk file " << fileName << std::endl;
+        throw std::string("failed to read bpb");
+    }
+    std::memcpy(&bpb, data, sizeof(BiosParameterBlock));
+    if (bpb.bytesPerSector != 0)
+    {
+        bytesPerSector = bpb.bytesPerSector;
+    }
+}
+
+DiskImage::~DiskImage()
+{
+    flush();
+}
+
+void DiskImage::flush()
+{
+    if (dirty)
+    {
+        std::ofstream f(fileName, std::ios::binary | std::ios::in | std::ios::out);
+        f.write(reinterpret_cast<const char*>(content.data()), content.size());
+        dirty = false;
+    }
+}
+
+#else
+
+DiskImage::DiskImage(const std::string& fileName) :
+    fileName(fileName)
+{
+    fd = open(fileName.c_str(), O_RDWR);
+    if (fd == -1)
+    {
+        fd = open(fileName.c_str(), O_RDONLY);
+        readOnly = true;
+    }
+    if (fd == -1)
+    {
+        std::cerr << "DiskImage error: failed to open disk file " << fileName << std::endl;
+        throw std::string("failed to open disk file");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(BiosParameterBlock))
+    {
+        close(fd);
+        std::cerr << "DiskImage error: failed to read BPB from disk file " << fileName << std::endl;
+        throw std::string("failed to read bpb");
+    }
+    size = static_cast<uint64_t>(st.st_size);
+
+    // a shared mapping makes the sector writes visible in the file without extra copy
+    int protection = readOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* p = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        close(fd);
+        std::cerr << "DiskImage error: failed to map disk file " << fileName << std::endl;
+        throw std::string("failed to map disk file");
+    }
+    data = static_cast<uint8_t*>(p);
+
+    std::memcpy(&bpb, data, sizeof(BiosParameterBlock));
+    if (bpb.bytesPerSector != 0)
+    {
+        bytesPerSector = bpb.bytesPerSector;
+    }
+}
+
+DiskImage::~DiskImage()
+{
+    flush();
+    munmap(data, size);
+    close(fd);
+}
+
+void DiskImage::flush()
+{
+    if (dirty)
+    {
+        msync(data, size, MS_SYNC);
+        dirty = false;
+    }
+}
+
+#endif
+
+/// <summary>
+/// Converts a sector range into a byte range of the image.
+/// </summary>
+/// <returns>false if the range is not entirely inside the image</returns>
+bool DiskImage::sectorRange(uint32_t sectorNumber, uint32_t sectorCount, uint64_t& offset, uint64_t& length) const
+{
+    offset = static_cast<uint64_t>(sectorNumber) * bytesPerSector;
+    length = static_cast<uint64_t>(sectorCount) * bytesPerSector;
+    return offset <= size && length <= size - offset;
+}
+
+/// <summary>
+/// Copies consecutive sectors from the image.
+/// </summary>
+/// <param name="buffer">Destination, must hold sectorCount sectors</param>
+/// <returns>The number of bytes read, 0 if the sectors are outside the image</returns>
+uint32_t DiskImage::read(void* buffer, uint32_t sectorNumber, uint32_t sectorCount) const
+{
+    uint64_t offset;
+    uint64_t length;
+    if (!sectorRange(sectorNumber, sectorCount, offset, length))
+    {
+        return 0;
+    }
+    std::memcpy(buffer, data + offset, length);
+    return static_cast<uint32_t>(length);
+}
+
+/// <summary>
+/// Copies consecutive sectors into the image. The file is updated by flush or when the image is closed.
+/// </summary>
+/// <param name="buffer">Source, must hold sectorCount sectors</param>
+/// <returns>The number of bytes written, 0 if the image is read-only or the sectors are outside the image</returns>
+uint32_t DiskImage::write(const void* buffer, uint32_t sectorNumber, uint32_t sectorCount)
+{
+    uint64_t offset;
+    uint64_t length;
+    if (readOnly || !sectorRange(sectorNumber, sectorCount, offset, length))
+    {
+        return 0;
+    }
+    std::memcpy(data + offset, buffer, length);
+    dirty = true;
+    if (sectorNumber == 0)
+    {
+        // the boot sector was rewritten (e.g. by a format), keep the cached parameters in sync
+        std::memcpy(&bpb, data, sizeof(BiosParameterBlock));
+        if (bpb.bytesPerSector != 0)
+        {
+            bytesPerSector = bpb.bytesPerSector;
+        }
+    }
+    return static_cast<uint32_t>(length);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "biosparameterblock.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// Disk image file opened once and kept in memory for the lifetime of the emulation.
+    /// The file is memory mapped when the platform allows it, otherwise it is loaded in a buffer and written back on flush.
+    /// The BiosParameterBlock is parsed when the image is opened so sector accesses don't touch the file system.
+    /// </summary>
+    class DiskImage
+    {
+    public:
+        explicit DiskImage(const std::string& fileName);
+        DiskImage(const DiskImage&) = delete;
+        DiskImage& operator=(const DiskImage&) = delete;
+        ~DiskImage();
+
+        uint32_t read(void* buffer, uint32_t sectorNumber, uint32_t sectorCount) const;
+        uint32_t write(const void* buffer, uint32_t sectorNumber, uint32_t sectorCount);
+        void flush();
+
+        const BiosParameterBlock& getBiosParameterBlock() const { return bpb; }
+        uint32_t getBytesPerSector() const { return bytesPerSector; }
+        uint64_t getSize() const { return size; }
+        bool isReadOnly() const { return readOnly; }
+
+    private:
+        bool sectorRange(uint32_t sectorNumber, uint32_t sectorCount, uint64_t& offset, uint64_t& length) const;
+
+    private:
+        std::string fileName;
+        BiosParameterBlock bpb;
+        uint32_t bytesPerSector = 512;
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+        bool readOnly = false;
+        bool dirty = false;
+#ifdef _WIN32
+        std::vector<uint8_t> content;
+#else
+        int fd = -1;
+#endif
+    };
+}
@@ -3,6 +3,7 @@
 #include "emulator.h"
 #include "simplebios.h"
 #include "ataribios.h"
+#include "osbios.h"
 
 using namespace mc68000;
 
@@ -16,22 +17,27 @@ const uint8_t code[] = {
     'M', 'C', '6','8', '0', '0', '0', ' ', 'H', 'e', 'l', 'l', 'o', '\n',0x00
 };
 const uint32_t base = 0x001000;
+const char* const configFile = "run68000.conf";
+
 Emulator::Emulator() :
     memory(1024, base, code, sizeof(code)),
-    cpu(memory)
+    cpu(memory),
+    config(BiosConfig::load(configFile))
 {
 }
 
 Emulator::Emulator(const char* binaryFile, const char* symbolsFilename) :
     memory(binaryFile),
     cpu(memory),
+    config(BiosConfig::load(configFile)),
     symbolsFile(symbolsFilename)
 {
 }
 
 Emulator::Emulator(uint32_t memorySize, uint32_t base, const uint8_t* code, size_t codeSize) :
 	memory(memorySize, base, code, codeSize),
-	cpu(memory)
+	cpu(memory),
+    config(BiosConfig::load(configFile))
 {
 }
 
@@ -46,21 +52,23 @@ void Emulator::run()
     cpu.reset();
     if (bios == nullptr)
     {
-        throw "bios not set";
+        setBios(config.bios);
     }
-    bios->setup();
+    bios->setup(config);
     bios->registerTrapHandlers(&cpu);
     auto memoryInfo = memory.getMemoryRange();
     uint32_t base = memoryInfo.first;
     uint16_t size = memoryInfo.second;
 
+    uint32_t stack = (base + size) & ~1u;
+
     if (debugMode)
     {
-        cpu.debug(base, base + size, base + size, symbolsFile);
+        cpu.debug(base, stack, stack, symbolsFile);
 	}
     else
     {
-        cpu.start(base, base + size, base + size);
+        cpu.start(base, stack, stack);
     }
 }
 
@@ -69,24 +77,26 @@ void Emulator::run(uint32_t startPc, uint32_t startSP, uint32_t startUSP)
     cpu.reset();
     if (bios == nullptr)
     {
-        assert(!"bios not set");
-        throw "bios not set";
+        setBios(config.bios);
     }
-    bios->setup();
+    bios->setup(config);
     bios->registerTrapHandlers(&cpu);
     auto memoryInfo = memory.getMemoryRange();
     uint32_t base = memoryInfo.first;
     uint16_t size = memoryInfo.second;
     uint16_t uspOffset = (size > 4096) ? 1024 : size / 4;
     uint16_t sspOffset = 0;
+    // the stacks must be even, word and long accesses to odd addresses are address errors
+    uint32_t userStack = (base + size - uspOffset) & ~1u;
+    uint32_t supervisorStack = (base + size - sspOffset) & ~1u;
 
     if (debugMode)
     {
-        cpu.debug(base, base + size - uspOffset, base + size - sspOffset, symbolsFile);
+        cpu.debug(base, userStack, supervisorStack, symbolsFile);
     }
     else
     {
-        cpu.start(base, base + size - uspOffset, base + size - sspOffset);
+        cpu.start(base, userStack, supervisorStack);
     }
 }
 
@@ -100,8 +110,60 @@ void Emulator::setBios(const std::string& biosName)
     {
         bios = new AtariBios();
     }
+    else if (biosName == "os")
+    {
+        bios = new OSBios();
+    }
     else
     {
         throw "unknown bios name";
     }
+    if (console)
+    {
+        bios->setConsoleInput(console);
+    }
+    // the files of the BIOS, like osbios.conf, still configure it when run68000.conf doesn't
+    BiosConfig loaded = BiosConfig::load(configFile, bios->configFile());
+    loaded.bios = biosName;     // may be config.bios itself
+    config = std::move(loaded);
+}
+
+void Emulator::setConsoleInput(std::shared_ptr<ConsoleInput> input)
+{
+    console = std::move(input);
+    if (bios != nullptr)
+    {
+        bios->setConsoleInput(console);
+    }
+}
+
+/// <summary>
+/// Collects the execution statistics of the next runs, see getStatistics.
+/// </summary>
+void Emulator::enableStatistics()
+{
+    if (!statistics)
+    {
+        statistics = std::make_unique<Statistics>();
+        cpu.setStatistics(statistics.get());
+    }
+}
+
+/// <summary>
+/// Runs the routines known to NativeRoutines on the host, found by their labels when a symbols file is given,
+/// else by their code. In verification mode the guest code runs too and the differences are reported.
+/// </summary>
+/// <returns>The number of routines found</returns>
+size_t Emulator::enableNativeRoutines(bool verify)
+{
+    if (!nativeRoutines)
+    {
+        nativeRoutines = std::make_unique<NativeRoutines>();
+    }
+    cpu.setNativeVerification(verify);
+    if (symbolsFile != nullptr && *symbolsFile != 0)
+    {
+        return nativeRoutines->installFromSymbols(cpu, symbolsFile);
+    }
+    return nativeRoutines->installFromSignatures(cpu);
 }
@@ -1,6 +1,8 @@
 #pragma once
+#include <memory>
 #include "../core/cpu.h"
 #include "ibios.h"
+#include "nativeroutines.h"
 
 namespace mc68000
 {
@@ -10,6 +12,10 @@ namespace mc68000
         Memory memory;
         Cpu cpu;
 		IBios* bios = nullptr;
+        std::shared_ptr<ConsoleInput> console;
+        BiosConfig config;          // run68000.conf, with the defaults of the file of the BIOS once it is chosen
+        std::unique_ptr<Statistics> statistics;
+        std::unique_ptr<NativeRoutines> nativeRoutines;
 
         bool debugMode = false;
         const char* symbolsFile = nullptr;
@@ -19,6 +25,12 @@ namespace mc68000
 	    Emulator(const char* binaryFile, const char* symbolsFilename);
 	    Emulator(uint32_t memorySize, uint32_t base, const uint8_t* code, size_t codeSize);
         void setBios(const std::string& biosName);
+        const BiosConfig& getConfig() const { return config; }
+        void setConsoleInput(std::shared_ptr<ConsoleInput> input);
+        void enableStatistics();
+        const Statistics* getStatistics() const { return statistics.get(); }
+        size_t enableNativeRoutines(bool verify);
+        uint64_t getNativeMismatches() const { return cpu.getNativeMismatches(); }
 
 	    bool debug(bool enable);
         void run();
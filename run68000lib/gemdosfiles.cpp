@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "gemdosfiles.h"
+
+using namespace mc68000;
+
+namespace
+{
+#ifdef _WIN32
+    int64_t readAt(int fd, void* buffer, uint32_t count, int64_t position)
+    {
+        if (_lseeki64(fd, position, SEEK_SET) < 0)
+        {
+            return -1;
+        }
+        return _read(fd, buffer, count);
+    }
+
+    int64_t writeAt(int fd, const void* buffer, uint32_t count, int64_t position)
+    {
+        if (_lseeki64(fd, position, SEEK_SET) < 0)
+        {
+            return -1;
+        }
+        return _write(fd, buffer, count);
+    }
+
+    int64_t fileSize(int fd)
+    {
+        struct _stat64 st;
+        return _fstat64(fd, &st) == 0 ? st.st_size : -1;
+    }
+
+    int closeFile(int fd)
+    {
+        return _close(fd);
+    }
+
+    const int binaryFlag = _O_BINARY;
+#else
+    int64_t readAt(int fd, void* buffer, uint32_t count, int64_t position)
+    {
+        return pread(fd, buffer, count, position);
+    }
+
+    int64_t writeAt(int fd, const void* buffer, uint32_t count, int64_t position)
+    {
+        return pwrite(fd, buffer, count, position);
+    }
+
+    int64_t fileSize(int fd)
+    {
+        struct stat st;
+        return fstat(fd, &st) == 0 ? st.st_size : -1;
+    }
+
+    int closeFile(int fd)
+    {
+        return ::close(fd);
+    }
+
+    const int binaryFlag = 0;
+#endif
+
+    int32_t openError()
+    {
+        switch (errno)
+        {
+        case ENOENT:
+            return E_FILNF;
+        case ENOTDIR:
+            return E_PTHNF;
+        case EMFILE:
+        case ENFILE:
+            return E_NHNDL;
+        default:
+            return E_ACCDN;
+        }
+    }
+}
+
+GemdosFiles::~GemdosFiles()
+{
+    closeAll();
+}
+
+/// <summary>
+/// Sets the size of the buffers of the files opened from now on. 0 disables the buffering.
+/// </summary>
+void GemdosFiles::setBufferSizes(uint32_t readAhead, uint32_t writeBehind)
+{
+    this->readAhead = readAhead;
+    this->writeBehind = writeBehind;
+}
+
+/// <summary>
+/// Sets the host directory the guest file names are relative to.
+/// </summary>
+void GemdosFiles::setRoot(const std::string& root)
+{
+    this->root = root;
+}
+
+/// <summary>
+/// Fcreate: creates or truncates a file and opens it for reading and writing.
+/// </summary>
+/// <returns>The handle or a negative GEMDOS error</returns>
+int32_t GemdosFiles::create(const char* name, uint16_t attr)
+{
+    int permissions = (attr & 0x01) ? 0444 : 0666;      // bit 0: read-only
+    std::string path = hostPath(name);
+    if (path.empty())
+    {
+        return E_PTHNF;
+    }
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | binaryFlag, permissions);
+    if (fd == -1)
+    {
+        return openError();
+    }
+    return allocate(fd, true, true);
+}
+
+/// <summary>
+/// Fopen: opens an existing file.
+/// </summary>
+/// <param name="mode">0 read only, 1 write only, 2 read and write</param>
+/// <returns>The handle or a negative GEMDOS error</returns>
+int32_t GemdosFiles::open(const char* name, uint16_t mode)
+{
+    static const int flags[] = { O_RDONLY, O_WRONLY, O_RDWR };
+    mode &= 0x03;
+    if (mode > 2)
+    {
+        return E_ACCDN;
+    }
+    std::string path = hostPath(name);
+    if (path.empty())
+    {
+        return E_PTHNF;
+    }
+    int fd = ::open(path.c_str(), flags[mode] | binaryFlag);
+    if (fd == -1)
+    {
+        return openError();
+    }
+    return allocate(fd, mode != 1, mode != 0);
+}
+
+/// <summary>
+/// Fclose: writes the pending data and releases the handle.
+/// </summary>
+/// <returns>0 or a negative GEMDOS error</returns>
+int32_t GemdosFiles::close(uint16_t handle)
+{
+    OpenFile* file = find(handle);
+    if (file == nullptr)
+    {
+        return E_IHNDL;
+    }
+    bool flushed = flush(*file);
+    bool closed = closeFile(file->fd) == 0;
+    file->fd = -1;
+    discard(*file);
+    return flushed && closed ? E_OK : E_ACCDN;
+}
+
+/// <summary>
+/// Closes all the handles, for example when the guest terminates.
+/// </summary>
+void GemdosFiles::closeAll()
+{
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (files[i].fd != -1)
+        {
+            close(static_cast<uint16_t>(FIRST_HANDLE + i));
+        }
+    }
+}
+
+/// <summary>
+/// Fread: copies bytes from the current position to the guest memory.
+/// </summary>
+/// <param name="buffer">Host address of the guest buffer, already checked to hold count bytes</param>
+/// <returns>The number of bytes read (less than count at the end of the file) or a negative GEMDOS error</returns>
+int32_t GemdosFiles::read(uint16_t handle, uint32_t count, void* buffer)
+{
+    OpenFile* file = find(handle);
+    if (file == nullptr)
+    {
+        return E_IHNDL;
+    }
+    if (!file->canRead)
+    {
+        return E_ACCDN;
+    }
+
+    uint8_t* destination = static_cast<uint8_t*>(buffer);
+    uint32_t done = 0;
+    while (done < count)
+    {
+        int64_t bufferEnd = file->bufferStart + file->bufferLength;
+        if (file->position >= file->bufferStart && file->position < bufferEnd)
+        {
+            uint32_t offset = static_cast<uint32_t>(file->position - file->bufferStart);
+            uint32_t n = std::min(count - done, file->bufferLength - offset);
+            std::memcpy(destination + done, file->buffer.data() + offset, n);
+            file->position += n;
+            done += n;
+            continue;
+        }
+
+        // pending writes must reach the file before it is read again
+        if (!flush(*file))
+        {
+            return done ? static_cast<int32_t>(done) : E_ACCDN;
+        }
+
+        uint32_t remaining = count - done;
+        uint32_t fill = std::min(readAhead, static_cast<uint32_t>(file->buffer.size()));
+        if (remaining >= fill)
+        {
+            // large read: straight into the guest memory
+            int64_t n = readAt(file->fd, destination + done, remaining, file->position);
+            if (n < 0)
+            {
+                return done ? static_cast<int32_t>(done) : E_ACCDN;
+            }
+            file->position += n;
+            done += static_cast<uint32_t>(n);
+            break;
+        }
+
+        int64_t n = readAt(file->fd, file->buffer.data(), fill, file->position);
+        file->bufferStart = file->position;
+        file->bufferLength = n > 0 ? static_cast<uint32_t>(n) : 0;
+        if (n <= 0)
+        {
+            if (n < 0 && done == 0)
+            {
+                return E_ACCDN;
+            }
+            break;
+        }
+    }
+    return static_cast<int32_t>(done);
+}
+
+/// <summary>
+/// Fwrite: copies bytes from the guest memory at the current position.
+/// Small writes are accumulated in the buffer and reach the file when the buffer is full, when the guest moves out of it or on close.
+/// </summary>
+/// <param name="buffer">Host address of the guest buffer, already checked to hold count bytes</param>
+/// <returns>The number of bytes written or a negative GEMDOS error</returns>
+int32_t GemdosFiles::write(uint16_t handle, uint32_t count, const void* buffer)
+{
+    OpenFile* file = find(handle);
+    if (file == nullptr)
+    {
+        return E_IHNDL;
+    }
+    if (!file->canWrite)
+    {
+        return E_ACCDN;
+    }
+
+    if (count >= writeBehind || count >= file->buffer.size())
+    {
+        // large write: straight from the guest memory
+        if (!flush(*file))
+        {
+            return E_ACCDN;
+        }
+        int64_t n = writeAt(file->fd, buffer, count, file->position);
+        if (n < 0)
+        {
+            return E_ACCDN;
+        }
+        int64_t end = file->position + n;
+        if (file->position < file->bufferStart + file->bufferLength && end > file->bufferStart)
+        {
+            // the buffer is no longer an image of the file
+            discard(*file);
+        }
+        file->position = end;
+        return static_cast<int32_t>(n);
+    }
+
+    // extend the buffer when the write is contiguous to it and the pending data stay within the write-behind size
+    int64_t offset = file->position - file->bufferStart;
+    bool fits = file->bufferLength != 0 && offset >= 0 && offset <= file->bufferLength
+        && static_cast<uint64_t>(offset) + count <= file->buffer.size();
+    if (fits && file->dirtyEnd > file->dirtyBegin)
+    {
+        int64_t begin = std::min<int64_t>(file->dirtyBegin, offset);
+        int64_t end = std::max<int64_t>(file->dirtyEnd, offset + count);
+        fits = end - begin <= writeBehind;
+    }
+    if (!fits)
+    {
+        if (!flush(*file))
+        {
+            return E_ACCDN;
+        }
+        discard(*file);
+        file->bufferStart = file->position;
+        offset = 0;
+    }
+
+    uint32_t start = static_cast<uint32_t>(offset);
+    std::memcpy(file->buffer.data() + start, buffer, count);
+    file->bufferLength = std::max(file->bufferLength, start + count);
+    if (file->dirtyEnd > file->dirtyBegin)
+    {
+        file->dirtyBegin = std::min(file->dirtyBegin, start);
+        file->dirtyEnd = std::max(file->dirtyEnd, start + count);
+    }
+    else
+    {
+        file->dirtyBegin = start;
+        file->dirtyEnd = start + count;
+    }
+    file->position += count;
+    return static_cast<int32_t>(count);
+}
+
+/// <summary>
+/// Fseek: moves the current position. The buffer is kept so seeking back inside it doesn't access the file.
+/// </summary>
+/// <param name="mode">0 from the start, 1 from the current position, 2 from the end</param>
+/// <returns>The new position or a negative GEMDOS error</returns>
+int32_t GemdosFiles::seek(int32_t offset, uint16_t handle, uint16_t mode)
+{
+    OpenFile* file = find(handle);
+    if (file == nullptr)
+    {
+        return E_IHNDL;
+    }
+
+    int64_t size = fileSize(file->fd);
+    if (size < 0)
+    {
+        return E_ACCDN;
+    }
+    if (file->dirtyEnd > file->dirtyBegin)
+    {
+        // pending data can extend the file
+        size = std::max<int64_t>(size, file->bufferStart + file->dirtyEnd);
+    }
+
+    int64_t base;
+    switch (mode)
+    {
+    case 0:
+        base = 0;
+        break;
+    case 1:
+        base = file->position;
+        break;
+    case 2:
+        base = size;
+        break;
+    default:
+        return E_INVFN;
+    }
+
+    int64_t position = base + offset;
+    if (position < 0 || position > size)
+    {
+        return E_RANGE;
+    }
+    file->position = position;
+    return static_cast<int32_t>(position);
+}
+
+GemdosFiles::OpenFile* GemdosFiles::find(uint16_t handle)
+{
+    if (handle < FIRST_HANDLE || static_cast<size_t>(handle - FIRST_HANDLE) >= files.size())
+    {
+        return nullptr;
+    }
+    OpenFile& file = files[handle - FIRST_HANDLE];
+    return file.fd != -1 ? &file : nullptr;
+}
+
+int32_t GemdosFiles::allocate(int fd, bool canRead, bool canWrite)
+{
+    auto it = std::find_if(files.begin(), files.end(), [](const OpenFile& file) { return file.fd == -1; });
+    if (it == files.end())
+    {
+        if (files.size() >= MAX_HANDLES)
+        {
+            closeFile(fd);
+            return E_NHNDL;
+        }
+        it = files.emplace(files.end());
+    }
+
+    it->fd = fd;
+    it->canRead = canRead;
+    it->canWrite = canWrite;
+    it->position = 0;
+    it->buffer.resize(std::max(readAhead, writeBehind));
+    discard(*it);
+    return static_cast<int32_t>(FIRST_HANDLE + (it - files.begin()));
+}
+
+/// <summary>
+/// Translates a GEMDOS file name: the drive is the root, the backslashes become slashes and the name is relative to the root.
+/// The absolute names without a drive and the names with a ".." segment are rejected so the guest can't leave the root.
+/// </summary>
+/// <returns>The host path, empty if the name is rejected</returns>
+std::string GemdosFiles::hostPath(const char* name) const
+{
+    std::string path(name);
+    std::replace(path.begin(), path.end(), '\\', '/');
+    if (path.size() >= 2 && path[1] == ':')
+    {
+        path.erase(0, path.size() >= 3 && path[2] == '/' ? 3 : 2);
+    }
+    else if (!path.empty() && path[0] == '/')
+    {
+        return std::string();
+    }
+    if (path.empty())
+    {
+        return std::string();
+    }
+    for (size_t begin = 0; begin <= path.size();)
+    {
+        size_t end = std::min(path.find('/', begin), path.size());
+        if (path.compare(begin, end - begin, "..") == 0)
+        {
+            return std::string();
+        }
+        begin = end + 1;
+    }
+    return root.empty() ? path : root + "/" + path;
+}
+
+/// <summary>
+/// Writes the pending data of the buffer to the file.
+/// </summary>
+/// <returns>false if the file could not be written</returns>
+bool GemdosFiles::flush(OpenFile& file)
+{
+    if (file.dirtyEnd > file.dirtyBegin)
+    {
+        uint32_t length = file.dirtyEnd - file.dirtyBegin;
+        int64_t n = writeAt(file.fd, file.buffer.data() + file.dirtyBegin, length, file.bufferStart + file.dirtyBegin);
+        file.dirtyBegin = file.dirtyEnd = 0;
+        return n == length;
+    }
+    return true;
+}
+
+void GemdosFiles::discard(OpenFile& file)
+{
+    file.bufferStart = 0;
+    file.bufferLength = 0;
+    file.dirtyBegin = file.dirtyEnd = 0;
+}
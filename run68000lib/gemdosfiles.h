@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mc68000
+{
+    /// <summary>
+    /// GEMDOS error codes returned in d0.
+    /// </summary>
+    enum GemdosError : int32_t
+    {
+        E_OK = 0,
+        E_INVFN = -32,  // invalid function
+        E_FILNF = -33,  // file not found
+        E_PTHNF = -34,  // path not found
+        E_NHNDL = -35,  // no more handles
+        E_ACCDN = -36,  // access denied
+        E_IHNDL = -37,  // invalid handle
+        E_IMBA = -40,   // invalid memory block address
+        E_RANGE = -64,  // range error
+        E_GSBF = -67,   // memory block growth failure
+    };
+
+    /// <summary>
+    /// Table of the files opened by a GEMDOS guest, backed by host file descriptors.
+    /// Each handle has a buffer that serves as read-ahead for small reads and as write-behind for small writes;
+    /// transfers larger than the buffer go straight between the host file and the guest memory.
+    /// </summary>
+    class GemdosFiles
+    {
+    public:
+        static constexpr uint16_t FIRST_HANDLE = 6;     // 0 to 5 are the standard character devices
+        static constexpr uint16_t MAX_HANDLES = 64;
+
+        GemdosFiles() = default;
+        GemdosFiles(const GemdosFiles&) = delete;
+        GemdosFiles& operator=(const GemdosFiles&) = delete;
+        ~GemdosFiles();
+
+        void setBufferSizes(uint32_t readAhead, uint32_t writeBehind);
+        void setRoot(const std::string& root);
+
+        int32_t create(const char* name, uint16_t attr);
+        int32_t open(const char* name, uint16_t mode);
+        int32_t close(uint16_t handle);
+        int32_t read(uint16_t handle, uint32_t count, void* buffer);
+        int32_t write(uint16_t handle, uint32_t count, const void* buffer);
+        int32_t seek(int32_t offset, uint16_t handle, uint16_t mode);
+        void closeAll();
+
+    private:
+        struct OpenFile
+        {
+            int fd = -1;
+            bool canRead = false;
+            bool canWrite = false;
+            int64_t position = 0;           // position seen by the guest
+            std::vector<uint8_t> buffer;    // image of the file from bufferStart
+            int64_t bufferStart = 0;
+            uint32_t bufferLength = 0;      // valid bytes in the buffer
+            uint32_t dirtyBegin = 0;        // range of the buffer not yet written to the file
+            uint32_t dirtyEnd = 0;
+        };
+
+        OpenFile* find(uint16_t handle);
+        int32_t allocate(int fd, bool canRead, bool canWrite);
+        std::string hostPath(const char* name) const;
+        bool flush(OpenFile& file);
+        void discard(OpenFile& file);
+
+    private:
+        std::vector<OpenFile> files;
+        std::string root;
+        uint32_t readAhead = 16 * 1024;
+        uint32_t writeBehind = 16 * 1024;
+    };
+}
@@ -0,0 +1,160 @@
+#include "guestheap.h"
+
+using namespace mc68000;
+
+GuestHeap::GuestHeap(uint32_t start, uint32_t size)
+{
+    reset(start, size);
+}
+
+/// <summary>
+/// Makes the whole region free again.
+/// </summary>
+/// <param name="start">Guest address of the region</param>
+/// <param name="size">Size of the region in bytes</param>
+void GuestHeap::reset(uint32_t start, uint32_t size)
+{
+    // keep the blocks aligned
+    uint32_t alignedStart = (start + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    size = size > alignedStart - start ? (size - (alignedStart - start)) & ~(ALIGNMENT - 1) : 0;
+
+    regionStart = alignedStart;
+    regionSize = size;
+    freeByAddress.clear();
+    freeBySize.clear();
+    allocated.clear();
+    if (size != 0)
+    {
+        addFree(alignedStart, size);
+    }
+}
+
+/// <summary>
+/// Malloc: allocates the smallest free block that can hold the requested size.
+/// </summary>
+/// <returns>The guest address of the block or 0 if there is not enough memory</returns>
+uint32_t GuestHeap::allocate(uint32_t size)
+{
+    if (size == 0 || size > regionSize)
+    {
+        return 0;
+    }
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    auto best = freeBySize.lower_bound({ size, 0 });
+    if (best == freeBySize.end())
+    {
+        return 0;
+    }
+    uint32_t blockSize = best->first;
+    uint32_t address = best->second;
+    removeFree(freeByAddress.find(address));
+    if (blockSize > size)
+    {
+        addFree(address + size, blockSize - size);
+    }
+    allocated.emplace(address, size);
+    return address;
+}
+
+/// <summary>
+/// Mfree: releases a block and merges it with the free blocks around it.
+/// </summary>
+/// <returns>false if the address is not an allocated block</returns>
+bool GuestHeap::release(uint32_t address)
+{
+    auto block = allocated.find(address);
+    if (block == allocated.end())
+    {
+        return false;
+    }
+    uint32_t size = block->second;
+    allocated.erase(block);
+
+    auto next = freeByAddress.find(address + size);
+    if (next != freeByAddress.end())
+    {
+        size += next->second;
+        removeFree(next);
+    }
+    auto previous = freeByAddress.lower_bound(address);
+    if (previous != freeByAddress.begin())
+    {
+        --previous;
+        if (previous->first + previous->second == address)
+        {
+            address = previous->first;
+            size += previous->second;
+            removeFree(previous);
+        }
+    }
+    addFree(address, size);
+    return true;
+}
+
+/// <summary>
+/// Mshrink: reduces a block in place, the end of the block becomes free.
+/// </summary>
+/// <returns>false if the address is not an allocated block or if the new size is larger</returns>
+bool GuestHeap::shrink(uint32_t address, uint32_t size)
+{
+    auto block = allocated.find(address);
+    if (block == allocated.end())
+    {
+        return false;
+    }
+    if (size > block->second)
+    {
+        return false;
+    }
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);       // the block size is aligned: no overflow
+    if (size == 0)
+    {
+        return release(address);
+    }
+
+    uint32_t freed = block->second - size;
+    if (freed != 0)
+    {
+        block->second = size;
+        uint32_t freeAddress = address + size;
+        auto next = freeByAddress.find(address + size + freed);
+        if (next != freeByAddress.end())
+        {
+            freed += next->second;
+            removeFree(next);
+        }
+        addFree(freeAddress, freed);
+    }
+    return true;
+}
+
+/// <summary>
+/// Malloc(-1): size of the largest free block.
+/// </summary>
+uint32_t GuestHeap::largestFree() const
+{
+    return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+uint32_t GuestHeap::totalFree() const
+{
+    uint32_t total = 0;
+    for (const auto& block : freeByAddress)
+    {
+        total += block.second;
+    }
+    return total;
+}
+
+void GuestHeap::addFree(uint32_t address, uint32_t size)
+{
+    freeByAddress.emplace(address, size);
+    freeBySize.emplace(size, address);
+}
+
+void GuestHeap::removeFree(std::map<uint32_t, uint32_t>::iterator it)
+{
+    freeBySize.erase({ it->second, it->first });
+    freeByAddress.erase(it);
+}
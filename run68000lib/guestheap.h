@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace mc68000
+{
+    /// <summary>
+    /// Allocator of blocks inside a region of the guest memory, for the GEMDOS memory functions.
+    /// The free blocks are indexed by address, to merge neighbours when a block is released,
+    /// and by size, to find the smallest block that fits in O(log n).
+    /// </summary>
+    class GuestHeap
+    {
+    public:
+        static constexpr uint32_t ALIGNMENT = 4;
+
+        GuestHeap() = default;
+        GuestHeap(uint32_t start, uint32_t size);
+
+        void reset(uint32_t start, uint32_t size);
+        bool isInitialized() const { return regionSize != 0; }
+
+        uint32_t allocate(uint32_t size);
+        bool release(uint32_t address);
+        bool shrink(uint32_t address, uint32_t size);
+        bool isAllocated(uint32_t address) const { return allocated.count(address) != 0; }
+        uint32_t largestFree() const;
+        uint32_t totalFree() const;
+
+    private:
+        void addFree(uint32_t address, uint32_t size);
+        void removeFree(std::map<uint32_t, uint32_t>::iterator it);
+
+    private:
+        uint32_t regionStart = 0;
+        uint32_t regionSize = 0;
+        std::map<uint32_t, uint32_t> freeByAddress;             // address -> size
+        std::set<std::pair<uint32_t, uint32_t>> freeBySize;     // (size, address)
+        std::unordered_map<uint32_t, uint32_t> allocated;       // address -> size
+    };
+}
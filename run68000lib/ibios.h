@@ -1,12 +1,18 @@
 #pragma once
+#include <memory>
 #include "../core/cpu.h"
+#include "consoleinput.h"
+#include "biosconfig.h"
 
 namespace mc68000
 {
 	struct IBios
 	{
-        virtual void setup() = 0;
+        virtual void setup() = 0;                               // reads the BIOS's own configuration file
+        virtual const char* configFile() const { return nullptr; }  // that file, nullptr if it has none
+        virtual void setup(const BiosConfig& config) = 0;
 		virtual void registerTrapHandlers(Cpu* cpu) = 0;
+        virtual void setConsoleInput(std::shared_ptr<ConsoleInput> /*input*/) {}
         virtual ~IBios() = default;
 	};
 }
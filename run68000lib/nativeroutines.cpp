@@ -0,0 +1,241 @@
+#include "nativeroutines.h"
+#include "../core/symboltable.h"
+
+using namespace mc68000;
+
+namespace
+{
+    const uint8_t X = 0x10;
+    const uint8_t N = 0x08;
+    const uint8_t Z = 0x04;
+    const uint8_t V = 0x02;
+    const uint8_t C = 0x01;
+
+    /// <summary>
+    /// Indicates if the length bytes at address are in the memory; the routines check their accesses
+    /// before touching anything so that a fault is left to the guest code.
+    /// </summary>
+    bool inMemory(const Memory& memory, uint32_t address, uint32_t length)
+    {
+        auto [base, size] = memory.getMemoryRange();
+        uint64_t offset = static_cast<uint32_t>(address - base);
+        return offset + length <= size;
+    }
+
+    uint8_t* bytesAt(Memory& memory, uint32_t address)
+    {
+        return static_cast<uint8_t*>(memory.get<void*>(address));
+    }
+
+    /// <summary>
+    /// Condition codes of a CMP or CMPA between equal values: X is kept.
+    /// </summary>
+    uint8_t equalFlags(const Cpu& cpu)
+    {
+        return (static_cast<uint8_t>(cpu.sr) & X) | Z;
+    }
+
+    /// <summary>
+    /// MVUP: moves the bytes from a1 up to a3 to a2, incrementing both pointers.
+    ///     MVUP    cmpa.l  a1,a3
+    ///             beq     MVRET
+    ///             move.b  (a1)+,(a2)+
+    ///             bra     MVUP
+    ///     MVRET   rts
+    /// </summary>
+    class MoveUp : public NativeRoutine
+    {
+    public:
+        const char* name() const override { return "MVUP"; }
+
+        bool execute(Cpu& cpu, Memory& memory) override
+        {
+            uint32_t source = cpu.a1;
+            uint32_t end = cpu.a3;
+            uint32_t destination = cpu.a2;
+            // a1 above a3 would only stop after wrapping around the address space
+            if (source > end)
+            {
+                return false;
+            }
+            uint32_t length = end - source;
+            if (length != 0)
+            {
+                if (!inMemory(memory, source, length) || !inMemory(memory, destination, length))
+                {
+                    return false;
+                }
+                // one byte at a time like the guest: an overlapping destination repeats the first bytes
+                uint8_t* from = bytesAt(memory, source);
+                uint8_t* to = bytesAt(memory, destination);
+                for (uint32_t i = 0; i < length; i++)
+                {
+                    to[i] = from[i];
+                }
+                memory.noteWrite(destination, length);
+            }
+            cpu.setARegister(1, end);
+            cpu.setARegister(2, destination + length);
+            cpu.setCCR(equalFlags(cpu));
+            return true;
+        }
+    };
+
+    /// <summary>
+    /// MVDOWN: moves the bytes below a1 down to a2 below a3, decrementing both pointers.
+    ///     MVRET   rts
+    ///     MVDOWN  cmpa.l  a1,a2
+    ///             beq     MVRET
+    ///             move.b  -(a1),-(a3)
+    ///             bra     MVDOWN
+    /// </summary>
+    class MoveDown : public NativeRoutine
+    {
+    public:
+        const char* name() const override { return "MVDOWN"; }
+
+        bool execute(Cpu& cpu, Memory& memory) override
+        {
+            uint32_t source = cpu.a1;
+            uint32_t end = cpu.a2;
+            uint32_t destination = cpu.a3;
+            if (source < end)
+            {
+                return false;
+            }
+            uint32_t length = source - end;
+            if (length != 0)
+            {
+                if (destination < length || !inMemory(memory, end, length) || !inMemory(memory, destination - length, length))
+                {
+                    return false;
+                }
+                uint8_t* from = bytesAt(memory, end);
+                uint8_t* to = bytesAt(memory, destination - length);
+                for (uint32_t i = length; i > 0; i--)
+                {
+                    to[i - 1] = from[i - 1];
+                }
+                memory.noteWrite(destination - length, length);
+            }
+            cpu.setARegister(1, end);
+            cpu.setARegister(3, destination - length);
+            cpu.setCCR(equalFlags(cpu));
+            return true;
+        }
+    };
+
+    /// <summary>
+    /// IGNBLK: moves a0 past the spaces.
+    ///     IGNBLK  cmpi.b  #' ',(a0)
+    ///             bne     IGBRET
+    ///             addq.l  #1,a0
+    ///             bra     IGNBLK
+    ///     IGBRET  rts
+    /// </summary>
+    class IgnoreBlanks : public NativeRoutine
+    {
+    public:
+        const char* name() const override { return "IGNBLK"; }
+
+        bool execute(Cpu& cpu, Memory& memory) override
+        {
+            uint32_t address = cpu.a0;
+            uint8_t value;
+            for (;; address++)
+            {
+                if (!inMemory(memory, address, 1))
+                {
+                    return false;
+                }
+                value = *bytesAt(memory, address);
+                if (value != ' ')
+                {
+                    break;
+                }
+            }
+            // condition codes of the last cmpi.b #' ',(a0)
+            uint8_t result = static_cast<uint8_t>(value - ' ');
+            uint8_t ccr = static_cast<uint8_t>(cpu.sr) & X;
+            ccr |= (result & 0x80) ? N : 0;
+            ccr |= ((value ^ ' ') & (value ^ result) & 0x80) ? V : 0;
+            ccr |= (value < ' ') ? C : 0;
+            cpu.setARegister(0, address);
+            cpu.setCCR(ccr);
+            return true;
+        }
+    };
+}
+
+NativeRoutines::NativeRoutines()
+{
+    // the word branches of our assembler, then the short ones
+    entries.push_back({ std::make_unique<MoveUp>(), {
+        { { 0xb7c9, 0x6700, 0x0008, 0x14d9, 0x6000, 0xfff6, 0x4e75 }, 0 },
+        { { 0xb7c9, 0x6704, 0x14d9, 0x60f8, 0x4e75 }, 0 } } });
+    entries.push_back({ std::make_unique<MoveDown>(), {
+        { { 0x4e75, 0xb5c9, 0x6700, 0xfffa, 0x1721, 0x6000, 0xfff6 }, 1 },
+        { { 0x4e75, 0xb5c9, 0x67fa, 0x1721, 0x60f8 }, 1 } } });
+    entries.push_back({ std::make_unique<IgnoreBlanks>(), {
+        { { 0x0c10, 0x0020, 0x6600, 0x0008, 0x5288, 0x6000, 0xfff4, 0x4e75 }, 0 },
+        { { 0x0c10, 0x0020, 0x6604, 0x5288, 0x60f6, 0x4e75 }, 0 } } });
+}
+
+size_t NativeRoutines::installFromSymbols(Cpu& cpu, const char* symbolsFile)
+{
+    SymbolTable symbols;
+    if (!symbols.load(symbolsFile))
+    {
+        return 0;
+    }
+    size_t installed = 0;
+    for (size_t index = 0; index < symbols.size(); index++)
+    {
+        for (auto& entry : entries)
+        {
+            if (symbols.getName(index) == entry.routine->name())
+            {
+                cpu.registerNativeRoutine(symbols.getAddress(index), entry.routine.get());
+                installed++;
+            }
+        }
+    }
+    return installed;
+}
+
+size_t NativeRoutines::installFromSignatures(Cpu& cpu)
+{
+    auto [base, size] = cpu.mem.getMemoryRange();
+    size_t installed = 0;
+    for (uint32_t address = base; address + 2 <= base + size; address += 2)
+    {
+        for (auto& entry : entries)
+        {
+            for (const auto& signature : entry.signatures)
+            {
+                if (matches(cpu.mem, address, signature))
+                {
+                    cpu.registerNativeRoutine(address + static_cast<uint32_t>(signature.entry * 2), entry.routine.get());
+                    installed++;
+                }
+            }
+        }
+    }
+    return installed;
+}
+
+bool NativeRoutines::matches(const Memory& memory, uint32_t address, const Signature& signature)
+{
+    if (!inMemory(memory, address, static_cast<uint32_t>(signature.words.size() * 2)))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < signature.words.size(); i++)
+    {
+        if (memory.get<uint16_t>(address + static_cast<uint32_t>(i * 2)) != signature.words[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "../core/cpu.h"
+
+namespace mc68000
+{
+    /// <summary>
+    /// The guest routines the emulator can run natively: the block moves and the blank skipping of tinybasic,
+    /// which are the memmove and strspn loops of the guests. A routine is found either by the name of its label
+    /// in a symbols file (the .sym format read by SymbolTable::load) or by the words of its code.
+    /// </summary>
+    class NativeRoutines
+    {
+    public:
+        NativeRoutines();
+
+        /// <summary>
+        /// Registers the routines whose names are labels of the symbols file. The code is trusted to be the routine.
+        /// </summary>
+        /// <returns>The number of routines registered, 0 if the file cannot be read</returns>
+        size_t installFromSymbols(Cpu& cpu, const char* symbolsFile);
+
+        /// <summary>
+        /// Scans the memory of the cpu for the code of the routines and registers each match.
+        /// </summary>
+        /// <returns>The number of routines registered</returns>
+        size_t installFromSignatures(Cpu& cpu);
+
+    private:
+        /// <summary>
+        /// Instruction words of one assembled form of a routine, entry being the index of its first instruction.
+        /// Words before entry belong to a neighbour the routine branches to, usually a shared RTS.
+        /// </summary>
+        struct Signature
+        {
+            std::vector<uint16_t> words;
+            size_t entry;
+        };
+
+        struct Entry
+        {
+            std::unique_ptr<NativeRoutine> routine;
+            std::vector<Signature> signatures;
+        };
+
+        static bool matches(const Memory& memory, uint32_t address, const Signature& signature);
+
+        std::vector<Entry> entries;
+    };
+}
@@ -4,8 +4,26 @@ using namespace mc68000;
 
 void OSBios::setup()
 {
-    getConfig("osbios.conf", settings);
+    setup(BiosConfig::load(configFile()));
+}
 
+/// <summary>
+/// Opens the configured disk images so the traps only access memory.
+/// </summary>
+void OSBios::setup(const BiosConfig& config)
+{
+    disks.clear();
+    for (const auto& [deviceNumber, fileName] : config.disks)
+    {
+        try
+        {
+            disks.emplace(deviceNumber, std::make_unique<DiskImage>(fileName));
+        }
+        catch (const std::string& ex)
+        {
+            std::cerr << "OSBios setup error: disk" << deviceNumber << ": " << ex << std::endl;
+        }
+    }
 }
 
 void OSBios::registerTrapHandlers(Cpu* cpu)
@@ -19,95 +37,99 @@ void OSBios::trap(Cpu& cpu)
     cpu.setDRegister(0, 0x12ab34cd);
     cpu.setDRegister(1, 2);
 
-    bool isSupervisor = callerIsSupervisor(cpu);
-    uint16_t func = argWord(cpu, isSupervisor, 0);
+    TrapArguments args = cpu.trapArguments();
+    uint16_t func = args.getWord(0);
+    if (args.hasFault())
+    {
+        // the stack is outside the memory: the bus error is raised after the trap
+        return;
+    }
 
     switch (func)
     {
         case 0:
         {
             // For testing, return the given argument
-            uint16_t arg1 = argWord(cpu, isSupervisor, 1);
-            uint16_t result = argWord(cpu, isSupervisor, arg1);
+            uint16_t arg1 = args.getWord(1);
+            uint16_t result = args.getWord(arg1);
             cpu.setDRegister(0, static_cast<uint32_t>(result));
             break;
         }
         case 1:
         {
-            uint32_t address = argLong(cpu, isSupervisor, 1);
-            void* buffer = cpu.mem.get<void*>(address);
-            uint16_t deviceNumber = argWord(cpu, isSupervisor, 3);
-            uint16_t sectorNumber = argWord(cpu, isSupervisor, 4);
-            uint16_t sectorCount = argWord(cpu, isSupervisor, 5);
-            uint32_t ret = diskRead(buffer, deviceNumber, sectorNumber, sectorCount);
+            uint32_t address = args.getLong(1);
+            uint16_t deviceNumber = args.getWord(3);
+            uint16_t sectorNumber = args.getWord(4);
+            uint16_t sectorCount = args.getWord(5);
+            if (args.hasFault())
+            {
+                break;
+            }
+            uint32_t ret = diskRead(cpu, address, deviceNumber, sectorNumber, sectorCount);
+            cpu.setDRegister(0, ret);
+            break;
+        }
+        case 2:
+        {
+            uint32_t address = args.getLong(1);
+            uint16_t deviceNumber = args.getWord(3);
+            uint16_t sectorNumber = args.getWord(4);
+            uint16_t sectorCount = args.getWord(5);
+            if (args.hasFault())
+            {
+                break;
+            }
+            uint32_t ret = diskWrite(cpu, address, deviceNumber, sectorNumber, sectorCount);
             cpu.setDRegister(0, ret);
             break;
         }
     }
 }
 
-uint32_t OSBios::diskRead(void* buffer, uint16_t deviceNumber, uint16_t sectorNumber, uint16_t sectorCount)
+/// <summary>
+/// Reads consecutive sectors of a disk into the guest memory.
+/// </summary>
+/// <returns>The number of bytes read, 0 if the disk or the buffer is invalid</returns>
+uint32_t OSBios::diskRead(Cpu& cpu, uint32_t address, uint16_t deviceNumber, uint16_t sectorNumber, uint16_t sectorCount)
 {
-    try
+    DiskImage* disk = getDisk(deviceNumber);
+    if (disk == nullptr)
     {
-        std::string deviceFile = getDiskFileName(deviceNumber);
-
-        BiosParameterBlock bpb = getBiosParameterBlock(deviceNumber);
-        uint32_t bytesPerSector = bpb.bytesPerSector;
-        uint32_t offset = sectorNumber * bytesPerSector;
-        uint32_t bytesToRead = bytesPerSector * sectorCount;
-
-        std::ifstream f(deviceFile, std::ios::binary);
-        if (!f)
-        {
-            return 0;
-        }
-
-        f.seekg(offset);
-        f.read(reinterpret_cast<char*>(buffer), bytesToRead);
-        return bytesToRead;
-    }
-    catch (const std::exception& ex)
-    {
-        std::cerr << "diskRead error: " << ex.what() << std::endl;
         return 0;
     }
-    catch (const std::string& ex)
+    void* buffer = writableGuestBuffer(cpu, address, sectorCount * disk->getBytesPerSector());
+    if (buffer == nullptr)
     {
-        std::cerr << "diskRead error: " << ex << std::endl;
         return 0;
     }
+    return disk->read(buffer, sectorNumber, sectorCount);
 }
 
-std::string OSBios::getDiskFileName(uint16_t deviceNumber)
+/// <summary>
+/// Writes consecutive sectors of a disk from the guest memory.
+/// </summary>
+/// <returns>The number of bytes written, 0 if the disk or the buffer is invalid</returns>
+uint32_t OSBios::diskWrite(Cpu& cpu, uint32_t address, uint16_t deviceNumber, uint16_t sectorNumber, uint16_t sectorCount)
 {
-    std::string name = "disk" + std::to_string(deviceNumber);
-    auto it = settings.find(name);
-    if (it == settings.end())
+    DiskImage* disk = getDisk(deviceNumber);
+    if (disk == nullptr)
     {
-        std::cerr << "getDiskFileName error: " << name << " not found in configuration" << std::endl;
-        throw "disk file not configured for device " + std::to_string(deviceNumber);
-    }
-    return it->second;
-}
-
-BiosParameterBlock OSBios::getBiosParameterBlock(uint16_t deviceNumber)
-{
-    std::string deviceFile = getDiskFileName(deviceNumber);
-    std::ifstream f(deviceFile, std::ios::binary);
-    if (!f)
-    {
-        std::cerr << "getBiosParameterBlock error: failed to open disk file " << deviceFile << std::endl;
-        throw std::string("failed to open disk file");
+        return 0;
     }
-
-    BiosParameterBlock bpb;
-    f.read(reinterpret_cast<char*>(&bpb), sizeof(BiosParameterBlock));
-    if (!f)
+    const void* buffer = guestBuffer(cpu, address, sectorCount * disk->getBytesPerSector());
+    if (buffer == nullptr)
     {
-        std::cerr << "getBiosParameterBlock error: failed to read BPB from disk file " << deviceFile << std::endl;
-        throw std::string("failed to read bpb");
+        return 0;
     }
+    return disk->write(buffer, sectorNumber, sectorCount);
+}
 
-    return bpb;
+/// <summary>
+/// Retrieves the image of a device.
+/// </summary>
+/// <returns>The disk image or nullptr if the device is not configured or its file could not be opened</returns>
+DiskImage* OSBios::getDisk(uint16_t deviceNumber)
+{
+    auto it = disks.find(deviceNumber);
+    return it != disks.end() ? it->second.get() : nullptr;
 }
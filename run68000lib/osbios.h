@@ -1,7 +1,8 @@
 #pragma once
+#include <memory>
 #include <unordered_map>
 #include "ibios.h"
-#include "biosparameterblock.h"
+#include "diskimage.h"
 
 namespace mc68000
 {
@@ -10,6 +11,8 @@ namespace mc68000
     {
     public:
         void setup() override;
+        const char* configFile() const override { return "osbios.conf"; }
+        void setup(const BiosConfig& config) override;
         void registerTrapHandlers(Cpu* cpu) override;
         void handle(Cpu& cpu, uint16_t vector) override
         {
@@ -24,13 +27,13 @@ namespace mc68000
         }
     private:
         void trap(Cpu& cpu);
-        uint32_t diskRead(void* buffer, uint16_t deviceNumber, uint16_t sectorNumber, uint16_t sectorCount);
+        uint32_t diskRead(Cpu& cpu, uint32_t address, uint16_t deviceNumber, uint16_t sectorNumber, uint16_t sectorCount);
+        uint32_t diskWrite(Cpu& cpu, uint32_t address, uint16_t deviceNumber, uint16_t sectorNumber, uint16_t sectorCount);
 
-        std::string getDiskFileName(uint16_t deviceNumber);
-        BiosParameterBlock getBiosParameterBlock(uint16_t deviceNumber);
+        DiskImage* getDisk(uint16_t deviceNumber);
 
     private:
-        std::unordered_map<std::string, std::string> settings;
+        std::unordered_map<uint16_t, std::unique_ptr<DiskImage>> disks;   // images opened by setup, by device number
     };
 
 };
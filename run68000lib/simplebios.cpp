@@ -1,23 +1,22 @@
 #include <iostream>
 #include <chrono>
 
-#ifdef _WIN32
-#include <conio.h>
-#else
-#include <termios.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#endif
-
 #include "simplebios.h"
 #include "trapargs.h"
 
 using namespace mc68000;
 FILE* SimpleBios::diskFile = nullptr;
+const int32_t CTRL_Z = 0x1a;
 
 void SimpleBios::setup()
 {
-    // no setup needed for now
+    // no configuration file for now
+    setup(BiosConfig());
+}
+
+void SimpleBios::setup(const BiosConfig& config)
+{
+    consoleBufferSize = config.consoleBufferSize;
 }
 
 void SimpleBios::registerTrapHandlers(Cpu* cpu)
@@ -26,14 +25,24 @@ void SimpleBios::registerTrapHandlers(Cpu* cpu)
     cpu->registerTrapHandler(15, this);
 }
 
+void SimpleBios::setConsoleInput(std::shared_ptr<ConsoleInput> input)
+{
+    console = std::move(input);
+}
+
 void SimpleBios::trap0(Cpu& cpu)
 {
 }
 
 void SimpleBios::trap15(Cpu& cpu)
 {
-    bool isSupervisor = callerIsSupervisor(cpu);
-    uint16_t func = argWord(cpu, isSupervisor, 0);
+    TrapArguments args = cpu.trapArguments();
+    uint16_t func = args.getWord(0);
+    if (args.hasFault())
+    {
+        // the stack is outside the memory: the bus error is raised after the trap
+        return;
+    }
 
     switch (func)
     {
@@ -64,19 +73,19 @@ void SimpleBios::trap15(Cpu& cpu)
         }
         case 10:
         {
-            uint16_t chr = argWord(cpu, isSupervisor, 1);
+            uint16_t chr = args.getWord(1);
             putCharacter(chr & 0xff);
             break;
         }
         case 14:
         {
-            uint32_t address = argLong(cpu, isSupervisor, 1);
+            uint32_t address = args.getLong(1);
             displayString(cpu, address);
             break;
         }
         case 20:
         {
-            uint16_t chr = argWord(cpu, isSupervisor, 1);
+            uint16_t chr = args.getWord(1);
             writeCharacterToDisk(chr & 0xff);
             break;
         }
@@ -88,21 +97,21 @@ void SimpleBios::trap15(Cpu& cpu)
         }
         case 101: // For testing trap with 1 word argument
         {
-            uint16_t arg1 = argWord(cpu, isSupervisor, 1);
+            uint16_t arg1 = args.getWord(1);
             cpu.setDRegister(0, arg1);
             break;
         }
         case 102: // For testing trap with 1 long argument
         {
-            uint32_t arg1 = argLong(cpu, isSupervisor, 1);
+            uint32_t arg1 = args.getLong(1);
             cpu.setDRegister(0, arg1);
             break;
         }
         case 103: // For testing trap with 1 word 1 long 1 word arguments
         {
-            uint16_t arg1 = argWord(cpu, isSupervisor, 1);
-            uint32_t arg2 = argLong(cpu, isSupervisor, 2);
-            uint16_t arg3 = argWord(cpu, isSupervisor, 4);
+            uint16_t arg1 = args.getWord(1);
+            uint32_t arg2 = args.getLong(2);
+            uint16_t arg3 = args.getWord(4);
             uint32_t res = arg1 + arg2 + arg3;
             cpu.setDRegister(0, res);
             break;
@@ -111,62 +120,34 @@ void SimpleBios::trap15(Cpu& cpu)
             break;
     }
 }
-int32_t SimpleBios::getCharacter()
+ConsoleInput& SimpleBios::consoleInput()
 {
-#ifdef _WIN32
-    int ch = _getch();  // Windows: no Enter required
-    if (ch == '\n')
-    {
-        ch = '\r';    // Convert newline to carriage return
-    }
-#else
-    struct termios oldt, newt;
-    char ch;
-    tcgetattr(STDIN_FILENO, &oldt);          // Get current terminal settings
-    newt = oldt;
-    newt.c_lflag &= ~(ICANON | ECHO);        // Disable canonical mode and echo
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt); // Apply new settings
-    read(STDIN_FILENO, &ch, 1);              // Read one char    tcsetattr(STDIN_FILENO, TCSANOW, &oldt); // Restore old settings
-    if (ch == '\n')
+    if (!console)
     {
-        ch = '\r';                          // Convert newline to carriage return
+        // the terminal is only switched to raw mode when the guest starts reading the keyboard
+        console = std::make_shared<TerminalInput>(consoleBufferSize);
     }
-    else if (ch == 127)
+    return *console;
+}
+
+int32_t SimpleBios::getCharacter()
+{
+    int32_t ch = consoleInput().read();
+    if (ch == ConsoleInput::END_OF_INPUT)
     {
-        ch = 8;                             // convert backspace
+        ch = CTRL_Z;
     }
-#endif
     return ch;
 }
 
 int32_t SimpleBios::keyPressed()
 {
-#ifdef _WIN32
-    if(_kbhit())
-    {
-        int ch = _getch();
-        return ch;
-    }
-    return 0;
-#else
-    struct termios oldt, newt;
-    tcgetattr(STDIN_FILENO, &oldt);          // Get current terminal settings
-    newt = oldt;
-    newt.c_lflag &= ~(ICANON | ECHO);        // Disable canonical mode and echo
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt); // Apply new settings
-
-    int bytesWaiting;
-    ioctl(STDIN_FILENO, FIONREAD, &bytesWaiting);
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt); // Restore old settings
-    if (bytesWaiting > 0)
+    int32_t ch;
+    if (consoleInput().tryRead(ch))
     {
-        char ch;
-        read(STDIN_FILENO, &ch, 1);          // Read one char
         return ch;
     }
     return 0;
-#endif
-
 }
 
 int32_t SimpleBios::getInteger()
@@ -199,11 +180,8 @@ void SimpleBios::putCharacter(uint32_t c)
 }
 void SimpleBios::displayString(Cpu& cpu, uint32_t address)
 {
-    char* str = static_cast<char*>(cpu.mem.get<void*>(address));
-    std::cout << str << std::flush;
+    std::cout << guestString(cpu, address) << std::flush;
 }
-const int32_t CTRL_Z = 0x1a;
-
 void SimpleBios::writeCharacterToDisk(uint8_t ch)
 {
     if (diskFile == nullptr)
@@ -7,7 +7,9 @@ namespace mc68000
     {
     public:
         void setup() override;
+        void setup(const BiosConfig& config) override;
         void registerTrapHandlers(Cpu* cpu) override;
+        void setConsoleInput(std::shared_ptr<ConsoleInput> input) override;
         void handle(Cpu& cpu, uint16_t vector) override
         {
             switch (vector)
@@ -23,11 +25,12 @@ namespace mc68000
             }
         }
     private:
-        static void trap15(Cpu&);
+        void trap15(Cpu&);
         static void trap0(Cpu&);
 
-        static int32_t getCharacter();
-        static int32_t keyPressed();
+        ConsoleInput& consoleInput();
+        int32_t getCharacter();
+        int32_t keyPressed();
         static int32_t getInteger();
         static int32_t getTime();
         static void putCharacter(uint32_t c);
@@ -36,6 +39,8 @@ namespace mc68000
         static int32_t readCharacterFromDisk();
 
         static FILE* diskFile;
+        std::shared_ptr<ConsoleInput> console;
+        uint32_t consoleBufferSize = 4096;
     };
 };
 
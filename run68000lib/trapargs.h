@@ -7,57 +7,56 @@
 namespace mc68000
 {
     /// <summary>
-    /// Retrieves a 16-bit argument from the CPU stack, handling supervisor vs. user stack layout.
+    /// Translates a guest buffer into a host pointer after checking that it lies entirely in the guest memory.
     /// </summary>
-    /// <param name="cpu">Pointer to the CPU instance.</param>
-    /// <param name="callerIsSupervisor">True if the call was made in supervisor mode. </param>
-    /// <param name="index">Zero-based index of the 16-bit argument to retrieve (each argument is 2 bytes).</param>
-    /// <returns>The uint16_t value of the requested argument read from the calculated stack offset.</returns>
-    static inline uint16_t argWord(Cpu& cpu, bool callerIsSupervisor, unsigned index)
+    /// <param name="cpu">Pointer to the Cpu instance.</param>
+    /// <param name="address">Guest address of the buffer.</param>
+    /// <param name="length">Size of the buffer in bytes.</param>
+    /// <returns>The host pointer to the buffer or nullptr if the buffer is outside the guest memory.</returns>
+    static inline void* guestBuffer(Cpu& cpu, uint32_t address, uint32_t length)
     {
-        if (callerIsSupervisor)
-        {
-            // in Supervisor mode, the argument list starts at ssp+6 (PC and SR are saved on the supervisor stack)
-            return cpu.getFromStack<uint16_t>(true, 6 + index * 2);
-        }
-        else
+        auto [base, size] = cpu.mem.getMemoryRange();
+        if (address < base || length > size || address - base > size - length)
         {
-            // in User mode, the argument list starts at usp 
-            return cpu.getFromStack<uint16_t>(false, index * 2);
+            return nullptr;
         }
+        return cpu.mem.get<void*>(address);
     }
 
     /// <summary>
-    /// Fetches a 32-bit (long) argument from the CPU stack, handling supervisor vs. user stack layout.
+    /// guestBuffer for a buffer the host fills: the code pages it covers are invalidated.
     /// </summary>
-    /// <param name="cpu">Pointer to the Cpu instance.</param>
-    /// <param name="callerIsSupervisor">True if the call was made in supervisor mode. </param>
-    /// <param name="wordIndex">Zero-based index of the 32-bit argument to fetch.</param>
-    /// <returns>The 32-bit (uint32_t) value of the requested argument read from the appropriate stack.</returns>
-    /// <remarks>The stack can have a mix of word and long arguments so the indexing is done in words.</remarks>
-    static inline uint32_t argLong(Cpu& cpu, bool callerIsSupervisor, unsigned wordIndex)
+    static inline void* writableGuestBuffer(Cpu& cpu, uint32_t address, uint32_t length)
     {
-        if (callerIsSupervisor)
-        {
-            // in Supervisor mode, the argument list starts at ssp+6 (PC and SR are saved on the supervisor stack)
-            return cpu.getFromStack<uint32_t>(true, 6 + wordIndex * 2);
-        }
-        else
+        void* buffer = guestBuffer(cpu, address, length);
+        if (buffer != nullptr)
         {
-            // in User mode, the argument list starts at usp 
-            return cpu.getFromStack<uint32_t>(false, wordIndex * 2);
+            cpu.mem.noteWrite(address, length);
         }
+        return buffer;
     }
 
     /// <summary>
-    /// Determines whether the caller was running in supervisor mode.
+    /// Copies a null-terminated string from the guest memory.
     /// </summary>
     /// <param name="cpu">Pointer to the Cpu instance.</param>
-    /// <returns>True if the caller was running in supervisor mode; otherwise false.</returns>
-    static inline bool callerIsSupervisor(Cpu& cpu)
+    /// <param name="address">Guest address of the string.</param>
+    /// <returns>The string, truncated at the end of the guest memory.</returns>
+    static inline std::string guestString(Cpu& cpu, uint32_t address)
     {
-        uint16_t savedSR = cpu.getFromStack<uint16_t>(true, 0); // Read saved SR from top of supervisor stack
-        return (savedSR & 0x2000) != 0; // Check S bit (bit 13)
+        auto [base, size] = cpu.mem.getMemoryRange();
+        if (address < base || address - base >= size)
+        {
+            return std::string();
+        }
+        const char* s = static_cast<const char*>(cpu.mem.get<void*>(address));
+        size_t length = 0;
+        size_t maxLength = size - (address - base);
+        while (length < maxLength && s[length] != 0)
+        {
+            length++;
+        }
+        return std::string(s, length);
     }
 
     static inline void trim(std::string& s)
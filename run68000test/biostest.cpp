@@ -120,6 +120,108 @@ BOOST_AUTO_TEST_CASE(bios_arg_multiple)
     BOOST_CHECK_EQUAL(0x12ab34cd, cpu.d0);
 }
 
+BOOST_AUTO_TEST_CASE(bios_arg_exception_frame)
+{
+    unsigned char code[] = {
+        0x3f,0x3c, 0x00,0x2a,               //      move.w #42, -(sp)
+        0x2f,0x3c, 0x12,0xab, 0x34, 0xcd,   //      move.l #$12ab34cd, -(sp)
+        0x3f,0x3c, 0x00,0x66,               //      move.w #102, -(sp)
+        0x4e,0x4f,                          //      trap   #15
+        0x5c,0x8f,                          //      addq.l #6, sp
+        0x32, 0x1f,                         //      move.w (sp)+,d1
+        0xff,0xff };
+
+    // Arrange
+    Memory memory(256, 0, code, sizeof(code));
+    Cpu cpu(memory);
+    cpu.setFastTraps(false);
+    SimpleBios bios;
+    bios.setup();
+    bios.registerTrapHandlers(&cpu);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 256, 128);
+
+    // Assert
+    BOOST_CHECK_EQUAL(0x12ab34cd, cpu.d0);
+    BOOST_CHECK_EQUAL(42, cpu.d1);
+    BOOST_CHECK_EQUAL(256, cpu.a7);
+}
+
+BOOST_AUTO_TEST_CASE(bios_arg_supervisor_caller)
+{
+    unsigned char code[] = {
+        0x3f,0x3c, 0x00,0x2a,               //      move.w #42, -(sp)
+        0x2f,0x3c, 0x12,0xab, 0x34, 0xcd,   //      move.l #$12ab34cd, -(sp)
+        0x3f,0x3c, 0x00,0x66,               //      move.w #102, -(sp)
+        0x4e,0x4f,                          //      trap   #15
+        0x5c,0x8f,                          //      addq.l #6, sp
+        0x32, 0x1f,                         //      move.w (sp)+,d1
+        0xff,0xff };
+
+    for (bool fastTraps : { true, false })
+    {
+        // Arrange
+        Memory memory(256, 0, code, sizeof(code));
+        Cpu cpu(memory);
+        cpu.setFastTraps(fastTraps);
+        SimpleBios bios;
+        bios.setup();
+        bios.registerTrapHandlers(&cpu);
+
+        // Act
+        cpu.reset();
+        cpu.setSupervisorMode(true);
+        cpu.start(0, 256, 128);
+
+        // Assert
+        BOOST_CHECK_EQUAL(0x12ab34cd, cpu.d0);
+        BOOST_CHECK_EQUAL(42, cpu.d1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bios_arg_outside_memory)
+{
+    unsigned char code[] = {
+        0x00,0x00, 0x00,0x00,               //      reset - SSP
+        0x00,0x00, 0x00,0x00,               //      reset - PC
+        0x00,0x00, 0x00,0x1c,               //      Bus error
+        0x00,0x00, 0x00,0x00,               //      Address error
+
+        0x70,0x01,                          //      moveq.l #1, d0
+        0x2e,0x7c, 0x00,0x01, 0x00,0x00,    //      movea.l #$10000, sp
+        0x4e,0x4f,                          //      trap    #15
+        0x70,0x02,                          //      moveq.l #2, d0
+
+                                            // BUS_ERROR:
+        0x34,0x17,                          //      move.w  (sp), d2
+        0x26,0x2f, 0x00,0x02,               //      move.l  2(sp), d3
+        0x28,0x2f, 0x00,0x0a,               //      move.l  10(sp), d4
+        0xff,0xff };
+
+    for (bool fastTraps : { true, false })
+    {
+        // Arrange
+        Memory memory(256, 0, code, sizeof(code));
+        Cpu cpu(memory);
+        cpu.setFastTraps(fastTraps);
+        SimpleBios bios;
+        bios.setup();
+        bios.registerTrapHandlers(&cpu);
+
+        // Act
+        cpu.reset();
+        cpu.start(0x10, 256, 192);
+
+        // Assert: the handler doesn't run, the bus error returns after the trap
+        BOOST_CHECK_EQUAL(1, cpu.d0);
+        BOOST_CHECK_EQUAL(0x19, cpu.d2);        // read, not an instruction fetch, user data
+        BOOST_CHECK_EQUAL(0x10000, cpu.d3);
+        BOOST_CHECK_EQUAL(0x1a, cpu.d4);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(settings_one)
 {
     // Arrange
@@ -177,4 +279,31 @@ BOOST_AUTO_TEST_CASE(settings_comment_lines)
     BOOST_CHECK_EQUAL(settings["key2"], "value2");
     BOOST_CHECK_EQUAL(settings["key4"], "4");
 }
+BOOST_AUTO_TEST_CASE(typed_config)
+{
+    // Arrange
+    {
+        std::ofstream configFile("typed.conf");
+        configFile << "bios = atari" << std::endl;
+        configFile << "disk1 = a.dsk" << std::endl;
+        configFile << "disk12 = b.dsk  # comment" << std::endl;
+        configFile << "diskette = c.dsk" << std::endl;
+        configFile << "heapstart = 0x8000" << std::endl;
+        configFile << "readahead = 512" << std::endl;
+        configFile << "writebehind = lots" << std::endl;
+    }
+
+    // Act
+    BiosConfig config = BiosConfig::load("typed.conf");
+
+    // Assert
+    BOOST_CHECK_EQUAL(config.bios, "atari");
+    BOOST_CHECK_EQUAL(config.disks.size(), 2);
+    BOOST_CHECK_EQUAL(config.disks[1], "a.dsk");
+    BOOST_CHECK_EQUAL(config.disks[12], "b.dsk");
+    BOOST_CHECK_EQUAL(config.heapStart, 0x8000);
+    BOOST_CHECK_EQUAL(config.readAhead, 512);
+    BOOST_CHECK_EQUAL(config.writeBehind, 16 * 1024);   // invalid value keeps the default
+    BOOST_CHECK_EQUAL(config.consoleBufferSize, 4096);
+}
 BOOST_AUTO_TEST_SUITE_END()
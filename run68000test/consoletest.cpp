@@ -0,0 +1,174 @@
+#include <boost/test/unit_test.hpp>
+#include "cpu.h"
+#include "simplebios.h"
+#include "ataribios.h"
+#include "consoleinput.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(console)
+
+namespace
+{
+    // SimpleBios: key pressed in d1 then character read in d0
+    const unsigned char simpleBiosCode[] = {
+        0x3f,0x3c, 0x00,0x02,   //      move.w  #2,-(sp)    key pressed
+        0x4e,0x4f,              //      trap    #15
+        0x54,0x8f,              //      addq.l  #2,sp
+        0x22,0x00,              //      move.l  d0,d1
+        0x3f,0x3c, 0x00,0x01,   //      move.w  #1,-(sp)    get character
+        0x4e,0x4f,              //      trap    #15
+        0x54,0x8f,              //      addq.l  #2,sp
+        0xff,0xff };
+
+    // AtariBios: bconstat in d1 then bconin in d0
+    const unsigned char atariBiosCode[] = {
+        0x3f,0x3c, 0x00,0x02,   //      move.w  #2,-(sp)    console
+        0x3f,0x3c, 0x00,0x01,   //      move.w  #1,-(sp)    bconstat
+        0x4e,0x4d,              //      trap    #13
+        0x58,0x8f,              //      addq.l  #4,sp
+        0x22,0x00,              //      move.l  d0,d1
+        0x3f,0x3c, 0x00,0x02,   //      move.w  #2,-(sp)    console
+        0x3f,0x3c, 0x00,0x02,   //      move.w  #2,-(sp)    bconin
+        0x4e,0x4d,              //      trap    #13
+        0x58,0x8f,              //      addq.l  #4,sp
+        0xff,0xff };
+
+    // AtariBios: GEMDOS cconis in d1, BIOS bconstat in d2, XBIOS 1 (unused) in d0
+    const unsigned char atariTrapsCode[] = {
+        0x3f,0x3c, 0x00,0x0b,   //      move.w  #11,-(sp)   cconis
+        0x4e,0x41,              //      trap    #1
+        0x54,0x8f,              //      addq.l  #2,sp
+        0x22,0x00,              //      move.l  d0,d1
+        0x3f,0x3c, 0x00,0x02,   //      move.w  #2,-(sp)    console
+        0x3f,0x3c, 0x00,0x01,   //      move.w  #1,-(sp)    bconstat
+        0x4e,0x4d,              //      trap    #13
+        0x58,0x8f,              //      addq.l  #4,sp
+        0x24,0x00,              //      move.l  d0,d2
+        0x70,0xff,              //      moveq   #-1,d0
+        0x3f,0x3c, 0x00,0x01,   //      move.w  #1,-(sp)    no XBIOS function, cconin for GEMDOS
+        0x4e,0x4e,              //      trap    #14
+        0x54,0x8f,              //      addq.l  #2,sp
+        0xff,0xff };
+
+    template <typename Bios> void runWithInput(Cpu& cpu, const std::string& script)
+    {
+        Bios bios;
+        bios.setConsoleInput(std::make_shared<ScriptedInput>(script));
+        bios.registerTrapHandlers(&cpu);
+
+        cpu.reset();
+        cpu.start(0, 256, 128);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scripted_input)
+{
+    // Arrange
+    ScriptedInput input("ab\n");
+    int32_t ch;
+
+    // Act & Assert
+    BOOST_CHECK(input.available());
+    BOOST_CHECK(input.tryRead(ch));
+    BOOST_CHECK_EQUAL('a', ch);
+    BOOST_CHECK_EQUAL('b', input.read());
+    BOOST_CHECK_EQUAL('\r', input.read());
+    BOOST_CHECK(!input.available());
+    BOOST_CHECK(!input.tryRead(ch));
+    BOOST_CHECK_EQUAL(ConsoleInput::END_OF_INPUT, input.read());
+}
+
+BOOST_AUTO_TEST_CASE(scripted_input_large)
+{
+    // Arrange
+    std::string script(10000, 'x');
+    script.back() = 'y';
+    ScriptedInput input(script);
+
+    // Act
+    int32_t count = 0;
+    int32_t last = 0;
+    for (int32_t ch = input.read(); ch != ConsoleInput::END_OF_INPUT; ch = input.read())
+    {
+        last = ch;
+        count++;
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(10000, count);
+    BOOST_CHECK_EQUAL('y', last);
+}
+
+BOOST_AUTO_TEST_CASE(simplebios_keys)
+{
+    // Arrange
+    Memory memory(256, 0, simpleBiosCode, sizeof(simpleBiosCode));
+    Cpu cpu(memory);
+
+    // Act
+    runWithInput<SimpleBios>(cpu, "ab");
+
+    // Assert
+    BOOST_CHECK_EQUAL('a', cpu.d1);
+    BOOST_CHECK_EQUAL('b', cpu.d0);
+}
+
+BOOST_AUTO_TEST_CASE(simplebios_no_key)
+{
+    // Arrange
+    Memory memory(256, 0, simpleBiosCode, sizeof(simpleBiosCode));
+    Cpu cpu(memory);
+
+    // Act
+    runWithInput<SimpleBios>(cpu, "");
+
+    // Assert
+    BOOST_CHECK_EQUAL(0, cpu.d1);
+    BOOST_CHECK_EQUAL(0x1a, cpu.d0); // end of input is reported as CTRL-Z
+}
+
+BOOST_AUTO_TEST_CASE(ataribios_bconin)
+{
+    // Arrange
+    Memory memory(256, 0, atariBiosCode, sizeof(atariBiosCode));
+    Cpu cpu(memory);
+
+    // Act
+    runWithInput<AtariBios>(cpu, "\n");
+
+    // Assert
+    BOOST_CHECK_EQUAL(0xffff, cpu.d1);
+    BOOST_CHECK_EQUAL('\r', cpu.d0);
+}
+
+BOOST_AUTO_TEST_CASE(ataribios_bconstat_empty)
+{
+    // Arrange
+    Memory memory(256, 0, atariBiosCode, sizeof(atariBiosCode));
+    Cpu cpu(memory);
+
+    // Act
+    runWithInput<AtariBios>(cpu, "");
+
+    // Assert
+    BOOST_CHECK_EQUAL(0, cpu.d1);
+    BOOST_CHECK_EQUAL(0, cpu.d0);
+}
+
+BOOST_AUTO_TEST_CASE(ataribios_trap_vectors)
+{
+    // Arrange
+    Memory memory(256, 0, atariTrapsCode, sizeof(atariTrapsCode));
+    Cpu cpu(memory);
+
+    // Act
+    runWithInput<AtariBios>(cpu, "a");
+
+    // Assert: trap #1 is GEMDOS, trap #13 is BIOS, trap #14 is XBIOS and leaves the key
+    BOOST_CHECK_EQUAL(0xffff, cpu.d1);
+    BOOST_CHECK_EQUAL(0xffff, cpu.d2);
+    BOOST_CHECK_EQUAL(0, cpu.d0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
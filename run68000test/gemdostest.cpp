@@ -0,0 +1,301 @@
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "cpu.h"
+#include "ataribios.h"
+#include "gemdosfiles.h"
+#include "guestheap.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(gemdos)
+
+namespace
+{
+    std::string fileContent(const char* name)
+    {
+        std::ifstream f(name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(write_behind)
+{
+    // Arrange
+    GemdosFiles files;
+    files.setBufferSizes(64, 64);
+    int32_t handle = files.create("gemdos1.tst", 0);
+
+    // Act
+    int32_t written1 = files.write(static_cast<uint16_t>(handle), 3, "abc");
+    int32_t written2 = files.write(static_cast<uint16_t>(handle), 3, "def");
+    std::string beforeClose = fileContent("gemdos1.tst");
+    int32_t closed = files.close(static_cast<uint16_t>(handle));
+
+    // Assert
+    BOOST_CHECK_EQUAL(GemdosFiles::FIRST_HANDLE, handle);
+    BOOST_CHECK_EQUAL(3, written1);
+    BOOST_CHECK_EQUAL(3, written2);
+    BOOST_CHECK_EQUAL("", beforeClose);
+    BOOST_CHECK_EQUAL(0, closed);
+    BOOST_CHECK_EQUAL("abcdef", fileContent("gemdos1.tst"));
+}
+
+BOOST_AUTO_TEST_CASE(read_ahead_and_seek)
+{
+    // Arrange
+    {
+        std::ofstream f("gemdos2.tst", std::ios::binary);
+        f << "0123456789";
+    }
+    GemdosFiles files;
+    files.setBufferSizes(64, 64);
+    uint16_t handle = static_cast<uint16_t>(files.open("gemdos2.tst", 0));
+    char buffer[16] = {};
+
+    // Act & Assert
+    BOOST_CHECK_EQUAL(4, files.read(handle, 4, buffer));
+    BOOST_CHECK_EQUAL(0, std::memcmp(buffer, "0123", 4));
+    BOOST_CHECK_EQUAL(8, files.seek(4, handle, 1));
+    BOOST_CHECK_EQUAL(2, files.read(handle, 4, buffer));
+    BOOST_CHECK_EQUAL(0, std::memcmp(buffer, "89", 2));
+    BOOST_CHECK_EQUAL(7, files.seek(-3, handle, 2));
+    BOOST_CHECK_EQUAL(1, files.read(handle, 1, buffer));
+    BOOST_CHECK_EQUAL('7', buffer[0]);
+    BOOST_CHECK_EQUAL(E_RANGE, files.seek(11, handle, 0));
+    BOOST_CHECK_EQUAL(E_ACCDN, files.write(handle, 1, "x"));
+    BOOST_CHECK_EQUAL(0, files.close(handle));
+}
+
+BOOST_AUTO_TEST_CASE(read_after_write)
+{
+    // Arrange
+    GemdosFiles files;
+    files.setBufferSizes(8, 8);
+    uint16_t handle = static_cast<uint16_t>(files.create("gemdos3.tst", 0));
+    std::string large(100, 'L');
+    char buffer[128] = {};
+
+    // Act
+    files.write(handle, 3, "abc");                                      // buffered
+    files.write(handle, static_cast<uint32_t>(large.size()), large.data());  // direct
+    files.seek(0, handle, 0);
+    int32_t read = files.read(handle, sizeof(buffer), buffer);          // direct
+
+    // Assert
+    BOOST_CHECK_EQUAL(103, read);
+    BOOST_CHECK_EQUAL(0, std::memcmp(buffer, "abcLL", 5));
+    BOOST_CHECK_EQUAL('L', buffer[102]);
+    BOOST_CHECK_EQUAL(0, files.close(handle));
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    // Arrange
+    GemdosFiles files;
+    char buffer[4];
+
+    // Act & Assert
+    BOOST_CHECK_EQUAL(E_FILNF, files.open("gemdos_missing.tst", 0));
+    BOOST_CHECK_EQUAL(E_IHNDL, files.read(6, sizeof(buffer), buffer));
+    BOOST_CHECK_EQUAL(E_IHNDL, files.close(3));
+}
+
+BOOST_AUTO_TEST_CASE(names_outside_root)
+{
+    // Arrange
+    GemdosFiles files;
+
+    // Act & Assert
+    BOOST_CHECK_EQUAL(E_PTHNF, files.open("..\\gemdos.tst", 0));
+    BOOST_CHECK_EQUAL(E_PTHNF, files.open("C:\\DIR\\..\\..\\gemdos.tst", 0));
+    BOOST_CHECK_EQUAL(E_PTHNF, files.open("\\etc\\passwd", 0));
+    BOOST_CHECK_EQUAL(E_PTHNF, files.create("/tmp/gemdos.tst", 0));
+    BOOST_CHECK_EQUAL(E_PTHNF, files.create("", 0));
+    BOOST_CHECK_EQUAL(E_PTHNF, files.create("C:\\..", 0));
+    BOOST_CHECK_EQUAL(E_FILNF, files.open("..gemdos_missing.tst", 0));
+}
+
+BOOST_AUTO_TEST_CASE(trap_file_functions)
+{
+    unsigned char code[] = {
+        0x3f,0x3c, 0x00,0x00,               //      move.w  #0,-(sp)        attr
+        0x2f,0x3c, 0x00,0x00, 0x01,0x00,    //      move.l  #$100,-(sp)     name
+        0x3f,0x3c, 0x00,0x3c,               //      move.w  #60,-(sp)       Fcreate
+        0x4e,0x41,                          //      trap    #1
+        0x50,0x8f,                          //      addq.l  #8,sp
+        0x36,0x00,                          //      move.w  d0,d3
+        0x2f,0x3c, 0x00,0x00, 0x01,0x10,    //      move.l  #$110,-(sp)     buffer
+        0x2f,0x3c, 0x00,0x00, 0x00,0x05,    //      move.l  #5,-(sp)        count
+        0x3f,0x03,                          //      move.w  d3,-(sp)        handle
+        0x3f,0x3c, 0x00,0x40,               //      move.w  #64,-(sp)       Fwrite
+        0x4e,0x41,                          //      trap    #1
+        0x4f,0xef, 0x00,0x0c,               //      lea     12(sp),sp
+        0x28,0x00,                          //      move.l  d0,d4
+        0x3f,0x03,                          //      move.w  d3,-(sp)        handle
+        0x3f,0x3c, 0x00,0x3e,               //      move.w  #62,-(sp)       Fclose
+        0x4e,0x41,                          //      trap    #1
+        0x58,0x8f,                          //      addq.l  #4,sp
+        0x3f,0x3c, 0x00,0x00,               //      move.w  #0,-(sp)        mode
+        0x2f,0x3c, 0x00,0x00, 0x01,0x00,    //      move.l  #$100,-(sp)     name
+        0x3f,0x3c, 0x00,0x3d,               //      move.w  #61,-(sp)       Fopen
+        0x4e,0x41,                          //      trap    #1
+        0x50,0x8f,                          //      addq.l  #8,sp
+        0x36,0x00,                          //      move.w  d0,d3
+        0x2f,0x3c, 0x00,0x00, 0x01,0x20,    //      move.l  #$120,-(sp)     buffer
+        0x2f,0x3c, 0x00,0x00, 0x00,0x10,    //      move.l  #16,-(sp)       count
+        0x3f,0x03,                          //      move.w  d3,-(sp)        handle
+        0x3f,0x3c, 0x00,0x3f,               //      move.w  #63,-(sp)       Fread
+        0x4e,0x41,                          //      trap    #1
+        0x4f,0xef, 0x00,0x0c,               //      lea     12(sp),sp
+        0x2a,0x00,                          //      move.l  d0,d5
+        0x3f,0x03,                          //      move.w  d3,-(sp)        handle
+        0x3f,0x3c, 0x00,0x3e,               //      move.w  #62,-(sp)       Fclose
+        0x4e,0x41,                          //      trap    #1
+        0x58,0x8f,                          //      addq.l  #4,sp
+        0xff,0xff };
+
+    // Arrange
+    std::vector<uint8_t> content(0x400);
+    std::copy(std::begin(code), std::end(code), content.begin());
+    std::strcpy(reinterpret_cast<char*>(&content[0x100]), "C:\\GEMDOS4.TST");
+    std::strcpy(reinterpret_cast<char*>(&content[0x110]), "hello");
+    Memory memory(static_cast<uint32_t>(content.size()), 0, content.data(), static_cast<uint32_t>(content.size()));
+    Cpu cpu(memory);
+    AtariBios bios;
+    bios.setup();
+    bios.registerTrapHandlers(&cpu);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 0x400, 0x380);
+
+    // Assert
+    BOOST_CHECK_EQUAL(GemdosFiles::FIRST_HANDLE, cpu.d3);
+    BOOST_CHECK_EQUAL(5, cpu.d4);
+    BOOST_CHECK_EQUAL(5, cpu.d5);
+    BOOST_CHECK_EQUAL(0, cpu.d0);
+    BOOST_CHECK_EQUAL(0, std::memcmp(cpu.mem.get<void*>(0x120), "hello", 5));
+    BOOST_CHECK_EQUAL("hello", fileContent("GEMDOS4.TST"));
+}
+
+BOOST_AUTO_TEST_CASE(cconws_outside_memory)
+{
+    unsigned char code[] = {
+        0x2f,0x3c, 0x00,0x01, 0x00,0x00,    //      move.l  #$10000,-(sp)   str
+        0x3f,0x3c, 0x00,0x09,               //      move.w  #9,-(sp)        Cconws
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0xff,0xff };
+
+    // Arrange
+    std::vector<uint8_t> content(0x400);
+    std::copy(std::begin(code), std::end(code), content.begin());
+    Memory memory(static_cast<uint32_t>(content.size()), 0, content.data(), static_cast<uint32_t>(content.size()));
+    Cpu cpu(memory);
+    AtariBios bios;
+    bios.setup();
+    bios.registerTrapHandlers(&cpu);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 0x400, 0x380);
+
+    // Assert: the output still works
+    BOOST_CHECK(std::cout.good());
+}
+
+BOOST_AUTO_TEST_CASE(heap_best_fit_and_coalesce)
+{
+    // Arrange
+    GuestHeap heap(0x1000, 0x1000);
+
+    // Act
+    uint32_t a = heap.allocate(0x100);
+    uint32_t b = heap.allocate(0x40);
+    uint32_t c = heap.allocate(0x100);
+    heap.release(b);
+    uint32_t d = heap.allocate(0x3e);      // fits in the hole left by b
+
+    // Assert
+    BOOST_CHECK_EQUAL(0x1000, a);
+    BOOST_CHECK_EQUAL(0x1100, b);
+    BOOST_CHECK_EQUAL(0x1140, c);
+    BOOST_CHECK_EQUAL(b, d);
+    BOOST_CHECK(heap.release(a));
+    BOOST_CHECK(heap.release(c));
+    BOOST_CHECK(heap.release(d));
+    BOOST_CHECK(!heap.release(d));
+    BOOST_CHECK_EQUAL(0x1000, heap.largestFree());
+}
+
+BOOST_AUTO_TEST_CASE(heap_shrink_in_place)
+{
+    // Arrange
+    GuestHeap heap(0x1000, 0x1000);
+    uint32_t a = heap.allocate(0x800);
+
+    // Act & Assert
+    BOOST_CHECK(!heap.shrink(a, 0x900));
+    BOOST_CHECK(!heap.shrink(a, 0xfffffffe));
+    BOOST_CHECK(heap.shrink(a, 0x100));
+    BOOST_CHECK_EQUAL(0xf00, heap.largestFree());
+    BOOST_CHECK_EQUAL(0x1100, heap.allocate(0x10));
+    BOOST_CHECK_EQUAL(0, heap.allocate(0x1000));
+}
+
+BOOST_AUTO_TEST_CASE(trap_memory_functions)
+{
+    unsigned char code[] = {
+        0x2f,0x3c, 0xff,0xff, 0xff,0xff,    //      move.l  #-1,-(sp)
+        0x3f,0x3c, 0x00,0x48,               //      move.w  #72,-(sp)       Malloc
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0x26,0x00,                          //      move.l  d0,d3           largest block
+        0x2f,0x3c, 0x00,0x00, 0x01,0x00,    //      move.l  #256,-(sp)
+        0x3f,0x3c, 0x00,0x48,               //      move.w  #72,-(sp)       Malloc
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0x28,0x00,                          //      move.l  d0,d4           block
+        0x2f,0x3c, 0x00,0x00, 0x00,0x10,    //      move.l  #16,-(sp)
+        0x2f,0x04,                          //      move.l  d4,-(sp)
+        0x3f,0x3c, 0x00,0x00,               //      move.w  #0,-(sp)
+        0x3f,0x3c, 0x00,0x4a,               //      move.w  #74,-(sp)       Mshrink
+        0x4e,0x41,                          //      trap    #1
+        0x4f,0xef, 0x00,0x0c,               //      lea     12(sp),sp
+        0x2a,0x00,                          //      move.l  d0,d5
+        0x2f,0x04,                          //      move.l  d4,-(sp)
+        0x3f,0x3c, 0x00,0x49,               //      move.w  #73,-(sp)       Mfree
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0x2c,0x00,                          //      move.l  d0,d6
+        0x2f,0x04,                          //      move.l  d4,-(sp)
+        0x3f,0x3c, 0x00,0x49,               //      move.w  #73,-(sp)       Mfree again
+        0x4e,0x41,                          //      trap    #1
+        0x5c,0x8f,                          //      addq.l  #6,sp
+        0xff,0xff };
+
+    // Arrange: the heap is the upper half of the memory without the stack reserve
+    std::vector<uint8_t> content(0x4000);
+    std::copy(std::begin(code), std::end(code), content.begin());
+    Memory memory(static_cast<uint32_t>(content.size()), 0, content.data(), static_cast<uint32_t>(content.size()));
+    Cpu cpu(memory);
+    AtariBios bios;
+    bios.setup();
+    bios.registerTrapHandlers(&cpu);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 0x4000, 0x3800);
+
+    // Assert
+    BOOST_CHECK_EQUAL(0x1000, cpu.d3);
+    BOOST_CHECK_EQUAL(0x2000, cpu.d4);
+    BOOST_CHECK_EQUAL(0, cpu.d5);
+    BOOST_CHECK_EQUAL(0, cpu.d6);
+    BOOST_CHECK_EQUAL(static_cast<uint32_t>(E_IMBA), cpu.d0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
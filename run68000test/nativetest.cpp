@@ -0,0 +1,189 @@
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "cpu.h"
+#include "nativeroutines.h"
+
+using namespace mc68000;
+
+BOOST_AUTO_TEST_SUITE(native)
+
+namespace
+{
+    // calls of the tinybasic routines, assembled with short branches at $40 and $60
+    const std::vector<uint16_t> program = {
+        0x227c, 0x0000, 0x0100,     // 00  movea.l #$100,a1
+        0x267c, 0x0000, 0x0108,     // 06  movea.l #$108,a3
+        0x247c, 0x0000, 0x0200,     // 0c  movea.l #$200,a2
+        0x6100, 0x002c,             // 12  bsr     MVUP
+        0x227c, 0x0000, 0x0108,     // 16  movea.l #$108,a1
+        0x247c, 0x0000, 0x0100,     // 1c  movea.l #$100,a2
+        0x267c, 0x0000, 0x0308,     // 22  movea.l #$308,a3
+        0x6100, 0x0020,             // 28  bsr     MVDOWN
+        0x41f8, 0x0180,             // 2c  lea     $180.w,a0
+        0x6100, 0x002e,             // 30  bsr     IGNBLK
+        0xffff };
+    const std::vector<uint16_t> routines = {
+        0xb7c9, 0x6704, 0x14d9, 0x60f8, 0x4e75,             // 40  MVUP
+        0xb5c9, 0x67fa, 0x1721, 0x60f8, 0, 0, 0, 0, 0, 0, 0, // 4a  MVDOWN
+        0x0c10, 0x0020, 0x6604, 0x5288, 0x60f6, 0x4e75 };   // 60  IGNBLK
+
+    Memory programMemory()
+    {
+        std::vector<uint8_t> bytes(0x400);
+        auto store = [&bytes](uint32_t address, const std::vector<uint16_t>& words)
+        {
+            for (uint16_t word : words)
+            {
+                bytes[address++] = static_cast<uint8_t>(word >> 8);
+                bytes[address++] = static_cast<uint8_t>(word);
+            }
+        };
+        store(0, program);
+        store(0x40, routines);
+        std::string text = "ABCDEFGH";
+        std::copy(text.begin(), text.end(), bytes.begin() + 0x100);
+        text = "   X";
+        std::copy(text.begin(), text.end(), bytes.begin() + 0x180);
+        return Memory(static_cast<uint32_t>(bytes.size()), 0, bytes.data(), static_cast<uint32_t>(bytes.size()));
+    }
+
+    std::string textAt(const Cpu& cpu, uint32_t address, size_t length)
+    {
+        std::string text;
+        for (size_t i = 0; i < length; i++)
+        {
+            text += static_cast<char>(cpu.mem.get<uint8_t>(address + static_cast<uint32_t>(i)));
+        }
+        return text;
+    }
+
+    void checkResults(const Cpu& cpu)
+    {
+        BOOST_CHECK_EQUAL("ABCDEFGH", textAt(cpu, 0x200, 8));
+        BOOST_CHECK_EQUAL("ABCDEFGH", textAt(cpu, 0x300, 8));
+        BOOST_CHECK_EQUAL(0x183, cpu.a0);
+        BOOST_CHECK_EQUAL(0x100, cpu.a1);
+        BOOST_CHECK_EQUAL(0x100, cpu.a2);
+        BOOST_CHECK_EQUAL(0x300, cpu.a3);
+        BOOST_CHECK_EQUAL(0x400, cpu.a7);
+        BOOST_CHECK_EQUAL(0, static_cast<uint8_t>(cpu.sr));
+    }
+
+    /// <summary>
+    /// Claims to be MVUP but only returns.
+    /// </summary>
+    class WrongMoveUp : public NativeRoutine
+    {
+    public:
+        const char* name() const override { return "MVUP"; }
+        bool execute(Cpu&, Memory&) override { return true; }
+    };
+
+    /// <summary>
+    /// Claims to be MVUP but writes a byte elsewhere.
+    /// </summary>
+    class ScribblingMoveUp : public NativeRoutine
+    {
+    public:
+        const char* name() const override { return "MVUP"; }
+        bool execute(Cpu&, Memory& memory) override
+        {
+            memory.set<uint8_t>(0x380, 'Z');
+            return true;
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(install_from_signatures)
+{
+    // Arrange
+    Cpu cpu(programMemory());
+    NativeRoutines natives;
+
+    // Act
+    size_t installed = natives.installFromSignatures(cpu);
+    cpu.reset();
+    cpu.start(0, 0x400, 0x400);
+
+    // Assert
+    BOOST_CHECK_EQUAL(3, installed);
+    checkResults(cpu);
+}
+
+BOOST_AUTO_TEST_CASE(install_from_symbols)
+{
+    // Arrange
+    {
+        std::ofstream symbols("native.sym");
+        symbols << "# Labels" << std::endl << "MVUP 64" << std::endl << "MVDOWN 74" << std::endl << "IGB1 102" << std::endl;
+    }
+    Cpu cpu(programMemory());
+    NativeRoutines natives;
+
+    // Act
+    size_t installed = natives.installFromSymbols(cpu, "native.sym");
+    cpu.reset();
+    cpu.start(0, 0x400, 0x400);
+
+    // Assert
+    BOOST_CHECK_EQUAL(2, installed);
+    checkResults(cpu);
+}
+
+BOOST_AUTO_TEST_CASE(verification_without_mismatch)
+{
+    // Arrange
+    Cpu cpu(programMemory());
+    NativeRoutines natives;
+    natives.installFromSignatures(cpu);
+    cpu.setNativeVerification(true);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 0x400, 0x400);
+
+    // Assert
+    BOOST_CHECK_EQUAL(0, cpu.getNativeMismatches());
+    checkResults(cpu);
+}
+
+BOOST_AUTO_TEST_CASE(verification_keeps_the_guest_results)
+{
+    // Arrange
+    Cpu cpu(programMemory());
+    WrongMoveUp wrong;
+    cpu.registerNativeRoutine(0x40, &wrong);
+    cpu.setNativeVerification(true);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 0x400, 0x400);
+
+    // Assert
+    BOOST_CHECK_EQUAL(1, cpu.getNativeMismatches());
+    checkResults(cpu);
+}
+
+BOOST_AUTO_TEST_CASE(verification_restores_the_memory_in_place)
+{
+    // Arrange
+    Cpu cpu(programMemory());
+    ScribblingMoveUp scribbling;
+    cpu.registerNativeRoutine(0x40, &scribbling);
+    cpu.setNativeVerification(true);
+    cpu.reset();
+    const void* buffer = cpu.mem.get<void*>(0);
+
+    // Act
+    cpu.start(0, 0x400, 0x400);
+
+    // Assert
+    BOOST_CHECK_EQUAL(1, cpu.getNativeMismatches());
+    BOOST_CHECK_EQUAL(0, cpu.mem.get<uint8_t>(0x380));
+    BOOST_CHECK(buffer == cpu.mem.get<void*>(0));
+    checkResults(cpu);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,7 @@
 #include <boost/test/unit_test.hpp>
+#include <cstdio>
 #include "osbios.h"
+#include "emulator.h"
 using namespace mc68000;
 
 BOOST_AUTO_TEST_SUITE(osbios)
@@ -197,4 +199,138 @@ BOOST_AUTO_TEST_CASE(sector_read_no_disk)
     // Assert
     BOOST_CHECK_EQUAL(0, cpu.d0);
 }
+BOOST_AUTO_TEST_CASE(sector_write)
+{
+    unsigned char code[] = {
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) sectorCount
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) sectorNumber
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) device
+    0x2f,0x3c, 0x00,0x00, 0x01, 0x00,   // move.l #256, -(sp)  buffer
+    0x3f,0x3c, 0x00,0x02,               // move.w #2, -(sp) diskwrite
+    0x4e,0x42,                          // trap   #2
+    0xdf,0xfc, 0x00, 0x00, 0x00, 0x0c,  // add.l  #12, sp
+    0xff,0xff };
+
+    // Arrange the configuration file
+    std::ofstream configFile("osbios.conf");
+    configFile << "disk1 = driveb.dsk" << std::endl;
+    configFile.close();
+
+    // Arrange the disk file with 2 sectors
+    std::ofstream disk("driveb.dsk", std::ios::binary);
+    BiosParameterBlock bpb(false);
+    disk.write(reinterpret_cast<char*>(&bpb), sizeof(BiosParameterBlock));
+    char sector[2 * 512 - sizeof(BiosParameterBlock)] = {};
+    disk.write(sector, sizeof(sector));
+    disk.close();
+
+    // Arrange the memory and CPU
+    Memory memory(256 + 512, 0, code, sizeof(code));
+    Cpu cpu(memory);
+    uint8_t* pcontent = static_cast<uint8_t*>(cpu.mem.get<void*>(256));
+    std::fill(pcontent, pcontent + 512, 0x44);
+    {
+        OSBios bios;
+        bios.setup();
+        bios.registerTrapHandlers(&cpu);
+
+        // Act
+        cpu.reset();
+        cpu.start(0, 256, 128);
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(512, cpu.d0);
+    std::ifstream written("driveb.dsk", std::ios::binary);
+    written.seekg(512);
+    char content[512];
+    written.read(content, sizeof(content));
+    BOOST_CHECK(written.good());
+    BOOST_CHECK_EQUAL(0x44, content[0]);
+    BOOST_CHECK_EQUAL(0x44, content[511]);
+}
+
+BOOST_AUTO_TEST_CASE(sector_read_out_of_range)
+{
+    unsigned char code[] = {
+    0x3f,0x3c, 0x00,0x02,               // move.w #2, -(sp) sectorCount
+    0x3f,0x3c, 0x00,0x00,               // move.w #0, -(sp) sectorNumber
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) device
+    0x2f,0x3c, 0x00,0x00, 0x01, 0x00,   // move.l #256, -(sp)  buffer
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) diskread
+    0x4e,0x42,                          // trap   #2
+    0xdf,0xfc, 0x00, 0x00, 0x00, 0x0c,  // add.l  #12, sp
+    0xff,0xff };
+
+    // Arrange the configuration file
+    std::ofstream configFile("osbios.conf");
+    configFile << "disk1 = drivec.dsk" << std::endl;
+    configFile.close();
+
+    // Arrange a disk file with a single sector
+    std::ofstream disk("drivec.dsk", std::ios::binary);
+    BiosParameterBlock bpb(false);
+    disk.write(reinterpret_cast<char*>(&bpb), sizeof(BiosParameterBlock));
+    char sector[512 - sizeof(BiosParameterBlock)] = {};
+    disk.write(sector, sizeof(sector));
+    disk.close();
+
+    // Arrange the memory and CPU: the buffer can hold the 2 sectors
+    Memory memory(256 + 2 * 512, 0, code, sizeof(code));
+    Cpu cpu(memory);
+    OSBios bios;
+    bios.setup();
+    bios.registerTrapHandlers(&cpu);
+
+    // Act
+    cpu.reset();
+    cpu.start(0, 256, 128);
+
+    // Assert
+    BOOST_CHECK_EQUAL(0, cpu.d0);
+}
+BOOST_AUTO_TEST_CASE(emulator_reads_osbios_conf)
+{
+    unsigned char code[] = {
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) sectorCount
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) sectorNumber
+    0x3f,0x3c, 0x00,0x01,               // move.w #1, -(sp) device
+    0x2f,0x3c, 0x00,0x00, 0x01, 0x00,   // move.l #256, -(sp)  buffer
+    0x3f,0x3c, 0x00,0x02,               // move.w #2, -(sp) diskwrite
+    0x4e,0x42,                          // trap   #2
+    0xdf,0xfc, 0x00, 0x00, 0x00, 0x0c,  // add.l  #12, sp
+    0xff,0xff };
+
+    // Arrange the configuration of the BIOS only
+    std::remove("run68000.conf");
+    std::ofstream configFile("osbios.conf");
+    configFile << "disk1 = drivec.dsk" << std::endl;
+    configFile.close();
+
+    // Arrange the disk file with 2 sectors of 0x55
+    std::ofstream disk("drivec.dsk", std::ios::binary);
+    BiosParameterBlock bpb(false);
+    disk.write(reinterpret_cast<char*>(&bpb), sizeof(BiosParameterBlock));
+    char sector[2 * 512 - sizeof(BiosParameterBlock)];
+    std::fill(std::begin(sector), std::end(sector), 0x55);
+    disk.write(sector, sizeof(sector));
+    disk.close();
+
+    // Act: the zeros of the memory are written to the second sector
+    {
+        Emulator emulator(2048, 0, code, sizeof(code));
+        emulator.setBios("os");
+        emulator.run();
+    }
+
+    // Assert
+    std::ifstream written("drivec.dsk", std::ios::binary);
+    written.seekg(512);
+    char content[512];
+    written.read(content, sizeof(content));
+    BOOST_CHECK(written.good());
+    BOOST_CHECK_EQUAL(0, content[0]);
+    BOOST_CHECK_EQUAL(0, content[511]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()